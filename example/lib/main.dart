@@ -40,6 +40,10 @@ class _MyAppState extends State<MyApp> {
               onPressed: () {
                 AgoraRtcEngine.requestAVPermissions();
               },
+            ),
+            FlatButton(
+              child: Text('benchmarkCallSetup'),
+              onPressed: _benchmarkCallSetup,
             )
           ],
         ),
@@ -105,7 +109,17 @@ class _MyAppState extends State<MyApp> {
     }
   }
 
-  static TextStyle textStyle = TextStyle(fontSize: 18, color: Colors.blue);
+  // Times the setup calls made one by one against a batch of them
+  void _benchmarkCallSetup() async {
+    final benchmark = await AgoraRtcEngine.benchmarkCallSetup();
+    setState(() {
+      _infoStrings.add('callSetup: ${benchmark.calls} calls, '
+          '${benchmark.oneByOneMicros} us one by one, '
+          '${benchmark.batchMicros} us batched');
+    });
+  }
+
+    static TextStyle textStyle = TextStyle(fontSize: 18, color: Colors.blue);
 
   Widget _buildInfoList() {
     return ListView.builder(
@@ -1,44 +1,49 @@
 #include "run_loop.h"
 
-#include <windows.h>
-
 #include <algorithm>
 
-RunLoop::RunLoop() {}
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+RunLoop::RunLoop() {
+  // High-resolution timers need Windows 10 1803, fall back to a regular one.
+  timer_ = ::CreateWaitableTimerExW(nullptr, nullptr,
+                                    CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                    TIMER_ALL_ACCESS);
+  if (!timer_) {
+    timer_ = ::CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+  }
+}
 
-RunLoop::~RunLoop() {}
+RunLoop::~RunLoop() {
+  if (timer_) {
+    ::CloseHandle(timer_);
+  }
+}
 
 void RunLoop::Run() {
   bool keep_running = true;
-  TimePoint next_flutter_event_time = TimePoint::clock::now();
   while (keep_running) {
-    std::chrono::nanoseconds wait_duration =
-        std::max(std::chrono::nanoseconds(0),
-                 next_flutter_event_time - TimePoint::clock::now());
-    ::MsgWaitForMultipleObjects(
-        0, nullptr, FALSE, static_cast<DWORD>(wait_duration.count() / 1000),
-        QS_ALLINPUT);
-    bool processed_events = false;
+    WaitForMessages(
+        scheduler_.TimeUntilFlutterEvent(RunLoopScheduler::Clock::now()));
     MSG message;
-    // All pending Windows messages must be processed; MsgWaitForMultipleObjects
-    // won't return again for items left in the queue after PeekMessage.
     while (::PeekMessage(&message, nullptr, 0, 0, PM_REMOVE)) {
-      processed_events = true;
       if (message.message == WM_QUIT) {
         keep_running = false;
         break;
       }
       ::TranslateMessage(&message);
       ::DispatchMessage(&message);
-      // Allow Flutter to process messages each time a Windows message is
-      // processed, to prevent starvation.
-      next_flutter_event_time =
-          std::min(next_flutter_event_time, ProcessFlutterMessages());
+      // Let Flutter run between messages when its work is due or the queue
+      // is long, rather than after every message.
+      if (scheduler_.OnWindowsMessage(RunLoopScheduler::Clock::now())) {
+        ProcessFlutterMessages();
+      }
     }
-    // If the PeekMessage loop didn't run, process Flutter messages.
-    if (!processed_events) {
-      next_flutter_event_time =
-          std::min(next_flutter_event_time, ProcessFlutterMessages());
+    if (keep_running &&
+        scheduler_.OnWindowsMessagesDrained(RunLoopScheduler::Clock::now())) {
+      ProcessFlutterMessages();
     }
   }
 }
@@ -53,14 +58,47 @@ void RunLoop::UnregisterFlutterInstance(
   flutter_instances_.erase(flutter_instance);
 }
 
-RunLoop::TimePoint RunLoop::ProcessFlutterMessages() {
+void RunLoop::WaitForMessages(RunLoopScheduler::Clock::duration timeout) {
+  if (timeout <= RunLoopScheduler::Clock::duration::zero()) {
+    return;
+  }
+  // MWMO_INPUTAVAILABLE also returns for messages already seen by an earlier
+  // PeekMessage but left in the queue.
+  if (timeout == RunLoopScheduler::Clock::duration::max()) {
+    ::MsgWaitForMultipleObjectsEx(0, nullptr, INFINITE, QS_ALLINPUT,
+                                  MWMO_INPUTAVAILABLE);
+    return;
+  }
+  // Negative due times are relative, in 100 ns units.
+  using HundredNanoseconds =
+      std::chrono::duration<int64_t, std::ratio<1, 10000000>>;
+  LARGE_INTEGER due_time;
+  due_time.QuadPart = -std::max<int64_t>(
+      1, std::chrono::ceil<HundredNanoseconds>(timeout).count());
+  if (timer_ &&
+      ::SetWaitableTimer(timer_, &due_time, 0, nullptr, nullptr, FALSE)) {
+    ::MsgWaitForMultipleObjectsEx(1, &timer_, INFINITE, QS_ALLINPUT,
+                                  MWMO_INPUTAVAILABLE);
+    return;
+  }
+  // Rounded up, waking early would only spin until the deadline.
+  int64_t milliseconds =
+      std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+  ::MsgWaitForMultipleObjectsEx(
+      0, nullptr,
+      static_cast<DWORD>(std::min<int64_t>(milliseconds, INFINITE - 1)),
+      QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+}
+
+void RunLoop::ProcessFlutterMessages() {
+  TimePoint started = RunLoopScheduler::Clock::now();
   TimePoint next_event_time = TimePoint::max();
   for (auto instance : flutter_instances_) {
     std::chrono::nanoseconds wait_duration = instance->ProcessMessages();
     if (wait_duration != std::chrono::nanoseconds::max()) {
-      next_event_time =
-          std::min(next_event_time, TimePoint::clock::now() + wait_duration);
+      next_event_time = std::min(
+          next_event_time, RunLoopScheduler::Clock::now() + wait_duration);
     }
   }
-  return next_event_time;
+  scheduler_.OnFlutterMessagesProcessed(started, next_event_time);
 }
@@ -2,10 +2,13 @@
 #define RUNNER_RUN_LOOP_H_
 
 #include <flutter/flutter_engine.h>
+#include <windows.h>
 
 #include <chrono>
 #include <set>
 
+#include "run_loop_scheduler.h"
+
 // A runloop that will service events for Flutter instances as well
 // as native messages.
 class RunLoop {
@@ -28,13 +31,24 @@ class RunLoop {
   void UnregisterFlutterInstance(
       flutter::FlutterEngine* flutter_instance);
 
+  const RunLoopMetrics& metrics() const { return scheduler_.metrics(); }
+
  private:
-  using TimePoint = std::chrono::steady_clock::time_point;
+  using TimePoint = RunLoopScheduler::TimePoint;
+
+  // Waits until a native message arrives or |timeout| elapses.
+  void WaitForMessages(RunLoopScheduler::Clock::duration timeout);
 
   // Processes all currently pending messages for registered Flutter instances.
-  TimePoint ProcessFlutterMessages();
+  void ProcessFlutterMessages();
 
   std::set<flutter::FlutterEngine*> flutter_instances_;
+
+  RunLoopScheduler scheduler_;
+
+  // A high-resolution waitable timer where available, so that deadlines are
+  // not rounded to milliseconds. Null if no timer could be created.
+  HANDLE timer_ = nullptr;
 };
 
 #endif  // RUNNER_RUN_LOOP_H_
@@ -0,0 +1,53 @@
+#include "run_loop_scheduler.h"
+
+#include <algorithm>
+
+RunLoopScheduler::RunLoopScheduler(int flutter_message_budget)
+    : flutter_message_budget_(std::max(1, flutter_message_budget)) {}
+
+RunLoopScheduler::Clock::duration RunLoopScheduler::TimeUntilFlutterEvent(
+    TimePoint now) const {
+  if (next_flutter_event_time_ == TimePoint::max()) {
+    return Clock::duration::max();
+  }
+  if (FlutterEventDue(now)) {
+    return Clock::duration::zero();
+  }
+  return next_flutter_event_time_ - now;
+}
+
+bool RunLoopScheduler::OnWindowsMessage(TimePoint now) {
+  metrics_.windows_messages++;
+  messages_since_flutter_++;
+  return FlutterEventDue(now) ||
+         messages_since_flutter_ >= flutter_message_budget_;
+}
+
+bool RunLoopScheduler::OnWindowsMessagesDrained(TimePoint now) {
+  metrics_.iterations++;
+  // Native messages may have posted Flutter work, e.g. platform channel
+  // replies, that the next event time does not account for yet.
+  return messages_since_flutter_ > 0 || FlutterEventDue(now);
+}
+
+void RunLoopScheduler::OnFlutterMessagesProcessed(TimePoint started,
+                                                  TimePoint next_event_time) {
+  metrics_.flutter_batches++;
+  if (next_flutter_event_time_ != TimePoint::min() &&
+      next_flutter_event_time_ != TimePoint::max() &&
+      started >= next_flutter_event_time_) {
+    auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        started - next_flutter_event_time_);
+    metrics_.latency_samples++;
+    metrics_.total_latency += latency;
+    metrics_.max_latency = std::max(metrics_.max_latency, latency);
+  }
+  // What Flutter reports replaces the previous deadline, which it has just
+  // served.
+  next_flutter_event_time_ = next_event_time;
+  messages_since_flutter_ = 0;
+}
+
+bool RunLoopScheduler::FlutterEventDue(TimePoint now) const {
+  return now >= next_flutter_event_time_;
+}
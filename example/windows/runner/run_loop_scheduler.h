@@ -0,0 +1,66 @@
+#ifndef RUNNER_RUN_LOOP_SCHEDULER_H_
+#define RUNNER_RUN_LOOP_SCHEDULER_H_
+
+#include <chrono>
+#include <cstdint>
+
+// Counters describing how well the run loop keeps up with Flutter.
+struct RunLoopMetrics {
+  uint64_t iterations = 0;
+  uint64_t windows_messages = 0;
+  uint64_t flutter_batches = 0;
+  // How late scheduled Flutter work ran compared to when it was due, over
+  // the batches that ran for a deadline.
+  uint64_t latency_samples = 0;
+  std::chrono::nanoseconds total_latency{0};
+  std::chrono::nanoseconds max_latency{0};
+
+  std::chrono::nanoseconds mean_latency() const {
+    return latency_samples == 0
+               ? std::chrono::nanoseconds(0)
+               : total_latency / static_cast<int64_t>(latency_samples);
+  }
+};
+
+// The platform-independent policy of the run loop: how long to wait for
+// native messages, and when to let Flutter process its messages.
+//
+// Flutter runs when its next event is due, once the native message queue
+// has been drained, and at most every |flutter_message_budget| native
+// messages while draining a long queue so that it is not starved.
+class RunLoopScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  explicit RunLoopScheduler(int flutter_message_budget = 16);
+
+  // How long to wait for native messages before Flutter work is due, zero
+  // if it is already due, or Clock::duration::max() if none is scheduled.
+  Clock::duration TimeUntilFlutterEvent(TimePoint now) const;
+
+  // Called after dispatching each native message, returns whether Flutter
+  // messages should be processed now.
+  bool OnWindowsMessage(TimePoint now);
+
+  // Called once no native message is left, returns whether Flutter messages
+  // should be processed now.
+  bool OnWindowsMessagesDrained(TimePoint now);
+
+  // Called with the time Flutter messages started being processed, and the
+  // time its next event is due, TimePoint::max() for none.
+  void OnFlutterMessagesProcessed(TimePoint started, TimePoint next_event_time);
+
+  const RunLoopMetrics& metrics() const { return metrics_; }
+
+ private:
+  bool FlutterEventDue(TimePoint now) const;
+
+  int flutter_message_budget_;
+  // Flutter starts with work to do.
+  TimePoint next_flutter_event_time_ = TimePoint::min();
+  int messages_since_flutter_ = 0;
+  RunLoopMetrics metrics_;
+};
+
+#endif  // RUNNER_RUN_LOOP_SCHEDULER_H_
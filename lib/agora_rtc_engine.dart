@@ -1,4 +1,5 @@
 import 'dart:async';
+import 'dart:typed_data';
 import 'dart:ui';
 
 import 'package:flutter/services.dart';
@@ -67,11 +68,73 @@ class AgoraRtcEngine {
   /// Reports the statistics of the RtcEngine once every two seconds.
   static void Function(RtcStats stats) onRtcStats;
 
+  // Data Transport Events
+  /// Occurs when a message sent with [sendData] by the remote user [uid] has been received in full.
+  static void Function(int uid, Uint8List data) onDataTransportMessage;
+
+  // Metadata Events
+  /// Occurs when a message sent with [sendMetadata] on [channel] by the remote user [uid] is received, along with the video frame it was attached to.
+  ///
+  /// [timeStampMs] is the timestamp of that video frame.
+  static void Function(int uid, int channel, Uint8List data, int timeStampMs)
+      onMetadataReceived;
+
+  // Channel Media Relay Events
+  /// Occurs when the state of a destination channel set with [setChannelMediaRelayDestination] changes.
+  ///
+  /// [error] is the last relay error code, or a negative SDK error code when the relay could not be started or updated.
+  static void Function(
+          String channelName, RelayDestinationState state, int error)
+      onChannelMediaRelayDestinationStateChanged;
+
+  // Device Events
+  /// Occurs when devices are added or removed, or when the device used by the engine changes.
+  ///
+  /// Not raised for the devices present when the engine is created, and only once hot-plug notifications have stopped for 250 ms.
+  static void Function(List<DeviceChange> changes) onDevicesChanged;
+
+  // Encoder Auto-Tuning Events
+  /// Occurs when encoder auto-tuning changes the video encoder configuration.
+  static void Function(EncoderTuningDecision decision) onEncoderTuningDecision;
+
+  // Network Pre-Flight Events
+  /// Occurs when the probe of a [runNetworkPreflight] answered from the last-mile quality completes, with the plan from its bandwidth estimate.
+  ///
+  /// The plan is not applied to the engine. Later preflights on the same network start from it.
+  static void Function(NetworkPreflightPlan plan) onNetworkPreflightRefined;
+
+  // Token Events
+  /// Occurs when the token manager needs a token for [channelId] and [uid], with the app as the provider.
+  ///
+  /// Answer with [provideToken] and the same [requestId].
+  static void Function(int requestId, String channelId, int uid)
+      onTokenRequired;
+
+  // Raw Audio Data Events
+  /// Occurs about every 100 ms with the 16-bit PCM [samples] read by the audio tap [tapId], interleaved when [channels] is 2.
+  static void Function(
+          int tapId, int sampleRate, int channels, Int16List samples)
+      onAudioFrame;
+
+  /// Occurs about every 100 ms with the [frames] log-mel feature frames extracted by [extractorId], [bins] values each.
+  ///
+  /// [firstFrame] counts the 10 ms frames since the extractor started, so a gap from the previous call tells how many were dropped.
+  static void Function(int extractorId, int firstFrame, int frames, int bins,
+      Float32List features) onLogMelFeatures;
+
+  // Engine Events
+  /// Occurs with each engine event subscribed to with [subscribeEvents] that has no callback of its own.
+  ///
+  /// [event] is the name of the `IRtcEngineEventHandler` callback, and [arguments] holds its arguments by parameter name.
+  static void Function(String event, Map<dynamic, dynamic> arguments)
+      onEngineEvent;
+
   // Core Methods
   /// Creates an RtcEngine instance.
   ///
   /// The Agora SDK only supports one RtcEngine instance at a time, therefore the app should create one RtcEngine object only.
   /// Only users with the same App ID can join the same channel and call each other.
+  /// The windows of a desktop app share the instance: each window creates and destroys it, the first creating it and the last releasing it, and all must use the same App ID.
   static Future<void> create(String appid) async {
     await _channel.invokeMethod('create', {'appId': appid});
     _addEventChannelHandler();
@@ -97,17 +160,35 @@ class AgoraRtcEngine {
         .invokeMethod('setChannelProfile', {'profile': profile.index});
   }
 
+  /// Sets the role of the user in a live broadcast.
+  static Future<bool> setClientRole(ClientRole role) async {
+    // CLIENT_ROLE_BROADCASTER is 1
+    final bool success = await _channel
+        .invokeMethod('setClientRole', {'role': role.index + 1});
+    return success;
+  }
+
   /// Allows a user to join a channel.
   ///
   /// Users in the same channel can talk to each other, and multiple users in the same channel can start a group chat. Users with different App IDs cannot call each other.
   /// You must call the [leaveChannel] method to exit the current call before joining another channel.
   /// A channel does not accept duplicate uids, such as two users with the same uid. If you set uid as 0, the system automatically assigns a uid.
+  /// With the token manager enabled, a null [token] joins with one from the manager, prefetched with [prefetchToken] or fetched first.
   static Future<bool> joinChannel(String token, String channelId, String info, int uid) async {
     final bool success = await _channel.invokeMethod('joinChannel',
         {'token': token, 'channelId': channelId, 'info': info, 'uid': uid});
     return success;
   }
 
+  /// Switches an audience in a live broadcast from the current channel to [channelId].
+  ///
+  /// With the token manager enabled, a null [token] switches with one from the manager, prefetched with [prefetchToken] or fetched first.
+  static Future<bool> switchChannel(String token, String channelId) async {
+    final bool success = await _channel.invokeMethod(
+        'switchChannel', {'token': token, 'channelId': channelId});
+    return success;
+  }
+
   /// Allows a user to leave a channel.
   ///
   /// If you call the [destroy] method immediately after calling this method, the leaveChannel process interrupts, and the SDK does not trigger the onLeaveChannel callback.
@@ -128,6 +209,745 @@ class AgoraRtcEngine {
     await _channel.invokeMethod('muteAllRemoteAudioStreams', {'muted': muted});
   }
 
+  // Video Render Policy
+  /// Sets how the video frames of [uid] are handled natively. Use 0 for the local capture.
+  ///
+  /// Frames of a hidden tile are dropped before any copy or conversion, and frames arriving faster than [maxFps] are skipped.
+  /// Frames larger than [maxWidth] x [maxHeight] are dropped. When that size is small enough, the low-quality stream of a remote user that publishes dual streams is received instead.
+  /// A limit of 0 means unlimited. The policy of a remote user is forgotten when the user goes offline or the channel is left.
+  static Future<void> setRenderPolicy(int uid,
+      {bool visible = true, int maxFps = 0, int maxWidth = 0, int maxHeight = 0}) async {
+    await _channel.invokeMethod('setRenderPolicy', {
+      'uid': uid,
+      'visible': visible,
+      'maxFps': maxFps,
+      'maxWidth': maxWidth,
+      'maxHeight': maxHeight,
+    });
+  }
+
+  /// Removes the render policy of [uid], so that all of its frames are delivered again.
+  static Future<void> removeRenderPolicy(int uid) async {
+    await _channel.invokeMethod('removeRenderPolicy', {'uid': uid});
+  }
+
+  /// Gets the counters of frames skipped by the render policies, by reason, and the bytes of frame data they spared.
+  static Future<RenderPolicyStats> getRenderPolicyStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getRenderPolicyStats');
+    return RenderPolicyStats.fromJson(map);
+  }
+
+  // Snapshot
+  /// Takes a still image of the next video frame of [uid]. Use 0 for the local capture.
+  ///
+  /// The longer side of the image is at most [maxSize] pixels, 0 keeps the frame size.
+  /// Concurrent requests for the same uid share one frame.
+  /// Fails with `SNAPSHOT_TIMEOUT` if no frame arrives within 5 seconds, and with `SNAPSHOT_CANCELLED` if the user goes offline first.
+  static Future<Uint8List> takeSnapshot(int uid,
+      {int maxSize = 0, ImageFormat format = ImageFormat.Png}) async {
+    final Uint8List bytes = await _channel.invokeMethod('takeSnapshot',
+        {'uid': uid, 'maxSize': maxSize, 'format': format.index});
+    return bytes;
+  }
+
+  /// Gets the counters of the snapshot requests and the average encoding time.
+  static Future<SnapshotStats> getSnapshotStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getSnapshotStats');
+    return SnapshotStats.fromJson(map);
+  }
+
+  // Packet Encryption
+  /// Encrypts every sent media packet and decrypts every received one with [cipher], using a [key] of 16, 24 or 32 bytes shared by all users in the channel.
+  ///
+  /// This replaces the built-in encryption, so it must be set to the same cipher and key by every user, before [joinChannel].
+  /// Packets failing [PacketCipher.AesGcm] authentication are dropped. Use [PacketCipher.None] to stop encrypting.
+  /// After 2^32 sent packets, about 50 days of a call, packets are dropped until the key is set again.
+  static Future<void> setPacketEncryption(PacketCipher cipher,
+      [Uint8List key]) async {
+    await _channel.invokeMethod(
+        'setPacketEncryption', {'cipher': cipher.index, 'key': key});
+  }
+
+  /// Gets the per-direction packet counters and the time spent transforming packets.
+  static Future<PacketStats> getPacketStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getPacketStats');
+    return PacketStats.fromJson(map);
+  }
+
+  // Packet Capture
+  /// Records sent and received media packets, as they are on the wire, to pcapng files at [path].
+  ///
+  /// Only the first [snapLength] bytes of each packet are kept, 0 keeps whole packets.
+  /// Once a file exceeds [maxFileSize] bytes a new one is started as `path.1`, `path.2`, ..., and only the last [maxFiles] files are kept. 0 means unlimited.
+  static Future<void> startPacketCapture(String path,
+      {int snapLength = 0, int maxFileSize = 0, int maxFiles = 0}) async {
+    await _channel.invokeMethod('startPacketCapture', {
+      'path': path,
+      'snapLength': snapLength,
+      'maxFileSize': maxFileSize,
+      'maxFiles': maxFiles,
+    });
+  }
+
+  /// Stops recording packets and flushes what is still queued.
+  static Future<void> stopPacketCapture() async {
+    await _channel.invokeMethod('stopPacketCapture');
+  }
+
+  /// Gets the counters of the current packet capture.
+  static Future<PacketCaptureStats> getPacketCaptureStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getPacketCaptureStats');
+    return PacketCaptureStats.fromJson(map);
+  }
+
+  // Data Transport
+  /// Opens a reliable, ordered data stream that carries messages of any size, received with [onDataTransportMessage].
+  ///
+  /// Messages are paced to stay within [packetsPerSecond] and [bytesPerSecond], batched when small, fragmented when large and compressed with LZ4 when [compress] makes them smaller.
+  /// A packet the engine fails to send is sent again before any later one, so no message is lost or reordered while the transport is open.
+  /// Call it after [joinChannel]. Every user in the channel must use the data transport to read the messages.
+  static Future<void> openDataTransport(
+      {bool compress = true,
+      double packetsPerSecond = 30,
+      double bytesPerSecond = 6144}) async {
+    await _channel.invokeMethod('openDataTransport', {
+      'compress': compress,
+      'packetsPerSecond': packetsPerSecond,
+      'bytesPerSecond': bytesPerSecond,
+    });
+  }
+
+  /// Closes the data transport, dropping the messages not sent yet.
+  static Future<void> closeDataTransport() async {
+    await _channel.invokeMethod('closeDataTransport');
+  }
+
+  /// Queues [data] to be sent to every user in the channel.
+  ///
+  /// Returns false if too many bytes are already waiting to be sent.
+  static Future<bool> sendData(Uint8List data) async {
+    final bool success =
+        await _channel.invokeMethod('sendData', {'data': data});
+    return success;
+  }
+
+  /// Gets the counters and the payload throughput of the data transport.
+  static Future<DataTransportStats> getDataTransportStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getDataTransportStats');
+    return DataTransportStats.fromJson(map);
+  }
+
+  // Metadata
+  /// Adds or reconfigures a metadata [channel], from 0 to 31, whose messages are attached to the local video frames.
+  ///
+  /// Each frame carries up to 1 KB of metadata, packed from channels with a higher [priority] first.
+  /// Up to [queueLength] messages wait for a frame, the oldest is dropped beyond that.
+  /// With [latestOnly], only the newest message is kept, e.g. for cursor positions.
+  static Future<void> setMetadataChannel(int channel,
+      {int priority = 0, int queueLength = 8, bool latestOnly = false}) async {
+    await _channel.invokeMethod('setMetadataChannel', {
+      'channel': channel,
+      'priority': priority,
+      'queueLength': queueLength,
+      'latestOnly': latestOnly,
+    });
+  }
+
+  /// Removes a metadata [channel] and drops its queued messages.
+  static Future<void> removeMetadataChannel(int channel) async {
+    await _channel.invokeMethod('removeMetadataChannel', {'channel': channel});
+  }
+
+  /// Queues [data], of at most 1020 bytes, to be attached to the next local video frame with room for it.
+  ///
+  /// Returns false if [channel] was not set or [data] is too large.
+  static Future<bool> sendMetadata(int channel, Uint8List data) async {
+    final bool success = await _channel
+        .invokeMethod('sendMetadata', {'channel': channel, 'data': data});
+    return success;
+  }
+
+  /// Gets the per-channel message counters and how full the metadata slots are.
+  static Future<MetadataStats> getMetadataStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getMetadataStats');
+    return MetadataStats.fromJson(map);
+  }
+
+  // Transcoding Layout
+  /// Lays out the hosts in the channel with [layout] and applies it with `setLiveTranscoding` whenever a host joins or leaves.
+  ///
+  /// Bursts of changes within [debounceMs] of each other are applied together, and a layout is only applied when it differs from the current one.
+  /// The speaker featured by [LayoutTemplate.SpeakerFocus] and [LayoutTemplate.PictureInPicture] follows the active speaker, or [setTranscodingSpeaker].
+  /// At most 17 hosts are laid out.
+  static Future<void> setTranscodingLayout(LayoutTemplate layout,
+      {int width = 640,
+      int height = 360,
+      int videoBitrate = 400,
+      int videoFramerate = 15,
+      int backgroundColor = 0,
+      int debounceMs = 200}) async {
+    await _channel.invokeMethod('setTranscodingLayout', {
+      'layout': layout.index,
+      'width': width,
+      'height': height,
+      'videoBitrate': videoBitrate,
+      'videoFramerate': videoFramerate,
+      'backgroundColor': backgroundColor,
+      'debounceMs': debounceMs,
+    });
+  }
+
+  /// Features the host [uid] in the transcoding layout.
+  static Future<void> setTranscodingSpeaker(int uid) async {
+    await _channel.invokeMethod('setTranscodingSpeaker', {'uid': uid});
+  }
+
+  /// Stops applying transcoding layouts. The last one applied stays in effect.
+  static Future<void> stopTranscodingLayout() async {
+    await _channel.invokeMethod('stopTranscodingLayout');
+  }
+
+  /// Gets how many layouts were computed, applied or skipped as unchanged.
+  static Future<TranscodingLayoutStats> getTranscodingLayoutStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getTranscodingLayoutStats');
+    return TranscodingLayoutStats.fromJson(map);
+  }
+
+  // Channel Media Relay
+  /// Sets the [token] and [uid] used in the source channel of the media relay. By default, those of the current channel are used.
+  static Future<void> setChannelMediaRelaySource(
+      {String token, int uid = 0}) async {
+    await _channel.invokeMethod(
+        'setChannelMediaRelaySource', {'token': token, 'uid': uid});
+  }
+
+  /// Relays the media stream to [channelName], or changes the [token] and [uid] used there.
+  ///
+  /// Changes made within 100 ms of each other are applied in a single `startChannelMediaRelay` or `updateChannelMediaRelay` call.
+  /// Failures are retried with exponential backoff, and the state of each destination is reported by [onChannelMediaRelayDestinationStateChanged].
+  /// At most 4 destination channels are supported.
+  static Future<void> setChannelMediaRelayDestination(String channelName,
+      {String token, int uid = 0}) async {
+    await _channel.invokeMethod('setChannelMediaRelayDestination',
+        {'channelName': channelName, 'token': token, 'uid': uid});
+  }
+
+  /// Stops relaying the media stream to [channelName].
+  static Future<void> removeChannelMediaRelayDestination(
+      String channelName) async {
+    await _channel.invokeMethod(
+        'removeChannelMediaRelayDestination', {'channelName': channelName});
+  }
+
+  /// Stops relaying the media stream to every destination channel.
+  static Future<void> removeAllChannelMediaRelayDestinations() async {
+    await _channel.invokeMethod('removeAllChannelMediaRelayDestinations');
+  }
+
+  /// Gets the state of each destination channel and how many relay calls were made.
+  static Future<ChannelMediaRelayStats> getChannelMediaRelayStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getChannelMediaRelayStats');
+    return ChannelMediaRelayStats.fromJson(map);
+  }
+
+  // Devices
+  /// Gets the audio playback, audio recording or video capture devices.
+  ///
+  /// Devices are enumerated in the background when the engine is created and when they are plugged or unplugged, so this returns the cached list.
+  static Future<List<DeviceInfo>> getDevices(DeviceKind kind) async {
+    final List<dynamic> list =
+        await _channel.invokeMethod('getDevices', {'kind': kind.index});
+    return list.map((e) => DeviceInfo.fromJson(e)).toList();
+  }
+
+  /// Enumerates the devices again, reporting differences with [onDevicesChanged].
+  static Future<void> refreshDevices() async {
+    await _channel.invokeMethod('refreshDevices');
+  }
+
+  // Encoder Auto-Tuning
+  /// Steps the video encoder configuration along [levels], from the lightest to the heaviest, starting at [startLevel].
+  ///
+  /// It steps down when the total CPU usage exceeds [cpuHigh] percent, the encoder cannot keep up with the frame rate or the uplink quality is poor, for [downSamples] consecutive `onRtcStats` reports.
+  /// It steps up when the CPU usage is below [cpuLow] and the uplink quality is good, for [upSamples] consecutive reports.
+  /// Steps are at least [minIntervalMs] apart, and stepping up waits [upHoldMs] after stepping down.
+  /// A ladder from 320x180 at 15 fps to 1280x720 at 30 fps is used if [levels] is null, and its heaviest level if [startLevel] is null.
+  static Future<void> enableEncoderAutoTuning(
+      {List<EncoderLevel> levels,
+      int startLevel,
+      double cpuHigh = 85,
+      double cpuLow = 60,
+      int downSamples = 2,
+      int upSamples = 5,
+      int minIntervalMs = 6000,
+      int upHoldMs = 20000}) async {
+    await _channel.invokeMethod('enableEncoderAutoTuning', {
+      'levels': levels?.map((e) => e.toJson())?.toList(),
+      'startLevel': startLevel ?? -1,
+      'cpuHigh': cpuHigh,
+      'cpuLow': cpuLow,
+      'downSamples': downSamples,
+      'upSamples': upSamples,
+      'minIntervalMs': minIntervalMs,
+      'upHoldMs': upHoldMs,
+    });
+  }
+
+  /// Stops encoder auto-tuning, keeping the current configuration.
+  static Future<void> disableEncoderAutoTuning() async {
+    await _channel.invokeMethod('disableEncoderAutoTuning');
+  }
+
+  /// Gets the last 64 encoder auto-tuning decisions.
+  static Future<List<EncoderTuningDecision>> getEncoderTuningLog() async {
+    final List<dynamic> list =
+        await _channel.invokeMethod('getEncoderTuningLog');
+    return list.map((e) => EncoderTuningDecision.fromJson(e)).toList();
+  }
+
+  // Event Tracing
+  /// Records every engine event with its arguments and time to the binary trace at [path], until [stopEventRecording].
+  static Future<void> startEventRecording(String path) async {
+    await _channel.invokeMethod('startEventRecording', {'path': path});
+  }
+
+  /// Stops recording engine events and closes the trace.
+  static Future<EventRecordingStats> stopEventRecording() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('stopEventRecording');
+    return EventRecordingStats.fromJson(map);
+  }
+
+  /// Sends the events of the trace at [path] to their subscribed handlers as if they came from the engine, completing once the trace ends.
+  ///
+  /// Replayed events do not reach the native components of the plugin, such as the encoder tuner, the media relay or the data transport, so a replay never acts on the engine. They are not counted by [getEventCounters].
+  /// Events are replayed at [speed] times their recorded pace, or as fast as they are handled if [speed] is 0.
+  static Future<EventReplayStats> replayEventTrace(String path,
+      {double speed = 1}) async {
+    final Map<dynamic, dynamic> map = await _channel
+        .invokeMethod('replayEventTrace', {'path': path, 'speed': speed});
+    return EventReplayStats.fromJson(map);
+  }
+
+  /// Stops the running replay, completing [replayEventTrace] with what was replayed.
+  static Future<void> stopEventReplay() async {
+    await _channel.invokeMethod('stopEventReplay');
+  }
+
+  // Engine Events
+  /// Sends the engine events named in [events], such as `onNetworkQuality`, to [onEngineEvent] or their own callbacks.
+  ///
+  /// Events nobody subscribes to are dropped natively before their arguments are encoded.
+  /// `onJoinChannelSuccess`, `onLeaveChannel`, `onUserJoined`, `onUserOffline`, `onRtcStats` and `onRemoteAudioStats` are subscribed to by default.
+  static Future<void> subscribeEvents(List<String> events) async {
+    await _channel.invokeMethod('subscribeEvents', {'events': events});
+  }
+
+  /// Stops sending the engine events named in [events].
+  static Future<void> unsubscribeEvents(List<String> events) async {
+    await _channel.invokeMethod('unsubscribeEvents', {'events': events});
+  }
+
+  /// Gets how many times each engine event occurred and was sent, by event name.
+  static Future<Map<String, EventCounters>> getEventCounters() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getEventCounters');
+    return map.map((key, value) =>
+        MapEntry<String, EventCounters>(key, EventCounters.fromJson(value)));
+  }
+
+  // Batch Calls
+  /// Makes [calls] in order through one platform channel message, returning the outcome of each.
+  ///
+  /// A failing call does not stop the following ones. The calls do the same work as when made one by one, see
+  /// [benchmarkCallSetup] for the time sending them together saves.
+  static Future<List<BatchResult>> batch(List<BatchCall> calls) async {
+    final List<dynamic> list = await _channel.invokeMethod(
+        'batch', {'calls': calls.map((e) => e.toJson()).toList()});
+    return list.map((e) => BatchResult.fromJson(e)).toList();
+  }
+
+  // Audio Effects
+  /// Sets how much memory, in estimated decoded bytes, preloaded effects may take and which ones to evict beyond it.
+  ///
+  /// With [predict], the effects that usually follow the one played are preloaded ahead of time.
+  static Future<void> configureEffectCache(
+      {int memoryBudget = 64 * 1024 * 1024,
+      EffectEvictionPolicy policy = EffectEvictionPolicy.Lru,
+      bool predict = true}) async {
+    await _channel.invokeMethod('configureEffectCache', {
+      'memoryBudget': memoryBudget,
+      'policy': policy.index,
+      'predict': predict,
+    });
+  }
+
+  /// Registers the effect in [filePath] as [soundId], to be preloaded when prefetched or played.
+  ///
+  /// Its decoded size is estimated from the file unless [bytes] is given. [soundId] is from 0 to 65535, each window has
+  /// its own sound ids on the engine it shares with the others.
+  static Future<void> registerEffect(int soundId, String filePath,
+      {int bytes = -1}) async {
+    await _channel.invokeMethod('registerEffect',
+        {'soundId': soundId, 'filePath': filePath, 'bytes': bytes});
+  }
+
+  /// Unregisters [soundId], unloading it.
+  static Future<void> unregisterEffect(int soundId) async {
+    await _channel.invokeMethod('unregisterEffect', {'soundId': soundId});
+  }
+
+  /// Preloads the registered [soundIds] in the background, in this order, as long as they fit the memory budget.
+  static Future<void> prefetchEffects(List<int> soundIds) async {
+    await _channel.invokeMethod('prefetchEffects', {'soundIds': soundIds});
+  }
+
+  /// Plays the registered effect [soundId], from memory when it is preloaded.
+  ///
+  /// Returns the SDK's result, 0 on success.
+  static Future<int> playEffect(int soundId,
+      {int loopCount = 0,
+      double pitch = 1,
+      double pan = 0,
+      int gain = 100,
+      bool publish = false}) async {
+    return await _channel.invokeMethod('playEffect', {
+      'soundId': soundId,
+      'loopCount': loopCount,
+      'pitch': pitch,
+      'pan': pan,
+      'gain': gain,
+      'publish': publish,
+    });
+  }
+
+  /// Stops [soundId], which may then be evicted.
+  static Future<void> stopEffect(int soundId) async {
+    await _channel.invokeMethod('stopEffect', {'soundId': soundId});
+  }
+
+  /// Stops all effects, including those other windows sharing the engine play, which may then be evicted.
+  static Future<void> stopAllEffects() async {
+    await _channel.invokeMethod('stopAllEffects');
+  }
+
+  /// Gets the effect cache hit rate and how long playing took with and without preloading.
+  static Future<AudioEffectCacheStats> getEffectCacheStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getEffectCacheStats');
+    return AudioEffectCacheStats.fromJson(map);
+  }
+
+  // Channel Switching
+  /// Moves to [channelId] without releasing the engine, keeping the audio, video and encoder configuration.
+  ///
+  /// An audience member in a live broadcast switches in a single call, other users leave and join again.
+  /// With the token manager enabled, a null [token] uses one from the manager, fetched ahead of time with [prepareChannelSwitch].
+  /// Completes at the first remote audio or video frame, or after [timeoutMs] if none arrives, with how long each step took.
+  static Future<ChannelSwitchResult> switchToChannel(String channelId,
+      {String token, int timeoutMs = 10000}) async {
+    final Map<dynamic, dynamic> map = await _channel.invokeMethod(
+        'switchToChannel',
+        {'channelId': channelId, 'token': token, 'timeoutMs': timeoutMs});
+    return ChannelSwitchResult.fromJson(map);
+  }
+
+  /// Fetches the token for a later [switchToChannel] to [channelId], when the token manager is enabled.
+  static Future<void> prepareChannelSwitch(String channelId) async {
+    await _channel
+        .invokeMethod('prepareChannelSwitch', {'channelId': channelId});
+  }
+
+  /// Gets how many switches succeeded and how long they took on average.
+  static Future<ChannelSwitchStats> getChannelSwitchStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getChannelSwitchStats');
+    return ChannelSwitchStats.fromJson(map);
+  }
+
+  // Token Management
+  /// Has the engine's token renewed before it expires and tokens for other channels fetched ahead of time.
+  ///
+  /// Tokens come from the app through [onTokenRequired] with [provider] `'app'`, or are made up locally with `'stub'`,
+  /// taking [stubLatencyMs] and lasting [stubTtlSeconds], for testing without a token server.
+  /// Tokens are renewed [renewAheadSeconds] before they expire, or halfway through their lifetime if shorter.
+  /// Failed renewals are retried after [retryMs], doubling up to 30 seconds.
+  static Future<void> enableTokenManager(
+      {String provider = 'app',
+      int renewAheadSeconds = 60,
+      int fetchTimeoutMs = 10000,
+      int retryMs = 1000,
+      int stubLatencyMs = 100,
+      int stubTtlSeconds = 3600}) async {
+    await _channel.invokeMethod('enableTokenManager', {
+      'provider': provider,
+      'renewAheadSeconds': renewAheadSeconds,
+      'fetchTimeoutMs': fetchTimeoutMs,
+      'retryMs': retryMs,
+      'stubLatencyMs': stubLatencyMs,
+      'stubTtlSeconds': stubTtlSeconds,
+    });
+  }
+
+  /// Stops renewing tokens and forgets the prefetched ones.
+  static Future<void> disableTokenManager() async {
+    await _channel.invokeMethod('disableTokenManager');
+  }
+
+  /// Answers [onTokenRequired] with [token], or a failure when null.
+  ///
+  /// [expiresAt] is in seconds since the Unix epoch, or 0 when unknown, in which case the token is only renewed when the SDK asks.
+  /// Returns false if the request was already answered or timed out.
+  static Future<bool> provideToken(int requestId, String token,
+      {int expiresAt = 0}) async {
+    return await _channel.invokeMethod('provideToken',
+        {'requestId': requestId, 'token': token, 'expiresAt': expiresAt});
+  }
+
+  /// Fetches a token for [channelId] and [uid] in the background, for a later [joinChannel] or [switchChannel] to use at once.
+  static Future<void> prefetchToken(String channelId, int uid) async {
+    await _channel
+        .invokeMethod('prefetchToken', {'channelId': channelId, 'uid': uid});
+  }
+
+  /// Gets the latest token fetches and renewals, with how long each took.
+  static Future<List<TokenEvent>> getTokenRenewalLog() async {
+    final List<dynamic> list =
+        await _channel.invokeMethod('getTokenRenewalLog');
+    return list.map((e) => TokenEvent.fromJson(e)).toList();
+  }
+
+  /// Gets how many tokens were fetched or served from the prefetched ones.
+  static Future<TokenManagerStats> getTokenManagerStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getTokenManagerStats');
+    return TokenManagerStats.fromJson(map);
+  }
+
+  // Network Pre-Flight
+  /// Measures the last mile with a probe test and picks the encoder level and audio profile it carries, before joining.
+  ///
+  /// Completes with the first last-mile quality report, about 2 seconds into the probe. The probe's bandwidth estimate arrives within 30 seconds and is reported with [onNetworkPreflightRefined].
+  /// The video uses up to [headroom] of the measured uplink bandwidth, picking from [levels] or the encoder auto-tuning ladder when null.
+  /// Measurements are cached for [cacheTtlMs] per network type and [networkId], e.g. a Wi-Fi SSID, so preflights on a known network return at once.
+  /// Without a [networkId] nothing is cached while the network type is unknown.
+  /// The plan is applied to the engine when [apply] is true, which also resets the audio scenario.
+  static Future<NetworkPreflightPlan> runNetworkPreflight(
+      {List<EncoderLevel> levels,
+      String networkId = '',
+      int cacheTtlMs = 600000,
+      bool forceProbe = false,
+      int timeoutMs = 35000,
+      double headroom = 0.7,
+      bool apply = true}) async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('runNetworkPreflight', {
+      'levels': levels?.map((e) => e.toJson())?.toList(),
+      'networkId': networkId,
+      'cacheTtlMs': cacheTtlMs,
+      'forceProbe': forceProbe,
+      'timeoutMs': timeoutMs,
+      'headroom': headroom,
+      'apply': apply,
+    });
+    return NetworkPreflightPlan.fromJson(map);
+  }
+
+  /// Gets how many preflights were served from the cache or probed.
+  static Future<NetworkPreflightStats> getNetworkPreflightStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getNetworkPreflightStats');
+    return NetworkPreflightStats.fromJson(map);
+  }
+
+  /// Forgets the cached measurements, e.g. after connecting a VPN.
+  static Future<void> clearNetworkPreflightCache() async {
+    await _channel.invokeMethod('clearNetworkPreflightCache');
+  }
+
+  // Screen Sharing
+  /// Shares the window with handle [windowId], or the screen region at [x], [y] of [width] by [height], as the local video.
+  ///
+  /// The whole virtual screen is shared when neither is given. Frames are only sent when their content changes,
+  /// capturing at [maxFrameRate] while it does and slowing down to [minFrameRate] while it does not.
+  /// An unchanged frame is still sent every [refreshIntervalMs] milliseconds.
+  static Future<void> startScreenShare(
+      {int windowId = 0,
+      int x = 0,
+      int y = 0,
+      int width = 0,
+      int height = 0,
+      int maxFrameRate = 15,
+      int minFrameRate = 1,
+      int refreshIntervalMs = 2000}) async {
+    await _channel.invokeMethod('startScreenShare', {
+      'windowId': windowId,
+      'x': x,
+      'y': y,
+      'width': width,
+      'height': height,
+      'maxFrameRate': maxFrameRate,
+      'minFrameRate': minFrameRate,
+      'refreshIntervalMs': refreshIntervalMs,
+    });
+  }
+
+  /// Stops sharing, returning the final statistics.
+  static Future<ScreenShareStats> stopScreenShare() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('stopScreenShare');
+    return ScreenShareStats.fromJson(map);
+  }
+
+  /// Gets the statistics of the current or last screen share.
+  static Future<ScreenShareStats> getScreenShareStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getScreenShareStats');
+    return ScreenShareStats.fromJson(map);
+  }
+
+  // Raw Audio Data
+  /// Starts reading the [source] audio frames as [sampleRate] Hz, from 8000 to 48000, with 1 or 2 [channels], delivered to [onAudioFrame].
+  ///
+  /// The SDK is asked for the highest rate and the most channels any tap of [source] wants; the other taps get frames resampled once per format.
+  /// Frames the app does not keep up with are dropped, oldest first. Only the window owning the engine, see [EngineBrokerStats.engineOwner], can tap its audio.
+  /// Returns the tap's id.
+  static Future<int> startAudioTap(AudioFrameSource source,
+      {int sampleRate = 16000, int channels = 1}) async {
+    final int tapId = await _channel.invokeMethod('startAudioTap', {
+      'source': AudioFrameSource.values.indexOf(source),
+      'sampleRate': sampleRate,
+      'channels': channels,
+    });
+    return tapId;
+  }
+
+  /// Stops the audio tap [tapId], delivering the samples it read since the last [onAudioFrame].
+  static Future<void> stopAudioTap(int tapId) async {
+    await _channel.invokeMethod('stopAudioTap', {'tapId': tapId});
+  }
+
+  /// Gets how the raw audio frames were delivered to the audio taps, and how many each tap dropped.
+  static Future<AudioFrameStats> getAudioFrameStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getAudioFrameStats');
+    return AudioFrameStats.fromJson(map);
+  }
+
+  // Speech Features
+  /// Starts extracting 80-bin log-mel features from the [source] audio frames, delivered to [onLogMelFeatures].
+  ///
+  /// Each 10 ms frame is the log10 power of 80 Slaney mel bands from 0 to 8 kHz, over a 25 ms Hann window of the audio resampled to 16 kHz mono.
+  /// Features are extracted on the audio thread; those the app does not keep up with are dropped, oldest first.
+  /// Only the window owning the engine, see [EngineBrokerStats.engineOwner], can observe its audio. Returns the extractor's id.
+  static Future<int> startLogMelFeatures(AudioFrameSource source) async {
+    final int extractorId = await _channel.invokeMethod('startLogMelFeatures',
+        {'source': AudioFrameSource.values.indexOf(source)});
+    return extractorId;
+  }
+
+  /// Stops the extractor [extractorId], delivering the features it extracted since the last [onLogMelFeatures].
+  static Future<void> stopLogMelFeatures(int extractorId) async {
+    await _channel
+        .invokeMethod('stopLogMelFeatures', {'extractorId': extractorId});
+  }
+
+  /// Gets, by extractor id, how many feature frames each extractor produced and dropped, and how much of the audio's duration it spent extracting.
+  static Future<Map<int, LogMelStats>> getLogMelStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getLogMelStats');
+    return map.map((key, value) =>
+        MapEntry<int, LogMelStats>(key, LogMelStats.fromJson(value)));
+  }
+
+  // Diagnostics
+  /// Posts [tasks] native tasks from [threads] threads to the platform thread, reporting how fast they are run.
+  ///
+  /// Events and asynchronous results are delivered through the same task runner.
+  static Future<TaskRunnerBenchmark> benchmarkPlatformTaskRunner(
+      {int tasks = 100000, int threads = 4}) async {
+    final Map<dynamic, dynamic> map = await _channel.invokeMethod(
+        'benchmarkPlatformTaskRunner', {'tasks': tasks, 'threads': threads});
+    return TaskRunnerBenchmark.fromJson(map);
+  }
+
+  /// Encodes RtcStats [iterations] times with the generated encoders and the handwritten one they replaced, reporting the mean time of each.
+  static Future<StatsEncodingBenchmark> benchmarkStatsEncoding(
+      {int iterations = 100000}) async {
+    final Map<dynamic, dynamic> map = await _channel
+        .invokeMethod('benchmarkStatsEncoding', {'iterations': iterations});
+    return StatsEncodingBenchmark.fromJson(map);
+  }
+
+  /// Passes [items] integers through the native lock-free queues and through a mutex-guarded deque, reporting the mean time per item of each.
+  ///
+  /// The MPSC queue and the deque are fed by [producers] threads.
+  static Future<QueueBenchmark> benchmarkQueues(
+      {int items = 1000000, int producers = 4}) async {
+    final Map<dynamic, dynamic> map = await _channel.invokeMethod(
+        'benchmarkQueues', {'items': items, 'producers': producers});
+    return QueueBenchmark.fromJson(map);
+  }
+
+  /// Extracts the log-mel features of [seconds] of synthetic audio on one native thread, reporting the real-time factor.
+  static Future<LogMelBenchmark> benchmarkLogMel({int seconds = 60}) async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('benchmarkLogMel', {'seconds': seconds});
+    return LogMelBenchmark.fromJson(map);
+  }
+
+  /// Sends the calls made before [joinChannel] [rounds] times one by one, each awaited as apps usually do, and as many
+  /// times in one [batch], reporting the mean time a round of each took.
+  ///
+  /// The engine must have been created. The calls set the profile, role and mute states to those of a broadcaster in a
+  /// communication channel hearing everyone, and subscribe to the default events.
+  static Future<CallSetupBenchmark> benchmarkCallSetup({int rounds = 50}) async {
+    final calls = <BatchCall>[
+      BatchCall('setChannelProfile', {'profile': ChannelProfile.Communication.index}),
+      // CLIENT_ROLE_BROADCASTER is 1
+      BatchCall('setClientRole', {'role': ClientRole.Broadcaster.index + 1}),
+      BatchCall('muteLocalAudioStream', {'muted': false}),
+      BatchCall('muteAllRemoteAudioStreams', {'muted': false}),
+      BatchCall('subscribeEvents', {
+        'events': ['onJoinChannelSuccess', 'onLeaveChannel', 'onUserJoined', 'onUserOffline']
+      }),
+    ];
+    final oneByOne = Stopwatch();
+    final batched = Stopwatch();
+    // Alternated, so that both see the same conditions
+    for (var round = 0; round < rounds; round++) {
+      oneByOne.start();
+      for (final call in calls) {
+        await _channel.invokeMethod(call.method, call.arguments);
+      }
+      oneByOne.stop();
+      batched.start();
+      await batch(calls);
+      batched.stop();
+    }
+    return CallSetupBenchmark(
+      rounds,
+      calls.length,
+      oneByOne.elapsedMicroseconds ~/ rounds,
+      batched.elapsedMicroseconds ~/ rounds,
+    );
+  }
+
+  /// Gets how the engine is shared with the app's other windows, and how many of its events were encoded once for several of them.
+  static Future<EngineBrokerStats> getEngineBrokerStats() async {
+    final Map<dynamic, dynamic> map =
+        await _channel.invokeMethod('getEngineBrokerStats');
+    return EngineBrokerStats.fromJson(map);
+  }
+
   static void _addEventChannelHandler() async {
     _sink = _sinkController.stream.listen(_eventListener, onError: onError);
   }
@@ -172,6 +992,68 @@ class AgoraRtcEngine {
           onRemoteAudioStats(stats);
         }
         break;
+      case 'onDataTransportMessage':
+        if (onDataTransportMessage != null) {
+          onDataTransportMessage(map['uid'], map['data']);
+        }
+        break;
+      case 'onMetadataReceived':
+        if (onMetadataReceived != null) {
+          onMetadataReceived(
+              map['uid'], map['channel'], map['data'], map['timeStampMs']);
+        }
+        break;
+      case 'onChannelMediaRelayDestinationStateChanged':
+        if (onChannelMediaRelayDestinationStateChanged != null) {
+          onChannelMediaRelayDestinationStateChanged(map['channelName'],
+              RelayDestinationState.values[map['state']], map['error']);
+        }
+        break;
+      case 'onDevicesChanged':
+        if (onDevicesChanged != null) {
+          List<DeviceChange> changes = (map['changes'] as List)
+              .map((e) => DeviceChange.fromJson(e))
+              .toList();
+          onDevicesChanged(changes);
+        }
+        break;
+      case 'onEncoderTuningDecision':
+        if (onEncoderTuningDecision != null) {
+          onEncoderTuningDecision(
+              EncoderTuningDecision.fromJson(map['decision']));
+        }
+        break;
+      case 'onNetworkPreflightRefined':
+        if (onNetworkPreflightRefined != null) {
+          onNetworkPreflightRefined(NetworkPreflightPlan.fromJson(map['plan']));
+        }
+        break;
+      case 'onTokenRequired':
+        if (onTokenRequired != null) {
+          onTokenRequired(map['requestId'], map['channelId'], map['uid']);
+        }
+        break;
+      case 'onAudioFrame':
+        if (onAudioFrame != null) {
+          // Copied, as the message's bytes may not be aligned for 16-bit access
+          Uint8List data = map['data'];
+          onAudioFrame(map['tapId'], map['sampleRate'], map['channels'],
+              Uint8List.fromList(data).buffer.asInt16List());
+        }
+        break;
+      case 'onLogMelFeatures':
+        if (onLogMelFeatures != null) {
+          // Copied, as the message's bytes may not be aligned for 32-bit access
+          Uint8List data = map['data'];
+          onLogMelFeatures(map['extractorId'], map['firstFrame'], map['frames'],
+              map['bins'], Uint8List.fromList(data).buffer.asFloat32List());
+        }
+        break;
+      default:
+        if (onEngineEvent != null) {
+          onEngineEvent(map['event'], map);
+        }
+        break;
     }
   }
 }
\ No newline at end of file
@@ -140,6 +140,1459 @@ class RemoteAudioStats {
   }
 }
 
+class RenderPolicyCounters {
+  final int uid;
+  final int delivered;
+  final int droppedHidden;
+  final int droppedRate;
+  final int droppedStale;
+  /// Frames larger than the policy's maximum size.
+  final int droppedSize;
+  final int skippedBytes;
+
+  RenderPolicyCounters(
+    this.uid,
+    this.delivered,
+    this.droppedHidden,
+    this.droppedRate,
+    this.droppedStale,
+    this.droppedSize,
+    this.skippedBytes,
+  );
+
+  RenderPolicyCounters.fromJson(Map<dynamic, dynamic> json)
+      : uid = json['uid'],
+        delivered = json['delivered'],
+        droppedHidden = json['droppedHidden'],
+        droppedRate = json['droppedRate'],
+        droppedStale = json['droppedStale'],
+        droppedSize = json['droppedSize'],
+        skippedBytes = json['skippedBytes'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "uid": uid,
+      "delivered": delivered,
+      "droppedHidden": droppedHidden,
+      "droppedRate": droppedRate,
+      "droppedStale": droppedStale,
+      "droppedSize": droppedSize,
+      "skippedBytes": skippedBytes,
+    };
+  }
+}
+
+class RenderPolicyStats {
+  final List<RenderPolicyCounters> users;
+  final RenderPolicyCounters total;
+
+  RenderPolicyStats(
+    this.users,
+    this.total,
+  );
+
+  RenderPolicyStats.fromJson(Map<dynamic, dynamic> json)
+      : users = (json['users'] as List)
+            .map((e) => RenderPolicyCounters.fromJson(e))
+            .toList(),
+        total = RenderPolicyCounters.fromJson(json['total']);
+
+  Map<String, dynamic> toJson() {
+    return {
+      "users": users.map((e) => e.toJson()).toList(),
+      "total": total.toJson(),
+    };
+  }
+}
+
+class SnapshotStats {
+  final int requested;
+  final int coalesced;
+  final int captured;
+  final int encoded;
+  final int failed;
+  final int averageEncodeMicros;
+
+  SnapshotStats(
+    this.requested,
+    this.coalesced,
+    this.captured,
+    this.encoded,
+    this.failed,
+    this.averageEncodeMicros,
+  );
+
+  SnapshotStats.fromJson(Map<dynamic, dynamic> json)
+      : requested = json['requested'],
+        coalesced = json['coalesced'],
+        captured = json['captured'],
+        encoded = json['encoded'],
+        failed = json['failed'],
+        averageEncodeMicros = json['averageEncodeMicros'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "requested": requested,
+      "coalesced": coalesced,
+      "captured": captured,
+      "encoded": encoded,
+      "failed": failed,
+      "averageEncodeMicros": averageEncodeMicros,
+    };
+  }
+}
+
+class PacketDirectionStats {
+  final int packets;
+  final int bytes;
+  final int dropped;
+  final int totalNanos;
+  final int maxNanos;
+
+  PacketDirectionStats(
+    this.packets,
+    this.bytes,
+    this.dropped,
+    this.totalNanos,
+    this.maxNanos,
+  );
+
+  PacketDirectionStats.fromJson(Map<dynamic, dynamic> json)
+      : packets = json['packets'],
+        bytes = json['bytes'],
+        dropped = json['dropped'],
+        totalNanos = json['totalNanos'],
+        maxNanos = json['maxNanos'];
+
+  /// Average time spent on one packet.
+  int get averageNanos {
+    final count = packets + dropped;
+    return count == 0 ? 0 : totalNanos ~/ count;
+  }
+
+  /// Bytes transformed per second of processing time.
+  double get throughput => totalNanos == 0 ? 0 : bytes * 1e9 / totalNanos;
+
+  Map<String, dynamic> toJson() {
+    return {
+      "packets": packets,
+      "bytes": bytes,
+      "dropped": dropped,
+      "totalNanos": totalNanos,
+      "maxNanos": maxNanos,
+    };
+  }
+}
+
+class PacketStats {
+  final PacketDirectionStats sendAudio;
+  final PacketDirectionStats sendVideo;
+  final PacketDirectionStats receiveAudio;
+  final PacketDirectionStats receiveVideo;
+
+  PacketStats(
+    this.sendAudio,
+    this.sendVideo,
+    this.receiveAudio,
+    this.receiveVideo,
+  );
+
+  PacketStats.fromJson(Map<dynamic, dynamic> json)
+      : sendAudio = PacketDirectionStats.fromJson(json['sendAudio']),
+        sendVideo = PacketDirectionStats.fromJson(json['sendVideo']),
+        receiveAudio = PacketDirectionStats.fromJson(json['receiveAudio']),
+        receiveVideo = PacketDirectionStats.fromJson(json['receiveVideo']);
+
+  Map<String, dynamic> toJson() {
+    return {
+      "sendAudio": sendAudio.toJson(),
+      "sendVideo": sendVideo.toJson(),
+      "receiveAudio": receiveAudio.toJson(),
+      "receiveVideo": receiveVideo.toJson(),
+    };
+  }
+}
+
+class PacketCaptureStats {
+  final int captured;
+  final int dropped;
+  final int bytesWritten;
+  final int files;
+
+  PacketCaptureStats(
+    this.captured,
+    this.dropped,
+    this.bytesWritten,
+    this.files,
+  );
+
+  PacketCaptureStats.fromJson(Map<dynamic, dynamic> json)
+      : captured = json['captured'],
+        dropped = json['dropped'],
+        bytesWritten = json['bytesWritten'],
+        files = json['files'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "captured": captured,
+      "dropped": dropped,
+      "bytesWritten": bytesWritten,
+      "files": files,
+    };
+  }
+}
+
+class DataTransportStats {
+  final int queuedMessages;
+  final int queuedBytes;
+  final int sentMessages;
+  final int sentPackets;
+  final int sentBytes;
+  final int payloadBytes;
+  final int rejectedMessages;
+
+  /// Attempts to send a packet that failed; each such packet is sent again.
+  final int failedPackets;
+  final int receivedMessages;
+  final int receivedBytes;
+  final int droppedMessages;
+
+  /// Payload bytes sent per second since the transport was opened.
+  final double throughput;
+
+  DataTransportStats(
+    this.queuedMessages,
+    this.queuedBytes,
+    this.sentMessages,
+    this.sentPackets,
+    this.sentBytes,
+    this.payloadBytes,
+    this.rejectedMessages,
+    this.failedPackets,
+    this.receivedMessages,
+    this.receivedBytes,
+    this.droppedMessages,
+    this.throughput,
+  );
+
+  DataTransportStats.fromJson(Map<dynamic, dynamic> json)
+      : queuedMessages = json['queuedMessages'],
+        queuedBytes = json['queuedBytes'],
+        sentMessages = json['sentMessages'],
+        sentPackets = json['sentPackets'],
+        sentBytes = json['sentBytes'],
+        payloadBytes = json['payloadBytes'],
+        rejectedMessages = json['rejectedMessages'],
+        failedPackets = json['failedPackets'],
+        receivedMessages = json['receivedMessages'],
+        receivedBytes = json['receivedBytes'],
+        droppedMessages = json['droppedMessages'],
+        throughput = json['throughput'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "queuedMessages": queuedMessages,
+      "queuedBytes": queuedBytes,
+      "sentMessages": sentMessages,
+      "sentPackets": sentPackets,
+      "sentBytes": sentBytes,
+      "payloadBytes": payloadBytes,
+      "rejectedMessages": rejectedMessages,
+      "failedPackets": failedPackets,
+      "receivedMessages": receivedMessages,
+      "receivedBytes": receivedBytes,
+      "droppedMessages": droppedMessages,
+      "throughput": throughput,
+    };
+  }
+}
+
+class MetadataChannelStats {
+  final int channel;
+  final int queued;
+  final int sent;
+  final int dropped;
+  final int rejected;
+  final int received;
+
+  MetadataChannelStats(
+    this.channel,
+    this.queued,
+    this.sent,
+    this.dropped,
+    this.rejected,
+    this.received,
+  );
+
+  MetadataChannelStats.fromJson(Map<dynamic, dynamic> json)
+      : channel = json['channel'],
+        queued = json['queued'],
+        sent = json['sent'],
+        dropped = json['dropped'],
+        rejected = json['rejected'],
+        received = json['received'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "channel": channel,
+      "queued": queued,
+      "sent": sent,
+      "dropped": dropped,
+      "rejected": rejected,
+      "received": received,
+    };
+  }
+}
+
+class MetadataStats {
+  final List<MetadataChannelStats> channels;
+  final int slots;
+  final int usedSlots;
+  final int packedBytes;
+  /// Share of the offered metadata bytes that carried messages.
+  final double fillRate;
+  final int malformed;
+
+  MetadataStats(
+    this.channels,
+    this.slots,
+    this.usedSlots,
+    this.packedBytes,
+    this.fillRate,
+    this.malformed,
+  );
+
+  MetadataStats.fromJson(Map<dynamic, dynamic> json)
+      : channels = (json['channels'] as List)
+            .map((e) => MetadataChannelStats.fromJson(e))
+            .toList(),
+        slots = json['slots'],
+        usedSlots = json['usedSlots'],
+        packedBytes = json['packedBytes'],
+        fillRate = json['fillRate'],
+        malformed = json['malformed'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "channels": channels.map((e) => e.toJson()).toList(),
+      "slots": slots,
+      "usedSlots": usedSlots,
+      "packedBytes": packedBytes,
+      "fillRate": fillRate,
+      "malformed": malformed,
+    };
+  }
+}
+
+class TranscodingLayoutStats {
+  final int users;
+  final int changes;
+  final int layouts;
+  final int applied;
+  final int unchanged;
+  final int averageLayoutNanos;
+
+  TranscodingLayoutStats(
+    this.users,
+    this.changes,
+    this.layouts,
+    this.applied,
+    this.unchanged,
+    this.averageLayoutNanos,
+  );
+
+  TranscodingLayoutStats.fromJson(Map<dynamic, dynamic> json)
+      : users = json['users'],
+        changes = json['changes'],
+        layouts = json['layouts'],
+        applied = json['applied'],
+        unchanged = json['unchanged'],
+        averageLayoutNanos = json['averageLayoutNanos'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "users": users,
+      "changes": changes,
+      "layouts": layouts,
+      "applied": applied,
+      "unchanged": unchanged,
+      "averageLayoutNanos": averageLayoutNanos,
+    };
+  }
+}
+
+class RelayDestinationInfo {
+  final String channelName;
+  final RelayDestinationState state;
+  /// The last relay error code, or a negative SDK error code.
+  final int error;
+  final int retries;
+
+  RelayDestinationInfo(
+    this.channelName,
+    this.state,
+    this.error,
+    this.retries,
+  );
+
+  RelayDestinationInfo.fromJson(Map<dynamic, dynamic> json)
+      : channelName = json['channelName'],
+        state = RelayDestinationState.values[json['state']],
+        error = json['error'],
+        retries = json['retries'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "channelName": channelName,
+      "state": state.index,
+      "error": error,
+      "retries": retries,
+    };
+  }
+}
+
+class ChannelMediaRelayStats {
+  final List<RelayDestinationInfo> destinations;
+  final int changes;
+  final int starts;
+  final int updates;
+  final int stops;
+  final int retries;
+
+  ChannelMediaRelayStats(
+    this.destinations,
+    this.changes,
+    this.starts,
+    this.updates,
+    this.stops,
+    this.retries,
+  );
+
+  ChannelMediaRelayStats.fromJson(Map<dynamic, dynamic> json)
+      : destinations = (json['destinations'] as List)
+            .map((e) => RelayDestinationInfo.fromJson(e))
+            .toList(),
+        changes = json['changes'],
+        starts = json['starts'],
+        updates = json['updates'],
+        stops = json['stops'],
+        retries = json['retries'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "destinations": destinations.map((e) => e.toJson()).toList(),
+      "changes": changes,
+      "starts": starts,
+      "updates": updates,
+      "stops": stops,
+      "retries": retries,
+    };
+  }
+}
+
+class DeviceInfo {
+  final String id;
+  final String name;
+  /// Whether the engine uses this device, the system default unless one was set.
+  final bool isDefault;
+
+  DeviceInfo(
+    this.id,
+    this.name,
+    this.isDefault,
+  );
+
+  DeviceInfo.fromJson(Map<dynamic, dynamic> json)
+      : id = json['id'],
+        name = json['name'],
+        isDefault = json['isDefault'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "id": id,
+      "name": name,
+      "isDefault": isDefault,
+    };
+  }
+}
+
+class DeviceChange {
+  final DeviceKind kind;
+  final DeviceChangeType type;
+  final DeviceInfo device;
+
+  DeviceChange(
+    this.kind,
+    this.type,
+    this.device,
+  );
+
+  DeviceChange.fromJson(Map<dynamic, dynamic> json)
+      : kind = DeviceKind.values[json['kind']],
+        type = DeviceChangeType.values[json['type']],
+        device = DeviceInfo.fromJson(json['device']);
+
+  Map<String, dynamic> toJson() {
+    return {
+      "kind": kind.index,
+      "type": type.index,
+      "device": device.toJson(),
+    };
+  }
+}
+
+class EncoderLevel {
+  final int width;
+  final int height;
+  final int frameRate;
+  /// Kbps
+  final int bitrate;
+
+  EncoderLevel(
+    this.width,
+    this.height,
+    this.frameRate,
+    this.bitrate,
+  );
+
+  EncoderLevel.fromJson(Map<dynamic, dynamic> json)
+      : width = json['width'],
+        height = json['height'],
+        frameRate = json['frameRate'],
+        bitrate = json['bitrate'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "width": width,
+      "height": height,
+      "frameRate": frameRate,
+      "bitrate": bitrate,
+    };
+  }
+}
+
+class EncoderTuningDecision {
+  /// Milliseconds since auto-tuning was enabled.
+  final int timeMs;
+  final int fromLevel;
+  final int toLevel;
+  final EncoderLevel level;
+  final EncoderTuningReason reason;
+  final double cpuTotalUsage;
+  final double cpuAppUsage;
+  final int txQuality;
+  /// -1 when not reported since the previous decision.
+  final int encoderOutputFrameRate;
+
+  EncoderTuningDecision(
+    this.timeMs,
+    this.fromLevel,
+    this.toLevel,
+    this.level,
+    this.reason,
+    this.cpuTotalUsage,
+    this.cpuAppUsage,
+    this.txQuality,
+    this.encoderOutputFrameRate,
+  );
+
+  EncoderTuningDecision.fromJson(Map<dynamic, dynamic> json)
+      : timeMs = json['timeMs'],
+        fromLevel = json['fromLevel'],
+        toLevel = json['toLevel'],
+        level = EncoderLevel.fromJson(json['level']),
+        reason = EncoderTuningReason.values[json['reason']],
+        cpuTotalUsage = json['cpuTotalUsage'],
+        cpuAppUsage = json['cpuAppUsage'],
+        txQuality = json['txQuality'],
+        encoderOutputFrameRate = json['encoderOutputFrameRate'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "timeMs": timeMs,
+      "fromLevel": fromLevel,
+      "toLevel": toLevel,
+      "level": level.toJson(),
+      "reason": reason.index,
+      "cpuTotalUsage": cpuTotalUsage,
+      "cpuAppUsage": cpuAppUsage,
+      "txQuality": txQuality,
+      "encoderOutputFrameRate": encoderOutputFrameRate,
+    };
+  }
+}
+
+class EventRecordingStats {
+  final int events;
+  final int bytes;
+
+  EventRecordingStats(
+    this.events,
+    this.bytes,
+  );
+
+  EventRecordingStats.fromJson(Map<dynamic, dynamic> json)
+      : events = json['events'],
+        bytes = json['bytes'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "events": events,
+      "bytes": bytes,
+    };
+  }
+}
+
+class EventReplayStats {
+  final int events;
+  /// Records with an unknown event or bad arguments.
+  final int skipped;
+  final int durationNanos;
+  /// Time spent handling the events, i.e. in the event path itself.
+  final int handlerNanos;
+  final int maxHandlerNanos;
+  final double eventsPerSecond;
+
+  EventReplayStats(
+    this.events,
+    this.skipped,
+    this.durationNanos,
+    this.handlerNanos,
+    this.maxHandlerNanos,
+    this.eventsPerSecond,
+  );
+
+  EventReplayStats.fromJson(Map<dynamic, dynamic> json)
+      : events = json['events'],
+        skipped = json['skipped'],
+        durationNanos = json['durationNanos'],
+        handlerNanos = json['handlerNanos'],
+        maxHandlerNanos = json['maxHandlerNanos'],
+        eventsPerSecond = json['eventsPerSecond'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "events": events,
+      "skipped": skipped,
+      "durationNanos": durationNanos,
+      "handlerNanos": handlerNanos,
+      "maxHandlerNanos": maxHandlerNanos,
+      "eventsPerSecond": eventsPerSecond,
+    };
+  }
+}
+
+class EventCounters {
+  /// Callbacks from the engine.
+  final int received;
+  /// Callbacks sent to Dart, i.e. while subscribed.
+  final int forwarded;
+
+  EventCounters(
+    this.received,
+    this.forwarded,
+  );
+
+  EventCounters.fromJson(Map<dynamic, dynamic> json)
+      : received = json['received'],
+        forwarded = json['forwarded'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "received": received,
+      "forwarded": forwarded,
+    };
+  }
+}
+
+class BatchCall {
+  /// The method name, e.g. `setChannelProfile`.
+  final String method;
+  /// The arguments as the method passes them to the platform, e.g. `{'profile': 1}`.
+  final Map<String, dynamic> arguments;
+
+  BatchCall(
+    this.method, [
+    this.arguments,
+  ]);
+
+  Map<String, dynamic> toJson() {
+    return {
+      "method": method,
+      "arguments": arguments,
+    };
+  }
+}
+
+class BatchResult {
+  /// What the call returned, if it succeeded.
+  final dynamic value;
+  /// The error code, or null if the call succeeded.
+  final String errorCode;
+  final String errorMessage;
+  final dynamic errorDetails;
+  final bool notImplemented;
+
+  BatchResult(
+    this.value,
+    this.errorCode,
+    this.errorMessage,
+    this.errorDetails,
+    this.notImplemented,
+  );
+
+  BatchResult.fromJson(Map<dynamic, dynamic> json)
+      : value = json['value'],
+        errorCode = json['errorCode'],
+        errorMessage = json['errorMessage'],
+        errorDetails = json['errorDetails'],
+        notImplemented = json['notImplemented'] ?? false;
+
+  bool get succeeded => errorCode == null && !notImplemented;
+
+  Map<String, dynamic> toJson() {
+    return {
+      "value": value,
+      "errorCode": errorCode,
+      "errorMessage": errorMessage,
+      "errorDetails": errorDetails,
+      "notImplemented": notImplemented,
+    };
+  }
+}
+
+class StatsEncodingBenchmark {
+  final int iterations;
+  /// Mean time to encode RtcStats with the handwritten encoder.
+  final int handwrittenNanos;
+  /// Mean time with the generated encoder.
+  final int generatedNanos;
+  /// Mean time with the generated encoder updating the map of the previous iteration.
+  final int inPlaceNanos;
+
+  StatsEncodingBenchmark(
+    this.iterations,
+    this.handwrittenNanos,
+    this.generatedNanos,
+    this.inPlaceNanos,
+  );
+
+  StatsEncodingBenchmark.fromJson(Map<dynamic, dynamic> json)
+      : iterations = json['iterations'],
+        handwrittenNanos = json['handwrittenNanos'],
+        generatedNanos = json['generatedNanos'],
+        inPlaceNanos = json['inPlaceNanos'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "iterations": iterations,
+      "handwrittenNanos": handwrittenNanos,
+      "generatedNanos": generatedNanos,
+      "inPlaceNanos": inPlaceNanos,
+    };
+  }
+}
+
+class CallSetupBenchmark {
+  final int rounds;
+  /// Calls per round.
+  final int calls;
+  /// Mean time a round took with the calls made one by one.
+  final int oneByOneMicros;
+  /// Mean time a round took in one batch.
+  final int batchMicros;
+
+  CallSetupBenchmark(
+    this.rounds,
+    this.calls,
+    this.oneByOneMicros,
+    this.batchMicros,
+  );
+
+  CallSetupBenchmark.fromJson(Map<dynamic, dynamic> json)
+      : rounds = json['rounds'],
+        calls = json['calls'],
+        oneByOneMicros = json['oneByOneMicros'],
+        batchMicros = json['batchMicros'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "rounds": rounds,
+      "calls": calls,
+      "oneByOneMicros": oneByOneMicros,
+      "batchMicros": batchMicros,
+    };
+  }
+}
+
+class TaskRunnerBenchmark {
+  final int tasks;
+  final int threads;
+  final int durationNanos;
+  final double tasksPerSecond;
+  /// Times the platform thread was woken to run tasks.
+  final int wakeups;
+
+  TaskRunnerBenchmark(
+    this.tasks,
+    this.threads,
+    this.durationNanos,
+    this.tasksPerSecond,
+    this.wakeups,
+  );
+
+  TaskRunnerBenchmark.fromJson(Map<dynamic, dynamic> json)
+      : tasks = json['tasks'],
+        threads = json['threads'],
+        durationNanos = json['durationNanos'],
+        tasksPerSecond = json['tasksPerSecond'],
+        wakeups = json['wakeups'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "tasks": tasks,
+      "threads": threads,
+      "durationNanos": durationNanos,
+      "tasksPerSecond": tasksPerSecond,
+      "wakeups": wakeups,
+    };
+  }
+}
+
+class ScreenShareStats {
+  final int captured;
+  final int pushed;
+  /// Captured frames not sent because nothing changed.
+  final int skipped;
+  final int failed;
+  /// Frames not sent compared to capturing at a fixed maxFrameRate.
+  final int savedFrames;
+  /// The current capture rate, between minFrameRate and maxFrameRate.
+  final double frameRate;
+  /// The mean fraction of 32x32 tiles changed in the frames that changed.
+  final double dirtyTileRatio;
+  final int meanCaptureNanos;
+  final int meanHashNanos;
+
+  ScreenShareStats(
+    this.captured,
+    this.pushed,
+    this.skipped,
+    this.failed,
+    this.savedFrames,
+    this.frameRate,
+    this.dirtyTileRatio,
+    this.meanCaptureNanos,
+    this.meanHashNanos,
+  );
+
+  ScreenShareStats.fromJson(Map<dynamic, dynamic> json)
+      : captured = json['captured'],
+        pushed = json['pushed'],
+        skipped = json['skipped'],
+        failed = json['failed'],
+        savedFrames = json['savedFrames'],
+        frameRate = json['frameRate'],
+        dirtyTileRatio = json['dirtyTileRatio'],
+        meanCaptureNanos = json['meanCaptureNanos'],
+        meanHashNanos = json['meanHashNanos'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "captured": captured,
+      "pushed": pushed,
+      "skipped": skipped,
+      "failed": failed,
+      "savedFrames": savedFrames,
+      "frameRate": frameRate,
+      "dirtyTileRatio": dirtyTileRatio,
+      "meanCaptureNanos": meanCaptureNanos,
+      "meanHashNanos": meanHashNanos,
+    };
+  }
+}
+
+class NetworkPreflightPlan {
+  /// Index of [video] in the levels, e.g. a start level for encoder auto-tuning.
+  final int level;
+  final EncoderLevel video;
+  /// The SDK's AUDIO_PROFILE_TYPE value.
+  final int audioProfile;
+  /// The LASTMILE_PROBE_RESULT_STATE value, 0 if the probe did not report.
+  final int state;
+  /// The last-mile quality, 0 if it was not reported.
+  final int quality;
+  final int uplinkLossRate;
+  final int uplinkJitter;
+  /// Kbps, 0 when not estimated.
+  final int uplinkBandwidth;
+  final int downlinkLossRate;
+  final int downlinkJitter;
+  final int downlinkBandwidth;
+  final int rtt;
+  /// The measurement was reused without probing.
+  final bool cached;
+  /// The plan is based on the probe's bandwidth estimate, not only on [quality].
+  final bool refined;
+  /// The probe reported nothing in time.
+  final bool timedOut;
+  /// Age of the cached measurement.
+  final int ageMs;
+  /// Time spent waiting for the probe.
+  final int probeMs;
+
+  NetworkPreflightPlan(
+    this.level,
+    this.video,
+    this.audioProfile,
+    this.state,
+    this.quality,
+    this.uplinkLossRate,
+    this.uplinkJitter,
+    this.uplinkBandwidth,
+    this.downlinkLossRate,
+    this.downlinkJitter,
+    this.downlinkBandwidth,
+    this.rtt,
+    this.cached,
+    this.refined,
+    this.timedOut,
+    this.ageMs,
+    this.probeMs,
+  );
+
+  NetworkPreflightPlan.fromJson(Map<dynamic, dynamic> json)
+      : level = json['level'],
+        video = EncoderLevel.fromJson(json['video']),
+        audioProfile = json['audioProfile'],
+        state = json['state'],
+        quality = json['quality'],
+        uplinkLossRate = json['uplinkLossRate'],
+        uplinkJitter = json['uplinkJitter'],
+        uplinkBandwidth = json['uplinkBandwidth'],
+        downlinkLossRate = json['downlinkLossRate'],
+        downlinkJitter = json['downlinkJitter'],
+        downlinkBandwidth = json['downlinkBandwidth'],
+        rtt = json['rtt'],
+        cached = json['cached'],
+        refined = json['refined'],
+        timedOut = json['timedOut'],
+        ageMs = json['ageMs'],
+        probeMs = json['probeMs'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "level": level,
+      "video": video.toJson(),
+      "audioProfile": audioProfile,
+      "state": state,
+      "quality": quality,
+      "uplinkLossRate": uplinkLossRate,
+      "uplinkJitter": uplinkJitter,
+      "uplinkBandwidth": uplinkBandwidth,
+      "downlinkLossRate": downlinkLossRate,
+      "downlinkJitter": downlinkJitter,
+      "downlinkBandwidth": downlinkBandwidth,
+      "rtt": rtt,
+      "cached": cached,
+      "refined": refined,
+      "timedOut": timedOut,
+      "ageMs": ageMs,
+      "probeMs": probeMs,
+    };
+  }
+}
+
+class NetworkPreflightStats {
+  final int requests;
+  final int cacheHits;
+  final int probes;
+  final int timeouts;
+  final int cachedNetworks;
+  /// The last network type reported by the SDK, -1 when unknown.
+  final int networkType;
+
+  NetworkPreflightStats(
+    this.requests,
+    this.cacheHits,
+    this.probes,
+    this.timeouts,
+    this.cachedNetworks,
+    this.networkType,
+  );
+
+  NetworkPreflightStats.fromJson(Map<dynamic, dynamic> json)
+      : requests = json['requests'],
+        cacheHits = json['cacheHits'],
+        probes = json['probes'],
+        timeouts = json['timeouts'],
+        cachedNetworks = json['cachedNetworks'],
+        networkType = json['networkType'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "requests": requests,
+      "cacheHits": cacheHits,
+      "probes": probes,
+      "timeouts": timeouts,
+      "cachedNetworks": cachedNetworks,
+      "networkType": networkType,
+    };
+  }
+}
+
+class AudioEffectCacheStats {
+  final int plays;
+  final int hits;
+  final int preloads;
+  /// Effects preloaded because they usually follow the one played.
+  final int predictedPreloads;
+  final int failedPreloads;
+  final int evictions;
+  /// Estimated decoded bytes of the preloaded effects.
+  final int usedBytes;
+  final int memoryBudget;
+  final int registered;
+  final int loaded;
+  final double hitRate;
+  /// Mean time `playEffect` took for preloaded effects.
+  final int meanHitPlayNanos;
+  /// Mean time `playEffect` took for effects read from their file.
+  final int meanColdPlayNanos;
+
+  AudioEffectCacheStats(
+    this.plays,
+    this.hits,
+    this.preloads,
+    this.predictedPreloads,
+    this.failedPreloads,
+    this.evictions,
+    this.usedBytes,
+    this.memoryBudget,
+    this.registered,
+    this.loaded,
+    this.hitRate,
+    this.meanHitPlayNanos,
+    this.meanColdPlayNanos,
+  );
+
+  AudioEffectCacheStats.fromJson(Map<dynamic, dynamic> json)
+      : plays = json['plays'],
+        hits = json['hits'],
+        preloads = json['preloads'],
+        predictedPreloads = json['predictedPreloads'],
+        failedPreloads = json['failedPreloads'],
+        evictions = json['evictions'],
+        usedBytes = json['usedBytes'],
+        memoryBudget = json['memoryBudget'],
+        registered = json['registered'],
+        loaded = json['loaded'],
+        hitRate = json['hitRate'],
+        meanHitPlayNanos = json['meanHitPlayNanos'],
+        meanColdPlayNanos = json['meanColdPlayNanos'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "plays": plays,
+      "hits": hits,
+      "preloads": preloads,
+      "predictedPreloads": predictedPreloads,
+      "failedPreloads": failedPreloads,
+      "evictions": evictions,
+      "usedBytes": usedBytes,
+      "memoryBudget": memoryBudget,
+      "registered": registered,
+      "loaded": loaded,
+      "hitRate": hitRate,
+      "meanHitPlayNanos": meanHitPlayNanos,
+      "meanColdPlayNanos": meanColdPlayNanos,
+    };
+  }
+}
+
+class TokenEvent {
+  /// Milliseconds since the Unix epoch.
+  final int timeMs;
+  final String channelId;
+  final int uid;
+  final TokenReason reason;
+  final bool ok;
+  /// Whether the token was prefetched or fetched earlier, needing no round trip.
+  final bool cached;
+  /// From the trigger to the token being available.
+  final int latencyNanos;
+
+  TokenEvent(
+    this.timeMs,
+    this.channelId,
+    this.uid,
+    this.reason,
+    this.ok,
+    this.cached,
+    this.latencyNanos,
+  );
+
+  TokenEvent.fromJson(Map<dynamic, dynamic> json)
+      : timeMs = json['timeMs'],
+        channelId = json['channelId'],
+        uid = json['uid'],
+        reason = TokenReason.values[json['reason']],
+        ok = json['ok'],
+        cached = json['cached'],
+        latencyNanos = json['latencyNanos'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "timeMs": timeMs,
+      "channelId": channelId,
+      "uid": uid,
+      "reason": reason.index,
+      "ok": ok,
+      "cached": cached,
+      "latencyNanos": latencyNanos,
+    };
+  }
+}
+
+class TokenManagerStats {
+  final int fetches;
+  final int failures;
+  final int timeouts;
+  /// Joins, switches and renewals served without a fetch.
+  final int cacheHits;
+  final int renewals;
+  final int meanFetchNanos;
+  final int maxFetchNanos;
+
+  TokenManagerStats(
+    this.fetches,
+    this.failures,
+    this.timeouts,
+    this.cacheHits,
+    this.renewals,
+    this.meanFetchNanos,
+    this.maxFetchNanos,
+  );
+
+  TokenManagerStats.fromJson(Map<dynamic, dynamic> json)
+      : fetches = json['fetches'],
+        failures = json['failures'],
+        timeouts = json['timeouts'],
+        cacheHits = json['cacheHits'],
+        renewals = json['renewals'],
+        meanFetchNanos = json['meanFetchNanos'],
+        maxFetchNanos = json['maxFetchNanos'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "fetches": fetches,
+      "failures": failures,
+      "timeouts": timeouts,
+      "cacheHits": cacheHits,
+      "renewals": renewals,
+      "meanFetchNanos": meanFetchNanos,
+      "maxFetchNanos": maxFetchNanos,
+    };
+  }
+}
+
+class ChannelSwitchResult {
+  final String fromChannel;
+  final String toChannel;
+  final ChannelSwitchMode mode;
+  final bool ok;
+  /// The failed SDK call's error code, 0 if the switch timed out.
+  final int error;
+  /// Milliseconds from the request until the token was available.
+  final int tokenMs;
+  /// Milliseconds from the request until the previous channel was left, -1 if it was not.
+  final int leftMs;
+  /// Milliseconds from the request until the new channel was joined, -1 if it was not.
+  final int joinedMs;
+  /// Milliseconds from the request until the first remote audio or video frame, -1 if none arrived before the timeout.
+  final int firstFrameMs;
+
+  ChannelSwitchResult(
+    this.fromChannel,
+    this.toChannel,
+    this.mode,
+    this.ok,
+    this.error,
+    this.tokenMs,
+    this.leftMs,
+    this.joinedMs,
+    this.firstFrameMs,
+  );
+
+  ChannelSwitchResult.fromJson(Map<dynamic, dynamic> json)
+      : fromChannel = json['fromChannel'],
+        toChannel = json['toChannel'],
+        mode = ChannelSwitchMode.values[json['mode']],
+        ok = json['ok'],
+        error = json['error'],
+        tokenMs = json['tokenMs'],
+        leftMs = json['leftMs'],
+        joinedMs = json['joinedMs'],
+        firstFrameMs = json['firstFrameMs'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "fromChannel": fromChannel,
+      "toChannel": toChannel,
+      "mode": mode.index,
+      "ok": ok,
+      "error": error,
+      "tokenMs": tokenMs,
+      "leftMs": leftMs,
+      "joinedMs": joinedMs,
+      "firstFrameMs": firstFrameMs,
+    };
+  }
+}
+
+class ChannelSwitchStats {
+  final int switches;
+  /// Switches completed with switchChannel.
+  final int switched;
+  /// Switches completed by leaving and joining again.
+  final int rejoined;
+  final int failures;
+  /// Switches that joined without receiving a remote frame before the timeout.
+  final int withoutFrames;
+  final int meanJoinedMs;
+  final int meanFirstFrameMs;
+  final int maxFirstFrameMs;
+
+  ChannelSwitchStats(
+    this.switches,
+    this.switched,
+    this.rejoined,
+    this.failures,
+    this.withoutFrames,
+    this.meanJoinedMs,
+    this.meanFirstFrameMs,
+    this.maxFirstFrameMs,
+  );
+
+  ChannelSwitchStats.fromJson(Map<dynamic, dynamic> json)
+      : switches = json['switches'],
+        switched = json['switched'],
+        rejoined = json['rejoined'],
+        failures = json['failures'],
+        withoutFrames = json['withoutFrames'],
+        meanJoinedMs = json['meanJoinedMs'],
+        meanFirstFrameMs = json['meanFirstFrameMs'],
+        maxFirstFrameMs = json['maxFirstFrameMs'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "switches": switches,
+      "switched": switched,
+      "rejoined": rejoined,
+      "failures": failures,
+      "withoutFrames": withoutFrames,
+      "meanJoinedMs": meanJoinedMs,
+      "meanFirstFrameMs": meanFirstFrameMs,
+      "maxFirstFrameMs": maxFirstFrameMs,
+    };
+  }
+}
+
+class EngineBrokerStats {
+  /// The windows sharing the engine.
+  final int clients;
+  final int callbacks;
+  final int encodings;
+  /// Encodings spared by sending a window the event already encoded for another.
+  final int sharedEncodings;
+  /// Whether this window owns the engine and observes its packets, metadata and audio frames: the window that created
+  /// it, then once that one is destroyed, another window.
+  final bool engineOwner;
+
+  EngineBrokerStats(
+    this.clients,
+    this.callbacks,
+    this.encodings,
+    this.sharedEncodings,
+    this.engineOwner,
+  );
+
+  EngineBrokerStats.fromJson(Map<dynamic, dynamic> json)
+      : clients = json['clients'],
+        callbacks = json['callbacks'],
+        encodings = json['encodings'],
+        sharedEncodings = json['sharedEncodings'],
+        engineOwner = json['engineOwner'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "clients": clients,
+      "callbacks": callbacks,
+      "encodings": encodings,
+      "sharedEncodings": sharedEncodings,
+      "engineOwner": engineOwner,
+    };
+  }
+}
+
+class AudioTapStats {
+  /// Frames written to the tap.
+  final int frames;
+  /// Frames dropped as the app did not read them in time.
+  final int dropped;
+
+  AudioTapStats(
+    this.frames,
+    this.dropped,
+  );
+
+  AudioTapStats.fromJson(Map<dynamic, dynamic> json)
+      : frames = json['frames'],
+        dropped = json['dropped'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "frames": frames,
+      "dropped": dropped,
+    };
+  }
+}
+
+class AudioFrameStats {
+  /// Audio frames from the SDK.
+  final int frames;
+  /// Frames delivered to a tap as the SDK gave them.
+  final int passedThrough;
+  /// Frames delivered to a tap after resampling.
+  final int converted;
+  /// Frames not delivered as taps were being started or stopped.
+  final int skipped;
+  /// By tap id.
+  final Map<int, AudioTapStats> taps;
+
+  AudioFrameStats(
+    this.frames,
+    this.passedThrough,
+    this.converted,
+    this.skipped,
+    this.taps,
+  );
+
+  AudioFrameStats.fromJson(Map<dynamic, dynamic> json)
+      : frames = json['frames'],
+        passedThrough = json['passedThrough'],
+        converted = json['converted'],
+        skipped = json['skipped'],
+        taps = (json['taps'] as Map).map((key, value) =>
+            MapEntry<int, AudioTapStats>(key, AudioTapStats.fromJson(value)));
+
+  Map<String, dynamic> toJson() {
+    return {
+      "frames": frames,
+      "passedThrough": passedThrough,
+      "converted": converted,
+      "skipped": skipped,
+      "taps": taps.map((key, value) => MapEntry(key.toString(), value.toJson())),
+    };
+  }
+}
+
+class LogMelStats {
+  final int frames;
+  /// Frames dropped as the app did not read them in time.
+  final int dropped;
+  /// Time spent extracting over the duration of the audio.
+  final double realTimeFactor;
+
+  LogMelStats(
+    this.frames,
+    this.dropped,
+    this.realTimeFactor,
+  );
+
+  LogMelStats.fromJson(Map<dynamic, dynamic> json)
+      : frames = json['frames'],
+        dropped = json['dropped'],
+        realTimeFactor = json['realTimeFactor'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "frames": frames,
+      "dropped": dropped,
+      "realTimeFactor": realTimeFactor,
+    };
+  }
+}
+
+class LogMelBenchmark {
+  final double audioSeconds;
+  final int frames;
+  final double nanosPerFrame;
+  /// Extraction time over audio time, on one core.
+  final double realTimeFactor;
+
+  LogMelBenchmark(
+    this.audioSeconds,
+    this.frames,
+    this.nanosPerFrame,
+    this.realTimeFactor,
+  );
+
+  LogMelBenchmark.fromJson(Map<dynamic, dynamic> json)
+      : audioSeconds = json['audioSeconds'],
+        frames = json['frames'],
+        nanosPerFrame = json['nanosPerFrame'],
+        realTimeFactor = json['realTimeFactor'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "audioSeconds": audioSeconds,
+      "frames": frames,
+      "nanosPerFrame": nanosPerFrame,
+      "realTimeFactor": realTimeFactor,
+    };
+  }
+}
+
+class QueueBenchmark {
+  final int items;
+  final int producers;
+  /// Mean time per item, from the first push to the last pop.
+  final double spscNanos;
+  final double spscBatchNanos;
+  final double mpscNanos;
+  /// A deque guarded by a mutex, as the native pipelines used.
+  final double mutexNanos;
+
+  QueueBenchmark(
+    this.items,
+    this.producers,
+    this.spscNanos,
+    this.spscBatchNanos,
+    this.mpscNanos,
+    this.mutexNanos,
+  );
+
+  QueueBenchmark.fromJson(Map<dynamic, dynamic> json)
+      : items = json['items'],
+        producers = json['producers'],
+        spscNanos = json['spscNanos'],
+        spscBatchNanos = json['spscBatchNanos'],
+        mpscNanos = json['mpscNanos'],
+        mutexNanos = json['mutexNanos'];
+
+  Map<String, dynamic> toJson() {
+    return {
+      "items": items,
+      "producers": producers,
+      "spscNanos": spscNanos,
+      "spscBatchNanos": spscBatchNanos,
+      "mpscNanos": mpscNanos,
+      "mutexNanos": mutexNanos,
+    };
+  }
+}
+
 enum ChannelProfile {
   /// This is used in one-on-one or group calls, where all users in the channel can talk freely.
   Communication,
@@ -147,3 +1600,120 @@ enum ChannelProfile {
   /// Host and audience roles that can be set by calling the [AgoraRtcEngine.setClientRole] method. The host sends and receives voice/video, while the audience can only receive voice/video.
   LiveBroadcasting,
 }
+
+enum ClientRole {
+  /// A host, who sends and receives audio and video.
+  Broadcaster,
+
+  /// An audience member, who only receives audio and video.
+  Audience,
+}
+
+enum AudioFrameSource {
+  /// The local microphone, as recorded.
+  Record,
+
+  /// The remote users, as played back.
+  Playback,
+
+  /// Both mixed, always mono.
+  Mixed,
+}
+
+enum ImageFormat {
+  Png,
+  Jpeg,
+}
+
+enum PacketCipher {
+  None,
+  AesCtr,
+  AesGcm,
+}
+
+enum LayoutTemplate {
+  /// Equal cells, as close to square as the user count allows.
+  Grid,
+
+  /// The active speaker above a strip of the other users.
+  SpeakerFocus,
+
+  /// The active speaker full size, the other users in small tiles on top.
+  PictureInPicture,
+}
+
+enum RelayDestinationState {
+  /// Waiting for the batching window or a retry.
+  Pending,
+
+  /// Sent to the SDK, not confirmed yet.
+  Connecting,
+  Running,
+  Failed,
+
+  /// The destination was removed.
+  Removed,
+}
+
+enum DeviceKind {
+  Playback,
+  Recording,
+  Video,
+}
+
+enum DeviceChangeType {
+  Added,
+  Removed,
+
+  /// The device became the one used by the engine.
+  DefaultChanged,
+}
+
+enum EncoderTuningReason {
+  Start,
+
+  /// The total CPU usage is above the high threshold.
+  CpuHigh,
+
+  /// The encoder outputs less than 75% of the frame rate of its level.
+  EncoderLagging,
+
+  /// The uplink quality is poor or worse.
+  NetworkPoor,
+
+  /// The CPU usage is below the low threshold and the uplink quality is good.
+  Recovered,
+}
+
+enum EffectEvictionPolicy {
+  /// Evicts the least recently played effects first.
+  Lru,
+
+  /// Evicts the least often played effects first.
+  Lfu,
+}
+
+enum TokenReason {
+  /// Fetched for joining or switching to a channel.
+  Acquire,
+
+  /// Fetched ahead of a join or switch.
+  Prefetch,
+
+  /// Renewed ahead of the expiry.
+  Scheduled,
+
+  /// Renewed on onTokenPrivilegeWillExpire.
+  WillExpire,
+
+  /// Renewed on onRequestToken, after the token expired.
+  Expired,
+}
+
+enum ChannelSwitchMode {
+  /// Switched with switchChannel, as an audience member in a live broadcast.
+  Switch,
+
+  /// Left the channel and joined the new one.
+  Rejoin,
+}
@@ -0,0 +1,468 @@
+#include "aes_gcm.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define AGORA_AES_NI 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(AGORA_AES_NI) && defined(__GNUC__)
+#define AGORA_AES_NI_TARGET __attribute__((target("aes,pclmul,ssse3")))
+#else
+#define AGORA_AES_NI_TARGET
+#endif
+
+namespace agora_rtc_engine {
+
+    namespace {
+        uint32_t LoadBigEndian32(const uint8_t* p)
+        {
+            return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+        }
+
+        void StoreBigEndian32(uint8_t* p, uint32_t value)
+        {
+            p[0] = uint8_t(value >> 24);
+            p[1] = uint8_t(value >> 16);
+            p[2] = uint8_t(value >> 8);
+            p[3] = uint8_t(value);
+        }
+
+        uint64_t LoadBigEndian64(const uint8_t* p)
+        {
+            return (uint64_t(LoadBigEndian32(p)) << 32) | LoadBigEndian32(p + 4);
+        }
+
+        void StoreBigEndian64(uint8_t* p, uint64_t value)
+        {
+            StoreBigEndian32(p, uint32_t(value >> 32));
+            StoreBigEndian32(p + 4, uint32_t(value));
+        }
+
+        uint32_t RotateRight(uint32_t value, int bits)
+        {
+            return (value >> bits) | (value << (32 - bits));
+        }
+
+        uint8_t Rotate8(uint8_t value, int bits)
+        {
+            return uint8_t((value << bits) | (value >> (8 - bits)));
+        }
+
+        uint8_t Times2(uint8_t value)
+        {
+            return uint8_t((value << 1) ^ ((value & 0x80) ? 0x1b : 0));
+        }
+
+        // The S-box and the combined SubBytes/MixColumns table, computed once.
+        struct AesTables
+        {
+            uint8_t sbox[256];
+            uint32_t te[256];
+
+            AesTables()
+            {
+                // Walk the multiplicative group with generator 3 and its inverse
+                uint8_t p = 1;
+                uint8_t q = 1;
+                do
+                {
+                    p = uint8_t(p ^ Times2(p));
+                    q = uint8_t(q ^ (q << 1));
+                    q = uint8_t(q ^ (q << 2));
+                    q = uint8_t(q ^ (q << 4));
+                    if (q & 0x80)
+                        q ^= 0x09;
+                    sbox[p] = uint8_t(q ^ Rotate8(q, 1) ^ Rotate8(q, 2) ^ Rotate8(q, 3) ^ Rotate8(q, 4) ^ 0x63);
+                } while (p != 1);
+                sbox[0] = 0x63;
+
+                for (int i = 0; i < 256; ++i)
+                {
+                    uint8_t s = sbox[i];
+                    uint8_t s2 = Times2(s);
+                    uint8_t s3 = uint8_t(s2 ^ s);
+                    te[i] = (uint32_t(s2) << 24) | (uint32_t(s) << 16) | (uint32_t(s) << 8) | s3;
+                }
+            }
+        };
+
+        const AesTables& Tables()
+        {
+            static const AesTables tables;
+            return tables;
+        }
+
+        // Reduction constants for the 4-bit GHASH tables.
+        const uint64_t kLast4[16] = {
+            0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+            0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0,
+        };
+
+        void FillCounterBlock(uint8_t* block, const uint8_t* nonce, uint32_t counter)
+        {
+            std::memcpy(block, nonce, AesGcm::kNonceSize);
+            StoreBigEndian32(block + AesGcm::kNonceSize, counter);
+        }
+
+#ifdef AGORA_AES_NI
+        bool CpuSupportsAesNi()
+        {
+            unsigned int ecx = 0;
+#if defined(_MSC_VER)
+            int info[4] = {};
+            __cpuid(info, 1);
+            ecx = static_cast<unsigned int>(info[2]);
+#else
+            unsigned int eax = 0, ebx = 0, edx = 0;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+                return false;
+#endif
+            const unsigned int kSsse3 = 1u << 9;
+            const unsigned int kPclmul = 1u << 1;
+            const unsigned int kAes = 1u << 25;
+            return (ecx & (kSsse3 | kPclmul | kAes)) == (kSsse3 | kPclmul | kAes);
+        }
+
+        AGORA_AES_NI_TARGET __m128i ByteSwap(__m128i value)
+        {
+            return _mm_shuffle_epi8(value, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        }
+
+        // Carry-less multiplication in GF(2^128) on bit-reflected operands, from
+        // the Intel white paper on PCLMULQDQ and GCM.
+        AGORA_AES_NI_TARGET __m128i GfMultiply(__m128i a, __m128i b)
+        {
+            __m128i t3 = _mm_clmulepi64_si128(a, b, 0x00);
+            __m128i t4 = _mm_clmulepi64_si128(a, b, 0x10);
+            __m128i t5 = _mm_clmulepi64_si128(a, b, 0x01);
+            __m128i t6 = _mm_clmulepi64_si128(a, b, 0x11);
+            t4 = _mm_xor_si128(t4, t5);
+            t5 = _mm_slli_si128(t4, 8);
+            t4 = _mm_srli_si128(t4, 8);
+            t3 = _mm_xor_si128(t3, t5);
+            t6 = _mm_xor_si128(t6, t4);
+
+            __m128i t7 = _mm_srli_epi32(t3, 31);
+            __m128i t8 = _mm_srli_epi32(t6, 31);
+            t3 = _mm_slli_epi32(t3, 1);
+            t6 = _mm_slli_epi32(t6, 1);
+            __m128i t9 = _mm_srli_si128(t7, 12);
+            t8 = _mm_slli_si128(t8, 4);
+            t7 = _mm_slli_si128(t7, 4);
+            t3 = _mm_or_si128(t3, t7);
+            t6 = _mm_or_si128(t6, t8);
+            t6 = _mm_or_si128(t6, t9);
+
+            t7 = _mm_slli_epi32(t3, 31);
+            t8 = _mm_slli_epi32(t3, 30);
+            t9 = _mm_slli_epi32(t3, 25);
+            t7 = _mm_xor_si128(t7, t8);
+            t7 = _mm_xor_si128(t7, t9);
+            t8 = _mm_srli_si128(t7, 4);
+            t7 = _mm_slli_si128(t7, 12);
+            t3 = _mm_xor_si128(t3, t7);
+
+            __m128i t2 = _mm_srli_epi32(t3, 1);
+            t4 = _mm_srli_epi32(t3, 2);
+            t5 = _mm_srli_epi32(t3, 7);
+            t2 = _mm_xor_si128(t2, t4);
+            t2 = _mm_xor_si128(t2, t5);
+            t2 = _mm_xor_si128(t2, t8);
+            t3 = _mm_xor_si128(t3, t2);
+            return _mm_xor_si128(t6, t3);
+        }
+
+        AGORA_AES_NI_TARGET void CtrAesNi(const uint8_t* roundKeys, int rounds, const uint8_t* nonce,
+            const uint8_t* in, size_t size, uint8_t* out)
+        {
+            __m128i keys[15];
+            for (int i = 0; i <= rounds; ++i)
+                keys[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(roundKeys + 16 * i));
+
+            alignas(16) uint8_t counters[4 * 16];
+            uint32_t counter = 2;
+            // Four independent blocks keep the AES units busy
+            while (size >= 64)
+            {
+                __m128i blocks[4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    FillCounterBlock(counters + 16 * i, nonce, counter++);
+                    blocks[i] = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(counters + 16 * i)), keys[0]);
+                }
+                for (int r = 1; r < rounds; ++r)
+                    for (int i = 0; i < 4; ++i)
+                        blocks[i] = _mm_aesenc_si128(blocks[i], keys[r]);
+                for (int i = 0; i < 4; ++i)
+                {
+                    blocks[i] = _mm_aesenclast_si128(blocks[i], keys[rounds]);
+                    auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * i), _mm_xor_si128(data, blocks[i]));
+                }
+                in += 64;
+                out += 64;
+                size -= 64;
+            }
+            while (size > 0)
+            {
+                FillCounterBlock(counters, nonce, counter++);
+                __m128i block = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(counters)), keys[0]);
+                for (int r = 1; r < rounds; ++r)
+                    block = _mm_aesenc_si128(block, keys[r]);
+                block = _mm_aesenclast_si128(block, keys[rounds]);
+                _mm_store_si128(reinterpret_cast<__m128i*>(counters), block);
+                auto chunk = size < 16 ? size : 16;
+                for (size_t i = 0; i < chunk; ++i)
+                    out[i] = uint8_t(in[i] ^ counters[i]);
+                in += chunk;
+                out += chunk;
+                size -= chunk;
+            }
+        }
+
+        AGORA_AES_NI_TARGET void GhashPclmul(const uint8_t* hashKey, const uint8_t* data, size_t size, uint8_t* tag)
+        {
+            __m128i h = ByteSwap(_mm_load_si128(reinterpret_cast<const __m128i*>(hashKey)));
+            __m128i y = _mm_setzero_si128();
+            while (size >= 16)
+            {
+                y = GfMultiply(_mm_xor_si128(y, ByteSwap(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)))), h);
+                data += 16;
+                size -= 16;
+            }
+            alignas(16) uint8_t block[16] = {};
+            if (size > 0)
+            {
+                std::memcpy(block, data, size);
+                y = GfMultiply(_mm_xor_si128(y, ByteSwap(_mm_load_si128(reinterpret_cast<const __m128i*>(block)))), h);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(tag), ByteSwap(y));
+        }
+#endif
+    }  // namespace
+
+    bool AesGcm::SetKey(const uint8_t* key, size_t keySize)
+    {
+        if (keySize != 16 && keySize != 24 && keySize != 32)
+            return false;
+
+        const auto& tables = Tables();
+        const int keyWords = static_cast<int>(keySize / 4);
+        rounds = keyWords + 6;
+        uint32_t words[60];
+        for (int i = 0; i < keyWords; ++i)
+            words[i] = LoadBigEndian32(key + 4 * i);
+        uint8_t roundConstant = 1;
+        for (int i = keyWords; i < 4 * (rounds + 1); ++i)
+        {
+            uint32_t temp = words[i - 1];
+            if (i % keyWords == 0 || (keyWords > 6 && i % keyWords == 4))
+            {
+                if (i % keyWords == 0)
+                    temp = (temp << 8) | (temp >> 24);
+                temp = (uint32_t(tables.sbox[temp >> 24]) << 24) |
+                    (uint32_t(tables.sbox[(temp >> 16) & 0xff]) << 16) |
+                    (uint32_t(tables.sbox[(temp >> 8) & 0xff]) << 8) |
+                    uint32_t(tables.sbox[temp & 0xff]);
+                if (i % keyWords == 0)
+                {
+                    temp ^= uint32_t(roundConstant) << 24;
+                    roundConstant = Times2(roundConstant);
+                }
+            }
+            words[i] = words[i - keyWords] ^ temp;
+        }
+        for (int i = 0; i < 4 * (rounds + 1); ++i)
+            StoreBigEndian32(roundKeys + 4 * i, words[i]);
+
+#ifdef AGORA_AES_NI
+        useAesNi = CpuSupportsAesNi();
+#endif
+
+        // H = E(K, 0) and the 4-bit tables for the portable GHASH
+        uint8_t zero[16] = {};
+        EncryptBlock(zero, hashKey);
+        uint64_t high = LoadBigEndian64(hashKey);
+        uint64_t low = LoadBigEndian64(hashKey + 8);
+        hashTableHigh[0] = 0;
+        hashTableLow[0] = 0;
+        hashTableHigh[8] = high;
+        hashTableLow[8] = low;
+        for (int i = 4; i > 0; i >>= 1)
+        {
+            uint64_t carry = (low & 1) * 0xe1000000u;
+            low = (high << 63) | (low >> 1);
+            high = (high >> 1) ^ (carry << 32);
+            hashTableHigh[i] = high;
+            hashTableLow[i] = low;
+        }
+        for (int i = 2; i <= 8; i *= 2)
+        {
+            for (int j = 1; j < i; ++j)
+            {
+                hashTableHigh[i + j] = hashTableHigh[i] ^ hashTableHigh[j];
+                hashTableLow[i + j] = hashTableLow[i] ^ hashTableLow[j];
+            }
+        }
+        return true;
+    }
+
+    void AesGcm::Seal(const uint8_t* nonce, const uint8_t* in, size_t size, uint8_t* out, uint8_t* tag) const
+    {
+        Ctr(nonce, in, size, out);
+        if (tag != nullptr)
+            ComputeTag(nonce, out, size, tag);
+    }
+
+    bool AesGcm::Open(const uint8_t* nonce, const uint8_t* in, size_t size, uint8_t* out, const uint8_t* tag) const
+    {
+        if (tag != nullptr)
+        {
+            uint8_t expected[kTagSize];
+            ComputeTag(nonce, in, size, expected);
+            uint8_t difference = 0;
+            for (size_t i = 0; i < kTagSize; ++i)
+                difference = uint8_t(difference | (expected[i] ^ tag[i]));
+            if (difference != 0)
+                return false;
+        }
+        Ctr(nonce, in, size, out);
+        return true;
+    }
+
+    void AesGcm::EncryptBlock(const uint8_t* in, uint8_t* out) const
+    {
+        const auto& tables = Tables();
+        const auto* te = tables.te;
+        const auto* sbox = tables.sbox;
+        uint32_t s0 = LoadBigEndian32(in) ^ LoadBigEndian32(roundKeys);
+        uint32_t s1 = LoadBigEndian32(in + 4) ^ LoadBigEndian32(roundKeys + 4);
+        uint32_t s2 = LoadBigEndian32(in + 8) ^ LoadBigEndian32(roundKeys + 8);
+        uint32_t s3 = LoadBigEndian32(in + 12) ^ LoadBigEndian32(roundKeys + 12);
+        for (int r = 1; r < rounds; ++r)
+        {
+            const uint8_t* key = roundKeys + 16 * r;
+            uint32_t t0 = te[s0 >> 24] ^ RotateRight(te[(s1 >> 16) & 0xff], 8) ^
+                RotateRight(te[(s2 >> 8) & 0xff], 16) ^ RotateRight(te[s3 & 0xff], 24) ^ LoadBigEndian32(key);
+            uint32_t t1 = te[s1 >> 24] ^ RotateRight(te[(s2 >> 16) & 0xff], 8) ^
+                RotateRight(te[(s3 >> 8) & 0xff], 16) ^ RotateRight(te[s0 & 0xff], 24) ^ LoadBigEndian32(key + 4);
+            uint32_t t2 = te[s2 >> 24] ^ RotateRight(te[(s3 >> 16) & 0xff], 8) ^
+                RotateRight(te[(s0 >> 8) & 0xff], 16) ^ RotateRight(te[s1 & 0xff], 24) ^ LoadBigEndian32(key + 8);
+            uint32_t t3 = te[s3 >> 24] ^ RotateRight(te[(s0 >> 16) & 0xff], 8) ^
+                RotateRight(te[(s1 >> 8) & 0xff], 16) ^ RotateRight(te[s2 & 0xff], 24) ^ LoadBigEndian32(key + 12);
+            s0 = t0;
+            s1 = t1;
+            s2 = t2;
+            s3 = t3;
+        }
+        const uint8_t* key = roundKeys + 16 * rounds;
+        auto last = [sbox](uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+            return (uint32_t(sbox[a >> 24]) << 24) | (uint32_t(sbox[(b >> 16) & 0xff]) << 16) |
+                (uint32_t(sbox[(c >> 8) & 0xff]) << 8) | uint32_t(sbox[d & 0xff]);
+        };
+        StoreBigEndian32(out, last(s0, s1, s2, s3) ^ LoadBigEndian32(key));
+        StoreBigEndian32(out + 4, last(s1, s2, s3, s0) ^ LoadBigEndian32(key + 4));
+        StoreBigEndian32(out + 8, last(s2, s3, s0, s1) ^ LoadBigEndian32(key + 8));
+        StoreBigEndian32(out + 12, last(s3, s0, s1, s2) ^ LoadBigEndian32(key + 12));
+    }
+
+    void AesGcm::Ctr(const uint8_t* nonce, const uint8_t* in, size_t size, uint8_t* out) const
+    {
+#ifdef AGORA_AES_NI
+        if (useAesNi)
+        {
+            CtrAesNi(roundKeys, rounds, nonce, in, size, out);
+            return;
+        }
+#endif
+        uint8_t counterBlock[16];
+        uint8_t keyStream[16];
+        uint32_t counter = 2;
+        while (size > 0)
+        {
+            FillCounterBlock(counterBlock, nonce, counter++);
+            EncryptBlock(counterBlock, keyStream);
+            auto chunk = size < 16 ? size : 16;
+            for (size_t i = 0; i < chunk; ++i)
+                out[i] = uint8_t(in[i] ^ keyStream[i]);
+            in += chunk;
+            out += chunk;
+            size -= chunk;
+        }
+    }
+
+    void AesGcm::Ghash(const uint8_t* data, size_t size, uint8_t* tag) const
+    {
+#ifdef AGORA_AES_NI
+        if (useAesNi)
+        {
+            GhashPclmul(hashKey, data, size, tag);
+            return;
+        }
+#endif
+        uint8_t y[16] = {};
+        while (size > 0)
+        {
+            auto chunk = size < 16 ? size : 16;
+            for (size_t i = 0; i < chunk; ++i)
+                y[i] ^= data[i];
+            data += chunk;
+            size -= chunk;
+
+            // Shoup's method, one nibble at a time
+            uint8_t nibble = y[15] & 0xf;
+            uint64_t high = hashTableHigh[nibble];
+            uint64_t low = hashTableLow[nibble];
+            for (int i = 15; i >= 0; --i)
+            {
+                uint8_t lowNibble = y[i] & 0xf;
+                uint8_t highNibble = uint8_t(y[i] >> 4);
+                if (i != 15)
+                {
+                    uint8_t remainder = low & 0xf;
+                    low = (high << 60) | (low >> 4);
+                    high = (high >> 4) ^ (kLast4[remainder] << 48);
+                    high ^= hashTableHigh[lowNibble];
+                    low ^= hashTableLow[lowNibble];
+                }
+                uint8_t remainder = low & 0xf;
+                low = (high << 60) | (low >> 4);
+                high = (high >> 4) ^ (kLast4[remainder] << 48);
+                high ^= hashTableHigh[highNibble];
+                low ^= hashTableLow[highNibble];
+            }
+            StoreBigEndian64(y, high);
+            StoreBigEndian64(y + 8, low);
+        }
+        std::memcpy(tag, y, 16);
+    }
+
+    void AesGcm::ComputeTag(const uint8_t* nonce, const uint8_t* cipherText, size_t size, uint8_t* tag) const
+    {
+        // GHASH over the cipher text and the length block, no associated data
+        uint8_t hash[16];
+        Ghash(cipherText, size, hash);
+        uint8_t lengths[16] = {};
+        StoreBigEndian64(lengths + 8, uint64_t(size) * 8);
+        for (size_t i = 0; i < 16; ++i)
+            hash[i] ^= lengths[i];
+        Ghash(hash, 16, hash);
+
+        uint8_t counterBlock[16];
+        FillCounterBlock(counterBlock, nonce, 1);
+        uint8_t mask[16];
+        EncryptBlock(counterBlock, mask);
+        for (size_t i = 0; i < kTagSize; ++i)
+            tag[i] = uint8_t(hash[i] ^ mask[i]);
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,60 @@
+#ifndef AGORA_RTC_ENGINE_AES_GCM_H_
+#define AGORA_RTC_ENGINE_AES_GCM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace agora_rtc_engine {
+
+    // AES in counter mode, optionally authenticated with GHASH (AES-GCM).
+    //
+    // Uses AES-NI and PCLMULQDQ when the CPU supports them and a table-based
+    // implementation otherwise. Never allocates, so it can run on the packet
+    // path. A single instance can be used from several threads at once once
+    // its key is set.
+    class AesGcm
+    {
+    public:
+        static const size_t kNonceSize = 12;
+        static const size_t kTagSize = 16;
+
+        // Returns false unless |keySize| is 16, 24 or 32.
+        bool SetKey(const uint8_t* key, size_t keySize);
+
+        // Encrypts |size| bytes of |in| to |out|, which may be the same buffer.
+        // Writes the authentication tag to |tag| unless it is null.
+        void Seal(const uint8_t* nonce, const uint8_t* in, size_t size, uint8_t* out, uint8_t* tag) const;
+
+        // Decrypts |size| bytes of |in| to |out|. When |tag| is not null, it is
+        // verified first and nothing is written if it does not match.
+        bool Open(const uint8_t* nonce, const uint8_t* in, size_t size, uint8_t* out, const uint8_t* tag) const;
+
+        // Whether the AES-NI code path is used.
+        bool accelerated() const { return useAesNi; }
+
+        // Uses the portable code path from now on, e.g. to test it on a CPU
+        // with AES-NI. SetKey selects the path again.
+        void DisableAcceleration() { useAesNi = false; }
+
+    private:
+        void EncryptBlock(const uint8_t* in, uint8_t* out) const;
+
+        // XORs |in| with the keystream starting at counter block 2.
+        void Ctr(const uint8_t* nonce, const uint8_t* in, size_t size, uint8_t* out) const;
+
+        void Ghash(const uint8_t* data, size_t size, uint8_t* tag) const;
+
+        void ComputeTag(const uint8_t* nonce, const uint8_t* cipherText, size_t size, uint8_t* tag) const;
+
+        int rounds = 0;
+        alignas(16) uint8_t roundKeys[15 * 16] = {};
+        // GHASH key and its 4-bit multiplication tables.
+        alignas(16) uint8_t hashKey[16] = {};
+        uint64_t hashTableHigh[16] = {};
+        uint64_t hashTableLow[16] = {};
+        bool useAesNi = false;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_AES_GCM_H_
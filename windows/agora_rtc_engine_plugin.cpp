@@ -17,54 +17,359 @@
 #include <windows.h>
 
 #include <flutter/method_channel.h>
-#include <flutter/basic_message_channel.h>
+#include <flutter/method_result_functions.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_message_codec.h>
 #include <flutter/standard_method_codec.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <thread>
 
+#include "IAgoraMediaEngine.h"
 #include "IAgoraRtcEngine.h"
 
+#include "audio_effect_cache.h"
+#include "audio_frame_hub.h"
+#include "audio_tap.h"
+#include "channel_media_relay.h"
+#include "channel_switcher.h"
+#include "data_stream_transport.h"
+#include "device_registry.h"
+#include "encoder_tuner.h"
+#include "engine_broker.h"
+#include "event_forwarder.h"
+#include "event_trace.h"
+#include "gdi_screen_capture.h"
+#include "log_mel_extractor.h"
+#include "metadata_multiplexer.h"
+#include "network_preflight.h"
+#include "packet_capture.h"
+#include "packet_cipher.h"
+#include "packet_pipeline.h"
+#include "platform_task_runner.h"
+#include "queue_benchmark.h"
+#include "screen_share_source.h"
+#include "stats_encoder.h"
+#include "token_manager.h"
+#include "token_provider.h"
+#include "transcoding_layout.h"
+#include "video_render_policy.h"
+#include "video_snapshot.h"
+#include "worker_pool.h"
+
 using namespace agora::rtc;
+using agora::media::IVideoFrameObserver;
+using agora_rtc_engine::AesPacketCipher;
+using agora_rtc_engine::AudioEffectCache;
+using agora_rtc_engine::AudioEffectCacheOptions;
+using agora_rtc_engine::AudioEffectCacheStats;
+using agora_rtc_engine::AudioFormat;
+using agora_rtc_engine::AudioFrameHub;
+using agora_rtc_engine::AudioFrameHubStats;
+using agora_rtc_engine::AudioFrameSource;
+using agora_rtc_engine::AudioFrameView;
+using agora_rtc_engine::AudioTap;
+using agora_rtc_engine::AudioTapStats;
+using agora_rtc_engine::CallbackTokenProvider;
+using agora_rtc_engine::ChannelMediaRelayManager;
+using agora_rtc_engine::ChannelSwitchResult;
+using agora_rtc_engine::ChannelSwitchStats;
+using agora_rtc_engine::ChannelSwitcher;
+using agora_rtc_engine::DataStreamTransport;
+using agora_rtc_engine::DataTransportOptions;
+using agora_rtc_engine::DeviceChange;
+using agora_rtc_engine::DeviceInfo;
+using agora_rtc_engine::DeviceKind;
+using agora_rtc_engine::DeviceRegistry;
+using agora_rtc_engine::EffectEvictionPolicy;
+using agora_rtc_engine::EncoderLevel;
+using agora_rtc_engine::EncoderTuner;
+using agora_rtc_engine::EncoderTunerOptions;
+using agora_rtc_engine::EngineBroker;
+using agora_rtc_engine::EngineBrokerStats;
+using agora_rtc_engine::EventCounters;
+using agora_rtc_engine::EventForwarder;
+using agora_rtc_engine::EventMessage;
+using agora_rtc_engine::EventRecorder;
+using agora_rtc_engine::EventRecordingStats;
+using agora_rtc_engine::EventReplayStats;
+using agora_rtc_engine::EventReplayer;
+using agora_rtc_engine::GdiScreenCapture;
+using agora_rtc_engine::ImageFormat;
+using agora_rtc_engine::LastmileMeasurement;
+using agora_rtc_engine::LayoutTemplate;
+using agora_rtc_engine::LogMelExtractor;
+using agora_rtc_engine::MetadataChannelOptions;
+using agora_rtc_engine::MetadataMultiplexer;
+using agora_rtc_engine::NetworkPreflight;
+using agora_rtc_engine::PacketCapture;
+using agora_rtc_engine::PacketCaptureOptions;
+using agora_rtc_engine::PacketCipherMode;
+using agora_rtc_engine::PacketDirectionStats;
+using agora_rtc_engine::PacketPipeline;
+using agora_rtc_engine::PlatformTaskRunner;
+using agora_rtc_engine::PreflightOptions;
+using agora_rtc_engine::PreflightPlan;
+using agora_rtc_engine::PreflightStats;
+using agora_rtc_engine::QueueBenchmark;
+using agora_rtc_engine::RelayDestinationInfo;
+using agora_rtc_engine::RenderPolicy;
+using agora_rtc_engine::RenderPolicyCounters;
+using agora_rtc_engine::ScreenFrame;
+using agora_rtc_engine::ScreenShareOptions;
+using agora_rtc_engine::ScreenShareSource;
+using agora_rtc_engine::ScreenShareStats;
+using agora_rtc_engine::SnapshotStatus;
+using agora_rtc_engine::StubTokenProvider;
+using agora_rtc_engine::TokenEvent;
+using agora_rtc_engine::TokenGrant;
+using agora_rtc_engine::TokenManager;
+using agora_rtc_engine::TokenManagerOptions;
+using agora_rtc_engine::TokenManagerStats;
+using agora_rtc_engine::TokenProvider;
+using agora_rtc_engine::TokenRequest;
+using agora_rtc_engine::TranscodingLayoutEngine;
+using agora_rtc_engine::TranscodingLayoutOptions;
+using agora_rtc_engine::TuningDecision;
+using agora_rtc_engine::VideoRenderPolicy;
+using agora_rtc_engine::VideoSnapshotService;
+using agora_rtc_engine::WorkerPool;
 
 namespace {
+    using flutter::EncodableList;
     using flutter::EncodableMap;
     using flutter::EncodableValue;
 
+    // Frames of a remote user whose tile is at most this large are served from
+    // the low-quality stream when the sender publishes dual streams.
+    const int kLowStreamMaxArea = 320 * 240;
+
+    const char kEventChannel[] = "agora_rtc_engine_message_channel";
+
+    // Audio taps queue up to 640 ms of 10 ms frames, and log-mel
+    // extractors 1.28 s of features, sent to Dart every 100 ms.
+    const size_t kAudioTapChunks = 64;
+    const size_t kLogMelFrames = 128;
+    const std::chrono::milliseconds kAudioDrainInterval(100);
+
+    // Windows share the engine's sound ids, each maps those it registers
+    // from Dart into a range of its own.
+    const int kEffectSoundIdRange = 1 << 16;
+    const int kEffectSoundIdRanges = 1 << 14;
+    std::atomic<int> nextEffectSoundIdRange{0};
+
     void DebugPrintLine(const std::string& string)
     {
         std::wstring wstring{ string.begin(), string.end() };
         OutputDebugString((wstring + L"\n").c_str());
     }
 
-    EncodableMap toMap(const RtcStats& stats)
+    EncodableMap toMap(const RenderPolicyCounters& counters)
+    {
+        return EncodableMap{
+            {"uid", (int64_t)counters.uid},
+            {"delivered", (int64_t)counters.delivered},
+            {"droppedHidden", (int64_t)counters.droppedHidden},
+            {"droppedRate", (int64_t)counters.droppedRate},
+            {"droppedStale", (int64_t)counters.droppedStale},
+            {"droppedSize", (int64_t)counters.droppedSize},
+            {"skippedBytes", (int64_t)counters.skippedBytes},
+        };
+    }
+
+    EncodableMap toMap(const PacketDirectionStats& stats)
+    {
+        return EncodableMap{
+            {"packets", (int64_t)stats.packets},
+            {"bytes", (int64_t)stats.bytes},
+            {"dropped", (int64_t)stats.dropped},
+            {"totalNanos", stats.totalNanos},
+            {"maxNanos", stats.maxNanos},
+        };
+    }
+
+    EncodableMap toMap(const DeviceInfo& device)
     {
         return EncodableMap{
-            {"totalDuration", (int)stats.duration},
-            {"txBytes", (int)stats.txBytes},
-            {"rxBytes", (int)stats.rxBytes},
-            {"txAudioBytes", (int)stats.txAudioBytes},
-            {"txVideoBytes", (int)stats.txVideoBytes},
-            {"rxAudioBytes", (int)stats.rxAudioBytes},
-            {"rxVideoBytes", (int)stats.rxVideoBytes},
-            {"txKBitrate", (int)stats.txKBitRate},
-            {"rxKBitrate", (int)stats.rxKBitRate},
-            {"txAudioKBitrate", (int)stats.txAudioKBitRate},
-            {"rxAudioKBitrate", (int)stats.rxAudioKBitRate},
-            {"txVideoKBitrate", (int)stats.txVideoKBitRate},
-            {"rxVideoKBitrate", (int)stats.rxVideoKBitRate},
-            {"lastmileDelay", (int)stats.lastmileDelay},
-            {"txPacketLossRate", (int)stats.txPacketLossRate},
-            {"rxPacketLossRate", (int)stats.rxPacketLossRate},
-            {"users", (int)stats.userCount},
-            {"cpuAppUsage", stats.cpuAppUsage},
-            {"cpuTotalUsage", stats.cpuTotalUsage},
+            {"id", device.id},
+            {"name", device.name},
+            {"isDefault", device.isDefault},
         };
     }
 
-    class AgoraRtcEnginePlugin : public flutter::Plugin, IRtcEngineEventHandler
+    EncodableMap toMap(const AudioEffectCacheStats& stats)
+    {
+        return EncodableMap{
+            {"plays", (int64_t)stats.plays},
+            {"hits", (int64_t)stats.hits},
+            {"preloads", (int64_t)stats.preloads},
+            {"predictedPreloads", (int64_t)stats.predictedPreloads},
+            {"failedPreloads", (int64_t)stats.failedPreloads},
+            {"evictions", (int64_t)stats.evictions},
+            {"usedBytes", stats.usedBytes},
+            {"memoryBudget", stats.memoryBudget},
+            {"registered", stats.registered},
+            {"loaded", stats.loaded},
+            {"hitRate", stats.hitRate},
+            {"meanHitPlayNanos", stats.meanHitPlayNanos},
+            {"meanColdPlayNanos", stats.meanColdPlayNanos},
+        };
+    }
+
+    EncodableMap toMap(const EncoderLevel& level)
+    {
+        return EncodableMap{
+            {"width", level.width},
+            {"height", level.height},
+            {"frameRate", level.frameRate},
+            {"bitrate", level.bitrate},
+        };
+    }
+
+    EncodableMap toMap(const PreflightPlan& plan)
+    {
+        const auto& measurement = plan.measurement;
+        return EncodableMap{
+            {"level", plan.level},
+            {"video", toMap(plan.video)},
+            {"audioProfile", plan.audioProfile},
+            {"state", measurement.state},
+            {"quality", measurement.quality},
+            {"uplinkLossRate", measurement.uplink.packetLossRate},
+            {"uplinkJitter", measurement.uplink.jitter},
+            {"uplinkBandwidth", measurement.uplink.availableBandwidth},
+            {"downlinkLossRate", measurement.downlink.packetLossRate},
+            {"downlinkJitter", measurement.downlink.jitter},
+            {"downlinkBandwidth", measurement.downlink.availableBandwidth},
+            {"rtt", measurement.rtt},
+            {"cached", plan.cached},
+            {"refined", plan.refined},
+            {"timedOut", plan.timedOut},
+            {"ageMs", plan.ageMs},
+            {"probeMs", plan.probeMs},
+        };
+    }
+
+    EncodableMap toMap(const PreflightStats& stats)
+    {
+        return EncodableMap{
+            {"requests", (int64_t)stats.requests},
+            {"cacheHits", (int64_t)stats.cacheHits},
+            {"probes", (int64_t)stats.probes},
+            {"timeouts", (int64_t)stats.timeouts},
+            {"cachedNetworks", (int)stats.cachedNetworks},
+            {"networkType", stats.networkType},
+        };
+    }
+
+    EncodableMap toMap(const TuningDecision& decision)
+    {
+        return EncodableMap{
+            {"timeMs", decision.timeMs},
+            {"fromLevel", decision.fromLevel},
+            {"toLevel", decision.toLevel},
+            {"level", toMap(decision.level)},
+            {"reason", (int)decision.reason},
+            {"cpuTotalUsage", decision.cpuTotalUsage},
+            {"cpuAppUsage", decision.cpuAppUsage},
+            {"txQuality", decision.txQuality},
+            {"encoderOutputFrameRate", decision.encoderOutputFrameRate},
+        };
+    }
+
+    EncodableMap toMap(const EventRecordingStats& stats)
+    {
+        return EncodableMap{
+            {"events", (int64_t)stats.events},
+            {"bytes", (int64_t)stats.bytes},
+        };
+    }
+
+    EncodableMap toMap(const EventReplayStats& stats)
+    {
+        return EncodableMap{
+            {"events", (int64_t)stats.events},
+            {"skipped", (int64_t)stats.skipped},
+            {"durationNanos", stats.durationNanos},
+            {"handlerNanos", stats.handlerNanos},
+            {"maxHandlerNanos", stats.maxHandlerNanos},
+            {"eventsPerSecond", stats.eventsPerSecond},
+        };
+    }
+
+    EncodableMap toMap(const ScreenShareStats& stats)
+    {
+        return EncodableMap{
+            {"captured", (int64_t)stats.captured},
+            {"pushed", (int64_t)stats.pushed},
+            {"skipped", (int64_t)stats.skipped},
+            {"failed", (int64_t)stats.failed},
+            {"savedFrames", (int64_t)stats.savedFrames},
+            {"frameRate", stats.frameRate},
+            {"dirtyTileRatio", stats.dirtyTileRatio},
+            {"meanCaptureNanos", stats.meanCaptureNanos},
+            {"meanHashNanos", stats.meanHashNanos},
+        };
+    }
+
+    EncodableMap toMap(const ChannelSwitchResult& result)
+    {
+        return EncodableMap{
+            {"fromChannel", result.fromChannel},
+            {"toChannel", result.toChannel},
+            {"mode", (int)result.mode},
+            {"ok", result.ok},
+            {"error", result.error},
+            {"tokenMs", result.tokenMs},
+            {"leftMs", result.leftMs},
+            {"joinedMs", result.joinedMs},
+            {"firstFrameMs", result.firstFrameMs},
+        };
+    }
+
+    EncodableMap toMap(const ChannelSwitchStats& stats)
+    {
+        return EncodableMap{
+            {"switches", (int64_t)stats.switches},
+            {"switched", (int64_t)stats.switched},
+            {"rejoined", (int64_t)stats.rejoined},
+            {"failures", (int64_t)stats.failures},
+            {"withoutFrames", (int64_t)stats.withoutFrames},
+            {"meanJoinedMs", stats.meanJoinedMs},
+            {"meanFirstFrameMs", stats.meanFirstFrameMs},
+            {"maxFirstFrameMs", stats.maxFirstFrameMs},
+        };
+    }
+
+    EncodableMap toMap(const TokenEvent& event)
+    {
+        return EncodableMap{
+            {"timeMs", event.timeMs},
+            {"channelId", event.channelId},
+            {"uid", (int64_t)event.uid},
+            {"reason", (int)event.reason},
+            {"ok", event.ok},
+            {"cached", event.cached},
+            {"latencyNanos", event.latencyNanos},
+        };
+    }
+
+    EncodableMap toMap(const TokenManagerStats& stats)
+    {
+        return EncodableMap{
+            {"fetches", (int64_t)stats.fetches},
+            {"failures", (int64_t)stats.failures},
+            {"timeouts", (int64_t)stats.timeouts},
+            {"cacheHits", (int64_t)stats.cacheHits},
+            {"renewals", (int64_t)stats.renewals},
+            {"meanFetchNanos", stats.meanFetchNanos},
+            {"maxFetchNanos", stats.maxFetchNanos},
+        };
+    }
+
+    class AgoraRtcEnginePlugin : public flutter::Plugin, IRtcEngineEventHandler, IVideoFrameObserver
     {
     public:
         static void RegisterWithRegistrar(flutter::PluginRegistrarWindows* registrar);
@@ -79,7 +384,28 @@ namespace {
     	void onUserJoined(uid_t uid, int elapsed) override;
         void onUserOffline(uid_t uid, USER_OFFLINE_REASON_TYPE reason) override;
         void onRtcStats(const RtcStats& stats) override;
-        void onRemoteAudioStats(const RemoteAudioStats& stats) override;
+        void onLocalVideoStats(const LocalVideoStats& stats) override;
+        void onNetworkQuality(uid_t uid, int txQuality, int rxQuality) override;
+        void onStreamMessage(uid_t uid, int streamId, const char* data, size_t length) override;
+        void onActiveSpeaker(uid_t uid) override;
+        void onChannelMediaRelayStateChanged(CHANNEL_MEDIA_RELAY_STATE state, CHANNEL_MEDIA_RELAY_ERROR code) override;
+        void onChannelMediaRelayEvent(CHANNEL_MEDIA_RELAY_EVENT code) override;
+        void onAudioDeviceStateChanged(const char* deviceId, int deviceType, int deviceState) override;
+        void onAudioEffectFinished(int soundId) override;
+        void onLastmileQuality(int quality) override;
+        void onLastmileProbeResult(const LastmileProbeResult& result) override;
+        void onNetworkTypeChanged(NETWORK_TYPE type) override;
+        void onRequestToken() override;
+        void onClientRoleChanged(CLIENT_ROLE_TYPE oldRole, CLIENT_ROLE_TYPE newRole) override;
+        void onFirstRemoteVideoDecoded(uid_t uid, int width, int height, int elapsed) override;
+        void onFirstRemoteAudioFrame(uid_t uid, int elapsed) override;
+        void onTokenPrivilegeWillExpire(const char* token) override;
+        void onVideoDeviceStateChanged(const char* deviceId, int deviceType, int deviceState) override;
+#pragma endregion
+
+#pragma region IVideoFrameObserver
+        bool onCaptureVideoFrame(VideoFrame& videoFrame) override;
+        bool onRenderVideoFrame(unsigned int uid, VideoFrame& videoFrame) override;
 #pragma endregion
 
     private:
@@ -88,14 +414,174 @@ namespace {
             const flutter::MethodCall<flutter::EncodableValue>& method_call,
             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
-        IRtcEngine* agoraRtcEngine;
+        // Runs |calls| through HandleMethodCall in order, completing |result|
+        // with the outcome of each once they all have completed.
+        void HandleBatch(
+            const EncodableList& calls,
+            std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+        // Registers the packet, metadata and audio frame observers of the
+        // engine's owner.
+        void RegisterEngineObservers();
+
+        // Becomes the engine's owner once the owner detached, unless this
+        // window detached from |attachment| since.
+        void TakeEngineOwnership(uint64_t attachment);
+
+        // Unregisters the packet, metadata and audio frame observers if this
+        // window registered them.
+        void UnregisterEngineObservers();
+
+        // Detaches from the shared engine, which is released with the last
+        // window.
+        void DetachEngine();
+
+        // Admits or drops a frame of |uid| (0 for the local capture) before any
+        // processing, according to the render policy set from Dart.
+        bool ProcessVideoFrame(unsigned int uid, VideoFrame& videoFrame);
+
+        // Registers the packet pipeline while it has work to do, the SDK skips
+        // the observer entirely otherwise.
+        void UpdatePacketObserver();
+
+        void StopPacketCapture();
+
+        // Stops the pacing thread, which may be sending on the engine.
+        void CloseDataTransport();
+
+        // Requests the formats the audio consumers negotiated from the SDK,
+        // and observes its audio frames while there are consumers.
+        void UpdateAudioFrameObserver();
+
+        // Starts draining the audio consumers unless it already runs.
+        void ScheduleAudioDrain();
+
+        // Sends what each tap and extractor read since the last call, then
+        // again after kAudioDrainInterval while there are any.
+        void DrainAudioConsumers();
+
+        void SendAudioTap(int id, AudioTap& tap);
+
+        void SendLogMelFeatures(int id, LogMelExtractor& extractor);
+
+        // Stops the capture thread and the engine's external video source.
+        void StopScreenShare();
+
+        // Declared first so that it outlives the components posting to it.
+        PlatformTaskRunner platformTasks;
+
+        // Runs benchmarks one at a time off the platform thread. Destroying it
+        // waits for the running one, so that none outlives this plugin.
+        WorkerPool benchmarks{1};
+
+        IRtcEngine* agoraRtcEngine = nullptr;
+
+        // Whether this window owns the engine it shares with the others, as
+        // the window that created it or the one it was handed on to. The
+        // packet, metadata and audio frame observers, one per engine, are its
+        // own.
+        bool engineOwner = false;
+
+        // Counts the times this window attached to the engine.
+        uint64_t engineAttachment = 0;
+
+        PacketPipeline packetPipeline;
+
+        std::shared_ptr<PacketCapture> packetCapture;
+
+        VideoRenderPolicy renderPolicy;
+
+        VideoSnapshotService snapshots;
+
+        // Created once per engine, the SDK has no way to close a data stream.
+        int dataStreamId = -1;
+
+        // Read on the SDK thread in onStreamMessage.
+        std::shared_ptr<DataStreamTransport> dataTransport;
+
+        MetadataMultiplexer metadata;
+
+        // Hosts in the channel, including the local user once joined unless
+        // they are an audience member.
+        TranscodingLayoutEngine transcodingLayout;
+
+        uid_t localUid = 0;
+
+        // Set by setClientRole and onClientRoleChanged.
+        std::atomic<bool> localAudience{false};
+
+        ChannelMediaRelayManager mediaRelay;
+
+        DeviceRegistry devices;
+
+        EncoderTuner encoderTuner;
+
+        // Caches last-mile measurements across engines, per network.
+        NetworkPreflight preflight;
+
+        // Added to the sound ids from Dart on the engine.
+        const int effectSoundIdBase;
+
+        // Preloads the registered effects on a worker thread, by their sound
+        // ids from Dart.
+        AudioEffectCache effects;
 
-        std::unique_ptr<flutter::BasicMessageChannel<EncodableValue>> messageChannel;
+        // Calls this plugin with every engine event, then sends those
+        // subscribed to from Dart.
+        EventForwarder eventForwarder;
 
+        // The engine's event handler, forwarding to eventForwarder.
+        EventRecorder eventRecorder;
+
+        // Stands in for this plugin as the target of replayed events, whose
+        // handlers are empty, so that a replay reaches Dart without driving
+        // the tuner, relays, data transport or any other component.
+        IRtcEngineEventHandler replaySink;
+
+        // Sends replayed events with the subscriptions of eventForwarder.
+        EventForwarder replayForwarder;
+
+        // Feeds recorded traces to replayForwarder as if they came from the
+        // engine.
+        EventReplayer eventReplayer;
+
+        agora::util::AutoPtr<agora::media::IMediaEngine> screenShareEngine;
+
+        // Pushes to screenShareEngine on its capture thread while sharing.
+        ScreenShareSource screenShare;
+
+        // Renews the engine's token and prefetches tokens for other channels
+        // while enabled.
+        TokenManager tokens;
+
+        // Asks Dart for the tokens, when the app provides them.
+        std::shared_ptr<CallbackTokenProvider> appTokens;
+
+        // Moves the engine between channels, timing each switch.
+        ChannelSwitcher switcher;
+
+        // Raw audio frames, converted for each tap and extractor.
+        AudioFrameHub audioFrames;
+        // By consumer id, read on the platform thread.
+        std::map<int, std::unique_ptr<AudioTap>> audioTaps;
+        std::map<int, std::unique_ptr<LogMelExtractor>> logMelExtractors;
+        bool audioDraining = false;
+
+        flutter::BinaryMessenger* messenger = nullptr;
+
+        // Safe to call from any thread, events are sent in order on the
+        // platform thread.
         void SendEvent(std::string name, EncodableMap params)
         {
-            params[EncodableValue("event")] = name;
-            messageChannel->Send(params);
+            SendEncodedEvent(agora_rtc_engine::EncodeEventMessage(name, std::move(params)));
+        }
+
+        // Sends an event encoded once for all the windows subscribed to it.
+        void SendEncodedEvent(EventMessage message)
+        {
+            platformTasks.Post([this, message = std::move(message)]() {
+                messenger->Send(kEventChannel, message->data(), message->size());
+            });
         }
     };
 
@@ -115,21 +601,361 @@ namespace {
             plugin_pointer->HandleMethodCall(call, std::move(result));
         });
 
-        plugin->messageChannel = std::make_unique<flutter::BasicMessageChannel<EncodableValue>>(
-            registrar->messenger(),
-            "agora_rtc_engine_message_channel",
-            &flutter::StandardMessageCodec::GetInstance());
+        // Events are encoded with the standard message codec before they
+        // reach the platform thread
+        plugin->messenger = registrar->messenger();
 
         registrar->AddPlugin(std::move(plugin));
     }
 
-    AgoraRtcEnginePlugin::AgoraRtcEnginePlugin() {}
+    AgoraRtcEnginePlugin::AgoraRtcEnginePlugin()
+        : metadata([this](unsigned int uid, int channel, const uint8_t* data, size_t size, int64_t timeStampMs) {
+            SendEvent("onMetadataReceived", EncodableMap{
+                {"uid", (int)uid},
+                {"channel", channel},
+                {"data", std::vector<uint8_t>(data, data + size)},
+                {"timeStampMs", timeStampMs},
+            });
+        }),
+        transcodingLayout([this](const LiveTranscoding& transcoding) {
+            if (agoraRtcEngine != nullptr)
+                agoraRtcEngine->setLiveTranscoding(transcoding);
+        }),
+        mediaRelay(
+            [this](const ChannelMediaRelayConfiguration& configuration, bool update) {
+                if (agoraRtcEngine == nullptr)
+                    return -agora::ERR_NOT_INITIALIZED;
+                return update ? agoraRtcEngine->updateChannelMediaRelay(configuration)
+                              : agoraRtcEngine->startChannelMediaRelay(configuration);
+            },
+            [this]() { return agoraRtcEngine != nullptr ? agoraRtcEngine->stopChannelMediaRelay() : -agora::ERR_NOT_INITIALIZED; },
+            [this](const RelayDestinationInfo& destination) {
+                SendEvent("onChannelMediaRelayDestinationStateChanged", EncodableMap{
+                    {"channelName", destination.channelName},
+                    {"state", (int)destination.state},
+                    {"error", destination.error},
+                    {"retries", destination.retries},
+                });
+            }),
+        devices([this](const std::vector<DeviceChange>& changes) {
+            EncodableList list;
+            for (const auto& change : changes)
+            {
+                list.push_back(EncodableMap{
+                    {"kind", (int)change.kind},
+                    {"type", (int)change.type},
+                    {"device", toMap(change.device)},
+                });
+            }
+            SendEvent("onDevicesChanged", EncodableMap{
+                {"changes", list},
+            });
+        }),
+        encoderTuner(
+            [this](const EncoderLevel& level) {
+                VideoEncoderConfiguration configuration(level.width, level.height,
+                    static_cast<FRAME_RATE>(level.frameRate), level.bitrate, ORIENTATION_MODE_ADAPTIVE);
+                if (agoraRtcEngine != nullptr)
+                    agoraRtcEngine->setVideoEncoderConfiguration(configuration);
+            },
+            [this](const TuningDecision& decision) {
+                SendEvent("onEncoderTuningDecision", EncodableMap{
+                    {"decision", toMap(decision)},
+                });
+            }),
+        preflight(
+            [this](int uplinkKbps, int downlinkKbps) {
+                if (agoraRtcEngine == nullptr)
+                    return false;
+                LastmileProbeConfig config;
+                config.probeUplink = true;
+                config.probeDownlink = true;
+                config.expectedUplinkBitrate = uplinkKbps;
+                config.expectedDownlinkBitrate = downlinkKbps;
+                return agoraRtcEngine->startLastmileProbeTest(config) == 0;
+            },
+            [this](const PreflightPlan& plan) {
+                SendEvent("onNetworkPreflightRefined", EncodableMap{
+                    {"plan", toMap(plan)},
+                });
+            }),
+        effectSoundIdBase((nextEffectSoundIdRange++ % kEffectSoundIdRanges) * kEffectSoundIdRange),
+        effects(
+            [this](int soundId, const std::string& path) {
+                if (agoraRtcEngine == nullptr)
+                    return false;
+                return agoraRtcEngine->preloadEffect(effectSoundIdBase + soundId, path.c_str()) == 0;
+            },
+            [this](int soundId) {
+                if (agoraRtcEngine != nullptr)
+                    agoraRtcEngine->unloadEffect(effectSoundIdBase + soundId);
+            }),
+        eventForwarder(this, [this](EventMessage message) {
+            SendEncodedEvent(std::move(message));
+        }),
+        eventRecorder(&eventForwarder),
+        replayForwarder(&replaySink, [this](EventMessage message) {
+            SendEncodedEvent(std::move(message));
+        }),
+        eventReplayer(&replayForwarder),
+        screenShare([this](const ScreenFrame& frame, int64_t timestampMs) {
+            agora::media::ExternalVideoFrame videoFrame = {};
+            videoFrame.type = agora::media::ExternalVideoFrame::VIDEO_BUFFER_RAW_DATA;
+            videoFrame.format = agora::media::ExternalVideoFrame::VIDEO_PIXEL_BGRA;
+            videoFrame.buffer = const_cast<uint8_t*>(frame.data);
+            // In pixels
+            videoFrame.stride = frame.stride / 4;
+            videoFrame.height = frame.height;
+            videoFrame.timestamp = timestampMs;
+            screenShareEngine->pushVideoFrame(&videoFrame);
+        }),
+        tokens([this](const std::string& token) {
+            platformTasks.Post([this, token]() {
+                if (agoraRtcEngine != nullptr)
+                    agoraRtcEngine->renewToken(token.c_str());
+            });
+        }),
+        switcher(
+            [this](const std::string& token, const std::string& channelId) {
+                return agoraRtcEngine->switchChannel(token.c_str(), channelId.c_str());
+            },
+            [this]() { return agoraRtcEngine->leaveChannel(); },
+            [this](uint64_t id, const std::string& token, const std::string& channelId) {
+                // Rejoins as the same user, from onLeaveChannel
+                platformTasks.Post([this, id, token, channelId]() {
+                    if (agoraRtcEngine == nullptr)
+                        return;
+                    auto error = agoraRtcEngine->joinChannel(token.c_str(), channelId.c_str(), "", localUid);
+                    if (error != 0)
+                        switcher.OnFailed(id, error);
+                });
+            })
+    {
+        // The events sent before subscriptions existed
+        for (auto name : {"onJoinChannelSuccess", "onLeaveChannel", "onUserJoined", "onUserOffline", "onRtcStats", "onRemoteAudioStats"})
+        {
+            eventForwarder.Subscribe(name, true);
+            replayForwarder.Subscribe(name, true);
+        }
+    }
 
     AgoraRtcEnginePlugin::~AgoraRtcEnginePlugin()
     {
-        if (agoraRtcEngine != nullptr)
-            agoraRtcEngine->release();
+        eventReplayer.Stop();
+        switcher.Reset();
+        tokens.Stop();
+        StopScreenShare();
+        effects.Reset();
+        CloseDataTransport();
+        transcodingLayout.Stop();
+        mediaRelay.Reset();
+        devices.Stop();
+        DetachEngine();
+        StopPacketCapture();
+    }
+
+    void AgoraRtcEnginePlugin::RegisterEngineObservers()
+    {
+        agoraRtcEngine->registerMediaMetadataObserver(&metadata, IMetadataObserver::VIDEO_METADATA);
+        UpdatePacketObserver();
+        UpdateAudioFrameObserver();
+    }
+
+    void AgoraRtcEnginePlugin::TakeEngineOwnership(uint64_t attachment)
+    {
+        // Detached since, the broker handed the engine on again
+        if (agoraRtcEngine == nullptr || attachment != engineAttachment || engineOwner)
+            return;
+        engineOwner = true;
+        RegisterEngineObservers();
+    }
+
+    void AgoraRtcEnginePlugin::UnregisterEngineObservers()
+    {
+        if (agoraRtcEngine == nullptr || !engineOwner)
+            return;
+        agoraRtcEngine->registerPacketObserver(nullptr);
+        agoraRtcEngine->registerMediaMetadataObserver(nullptr, IMetadataObserver::VIDEO_METADATA);
+        agora::util::AutoPtr<agora::media::IMediaEngine> mediaEngine;
+        if (mediaEngine.queryInterface(agoraRtcEngine, agora::AGORA_IID_MEDIA_ENGINE))
+            mediaEngine->registerAudioFrameObserver(nullptr);
+    }
+
+    void AgoraRtcEnginePlugin::DetachEngine()
+    {
+        if (agoraRtcEngine == nullptr)
+            return;
+        UnregisterEngineObservers();
+        // Callbacks to this window are over once it returns
+        EngineBroker::Instance().Detach(&eventRecorder);
         agoraRtcEngine = nullptr;
+        engineOwner = false;
+    }
+
+    void AgoraRtcEnginePlugin::UpdateAudioFrameObserver()
+    {
+        if (agoraRtcEngine == nullptr || !engineOwner)
+            return;
+        // 10 ms per callback
+        auto record = audioFrames.Negotiate(AudioFrameSource::Record);
+        if (record.sampleRate > 0)
+            agoraRtcEngine->setRecordingAudioFrameParameters(record.sampleRate, record.channels, RAW_AUDIO_FRAME_OP_MODE_READ_ONLY, record.sampleRate / 100 * record.channels);
+        auto playback = audioFrames.Negotiate(AudioFrameSource::Playback);
+        if (playback.sampleRate > 0)
+            agoraRtcEngine->setPlaybackAudioFrameParameters(playback.sampleRate, playback.channels, RAW_AUDIO_FRAME_OP_MODE_READ_ONLY, playback.sampleRate / 100 * playback.channels);
+        auto mixed = audioFrames.Negotiate(AudioFrameSource::Mixed);
+        if (mixed.sampleRate > 0)
+            agoraRtcEngine->setMixedAudioFrameParameters(mixed.sampleRate, mixed.sampleRate / 100);
+        agora::util::AutoPtr<agora::media::IMediaEngine> mediaEngine;
+        if (mediaEngine.queryInterface(agoraRtcEngine, agora::AGORA_IID_MEDIA_ENGINE))
+            mediaEngine->registerAudioFrameObserver(audioFrames.active() ? &audioFrames : nullptr);
+    }
+
+    void AgoraRtcEnginePlugin::ScheduleAudioDrain()
+    {
+        if (audioDraining)
+            return;
+        audioDraining = true;
+        platformTasks.PostDelayed([this]() { DrainAudioConsumers(); }, kAudioDrainInterval);
+    }
+
+    void AgoraRtcEnginePlugin::DrainAudioConsumers()
+    {
+        if (audioTaps.empty() && logMelExtractors.empty())
+        {
+            audioDraining = false;
+            return;
+        }
+        for (const auto& tap : audioTaps)
+            SendAudioTap(tap.first, *tap.second);
+        for (const auto& extractor : logMelExtractors)
+            SendLogMelFeatures(extractor.first, *extractor.second);
+        platformTasks.PostDelayed([this]() { DrainAudioConsumers(); }, kAudioDrainInterval);
+    }
+
+    void AgoraRtcEnginePlugin::SendAudioTap(int id, AudioTap& tap)
+    {
+        std::vector<int16_t> samples;
+        if (tap.Read(samples) == 0)
+            return;
+        auto bytes = reinterpret_cast<const uint8_t*>(samples.data());
+        SendEvent("onAudioFrame", EncodableMap{
+            {"tapId", id},
+            {"source", static_cast<int>(tap.source())},
+            {"sampleRate", tap.format().sampleRate},
+            {"channels", tap.format().channels},
+            {"data", std::vector<uint8_t>(bytes, bytes + samples.size() * sizeof(int16_t))},
+        });
+    }
+
+    void AgoraRtcEnginePlugin::SendLogMelFeatures(int id, LogMelExtractor& extractor)
+    {
+        std::vector<float> features;
+        uint64_t first = 0;
+        auto frames = extractor.Read(features, first);
+        if (frames == 0)
+            return;
+        auto bytes = reinterpret_cast<const uint8_t*>(features.data());
+        SendEvent("onLogMelFeatures", EncodableMap{
+            {"extractorId", id},
+            {"firstFrame", (int64_t)first},
+            {"frames", (int64_t)frames},
+            {"bins", agora_rtc_engine::kLogMelBins},
+            {"data", std::vector<uint8_t>(bytes, bytes + features.size() * sizeof(float))},
+        });
+    }
+
+    void AgoraRtcEnginePlugin::UpdatePacketObserver()
+    {
+        if (agoraRtcEngine != nullptr && engineOwner)
+            agoraRtcEngine->registerPacketObserver(packetPipeline.active() ? &packetPipeline : nullptr);
+    }
+
+    void AgoraRtcEnginePlugin::StopPacketCapture()
+    {
+        if (packetCapture == nullptr)
+            return;
+        packetPipeline.SetCapture(nullptr);
+        packetCapture->Stop();
+        packetCapture = nullptr;
+    }
+
+    void AgoraRtcEnginePlugin::StopScreenShare()
+    {
+        screenShare.Stop();
+        if (screenShareEngine.get() == nullptr)
+            return;
+        screenShareEngine->setExternalVideoSource(false, false);
+        screenShareEngine.reset();
+    }
+
+    void AgoraRtcEnginePlugin::CloseDataTransport()
+    {
+        std::atomic_store(&dataTransport, std::shared_ptr<DataStreamTransport>());
+    }
+
+    void AgoraRtcEnginePlugin::HandleBatch(
+        const EncodableList& calls,
+        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result)
+    {
+        // Some calls complete later and on other threads, e.g. getDevices
+        // before the first enumeration
+        struct Batch
+        {
+            EncodableList results;
+            std::atomic<size_t> pending;
+            std::unique_ptr<flutter::MethodResult<EncodableValue>> result;
+        };
+        auto batch = std::make_shared<Batch>();
+        batch->results.resize(calls.size());
+        // One more than the calls, so that none can complete the batch while
+        // they are being dispatched
+        batch->pending = calls.size() + 1;
+        batch->result = std::move(result);
+        auto complete = [this, batch](size_t index, EncodableMap outcome) {
+            if (index < batch->results.size())
+                batch->results[index] = std::move(outcome);
+            if (batch->pending.fetch_sub(1) == 1)
+            {
+                platformTasks.Post([batch]() {
+                    batch->result->Success(EncodableValue(std::move(batch->results)));
+                });
+            }
+        };
+
+        for (size_t i = 0; i < calls.size(); ++i)
+        {
+            auto call = std::get<EncodableMap>(calls[i]);
+            auto method = std::get<std::string>(call[EncodableValue("method")]);
+            if ("batch" == method)
+            {
+                complete(i, EncodableMap{
+                    {"errorCode", "INVALID_BATCH"},
+                    {"errorMessage", "Batches cannot be nested"},
+                });
+                continue;
+            }
+            flutter::MethodCall<EncodableValue> methodCall(method, std::make_unique<EncodableValue>(call[EncodableValue("arguments")]));
+            HandleMethodCall(methodCall, std::make_unique<flutter::MethodResultFunctions<EncodableValue>>(
+                [complete, i](const EncodableValue* value) {
+                    complete(i, EncodableMap{
+                        {"value", value ? *value : EncodableValue()},
+                    });
+                },
+                [complete, i](const std::string& code, const std::string& message, const EncodableValue* details) {
+                    complete(i, EncodableMap{
+                        {"errorCode", code},
+                        {"errorMessage", message},
+                        {"errorDetails", details ? *details : EncodableValue()},
+                    });
+                },
+                [complete, i]() {
+                    complete(i, EncodableMap{
+                        {"notImplemented", true},
+                    });
+                }));
+        }
+        complete(calls.size(), EncodableMap());
     }
 
     void AgoraRtcEnginePlugin::HandleMethodCall(
@@ -145,39 +971,133 @@ namespace {
 	        // ignore macOS method
             result->Success(EncodableValue(true));
         }
+        else if ("batch" == methodName)
+        {
+            HandleBatch(std::get<EncodableList>(params[EncodableValue("calls")]), std::move(result));
+        }
         else if ("create" == methodName)
         {
             auto appId = std::get<std::string>(params[EncodableValue("appId")]);
-            agoraRtcEngine = createAgoraRtcEngine();
-            RtcEngineContext ctx;
-            ctx.eventHandler = this;
-            ctx.appId = appId.c_str();
-            agoraRtcEngine->initialize(ctx);
+            if (agoraRtcEngine == nullptr)
+            {
+                // Shared with the app's other windows, created by the first
+                int error;
+                auto attachment = ++engineAttachment;
+                agoraRtcEngine = EngineBroker::Instance().Attach(appId, &eventRecorder, this, [this, attachment]() {
+                    platformTasks.Post([this, attachment]() { TakeEngineOwnership(attachment); });
+                }, engineOwner, error);
+                if (agoraRtcEngine == nullptr)
+                {
+                    result->Error("CREATE_FAILED", "The engine could not be created for this app id, error " + std::to_string(error));
+                    return;
+                }
+                if (engineOwner)
+                    RegisterEngineObservers();
+                devices.Start(agoraRtcEngine);
+            }
             result->Success(nullptr);
         }
         else if ("destroy" == methodName)
         {
-            agoraRtcEngine->release();
-            agoraRtcEngine = nullptr;
+            UnregisterEngineObservers();
+            StopPacketCapture();
+            CloseDataTransport();
+            dataStreamId = -1;
+            transcodingLayout.Stop();
+            transcodingLayout.ClearUsers();
+            mediaRelay.Reset();
+            devices.Stop();
+            encoderTuner.Stop();
+            eventReplayer.Stop();
+            eventRecorder.Stop();
+            switcher.Reset();
+            tokens.Stop();
+            appTokens = nullptr;
+            StopScreenShare();
+            renderPolicy.Reset();
+            snapshots.CancelAll();
+            effects.Reset();
+            metadata.Reset();
+            audioFrames.Clear();
+            audioTaps.clear();
+            logMelExtractors.clear();
+            DetachEngine();
             result->Success(nullptr);
         }
         else if ("setChannelProfile" == methodName)
         {
             auto profile = std::get<int>(params[EncodableValue("profile")]);
             agoraRtcEngine->setChannelProfile(static_cast<CHANNEL_PROFILE_TYPE>(profile));
+            switcher.SetChannelProfile(profile);
             result->Success(nullptr);
         }
+        else if ("setClientRole" == methodName)
+        {
+            auto role = std::get<int>(params[EncodableValue("role")]);
+            auto success = agoraRtcEngine->setClientRole(static_cast<CLIENT_ROLE_TYPE>(role)) == 0;
+            if (success)
+            {
+                switcher.SetClientRole(role);
+                localAudience = role == CLIENT_ROLE_AUDIENCE;
+            }
+            result->Success(EncodableValue(success));
+        }
         else if ("joinChannel" == methodName)
         {
             auto token = params[EncodableValue("token")].IsNull() ? "" : std::get<std::string>(params[EncodableValue("token")]);
             auto channelId = std::get<std::string>(params[EncodableValue("channelId")]);
             auto info = params[EncodableValue("info")].IsNull() ? "" : std::get<std::string>(params[EncodableValue("info")]);
             auto uid = std::get<int>(params[EncodableValue("uid")]);
+            if (token.empty() && tokens.running())
+            {
+                // Joins once the token is there, at once if prefetched
+                std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+                tokens.Acquire(channelId, static_cast<uint32_t>(uid), [this, pending, channelId, info, uid](bool ok, const std::string& token) {
+                    platformTasks.Post([this, pending, channelId, info, uid, ok, token]() {
+                        if (!ok || agoraRtcEngine == nullptr)
+                        {
+                            pending->Error("TOKEN_UNAVAILABLE", "The token provider did not provide a token for " + channelId);
+                            return;
+                        }
+                        tokens.OnJoining(channelId, static_cast<uint32_t>(uid), token);
+                        agoraRtcEngine->joinChannel(token.c_str(), channelId.c_str(), info.c_str(), uid);
+                        pending->Success(EncodableValue(true));
+                    });
+                });
+                return;
+            }
+            tokens.OnJoining(channelId, static_cast<uint32_t>(uid), token);
             agoraRtcEngine->joinChannel(token.c_str(), channelId.c_str(), info.c_str(), uid);
             result->Success(EncodableValue(true));
         }
+        else if ("switchChannel" == methodName)
+        {
+            auto token = params[EncodableValue("token")].IsNull() ? "" : std::get<std::string>(params[EncodableValue("token")]);
+            auto channelId = std::get<std::string>(params[EncodableValue("channelId")]);
+            if (token.empty() && tokens.running())
+            {
+                std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+                tokens.Acquire(channelId, localUid, [this, pending, channelId](bool ok, const std::string& token) {
+                    platformTasks.Post([this, pending, channelId, ok, token]() {
+                        if (!ok || agoraRtcEngine == nullptr)
+                        {
+                            pending->Error("TOKEN_UNAVAILABLE", "The token provider did not provide a token for " + channelId);
+                            return;
+                        }
+                        tokens.OnJoining(channelId, localUid, token);
+                        pending->Success(EncodableValue(agoraRtcEngine->switchChannel(token.c_str(), channelId.c_str()) == 0));
+                    });
+                });
+                return;
+            }
+            tokens.OnJoining(channelId, localUid, token);
+            auto success = agoraRtcEngine->switchChannel(token.c_str(), channelId.c_str()) == 0;
+            result->Success(EncodableValue(success));
+        }
         else if ("leaveChannel" == methodName)
         {
+            switcher.Reset();
+            tokens.OnLeft();
             auto success = agoraRtcEngine->leaveChannel() == 0;
             result->Success(EncodableValue(success));
         }
@@ -193,68 +1113,1235 @@ namespace {
             agoraRtcEngine->muteAllRemoteAudioStreams(muted);
             result->Success(nullptr);
         }
+        else if ("setRenderPolicy" == methodName)
+        {
+            auto uid = (uid_t)params[EncodableValue("uid")].LongValue();
+            RenderPolicy policy;
+            policy.visible = std::get<bool>(params[EncodableValue("visible")]);
+            policy.maxFps = std::get<int>(params[EncodableValue("maxFps")]);
+            policy.maxWidth = std::get<int>(params[EncodableValue("maxWidth")]);
+            policy.maxHeight = std::get<int>(params[EncodableValue("maxHeight")]);
+            renderPolicy.SetPolicy(uid, policy);
+            // Small tiles do not need the high-quality stream at all
+            if (uid != 0 && agoraRtcEngine != nullptr)
+            {
+                auto small = policy.maxWidth > 0 && policy.maxHeight > 0 &&
+                    policy.maxWidth * policy.maxHeight <= kLowStreamMaxArea;
+                agoraRtcEngine->setRemoteVideoStreamType(uid, small ? REMOTE_VIDEO_STREAM_LOW : REMOTE_VIDEO_STREAM_HIGH);
+            }
+            result->Success(nullptr);
+        }
+        else if ("removeRenderPolicy" == methodName)
+        {
+            auto uid = (uid_t)params[EncodableValue("uid")].LongValue();
+            renderPolicy.RemovePolicy(uid);
+            if (uid != 0 && agoraRtcEngine != nullptr)
+                agoraRtcEngine->setRemoteVideoStreamType(uid, REMOTE_VIDEO_STREAM_HIGH);
+            result->Success(nullptr);
+        }
+        else if ("getRenderPolicyStats" == methodName)
+        {
+            auto stats = renderPolicy.GetStats();
+            EncodableList users;
+            for (const auto& counters : stats.users)
+                users.push_back(toMap(counters));
+            result->Success(EncodableValue(EncodableMap{
+                {"users", users},
+                {"total", toMap(stats.total)},
+            }));
+        }
+        else if ("takeSnapshot" == methodName)
+        {
+            auto uid = (uid_t)params[EncodableValue("uid")].LongValue();
+            auto maxSize = std::get<int>(params[EncodableValue("maxSize")]);
+            auto format = static_cast<ImageFormat>(std::get<int>(params[EncodableValue("format")]));
+            std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+            snapshots.Request(uid, maxSize, format, [this, pending, uid](SnapshotStatus status, std::vector<uint8_t> encoded) {
+                platformTasks.Post([pending, uid, status, encoded = std::move(encoded)]() {
+                    switch (status)
+                    {
+                    case SnapshotStatus::Captured:
+                        pending->Success(EncodableValue(encoded));
+                        break;
+                    case SnapshotStatus::TimedOut:
+                        pending->Error("SNAPSHOT_TIMEOUT", "No frame of uid " + std::to_string(uid) + " arrived in time");
+                        break;
+                    case SnapshotStatus::Cancelled:
+                        pending->Error("SNAPSHOT_CANCELLED", "The user went offline or the engine was destroyed");
+                        break;
+                    default:
+                        pending->Error("SNAPSHOT_FAILED", "The frame could not be encoded");
+                        break;
+                    }
+                });
+            });
+            // Fails the request even if |uid| never sends a frame
+            platformTasks.PostDelayed([this]() {
+                snapshots.Expire(VideoSnapshotService::Clock::now());
+            }, agora_rtc_engine::kSnapshotTimeout);
+        }
+        else if ("getSnapshotStats" == methodName)
+        {
+            auto stats = snapshots.GetStats();
+            result->Success(EncodableValue(EncodableMap{
+                {"requested", (int64_t)stats.requested},
+                {"coalesced", (int64_t)stats.coalesced},
+                {"captured", (int64_t)stats.captured},
+                {"encoded", (int64_t)stats.encoded},
+                {"failed", (int64_t)stats.failed},
+                {"averageEncodeMicros", stats.averageEncodeMicros},
+            }));
+        }
+        else if ("setPacketEncryption" == methodName)
+        {
+            if (agoraRtcEngine != nullptr && !engineOwner)
+            {
+                result->Error("NOT_ENGINE_OWNER", "Packets are observed by the window owning the engine");
+                return;
+            }
+            auto mode = static_cast<PacketCipherMode>(std::get<int>(params[EncodableValue("cipher")]));
+            if (mode == PacketCipherMode::None)
+            {
+                packetPipeline.SetTransform(nullptr);
+            }
+            else
+            {
+                auto key = std::get<std::vector<uint8_t>>(params[EncodableValue("key")]);
+                auto cipher = AesPacketCipher::Create(mode, key.data(), key.size());
+                if (cipher == nullptr)
+                {
+                    result->Error("INVALID_KEY", "The key must be 16, 24 or 32 bytes long");
+                    return;
+                }
+                packetPipeline.SetTransform(std::move(cipher));
+            }
+            UpdatePacketObserver();
+            result->Success(nullptr);
+        }
+        else if ("getPacketStats" == methodName)
+        {
+            PacketDirectionStats stats[agora_rtc_engine::kPacketDirectionCount];
+            packetPipeline.GetStats(stats);
+            result->Success(EncodableValue(EncodableMap{
+                {"sendAudio", toMap(stats[0])},
+                {"sendVideo", toMap(stats[1])},
+                {"receiveAudio", toMap(stats[2])},
+                {"receiveVideo", toMap(stats[3])},
+            }));
+        }
+        else if ("startPacketCapture" == methodName)
+        {
+            if (agoraRtcEngine != nullptr && !engineOwner)
+            {
+                result->Error("NOT_ENGINE_OWNER", "Packets are observed by the window owning the engine");
+                return;
+            }
+            StopPacketCapture();
+            PacketCaptureOptions options;
+            options.path = std::get<std::string>(params[EncodableValue("path")]);
+            options.snapLength = (size_t)std::get<int>(params[EncodableValue("snapLength")]);
+            options.maxFileSize = (uint64_t)params[EncodableValue("maxFileSize")].LongValue();
+            options.maxFiles = std::get<int>(params[EncodableValue("maxFiles")]);
+            auto capture = std::make_shared<PacketCapture>(options);
+            if (!capture->Start())
+            {
+                result->Error("CAPTURE_FAILED", "Could not open " + options.path);
+                return;
+            }
+            packetCapture = capture;
+            packetPipeline.SetCapture(capture);
+            UpdatePacketObserver();
+            result->Success(nullptr);
+        }
+        else if ("stopPacketCapture" == methodName)
+        {
+            StopPacketCapture();
+            UpdatePacketObserver();
+            result->Success(nullptr);
+        }
+        else if ("getPacketCaptureStats" == methodName)
+        {
+            auto stats = packetCapture != nullptr ? packetCapture->GetStats() : agora_rtc_engine::PacketCaptureStats();
+            result->Success(EncodableValue(EncodableMap{
+                {"captured", (int64_t)stats.captured},
+                {"dropped", (int64_t)stats.dropped},
+                {"bytesWritten", (int64_t)stats.bytesWritten},
+                {"files", stats.files},
+            }));
+        }
+        else if ("openDataTransport" == methodName)
+        {
+            if (agoraRtcEngine == nullptr)
+            {
+                result->Error("NOT_CREATED", "create has not been called");
+                return;
+            }
+            CloseDataTransport();
+            if (dataStreamId < 0)
+            {
+                auto ret = agoraRtcEngine->createDataStream(&dataStreamId, true, true);
+                if (ret < 0)
+                {
+                    dataStreamId = -1;
+                    result->Error("CREATE_DATA_STREAM_FAILED", "createDataStream returned " + std::to_string(ret));
+                    return;
+                }
+            }
+            DataTransportOptions options;
+            options.compress = std::get<bool>(params[EncodableValue("compress")]);
+            options.packetsPerSecond = std::get<double>(params[EncodableValue("packetsPerSecond")]);
+            options.bytesPerSecond = std::get<double>(params[EncodableValue("bytesPerSecond")]);
+            auto engine = agoraRtcEngine;
+            auto streamId = dataStreamId;
+            auto transport = std::make_shared<DataStreamTransport>(
+                options,
+                [engine, streamId](const uint8_t* data, size_t size) {
+                    return engine->sendStreamMessage(streamId, (const char*)data, size) == 0;
+                },
+                [this](unsigned int uid, std::vector<uint8_t> message) {
+                    SendEvent("onDataTransportMessage", EncodableMap{
+                        {"uid", (int)uid},
+                        {"data", std::move(message)},
+                    });
+                });
+            std::atomic_store(&dataTransport, transport);
+            result->Success(nullptr);
+        }
+        else if ("closeDataTransport" == methodName)
+        {
+            CloseDataTransport();
+            result->Success(nullptr);
+        }
+        else if ("sendData" == methodName)
+        {
+            auto data = std::get<std::vector<uint8_t>>(params[EncodableValue("data")]);
+            auto transport = std::atomic_load(&dataTransport);
+            if (transport == nullptr)
+            {
+                result->Error("NOT_OPEN", "openDataTransport has not been called");
+                return;
+            }
+            result->Success(EncodableValue(transport->Send(std::move(data))));
+        }
+        else if ("getDataTransportStats" == methodName)
+        {
+            auto transport = std::atomic_load(&dataTransport);
+            auto stats = transport != nullptr ? transport->GetStats() : agora_rtc_engine::DataTransportStats();
+            result->Success(EncodableValue(EncodableMap{
+                {"queuedMessages", (int64_t)stats.queuedMessages},
+                {"queuedBytes", (int64_t)stats.queuedBytes},
+                {"sentMessages", (int64_t)stats.sentMessages},
+                {"sentPackets", (int64_t)stats.sentPackets},
+                {"sentBytes", (int64_t)stats.sentBytes},
+                {"payloadBytes", (int64_t)stats.payloadBytes},
+                {"rejectedMessages", (int64_t)stats.rejectedMessages},
+                {"failedPackets", (int64_t)stats.failedPackets},
+                {"receivedMessages", (int64_t)stats.receivedMessages},
+                {"receivedBytes", (int64_t)stats.receivedBytes},
+                {"droppedMessages", (int64_t)stats.droppedMessages},
+                {"throughput", stats.throughput},
+            }));
+        }
+        else if ("setMetadataChannel" == methodName)
+        {
+            auto channel = std::get<int>(params[EncodableValue("channel")]);
+            MetadataChannelOptions options;
+            options.priority = std::get<int>(params[EncodableValue("priority")]);
+            options.queueLength = std::get<int>(params[EncodableValue("queueLength")]);
+            options.latestOnly = std::get<bool>(params[EncodableValue("latestOnly")]);
+            if (!metadata.SetChannel(channel, options))
+            {
+                result->Error("INVALID_CHANNEL", "Channel or queue length out of range");
+                return;
+            }
+            result->Success(nullptr);
+        }
+        else if ("removeMetadataChannel" == methodName)
+        {
+            auto channel = std::get<int>(params[EncodableValue("channel")]);
+            metadata.RemoveChannel(channel);
+            result->Success(nullptr);
+        }
+        else if ("sendMetadata" == methodName)
+        {
+            auto channel = std::get<int>(params[EncodableValue("channel")]);
+            const auto& data = std::get<std::vector<uint8_t>>(params[EncodableValue("data")]);
+            result->Success(EncodableValue(metadata.Send(channel, data.data(), data.size())));
+        }
+        else if ("getMetadataStats" == methodName)
+        {
+            auto stats = metadata.GetStats();
+            EncodableList channels;
+            for (const auto& channel : stats.channels)
+            {
+                channels.push_back(EncodableMap{
+                    {"channel", channel.channel},
+                    {"queued", (int64_t)channel.queued},
+                    {"sent", (int64_t)channel.sent},
+                    {"dropped", (int64_t)channel.dropped},
+                    {"rejected", (int64_t)channel.rejected},
+                    {"received", (int64_t)channel.received},
+                });
+            }
+            result->Success(EncodableValue(EncodableMap{
+                {"channels", channels},
+                {"slots", (int64_t)stats.slots},
+                {"usedSlots", (int64_t)stats.usedSlots},
+                {"packedBytes", (int64_t)stats.packedBytes},
+                {"fillRate", stats.fillRate},
+                {"malformed", (int64_t)stats.malformed},
+            }));
+        }
+        else if ("setTranscodingLayout" == methodName)
+        {
+            TranscodingLayoutOptions options;
+            options.layout = static_cast<LayoutTemplate>(std::get<int>(params[EncodableValue("layout")]));
+            options.width = std::get<int>(params[EncodableValue("width")]);
+            options.height = std::get<int>(params[EncodableValue("height")]);
+            options.videoBitrate = std::get<int>(params[EncodableValue("videoBitrate")]);
+            options.videoFramerate = std::get<int>(params[EncodableValue("videoFramerate")]);
+            options.backgroundColor = (unsigned int)params[EncodableValue("backgroundColor")].LongValue();
+            options.debounceMs = std::get<int>(params[EncodableValue("debounceMs")]);
+            transcodingLayout.Start(options);
+            result->Success(nullptr);
+        }
+        else if ("setTranscodingSpeaker" == methodName)
+        {
+            auto uid = (uid_t)params[EncodableValue("uid")].LongValue();
+            transcodingLayout.SetSpeaker(uid);
+            result->Success(nullptr);
+        }
+        else if ("stopTranscodingLayout" == methodName)
+        {
+            transcodingLayout.Stop();
+            result->Success(nullptr);
+        }
+        else if ("getTranscodingLayoutStats" == methodName)
+        {
+            auto stats = transcodingLayout.GetStats();
+            result->Success(EncodableValue(EncodableMap{
+                {"users", stats.users},
+                {"changes", (int64_t)stats.changes},
+                {"layouts", (int64_t)stats.layouts},
+                {"applied", (int64_t)stats.applied},
+                {"unchanged", (int64_t)stats.unchanged},
+                {"averageLayoutNanos", stats.averageLayoutNanos},
+            }));
+        }
+        else if ("setChannelMediaRelaySource" == methodName)
+        {
+            auto token = params[EncodableValue("token")].IsNull() ? std::string() : std::get<std::string>(params[EncodableValue("token")]);
+            auto uid = (uid_t)params[EncodableValue("uid")].LongValue();
+            mediaRelay.SetSource(token, uid);
+            result->Success(nullptr);
+        }
+        else if ("setChannelMediaRelayDestination" == methodName)
+        {
+            auto channelName = std::get<std::string>(params[EncodableValue("channelName")]);
+            auto token = params[EncodableValue("token")].IsNull() ? std::string() : std::get<std::string>(params[EncodableValue("token")]);
+            auto uid = (uid_t)params[EncodableValue("uid")].LongValue();
+            if (!mediaRelay.SetDestination(channelName, token, uid))
+            {
+                result->Error("TOO_MANY_DESTINATIONS", "At most 4 destination channels are supported");
+                return;
+            }
+            result->Success(nullptr);
+        }
+        else if ("removeChannelMediaRelayDestination" == methodName)
+        {
+            auto channelName = std::get<std::string>(params[EncodableValue("channelName")]);
+            mediaRelay.RemoveDestination(channelName);
+            result->Success(nullptr);
+        }
+        else if ("removeAllChannelMediaRelayDestinations" == methodName)
+        {
+            mediaRelay.RemoveAllDestinations();
+            result->Success(nullptr);
+        }
+        else if ("getChannelMediaRelayStats" == methodName)
+        {
+            auto stats = mediaRelay.GetStats();
+            EncodableList destinations;
+            for (const auto& destination : stats.destinations)
+            {
+                destinations.push_back(EncodableMap{
+                    {"channelName", destination.channelName},
+                    {"state", (int)destination.state},
+                    {"error", destination.error},
+                    {"retries", destination.retries},
+                });
+            }
+            result->Success(EncodableValue(EncodableMap{
+                {"destinations", destinations},
+                {"changes", (int64_t)stats.changes},
+                {"starts", (int64_t)stats.starts},
+                {"updates", (int64_t)stats.updates},
+                {"stops", (int64_t)stats.stops},
+                {"retries", (int64_t)stats.retries},
+            }));
+        }
+        else if ("getDevices" == methodName)
+        {
+            auto kind = static_cast<DeviceKind>(std::get<int>(params[EncodableValue("kind")]));
+            std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+            devices.GetDevices(kind, [this, pending](const std::vector<DeviceInfo>& list) {
+                EncodableList maps;
+                for (const auto& device : list)
+                    maps.push_back(toMap(device));
+                platformTasks.Post([pending, maps = std::move(maps)]() {
+                    pending->Success(EncodableValue(maps));
+                });
+            });
+        }
+        else if ("refreshDevices" == methodName)
+        {
+            devices.RefreshAll();
+            result->Success(nullptr);
+        }
+        else if ("enableEncoderAutoTuning" == methodName)
+        {
+            EncoderTunerOptions options;
+            if (!params[EncodableValue("levels")].IsNull())
+            {
+                for (auto& value : std::get<EncodableList>(params[EncodableValue("levels")]))
+                {
+                    auto map = std::get<EncodableMap>(value);
+                    EncoderLevel level;
+                    level.width = std::get<int>(map[EncodableValue("width")]);
+                    level.height = std::get<int>(map[EncodableValue("height")]);
+                    level.frameRate = std::get<int>(map[EncodableValue("frameRate")]);
+                    level.bitrate = std::get<int>(map[EncodableValue("bitrate")]);
+                    options.levels.push_back(level);
+                }
+            }
+            options.startLevel = std::get<int>(params[EncodableValue("startLevel")]);
+            options.cpuHigh = std::get<double>(params[EncodableValue("cpuHigh")]);
+            options.cpuLow = std::get<double>(params[EncodableValue("cpuLow")]);
+            options.downSamples = std::get<int>(params[EncodableValue("downSamples")]);
+            options.upSamples = std::get<int>(params[EncodableValue("upSamples")]);
+            options.minIntervalMs = std::get<int>(params[EncodableValue("minIntervalMs")]);
+            options.upHoldMs = std::get<int>(params[EncodableValue("upHoldMs")]);
+            if (!encoderTuner.Start(options, EncoderTuner::Clock::now()))
+            {
+                result->Error("INVALID_OPTIONS", "Invalid start level or thresholds");
+                return;
+            }
+            result->Success(nullptr);
+        }
+        else if ("disableEncoderAutoTuning" == methodName)
+        {
+            encoderTuner.Stop();
+            result->Success(nullptr);
+        }
+        else if ("getEncoderTuningLog" == methodName)
+        {
+            EncodableList decisions;
+            for (const auto& decision : encoderTuner.GetDecisions())
+                decisions.push_back(toMap(decision));
+            result->Success(EncodableValue(decisions));
+        }
+        else if ("startEventRecording" == methodName)
+        {
+            auto path = std::get<std::string>(params[EncodableValue("path")]);
+            if (!eventRecorder.Start(path))
+            {
+                result->Error("RECORDING_FAILED", "Could not open " + path);
+                return;
+            }
+            result->Success(nullptr);
+        }
+        else if ("stopEventRecording" == methodName)
+        {
+            result->Success(EncodableValue(toMap(eventRecorder.Stop())));
+        }
+        else if ("replayEventTrace" == methodName)
+        {
+            auto path = std::get<std::string>(params[EncodableValue("path")]);
+            auto speed = std::get<double>(params[EncodableValue("speed")]);
+            std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+            auto started = eventReplayer.Start(path, speed, [this, pending](bool ok, const EventReplayStats& stats) {
+                platformTasks.Post([pending, ok, stats]() {
+                    if (ok)
+                        pending->Success(EncodableValue(toMap(stats)));
+                    else
+                        pending->Error("REPLAY_FAILED", "The trace is truncated or corrupt");
+                });
+            });
+            if (!started)
+                pending->Error("REPLAY_FAILED", "A replay is running or " + path + " is not an event trace");
+        }
+        else if ("stopEventReplay" == methodName)
+        {
+            eventReplayer.Stop();
+            result->Success(nullptr);
+        }
+        else if ("subscribeEvents" == methodName || "unsubscribeEvents" == methodName)
+        {
+            auto subscribe = "subscribeEvents" == methodName;
+            for (auto& value : std::get<EncodableList>(params[EncodableValue("events")]))
+            {
+                auto name = std::get<std::string>(value);
+                if (!eventForwarder.Subscribe(name, subscribe))
+                {
+                    result->Error("UNKNOWN_EVENT", name + " is not an engine event");
+                    return;
+                }
+                replayForwarder.Subscribe(name, subscribe);
+            }
+            result->Success(nullptr);
+        }
+        else if ("getEventCounters" == methodName)
+        {
+            EncodableMap counters;
+            for (const auto& event : eventForwarder.GetCounters())
+            {
+                counters[EncodableValue(event.name)] = EncodableMap{
+                    {"received", (int64_t)event.received},
+                    {"forwarded", (int64_t)event.forwarded},
+                };
+            }
+            result->Success(EncodableValue(counters));
+        }
+        else if ("getEngineBrokerStats" == methodName)
+        {
+            auto stats = EngineBroker::Instance().GetStats();
+            result->Success(EncodableValue(EncodableMap{
+                {"clients", stats.clients},
+                {"callbacks", (int64_t)stats.callbacks},
+                {"encodings", (int64_t)stats.encodings},
+                {"sharedEncodings", (int64_t)stats.sharedEncodings},
+                {"engineOwner", engineOwner},
+            }));
+        }
+        else if ("benchmarkStatsEncoding" == methodName)
+        {
+            auto iterations = std::get<int>(params[EncodableValue("iterations")]);
+            // Takes a while, run off the platform thread
+            std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+            benchmarks.Post([this, pending, iterations]() {
+                auto benchmark = agora_rtc_engine::BenchmarkStatsEncoding(iterations);
+                platformTasks.Post([pending, benchmark]() {
+                    pending->Success(EncodableValue(EncodableMap{
+                        {"iterations", benchmark.iterations},
+                        {"handwrittenNanos", benchmark.handwrittenNanos},
+                        {"generatedNanos", benchmark.generatedNanos},
+                        {"inPlaceNanos", benchmark.inPlaceNanos},
+                    }));
+                });
+            });
+        }
+        else if ("benchmarkPlatformTaskRunner" == methodName)
+        {
+            // Posts |tasks| tasks spread over |threads| threads, completing
+            // once the last one has run on the platform thread.
+            struct Benchmark
+            {
+                std::chrono::steady_clock::time_point start;
+                int remaining;
+                uint64_t wakeups;
+                std::unique_ptr<flutter::MethodResult<EncodableValue>> result;
+            };
+            auto tasks = std::get<int>(params[EncodableValue("tasks")]);
+            auto threads = std::get<int>(params[EncodableValue("threads")]);
+            if (tasks < threads || threads < 1)
+            {
+                result->Error("INVALID_ARGUMENTS", "At least one task per thread is needed");
+                return;
+            }
+            auto benchmark = std::make_shared<Benchmark>();
+            benchmark->remaining = tasks;
+            benchmark->wakeups = platformTasks.GetStats().wakeups;
+            benchmark->result = std::move(result);
+            benchmark->start = std::chrono::steady_clock::now();
+            auto task = [this, benchmark, tasks, threads]() {
+                if (--benchmark->remaining > 0)
+                    return;
+                auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - benchmark->start).count();
+                benchmark->result->Success(EncodableValue(EncodableMap{
+                    {"tasks", tasks},
+                    {"threads", threads},
+                    {"durationNanos", (int64_t)nanos},
+                    {"tasksPerSecond", nanos > 0 ? tasks * 1e9 / static_cast<double>(nanos) : 0.0},
+                    {"wakeups", (int64_t)(platformTasks.GetStats().wakeups - benchmark->wakeups)},
+                }));
+            };
+            benchmarks.Post([this, task, tasks, threads]() {
+                std::vector<std::thread> posters;
+                for (int i = 0; i < threads; ++i)
+                {
+                    auto count = tasks / threads + (i < tasks % threads ? 1 : 0);
+                    posters.emplace_back([this, task, count]() {
+                        for (int j = 0; j < count; ++j)
+                            platformTasks.Post(task);
+                    });
+                }
+                for (auto& poster : posters)
+                    poster.join();
+            });
+        }
+        else if ("benchmarkQueues" == methodName)
+        {
+            auto items = params[EncodableValue("items")].LongValue();
+            auto producers = std::get<int>(params[EncodableValue("producers")]);
+            if (items < 1 || producers < 1)
+            {
+                result->Error("INVALID_ARGUMENTS", "At least one item and one producer are needed");
+                return;
+            }
+            // Takes a while, run off the platform thread
+            std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+            benchmarks.Post([this, pending, items, producers]() {
+                auto benchmark = agora_rtc_engine::BenchmarkQueues(static_cast<uint64_t>(items), producers);
+                platformTasks.Post([pending, benchmark]() {
+                    pending->Success(EncodableValue(EncodableMap{
+                        {"items", (int64_t)benchmark.items},
+                        {"producers", benchmark.producers},
+                        {"spscNanos", benchmark.spscNanos},
+                        {"spscBatchNanos", benchmark.spscBatchNanos},
+                        {"mpscNanos", benchmark.mpscNanos},
+                        {"mutexNanos", benchmark.mutexNanos},
+                    }));
+                });
+            });
+        }
+        else if ("startAudioTap" == methodName)
+        {
+            auto source = std::get<int>(params[EncodableValue("source")]);
+            AudioFormat format;
+            format.sampleRate = std::get<int>(params[EncodableValue("sampleRate")]);
+            format.channels = std::get<int>(params[EncodableValue("channels")]);
+            if (source < 0 || source >= agora_rtc_engine::kAudioFrameSourceCount
+                || format.sampleRate < 8000 || format.sampleRate > 48000 || format.channels < 1 || format.channels > 2)
+            {
+                result->Error("INVALID_ARGUMENTS", "Rates from 8000 to 48000 Hz and 1 or 2 channels are supported");
+                return;
+            }
+            if (agoraRtcEngine != nullptr && !engineOwner)
+            {
+                result->Error("NOT_ENGINE_OWNER", "Audio frames are observed by the window owning the engine");
+                return;
+            }
+            auto tap = std::make_unique<AudioTap>(static_cast<AudioFrameSource>(source), format, kAudioTapChunks);
+            auto writer = tap.get();
+            auto id = audioFrames.AddConsumer(static_cast<AudioFrameSource>(source), format, [writer](const AudioFrameView& frame) {
+                writer->Write(frame);
+            });
+            audioTaps[id] = std::move(tap);
+            UpdateAudioFrameObserver();
+            ScheduleAudioDrain();
+            result->Success(EncodableValue(id));
+        }
+        else if ("stopAudioTap" == methodName)
+        {
+            auto id = std::get<int>(params[EncodableValue("tapId")]);
+            auto tap = audioTaps.find(id);
+            if (tap != audioTaps.end())
+            {
+                audioFrames.RemoveConsumer(id);
+                // What it read since the last drain
+                SendAudioTap(id, *tap->second);
+                audioTaps.erase(tap);
+                UpdateAudioFrameObserver();
+            }
+            result->Success(nullptr);
+        }
+        else if ("startLogMelFeatures" == methodName)
+        {
+            auto source = std::get<int>(params[EncodableValue("source")]);
+            if (source < 0 || source >= agora_rtc_engine::kAudioFrameSourceCount)
+            {
+                result->Error("INVALID_ARGUMENTS", "Unknown audio frame source");
+                return;
+            }
+            if (agoraRtcEngine != nullptr && !engineOwner)
+            {
+                result->Error("NOT_ENGINE_OWNER", "Audio frames are observed by the window owning the engine");
+                return;
+            }
+            auto extractor = std::make_unique<LogMelExtractor>(static_cast<AudioFrameSource>(source), kLogMelFrames);
+            auto writer = extractor.get();
+            AudioFormat format;
+            format.sampleRate = agora_rtc_engine::kLogMelSampleRate;
+            format.channels = 1;
+            auto id = audioFrames.AddConsumer(static_cast<AudioFrameSource>(source), format, [writer](const AudioFrameView& frame) {
+                writer->Write(frame);
+            });
+            logMelExtractors[id] = std::move(extractor);
+            UpdateAudioFrameObserver();
+            ScheduleAudioDrain();
+            result->Success(EncodableValue(id));
+        }
+        else if ("stopLogMelFeatures" == methodName)
+        {
+            auto id = std::get<int>(params[EncodableValue("extractorId")]);
+            auto extractor = logMelExtractors.find(id);
+            if (extractor != logMelExtractors.end())
+            {
+                audioFrames.RemoveConsumer(id);
+                // What it extracted since the last drain
+                SendLogMelFeatures(id, *extractor->second);
+                logMelExtractors.erase(extractor);
+                UpdateAudioFrameObserver();
+            }
+            result->Success(nullptr);
+        }
+        else if ("getLogMelStats" == methodName)
+        {
+            EncodableMap extractors;
+            for (const auto& extractor : logMelExtractors)
+            {
+                auto stats = extractor.second->GetStats();
+                extractors[EncodableValue(extractor.first)] = EncodableMap{
+                    {"frames", (int64_t)stats.frames},
+                    {"dropped", (int64_t)stats.dropped},
+                    {"realTimeFactor", stats.realTimeFactor},
+                };
+            }
+            result->Success(EncodableValue(extractors));
+        }
+        else if ("benchmarkLogMel" == methodName)
+        {
+            auto seconds = std::get<int>(params[EncodableValue("seconds")]);
+            if (seconds < 1)
+            {
+                result->Error("INVALID_ARGUMENTS", "At least one second of audio is needed");
+                return;
+            }
+            // Takes a while, and measures the single core of the benchmark
+            // worker, not shared with another benchmark
+            std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+            benchmarks.Post([this, pending, seconds]() {
+                auto benchmark = agora_rtc_engine::BenchmarkLogMel(seconds);
+                platformTasks.Post([pending, benchmark]() {
+                    pending->Success(EncodableValue(EncodableMap{
+                        {"audioSeconds", benchmark.audioSeconds},
+                        {"frames", (int64_t)benchmark.frames},
+                        {"nanosPerFrame", benchmark.nanosPerFrame},
+                        {"realTimeFactor", benchmark.realTimeFactor},
+                    }));
+                });
+            });
+        }
+        else if ("getAudioFrameStats" == methodName)
+        {
+            auto stats = audioFrames.GetStats();
+            EncodableMap taps;
+            for (const auto& tap : audioTaps)
+            {
+                auto tapStats = tap.second->GetStats();
+                taps[EncodableValue(tap.first)] = EncodableMap{
+                    {"frames", (int64_t)tapStats.frames},
+                    {"dropped", (int64_t)tapStats.dropped},
+                };
+            }
+            result->Success(EncodableValue(EncodableMap{
+                {"frames", (int64_t)stats.frames},
+                {"passedThrough", (int64_t)stats.passedThrough},
+                {"converted", (int64_t)stats.converted},
+                {"skipped", (int64_t)stats.skipped},
+                {"taps", taps},
+            }));
+        }
+        else if ("configureEffectCache" == methodName)
+        {
+            AudioEffectCacheOptions options;
+            options.memoryBudget = params[EncodableValue("memoryBudget")].LongValue();
+            options.policy = static_cast<EffectEvictionPolicy>(std::get<int>(params[EncodableValue("policy")]));
+            options.predict = std::get<bool>(params[EncodableValue("predict")]);
+            effects.Configure(options);
+            result->Success(nullptr);
+        }
+        else if ("registerEffect" == methodName)
+        {
+            auto soundId = std::get<int>(params[EncodableValue("soundId")]);
+            auto filePath = std::get<std::string>(params[EncodableValue("filePath")]);
+            auto bytes = params[EncodableValue("bytes")].LongValue();
+            if (soundId < 0 || soundId >= kEffectSoundIdRange)
+            {
+                result->Error("INVALID_ARGUMENT", "soundId must be from 0 to " + std::to_string(kEffectSoundIdRange - 1));
+                return;
+            }
+            if (!effects.Register(soundId, filePath, bytes))
+            {
+                result->Error("FILE_NOT_FOUND", "Could not read " + filePath);
+                return;
+            }
+            result->Success(nullptr);
+        }
+        else if ("unregisterEffect" == methodName)
+        {
+            effects.Unregister(std::get<int>(params[EncodableValue("soundId")]));
+            result->Success(nullptr);
+        }
+        else if ("prefetchEffects" == methodName)
+        {
+            std::vector<int> soundIds;
+            for (auto& value : std::get<EncodableList>(params[EncodableValue("soundIds")]))
+                soundIds.push_back(std::get<int>(value));
+            effects.Prefetch(soundIds);
+            result->Success(nullptr);
+        }
+        else if ("playEffect" == methodName)
+        {
+            if (agoraRtcEngine == nullptr)
+            {
+                result->Error("NOT_CREATED", "create has not been called");
+                return;
+            }
+            auto soundId = std::get<int>(params[EncodableValue("soundId")]);
+            auto loopCount = std::get<int>(params[EncodableValue("loopCount")]);
+            auto pitch = std::get<double>(params[EncodableValue("pitch")]);
+            auto pan = std::get<double>(params[EncodableValue("pan")]);
+            auto gain = std::get<int>(params[EncodableValue("gain")]);
+            auto publish = std::get<bool>(params[EncodableValue("publish")]);
+            int error = 0;
+            auto played = effects.Play(soundId, [&](const std::string& path) {
+                return agoraRtcEngine->playEffect(effectSoundIdBase + soundId, path.c_str(), loopCount, pitch, pan, gain, publish);
+            }, error);
+            if (!played)
+            {
+                result->Error("UNKNOWN_EFFECT", "Effect " + std::to_string(soundId) + " is not registered");
+                return;
+            }
+            result->Success(EncodableValue(error));
+        }
+        else if ("stopEffect" == methodName)
+        {
+            if (agoraRtcEngine == nullptr)
+            {
+                result->Error("NOT_CREATED", "create has not been called");
+                return;
+            }
+            auto soundId = std::get<int>(params[EncodableValue("soundId")]);
+            agoraRtcEngine->stopEffect(effectSoundIdBase + soundId);
+            effects.OnFinished(soundId);
+            result->Success(nullptr);
+        }
+        else if ("stopAllEffects" == methodName)
+        {
+            if (agoraRtcEngine == nullptr)
+            {
+                result->Error("NOT_CREATED", "create has not been called");
+                return;
+            }
+            agoraRtcEngine->stopAllEffects();
+            effects.OnAllFinished();
+            result->Success(nullptr);
+        }
+        else if ("getEffectCacheStats" == methodName)
+        {
+            result->Success(EncodableValue(toMap(effects.GetStats())));
+        }
+        else if ("runNetworkPreflight" == methodName)
+        {
+            PreflightOptions options;
+            if (!params[EncodableValue("levels")].IsNull())
+            {
+                for (auto& value : std::get<EncodableList>(params[EncodableValue("levels")]))
+                {
+                    auto map = std::get<EncodableMap>(value);
+                    EncoderLevel level;
+                    level.width = std::get<int>(map[EncodableValue("width")]);
+                    level.height = std::get<int>(map[EncodableValue("height")]);
+                    level.frameRate = std::get<int>(map[EncodableValue("frameRate")]);
+                    level.bitrate = std::get<int>(map[EncodableValue("bitrate")]);
+                    options.levels.push_back(level);
+                }
+            }
+            options.networkId = std::get<std::string>(params[EncodableValue("networkId")]);
+            options.cacheTtlMs = std::get<int>(params[EncodableValue("cacheTtlMs")]);
+            options.forceProbe = std::get<bool>(params[EncodableValue("forceProbe")]);
+            options.timeoutMs = std::get<int>(params[EncodableValue("timeoutMs")]);
+            options.headroom = std::get<double>(params[EncodableValue("headroom")]);
+            auto apply = std::get<bool>(params[EncodableValue("apply")]);
+            std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+            auto probe = preflight.Run(options, NetworkPreflight::Clock::now(), [this, pending, apply](const PreflightPlan& plan) {
+                // Completed on the SDK thread by the quality report
+                platformTasks.Post([this, pending, apply, plan]() {
+                    if (apply && agoraRtcEngine != nullptr)
+                    {
+                        VideoEncoderConfiguration configuration(plan.video.width, plan.video.height,
+                            static_cast<FRAME_RATE>(plan.video.frameRate), plan.video.bitrate, ORIENTATION_MODE_ADAPTIVE);
+                        agoraRtcEngine->setVideoEncoderConfiguration(configuration);
+                        agoraRtcEngine->setAudioProfile(static_cast<AUDIO_PROFILE_TYPE>(plan.audioProfile), AUDIO_SCENARIO_DEFAULT);
+                    }
+                    pending->Success(EncodableValue(toMap(plan)));
+                });
+            });
+            if (probe != 0)
+            {
+                platformTasks.PostDelayed([this, probe]() {
+                    if (preflight.OnTimeout(probe, NetworkPreflight::Clock::now()) && agoraRtcEngine != nullptr)
+                        agoraRtcEngine->stopLastmileProbeTest();
+                }, std::chrono::milliseconds(options.timeoutMs));
+            }
+        }
+        else if ("getNetworkPreflightStats" == methodName)
+        {
+            result->Success(EncodableValue(toMap(preflight.GetStats())));
+        }
+        else if ("clearNetworkPreflightCache" == methodName)
+        {
+            preflight.ClearCache();
+            result->Success(nullptr);
+        }
+        else if ("switchToChannel" == methodName)
+        {
+            if (agoraRtcEngine == nullptr)
+            {
+                result->Error("NOT_CREATED", "create has not been called");
+                return;
+            }
+            auto requested = ChannelSwitcher::Clock::now();
+            auto token = params[EncodableValue("token")].IsNull() ? "" : std::get<std::string>(params[EncodableValue("token")]);
+            auto channelId = std::get<std::string>(params[EncodableValue("channelId")]);
+            auto timeoutMs = std::get<int>(params[EncodableValue("timeoutMs")]);
+            std::shared_ptr<flutter::MethodResult<EncodableValue>> pending = std::move(result);
+            auto start = [this, pending, channelId, requested, timeoutMs](const std::string& token) {
+                auto id = switcher.Start(channelId, token, requested, [this, pending](const ChannelSwitchResult& switched) {
+                    platformTasks.Post([pending, switched]() {
+                        pending->Success(EncodableValue(toMap(switched)));
+                    });
+                });
+                if (id == 0)
+                {
+                    pending->Error("SWITCH_IN_PROGRESS", "Another channel switch is in progress");
+                    return;
+                }
+                tokens.OnJoining(channelId, localUid, token);
+                platformTasks.PostDelayed([this, id]() {
+                    switcher.OnTimeout(id);
+                }, std::chrono::milliseconds(timeoutMs));
+            };
+            if (token.empty() && tokens.running())
+            {
+                tokens.Acquire(channelId, localUid, [this, pending, channelId, start](bool ok, const std::string& token) {
+                    platformTasks.Post([this, pending, channelId, start, ok, token]() {
+                        // Released while the token was fetched
+                        if (agoraRtcEngine == nullptr)
+                            pending->Error("NOT_CREATED", "create has not been called");
+                        else if (!ok)
+                            pending->Error("TOKEN_UNAVAILABLE", "The token provider did not provide a token for " + channelId);
+                        else
+                            start(token);
+                    });
+                });
+            }
+            else
+                start(token);
+        }
+        else if ("prepareChannelSwitch" == methodName)
+        {
+            // Rejoins keep the uid, so one token serves both ways of switching
+            tokens.Prefetch(std::get<std::string>(params[EncodableValue("channelId")]), localUid);
+            result->Success(nullptr);
+        }
+        else if ("getChannelSwitchStats" == methodName)
+        {
+            result->Success(EncodableValue(toMap(switcher.GetStats())));
+        }
+        else if ("enableTokenManager" == methodName)
+        {
+            TokenManagerOptions options;
+            options.renewAheadSeconds = std::get<int>(params[EncodableValue("renewAheadSeconds")]);
+            options.fetchTimeoutMs = std::get<int>(params[EncodableValue("fetchTimeoutMs")]);
+            options.retryMs = std::get<int>(params[EncodableValue("retryMs")]);
+            std::shared_ptr<TokenProvider> provider;
+            if (std::get<std::string>(params[EncodableValue("provider")]) == "stub")
+            {
+                appTokens = nullptr;
+                provider = std::make_shared<StubTokenProvider>(
+                    std::get<int>(params[EncodableValue("stubLatencyMs")]),
+                    std::get<int>(params[EncodableValue("stubTtlSeconds")]));
+            }
+            else
+            {
+                appTokens = std::make_shared<CallbackTokenProvider>([this](uint64_t requestId, const TokenRequest& request) {
+                    SendEvent("onTokenRequired", EncodableMap{
+                        {"requestId", (int64_t)requestId},
+                        {"channelId", request.channelId},
+                        {"uid", (int64_t)request.uid},
+                    });
+                });
+                provider = appTokens;
+            }
+            tokens.Start(provider, options);
+            result->Success(nullptr);
+        }
+        else if ("disableTokenManager" == methodName)
+        {
+            tokens.Stop();
+            appTokens = nullptr;
+            result->Success(nullptr);
+        }
+        else if ("provideToken" == methodName)
+        {
+            auto requestId = (uint64_t)params[EncodableValue("requestId")].LongValue();
+            TokenGrant grant;
+            if (!params[EncodableValue("token")].IsNull())
+                grant.token = std::get<std::string>(params[EncodableValue("token")]);
+            grant.expiresAt = params[EncodableValue("expiresAt")].LongValue();
+            auto accepted = appTokens != nullptr && appTokens->Complete(requestId, !grant.token.empty(), grant);
+            result->Success(EncodableValue(accepted));
+        }
+        else if ("prefetchToken" == methodName)
+        {
+            auto channelId = std::get<std::string>(params[EncodableValue("channelId")]);
+            auto uid = std::get<int>(params[EncodableValue("uid")]);
+            tokens.Prefetch(channelId, static_cast<uint32_t>(uid));
+            result->Success(nullptr);
+        }
+        else if ("getTokenRenewalLog" == methodName)
+        {
+            EncodableList list;
+            for (const auto& event : tokens.GetLog())
+                list.push_back(toMap(event));
+            result->Success(EncodableValue(list));
+        }
+        else if ("getTokenManagerStats" == methodName)
+        {
+            result->Success(EncodableValue(toMap(tokens.GetStats())));
+        }
+        else if ("startScreenShare" == methodName)
+        {
+            if (agoraRtcEngine == nullptr)
+            {
+                result->Error("NOT_CREATED", "create has not been called");
+                return;
+            }
+            auto windowId = params[EncodableValue("windowId")].LongValue();
+            RECT rect;
+            rect.left = std::get<int>(params[EncodableValue("x")]);
+            rect.top = std::get<int>(params[EncodableValue("y")]);
+            rect.right = rect.left + std::get<int>(params[EncodableValue("width")]);
+            rect.bottom = rect.top + std::get<int>(params[EncodableValue("height")]);
+            if (windowId == 0 && (rect.right <= rect.left || rect.bottom <= rect.top))
+            {
+                // The whole virtual screen, across monitors
+                rect.left = ::GetSystemMetrics(SM_XVIRTUALSCREEN);
+                rect.top = ::GetSystemMetrics(SM_YVIRTUALSCREEN);
+                rect.right = rect.left + ::GetSystemMetrics(SM_CXVIRTUALSCREEN);
+                rect.bottom = rect.top + ::GetSystemMetrics(SM_CYVIRTUALSCREEN);
+            }
+            ScreenShareOptions options;
+            options.maxFrameRate = std::get<int>(params[EncodableValue("maxFrameRate")]);
+            options.minFrameRate = std::get<int>(params[EncodableValue("minFrameRate")]);
+            options.refreshIntervalMs = std::get<int>(params[EncodableValue("refreshIntervalMs")]);
+
+            StopScreenShare();
+            if (!screenShareEngine.queryInterface(agoraRtcEngine, agora::AGORA_IID_MEDIA_ENGINE) ||
+                screenShareEngine->setExternalVideoSource(true, false) != 0)
+            {
+                screenShareEngine.reset();
+                result->Error("SCREEN_SHARE_FAILED", "The engine does not accept an external video source");
+                return;
+            }
+            if (windowId != 0)
+                screenShare.Start(options, std::make_unique<GdiScreenCapture>(reinterpret_cast<HWND>(windowId)));
+            else
+                screenShare.Start(options, std::make_unique<GdiScreenCapture>(rect));
+            result->Success(nullptr);
+        }
+        else if ("stopScreenShare" == methodName)
+        {
+            auto stats = screenShare.GetStats();
+            StopScreenShare();
+            result->Success(EncodableValue(toMap(stats)));
+        }
+        else if ("getScreenShareStats" == methodName)
+        {
+            result->Success(EncodableValue(toMap(screenShare.GetStats())));
+        }
         else
             result->NotImplemented();
     }
 
 #pragma region IRtcEngineEventHandler
-    void AgoraRtcEnginePlugin::onJoinChannelSuccess(const char* channel, uid_t uid, int elapsed)
+    void AgoraRtcEnginePlugin::onJoinChannelSuccess(const char* channel, uid_t uid, int /* elapsed */)
     {
-        SendEvent("onJoinChannelSuccess", EncodableMap{
-            {"channel", channel},
-            {"uid", (int)uid},
-            {"elapsed", elapsed},
-        });
+        switcher.OnJoinChannelSuccess(channel, ChannelSwitcher::Clock::now());
+        localUid = uid;
+        if (!localAudience)
+            transcodingLayout.AddUser(uid);
+        mediaRelay.Resume();
     }
 
-    void AgoraRtcEnginePlugin::onLeaveChannel(const RtcStats& stats)
+    void AgoraRtcEnginePlugin::onLeaveChannel(const RtcStats& /* stats */)
     {
-        SendEvent("onLeaveChannel", EncodableMap{
-            {"stats", toMap(stats)},
-        });
+        renderPolicy.RemoveRemoteUsers();
+        transcodingLayout.ClearUsers();
+        switcher.OnLeaveChannel(ChannelSwitcher::Clock::now());
     }
 
-    void AgoraRtcEnginePlugin::onUserJoined(uid_t uid, int elapsed)
+    void AgoraRtcEnginePlugin::onUserJoined(uid_t uid, int /* elapsed */)
     {
-        SendEvent("onUserJoined", EncodableMap{
-            {"uid", (int)uid},
-            {"elapsed", elapsed},
-        });
+        transcodingLayout.AddUser(uid);
     }
 
-    void AgoraRtcEnginePlugin::onUserOffline(uid_t uid, USER_OFFLINE_REASON_TYPE reason)
+    void AgoraRtcEnginePlugin::onUserOffline(uid_t uid, USER_OFFLINE_REASON_TYPE /* reason */)
     {
-        SendEvent("onUserOffline", EncodableMap{
-            {"uid", (int)uid},
-            {"reason", (int)reason},
-        });
+        snapshots.Cancel(uid);
+        renderPolicy.RemoveUser(uid);
+        transcodingLayout.RemoveUser(uid);
+        if (auto transport = std::atomic_load(&dataTransport))
+            transport->RemoveUser(uid);
     }
 
     void AgoraRtcEnginePlugin::onRtcStats(const RtcStats& stats)
     {
-        SendEvent("onRtcStats", EncodableMap{
-            {"stats", toMap(stats)},
-        });
+        encoderTuner.OnRtcStats(stats.cpuAppUsage, stats.cpuTotalUsage, EncoderTuner::Clock::now());
     }
 
-    void AgoraRtcEnginePlugin::onRemoteAudioStats(const RemoteAudioStats& stats)
-    {
-        SendEvent("onRemoteAudioStats", EncodableMap{
-            {"stats", EncodableMap{
-                {"uid", (int)stats.uid},
-                {"quality", stats.quality},
-                {"networkTransportDelay", stats.networkTransportDelay},
-                {"jitterBufferDelay", stats.jitterBufferDelay},
-                {"audioLossRate", stats.audioLossRate},
-                {"numChannels", stats.numChannels},
-                {"receivedSampleRate", stats.receivedSampleRate},
-                {"receivedBitrate", stats.receivedBitrate},
-                {"totalFrozenTime", stats.totalFrozenTime},
-                {"frozenRate", stats.frozenRate},
-            }},
-        });
+    void AgoraRtcEnginePlugin::onLocalVideoStats(const LocalVideoStats& stats)
+    {
+        encoderTuner.OnLocalVideoStats(stats.encoderOutputFrameRate);
+    }
+
+    void AgoraRtcEnginePlugin::onNetworkQuality(uid_t uid, int txQuality, int /* rxQuality */)
+    {
+        // uid 0 reports the local user
+        if (uid == 0)
+            encoderTuner.OnNetworkQuality(txQuality);
+    }
+
+    void AgoraRtcEnginePlugin::onStreamMessage(uid_t uid, int /* streamId */, const char* data, size_t length)
+    {
+        // Stream ids are local to each sender, the transport recognizes its
+        // own packets instead.
+        if (auto transport = std::atomic_load(&dataTransport))
+            transport->OnStreamMessage(uid, (const uint8_t*)data, length);
+    }
+
+    void AgoraRtcEnginePlugin::onAudioEffectFinished(int soundId)
+    {
+        // Every window attached to the engine is called, with any window's
+        // effects
+        if (soundId >= effectSoundIdBase && soundId < effectSoundIdBase + kEffectSoundIdRange)
+            effects.OnFinished(soundId - effectSoundIdBase);
+    }
+
+    void AgoraRtcEnginePlugin::onLastmileQuality(int quality)
+    {
+        preflight.OnLastmileQuality(quality, NetworkPreflight::Clock::now());
+    }
+
+    void AgoraRtcEnginePlugin::onLastmileProbeResult(const LastmileProbeResult& result)
+    {
+        LastmileMeasurement measurement;
+        measurement.state = result.state;
+        measurement.uplink.packetLossRate = static_cast<int>(result.uplinkReport.packetLossRate);
+        measurement.uplink.jitter = static_cast<int>(result.uplinkReport.jitter);
+        measurement.uplink.availableBandwidth = static_cast<int>(result.uplinkReport.availableBandwidth);
+        measurement.downlink.packetLossRate = static_cast<int>(result.downlinkReport.packetLossRate);
+        measurement.downlink.jitter = static_cast<int>(result.downlinkReport.jitter);
+        measurement.downlink.availableBandwidth = static_cast<int>(result.downlinkReport.availableBandwidth);
+        measurement.rtt = static_cast<int>(result.rtt);
+        if (preflight.OnLastmileProbeResult(measurement, NetworkPreflight::Clock::now()))
+        {
+            // The SDK keeps reporting the last-mile quality until stopped
+            platformTasks.Post([this]() {
+                if (agoraRtcEngine != nullptr)
+                    agoraRtcEngine->stopLastmileProbeTest();
+            });
+        }
+    }
+
+    void AgoraRtcEnginePlugin::onNetworkTypeChanged(NETWORK_TYPE type)
+    {
+        preflight.OnNetworkTypeChanged(type);
+    }
+
+    void AgoraRtcEnginePlugin::onRequestToken()
+    {
+        tokens.OnRequestToken();
+    }
+
+    void AgoraRtcEnginePlugin::onClientRoleChanged(CLIENT_ROLE_TYPE /* oldRole */, CLIENT_ROLE_TYPE newRole)
+    {
+        switcher.SetClientRole(newRole);
+        localAudience = newRole == CLIENT_ROLE_AUDIENCE;
+        if (localUid == 0)
+            return;
+        if (localAudience)
+            transcodingLayout.RemoveUser(localUid);
+        else
+            transcodingLayout.AddUser(localUid);
+    }
+
+    void AgoraRtcEnginePlugin::onFirstRemoteVideoDecoded(uid_t /* uid */, int /* width */, int /* height */, int /* elapsed */)
+    {
+        switcher.OnFirstRemoteFrame(ChannelSwitcher::Clock::now());
+    }
+
+    void AgoraRtcEnginePlugin::onFirstRemoteAudioFrame(uid_t /* uid */, int /* elapsed */)
+    {
+        switcher.OnFirstRemoteFrame(ChannelSwitcher::Clock::now());
+    }
+
+    void AgoraRtcEnginePlugin::onTokenPrivilegeWillExpire(const char* /* token */)
+    {
+        tokens.OnTokenPrivilegeWillExpire();
+    }
+
+    void AgoraRtcEnginePlugin::onActiveSpeaker(uid_t uid)
+    {
+        transcodingLayout.SetSpeaker(uid == 0 ? localUid : uid);
+    }
+
+    void AgoraRtcEnginePlugin::onChannelMediaRelayStateChanged(CHANNEL_MEDIA_RELAY_STATE state, CHANNEL_MEDIA_RELAY_ERROR code)
+    {
+        mediaRelay.OnStateChanged(state, code);
+    }
+
+    void AgoraRtcEnginePlugin::onChannelMediaRelayEvent(CHANNEL_MEDIA_RELAY_EVENT code)
+    {
+        mediaRelay.OnEvent(code);
+    }
+
+    void AgoraRtcEnginePlugin::onAudioDeviceStateChanged(const char* /* deviceId */, int deviceType, int /* deviceState */)
+    {
+        if (deviceType == AUDIO_PLAYOUT_DEVICE)
+            devices.Refresh(DeviceKind::Playback);
+        else if (deviceType == AUDIO_RECORDING_DEVICE)
+            devices.Refresh(DeviceKind::Recording);
+    }
+
+    void AgoraRtcEnginePlugin::onVideoDeviceStateChanged(const char* /* deviceId */, int deviceType, int /* deviceState */)
+    {
+        if (deviceType == VIDEO_CAPTURE_DEVICE)
+            devices.Refresh(DeviceKind::Video);
+    }
+#pragma endregion
+
+#pragma region IVideoFrameObserver
+    bool AgoraRtcEnginePlugin::onCaptureVideoFrame(VideoFrame& videoFrame)
+    {
+        // The render policy only governs local processing, the captured frame
+        // must still be sent
+        ProcessVideoFrame(0, videoFrame);
+        return true;
+    }
+
+    bool AgoraRtcEnginePlugin::onRenderVideoFrame(unsigned int uid, VideoFrame& videoFrame)
+    {
+        return ProcessVideoFrame(uid, videoFrame);
     }
 #pragma endregion
+
+    bool AgoraRtcEnginePlugin::ProcessVideoFrame(unsigned int uid, VideoFrame& videoFrame)
+    {
+        // Returning false makes the SDK drop the frame as well
+        if (!renderPolicy.Admit(uid, videoFrame.width, videoFrame.height, videoFrame.renderTimeMs, VideoRenderPolicy::Clock::now()))
+        {
+            // Snapshots are also taken of hidden tiles, when one is requested
+            snapshots.OnVideoFrame(uid, videoFrame);
+            return false;
+        }
+
+        snapshots.OnVideoFrame(uid, videoFrame);
+        return true;
+    }
 }  // namespace
 
 void AgoraRtcEnginePluginRegisterWithRegistrar(
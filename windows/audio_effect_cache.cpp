@@ -0,0 +1,363 @@
+#include "audio_effect_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const int kNone = -1;
+
+        int64_t NanosSince(AudioEffectCache::Clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(AudioEffectCache::Clock::now() - start).count();
+        }
+
+        // The SDK keeps effects decoded, uncompressed files take their size.
+        bool IsUncompressed(const std::filesystem::path& path)
+        {
+            auto extension = path.extension().u8string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+                return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            });
+            return extension == ".wav" || extension == ".pcm";
+        }
+    }  // namespace
+
+    AudioEffectCache::AudioEffectCache(PreloadFunction preload, UnloadFunction unload)
+        : preload(std::move(preload)), unload(std::move(unload)), worker(1)
+    {
+    }
+
+    AudioEffectCache::~AudioEffectCache()
+    {
+        // The worker runs the posted tasks before joining, let them find
+        // nothing to do.
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.clear();
+    }
+
+    void AudioEffectCache::Configure(const AudioEffectCacheOptions& newOptions)
+    {
+        std::vector<int> victims;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            options = newOptions;
+            Evict(0, kNone, false, victims);
+        }
+        for (auto soundId : victims)
+            unload(soundId);
+    }
+
+    bool AudioEffectCache::Register(int soundId, const std::string& path, int64_t bytes)
+    {
+        if (bytes < 0)
+        {
+            auto file = std::filesystem::u8path(path);
+            std::error_code error;
+            auto size = std::filesystem::file_size(file, error);
+            if (error)
+                return false;
+            bytes = static_cast<int64_t>(size) * (IsUncompressed(file) ? 1 : kCompressedExpansion);
+        }
+
+        bool replaced = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& entry = entries[soundId];
+            if (entry.loaded)
+            {
+                usedBytes -= entry.bytes;
+                replaced = true;
+            }
+            // A preload in progress of the old file is dropped when done
+            entry.path = path;
+            entry.bytes = bytes;
+            entry.loaded = false;
+            entry.fresh = false;
+        }
+        if (replaced)
+            unload(soundId);
+        return true;
+    }
+
+    void AudioEffectCache::Unregister(int soundId)
+    {
+        bool loaded = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto entry = entries.find(soundId);
+            if (entry == entries.end())
+                return;
+            if (entry->second.loaded)
+            {
+                usedBytes -= entry->second.bytes;
+                loaded = true;
+            }
+            entries.erase(entry);
+            if (lastSoundId == soundId)
+                lastSoundId = kNone;
+        }
+        if (loaded)
+            unload(soundId);
+    }
+
+    void AudioEffectCache::Prefetch(const std::vector<int>& soundIds)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto soundId : soundIds)
+            Enqueue(soundId, Reason::Prefetch);
+    }
+
+    bool AudioEffectCache::Play(int soundId, const PlayFunction& play, int& error)
+    {
+        std::string path;
+        bool hit;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = entries.find(soundId);
+            if (found == entries.end())
+                return false;
+            auto& entry = found->second;
+            hit = entry.loaded;
+            path = entry.path;
+            entry.playing++;
+            entry.playCount++;
+            entry.lastUsed = ++useSequence;
+            entry.fresh = false;
+            plays++;
+            if (hit)
+                hits++;
+
+            auto last = entries.find(lastSoundId);
+            if (last != entries.end() && lastSoundId != soundId)
+                last->second.successors[soundId]++;
+            lastSoundId = soundId;
+
+            if (!hit)
+                Enqueue(soundId, Reason::Miss);
+            if (options.predict)
+            {
+                int total = 0;
+                for (const auto& successor : entry.successors)
+                    total += successor.second;
+                for (const auto& successor : entry.successors)
+                {
+                    if (successor.second >= options.predictMinCount && successor.second >= options.predictMinShare * total)
+                        Enqueue(successor.first, Reason::Predicted);
+                }
+            }
+        }
+
+        auto start = Clock::now();
+        error = play(path);
+        auto nanos = NanosSince(start);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hit)
+            hitPlayNanos += nanos;
+        else
+            coldPlayNanos += nanos;
+        auto entry = entries.find(soundId);
+        if (error != 0 && entry != entries.end() && entry->second.playing > 0)
+            entry->second.playing--;
+        return true;
+    }
+
+    void AudioEffectCache::OnFinished(int soundId)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto entry = entries.find(soundId);
+        if (entry != entries.end() && entry->second.playing > 0)
+            entry->second.playing--;
+    }
+
+    void AudioEffectCache::OnAllFinished()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : entries)
+            entry.second.playing = 0;
+    }
+
+    void AudioEffectCache::Reset()
+    {
+        std::vector<int> loaded;
+        std::unique_lock<std::mutex> lock(mutex);
+        queue.clear();
+        idle.wait(lock, [this]() { return loading == kNone; });
+        for (auto& entry : entries)
+        {
+            if (entry.second.loaded)
+                loaded.push_back(entry.first);
+        }
+        entries.clear();
+        usedBytes = 0;
+        lastSoundId = kNone;
+        plays = 0;
+        hits = 0;
+        preloads = 0;
+        predictedPreloads = 0;
+        failedPreloads = 0;
+        evictions = 0;
+        hitPlayNanos = 0;
+        coldPlayNanos = 0;
+        lock.unlock();
+        for (auto soundId : loaded)
+            unload(soundId);
+    }
+
+    AudioEffectCacheStats AudioEffectCache::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        AudioEffectCacheStats stats;
+        stats.plays = plays;
+        stats.hits = hits;
+        stats.preloads = preloads;
+        stats.predictedPreloads = predictedPreloads;
+        stats.failedPreloads = failedPreloads;
+        stats.evictions = evictions;
+        stats.usedBytes = usedBytes;
+        stats.memoryBudget = options.memoryBudget;
+        stats.registered = static_cast<int>(entries.size());
+        stats.loaded = static_cast<int>(std::count_if(entries.begin(), entries.end(), [](const auto& entry) {
+            return entry.second.loaded;
+        }));
+        if (plays > 0)
+            stats.hitRate = static_cast<double>(hits) / static_cast<double>(plays);
+        if (hits > 0)
+            stats.meanHitPlayNanos = hitPlayNanos / static_cast<int64_t>(hits);
+        if (plays > hits)
+            stats.meanColdPlayNanos = coldPlayNanos / static_cast<int64_t>(plays - hits);
+        return stats;
+    }
+
+    void AudioEffectCache::PreloadNext()
+    {
+        int soundId = kNone;
+        std::string path;
+        int64_t bytes = 0;
+        std::vector<int> victims;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (!queue.empty() && soundId == kNone)
+            {
+                auto next = queue.front();
+                queue.pop_front();
+                auto entry = entries.find(next);
+                if (entry == entries.end() || !entry->second.queued)
+                    continue;
+                entry->second.queued = false;
+                if (entry->second.loaded)
+                    continue;
+                if (!Evict(entry->second.bytes, next, entry->second.reason == Reason::Prefetch, victims))
+                    continue;
+                soundId = next;
+                path = entry->second.path;
+                bytes = entry->second.bytes;
+            }
+            if (soundId == kNone)
+                return;
+            // Reserved while loading
+            usedBytes += bytes;
+            loading = soundId;
+        }
+        for (auto victim : victims)
+            unload(victim);
+
+        auto loaded = preload(soundId, path);
+
+        bool stale = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            loading = kNone;
+            auto entry = entries.find(soundId);
+            if (!loaded || entry == entries.end() || entry->second.path != path)
+            {
+                usedBytes -= bytes;
+                stale = loaded;
+                if (!loaded)
+                    failedPreloads++;
+            }
+            else
+            {
+                entry->second.loaded = true;
+                entry->second.fresh = true;
+                entry->second.lastUsed = ++useSequence;
+                preloads++;
+                if (entry->second.reason == Reason::Predicted)
+                    predictedPreloads++;
+            }
+        }
+        idle.notify_all();
+        // Unregistered or replaced while loading
+        if (stale)
+            unload(soundId);
+    }
+
+    void AudioEffectCache::Enqueue(int soundId, Reason reason)
+    {
+        auto entry = entries.find(soundId);
+        if (entry == entries.end() || entry->second.loaded || soundId == loading)
+            return;
+        if (entry->second.queued)
+        {
+            if (reason != Reason::Predicted || entry->second.reason == Reason::Predicted)
+                return;
+            // Moves it ahead of the others
+            queue.erase(std::find(queue.begin(), queue.end(), soundId));
+        }
+        entry->second.queued = true;
+        entry->second.reason = reason;
+        if (reason == Reason::Predicted)
+            queue.push_front(soundId);
+        else
+            queue.push_back(soundId);
+        worker.Post([this]() { PreloadNext(); });
+    }
+
+    bool AudioEffectCache::Evict(int64_t bytes, int keep, bool spareFresh, std::vector<int>& victims)
+    {
+        if (usedBytes + bytes <= options.memoryBudget)
+            return true;
+        if (bytes > options.memoryBudget)
+            return false;
+
+        std::vector<std::map<int, Entry>::iterator> candidates;
+        for (auto entry = entries.begin(); entry != entries.end(); ++entry)
+        {
+            const auto& value = entry->second;
+            if (value.loaded && value.playing == 0 && entry->first != keep && !(spareFresh && value.fresh))
+                candidates.push_back(entry);
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](const auto& a, const auto& b) {
+            return Colder(a->second, b->second);
+        });
+
+        size_t count = 0;
+        int64_t freed = 0;
+        while (usedBytes - freed + bytes > options.memoryBudget)
+        {
+            if (count == candidates.size())
+                return false;
+            freed += candidates[count++]->second.bytes;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            candidates[i]->second.loaded = false;
+            candidates[i]->second.fresh = false;
+            victims.push_back(candidates[i]->first);
+            evictions++;
+        }
+        usedBytes -= freed;
+        return true;
+    }
+
+    bool AudioEffectCache::Colder(const Entry& a, const Entry& b) const
+    {
+        if (options.policy == EffectEvictionPolicy::Lfu && a.playCount != b.playCount)
+            return a.playCount < b.playCount;
+        return a.lastUsed < b.lastUsed;
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,185 @@
+#ifndef AGORA_RTC_ENGINE_AUDIO_EFFECT_CACHE_H_
+#define AGORA_RTC_ENGINE_AUDIO_EFFECT_CACHE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "worker_pool.h"
+
+namespace agora_rtc_engine {
+
+    enum class EffectEvictionPolicy
+    {
+        // Least recently played first
+        Lru = 0,
+        // Least often played first, the least recently played among equals
+        Lfu = 1,
+    };
+
+    struct AudioEffectCacheOptions
+    {
+        // Estimated decoded bytes the preloaded effects may take.
+        int64_t memoryBudget = 64 * 1024 * 1024;
+        EffectEvictionPolicy policy = EffectEvictionPolicy::Lru;
+        // Preloads the effects usually played after the one being played.
+        bool predict = true;
+        // A successor is preloaded once it followed at least this many times
+        // and in this share of the plays.
+        int predictMinCount = 2;
+        double predictMinShare = 0.3;
+    };
+
+    struct AudioEffectCacheStats
+    {
+        uint64_t plays = 0;
+        uint64_t hits = 0;
+        uint64_t preloads = 0;
+        uint64_t predictedPreloads = 0;
+        uint64_t failedPreloads = 0;
+        uint64_t evictions = 0;
+        int64_t usedBytes = 0;
+        int64_t memoryBudget = 0;
+        int registered = 0;
+        int loaded = 0;
+        double hitRate = 0;
+        // Mean time playEffect took, for preloaded effects and those read
+        // from their file.
+        int64_t meanHitPlayNanos = 0;
+        int64_t meanColdPlayNanos = 0;
+    };
+
+    // Keeps registered audio effects preloaded in the SDK within a memory
+    // budget, so that playing them does not read and decode their file.
+    //
+    // Effects are preloaded on a worker thread: in the order they are
+    // prefetched, after a play that missed the cache, and first the effects
+    // that usually follow the one played. Loading over the budget evicts the
+    // least recently or least often played effects, except those playing.
+    // Prefetching stops at the budget rather than evicting effects prefetched
+    // earlier and not played yet, which are expected to play sooner.
+    class AudioEffectCache
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Called on the worker thread, e.g. to call preloadEffect.
+        using PreloadFunction = std::function<bool(int soundId, const std::string& path)>;
+        // Called without the lock held, e.g. to call unloadEffect.
+        using UnloadFunction = std::function<void(int soundId)>;
+        // Plays the effect, returning an SDK error code.
+        using PlayFunction = std::function<int(const std::string& path)>;
+
+        // Decoded PCM over compressed files, about 1411 Kbps over 128 Kbps.
+        static const int kCompressedExpansion = 11;
+
+        AudioEffectCache(PreloadFunction preload, UnloadFunction unload);
+
+        ~AudioEffectCache();
+
+        // Prevent copying
+        AudioEffectCache(AudioEffectCache const&) = delete;
+        AudioEffectCache& operator=(AudioEffectCache const&) = delete;
+
+        // Applies |options|, evicting down to the new budget.
+        void Configure(const AudioEffectCacheOptions& options);
+
+        // Registers or replaces |soundId|. A negative |bytes| estimates the
+        // decoded size from the file. Returns false if the file is missing.
+        bool Register(int soundId, const std::string& path, int64_t bytes);
+
+        void Unregister(int soundId);
+
+        // Queues |soundIds| for preloading in this order.
+        void Prefetch(const std::vector<int>& soundIds);
+
+        // Plays |soundId| with |play|, queueing it for preloading if it was
+        // not. Returns false if it is not registered.
+        bool Play(int soundId, const PlayFunction& play, int& error);
+
+        // The effect stopped playing and may be evicted.
+        void OnFinished(int soundId);
+
+        void OnAllFinished();
+
+        // Unloads and forgets every effect, e.g. before the engine is
+        // released, waiting for a preload in progress.
+        void Reset();
+
+        AudioEffectCacheStats GetStats() const;
+
+    private:
+        enum class Reason
+        {
+            Prefetch,
+            Miss,
+            Predicted,
+        };
+
+        struct Entry
+        {
+            std::string path;
+            int64_t bytes = 0;
+            bool loaded = false;
+            bool queued = false;
+            Reason reason = Reason::Prefetch;
+            // Loaded and not played since
+            bool fresh = false;
+            int playing = 0;
+            uint64_t playCount = 0;
+            // Sequence number of the last play or load, orders by recency
+            uint64_t lastUsed = 0;
+            // Plays that followed this one, by sound id
+            std::map<int, int> successors;
+        };
+
+        // Preloads the next queued effect, on the worker thread.
+        void PreloadNext();
+
+        // Queues |soundId|, predictions ahead of the others. Called with
+        // |mutex| held.
+        void Enqueue(int soundId, Reason reason);
+
+        // Picks victims until |bytes| more fit the budget, sparing |keep| and
+        // fresh effects if |spareFresh|, and marks them unloaded. Called with
+        // |mutex| held. Returns false if they cannot fit.
+        bool Evict(int64_t bytes, int keep, bool spareFresh, std::vector<int>& victims);
+
+        // Whether |a| should be evicted before |b|.
+        bool Colder(const Entry& a, const Entry& b) const;
+
+        PreloadFunction preload;
+        UnloadFunction unload;
+
+        mutable std::mutex mutex;
+        std::condition_variable idle;
+        AudioEffectCacheOptions options;
+        std::map<int, Entry> entries;
+        std::deque<int> queue;
+        // The effect being preloaded, -1 when none is.
+        int loading = -1;
+        int64_t usedBytes = 0;
+        uint64_t useSequence = 0;
+        int lastSoundId = -1;
+
+        uint64_t plays = 0;
+        uint64_t hits = 0;
+        uint64_t preloads = 0;
+        uint64_t predictedPreloads = 0;
+        uint64_t failedPreloads = 0;
+        uint64_t evictions = 0;
+        int64_t hitPlayNanos = 0;
+        int64_t coldPlayNanos = 0;
+
+        // Declared last, so that it joins before the state above is destroyed.
+        WorkerPool worker;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_AUDIO_EFFECT_CACHE_H_
@@ -0,0 +1,175 @@
+#include "audio_frame_hub.h"
+
+#include <algorithm>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // The rates the SDK accepts in set*AudioFrameParameters
+        const int kSdkSampleRates[] = {8000, 16000, 32000, 44100, 48000};
+    }  // namespace
+
+    AudioFrameHub::AudioFrameHub()
+    {
+    }
+
+    int AudioFrameHub::AddConsumer(AudioFrameSource source, const AudioFormat& format, DeliverFunction deliver)
+    {
+        auto id = ++lastId;
+        auto& entry = sources[static_cast<int>(source)];
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        auto group = std::find_if(entry.groups.begin(), entry.groups.end(), [&format](const std::unique_ptr<Group>& group) {
+            return group->format == format;
+        });
+        if (group == entry.groups.end())
+        {
+            entry.groups.push_back(std::make_unique<Group>());
+            group = entry.groups.end() - 1;
+            (*group)->format = format;
+        }
+        (*group)->consumers.push_back(Consumer{id, std::move(deliver)});
+        return id;
+    }
+
+    bool AudioFrameHub::RemoveConsumer(int id)
+    {
+        for (auto& entry : sources)
+        {
+            std::lock_guard<std::mutex> lock(entry.mutex);
+            for (auto group = entry.groups.begin(); group != entry.groups.end(); ++group)
+            {
+                auto& consumers = (*group)->consumers;
+                auto consumer = std::find_if(consumers.begin(), consumers.end(), [id](const Consumer& consumer) {
+                    return consumer.id == id;
+                });
+                if (consumer == consumers.end())
+                    continue;
+                consumers.erase(consumer);
+                if (consumers.empty())
+                    entry.groups.erase(group);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void AudioFrameHub::Clear()
+    {
+        for (auto& entry : sources)
+        {
+            std::lock_guard<std::mutex> lock(entry.mutex);
+            entry.groups.clear();
+        }
+    }
+
+    AudioFormat AudioFrameHub::Negotiate(AudioFrameSource source) const
+    {
+        AudioFormat format;
+        auto& entry = sources[static_cast<int>(source)];
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        for (const auto& group : entry.groups)
+        {
+            format.sampleRate = std::max(format.sampleRate, group->format.sampleRate);
+            format.channels = std::max(format.channels, group->format.channels);
+        }
+        if (format.sampleRate == 0)
+            return format;
+        // The lowest rate the SDK offers that loses nothing
+        auto rate = std::find_if(std::begin(kSdkSampleRates), std::end(kSdkSampleRates), [&format](int rate) {
+            return rate >= format.sampleRate;
+        });
+        format.sampleRate = rate != std::end(kSdkSampleRates) ? *rate : *(std::end(kSdkSampleRates) - 1);
+        if (source == AudioFrameSource::Mixed)
+            format.channels = 1;
+        return format;
+    }
+
+    bool AudioFrameHub::active() const
+    {
+        for (const auto& entry : sources)
+        {
+            std::lock_guard<std::mutex> lock(entry.mutex);
+            if (!entry.groups.empty())
+                return true;
+        }
+        return false;
+    }
+
+    AudioFrameHubStats AudioFrameHub::GetStats() const
+    {
+        AudioFrameHubStats stats;
+        stats.frames = frames;
+        stats.passedThrough = passedThrough;
+        stats.converted = converted;
+        stats.skipped = skipped;
+        return stats;
+    }
+
+#pragma region IAudioFrameObserver
+    bool AudioFrameHub::onRecordAudioFrame(AudioFrame& audioFrame)
+    {
+        Dispatch(AudioFrameSource::Record, audioFrame);
+        return true;
+    }
+
+    bool AudioFrameHub::onPlaybackAudioFrame(AudioFrame& audioFrame)
+    {
+        Dispatch(AudioFrameSource::Playback, audioFrame);
+        return true;
+    }
+
+    bool AudioFrameHub::onMixedAudioFrame(AudioFrame& audioFrame)
+    {
+        Dispatch(AudioFrameSource::Mixed, audioFrame);
+        return true;
+    }
+
+    bool AudioFrameHub::onPlaybackAudioFrameBeforeMixing(unsigned int /* uid */, AudioFrame& /* audioFrame */)
+    {
+        return true;
+    }
+#pragma endregion
+
+    void AudioFrameHub::Dispatch(AudioFrameSource source, const AudioFrame& frame)
+    {
+        if (frame.buffer == nullptr || frame.samples <= 0 || frame.bytesPerSample != 2)
+            return;
+        frames.fetch_add(1, std::memory_order_relaxed);
+        auto& entry = sources[static_cast<int>(source)];
+        std::unique_lock<std::mutex> lock(entry.mutex, std::try_to_lock);
+        if (!lock.owns_lock())
+        {
+            skipped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        AudioFrameView native;
+        native.samples = static_cast<const int16_t*>(frame.buffer);
+        native.frames = frame.samples;
+        native.format.sampleRate = frame.samplesPerSec;
+        native.format.channels = frame.channels;
+        native.renderTimeMs = frame.renderTimeMs;
+        for (auto& group : entry.groups)
+        {
+            auto view = native;
+            if (group->format != native.format)
+            {
+                group->resampler.Configure(native.format, group->format);
+                group->output.clear();
+                view.frames = group->resampler.Process(native.samples, native.frames, group->output);
+                view.samples = group->output.data();
+                view.format = group->format;
+                // Filling the filter's history at the start of a stream
+                if (view.frames == 0)
+                    continue;
+            }
+            for (const auto& consumer : group->consumers)
+                consumer.deliver(view);
+            if (view.samples == native.samples)
+                passedThrough.fetch_add(group->consumers.size(), std::memory_order_relaxed);
+            else
+                converted.fetch_add(group->consumers.size(), std::memory_order_relaxed);
+        }
+    }
+
+}  // namespace agora_rtc_engine
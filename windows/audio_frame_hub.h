@@ -0,0 +1,133 @@
+#ifndef AGORA_RTC_ENGINE_AUDIO_FRAME_HUB_H_
+#define AGORA_RTC_ENGINE_AUDIO_FRAME_HUB_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "IAgoraMediaEngine.h"
+
+#include "audio_resampler.h"
+
+namespace agora_rtc_engine {
+
+    enum class AudioFrameSource
+    {
+        // onRecordAudioFrame
+        Record = 0,
+        // onPlaybackAudioFrame
+        Playback = 1,
+        // onMixedAudioFrame, always mono
+        Mixed = 2,
+    };
+
+    const int kAudioFrameSourceCount = 3;
+
+    // Interleaved 16-bit PCM, valid for the duration of the call it is
+    // passed to.
+    struct AudioFrameView
+    {
+        const int16_t* samples = nullptr;
+        int frames = 0;
+        AudioFormat format;
+        int64_t renderTimeMs = 0;
+    };
+
+    struct AudioFrameHubStats
+    {
+        // Frames from the SDK.
+        uint64_t frames = 0;
+        // Deliveries of the SDK's own buffer, and of a converted one.
+        uint64_t passedThrough = 0;
+        uint64_t converted = 0;
+        // Frames that arrived while consumers were being changed.
+        uint64_t skipped = 0;
+    };
+
+    // Takes the SDK's raw audio frames once and fans them out to consumers
+    // that each want their own sample rate and channel count.
+    //
+    // The SDK delivers one format per source, so the hub negotiates it: the
+    // highest rate and the most channels any consumer of the source wants,
+    // so that conversions only lose information a consumer did not ask for.
+    // Consumers wanting that format get the SDK's buffer as it is; the others
+    // are grouped by format, each group converted once by a resampler that
+    // keeps its filter history from frame to frame.
+    //
+    // Callbacks never wait: a frame arriving while consumers are added or
+    // removed is skipped.
+    class AudioFrameHub : public agora::media::IAudioFrameObserver
+    {
+    public:
+        // Called on the SDK's audio threads.
+        using DeliverFunction = std::function<void(const AudioFrameView& frame)>;
+
+        AudioFrameHub();
+
+        // Prevent copying
+        AudioFrameHub(AudioFrameHub const&) = delete;
+        AudioFrameHub& operator=(AudioFrameHub const&) = delete;
+
+        // Returns the consumer's id.
+        int AddConsumer(AudioFrameSource source, const AudioFormat& format, DeliverFunction deliver);
+
+        // Returns false if there is no consumer |id|. |deliver| is not called
+        // once this returns.
+        bool RemoveConsumer(int id);
+
+        void Clear();
+
+        // The format to request from the SDK for |source|, a rate of 0 when
+        // it has no consumers.
+        AudioFormat Negotiate(AudioFrameSource source) const;
+
+        bool active() const;
+
+        AudioFrameHubStats GetStats() const;
+
+#pragma region IAudioFrameObserver
+        bool onRecordAudioFrame(AudioFrame& audioFrame) override;
+        bool onPlaybackAudioFrame(AudioFrame& audioFrame) override;
+        bool onMixedAudioFrame(AudioFrame& audioFrame) override;
+        bool onPlaybackAudioFrameBeforeMixing(unsigned int uid, AudioFrame& audioFrame) override;
+#pragma endregion
+
+    private:
+        struct Consumer
+        {
+            int id;
+            DeliverFunction deliver;
+        };
+
+        // The consumers of one format.
+        struct Group
+        {
+            AudioFormat format;
+            std::vector<Consumer> consumers;
+            AudioResampler resampler;
+            std::vector<int16_t> output;
+        };
+
+        struct Source
+        {
+            mutable std::mutex mutex;
+            std::vector<std::unique_ptr<Group>> groups;
+        };
+
+        void Dispatch(AudioFrameSource source, const AudioFrame& frame);
+
+        Source sources[kAudioFrameSourceCount];
+        std::atomic<int> lastId{0};
+
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> passedThrough{0};
+        std::atomic<uint64_t> converted{0};
+        std::atomic<uint64_t> skipped{0};
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_AUDIO_FRAME_HUB_H_
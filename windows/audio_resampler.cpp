@@ -0,0 +1,207 @@
+#include "audio_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <utility>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define AGORA_RTC_ENGINE_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // Per phase when upsampling, scaled up with the decimation ratio so
+        // that the transition band keeps its width.
+        const int kTapsPerPhase = 32;
+        const double kKaiserBeta = 8.0;
+        // Of the lower Nyquist frequency, where the pass band ends.
+        const double kPassBand = 0.9;
+        const double kPi = 3.14159265358979323846;
+
+        // The zeroth-order modified Bessel function of the first kind.
+        double BesselI0(double x)
+        {
+            double sum = 1;
+            double term = 1;
+            for (int k = 1; k < 32; ++k)
+            {
+                term *= (x / (2 * k)) * (x / (2 * k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        std::shared_ptr<const PolyphaseFilter> Design(int inputRate, int outputRate)
+        {
+            auto filter = std::make_shared<PolyphaseFilter>();
+            auto divisor = std::gcd(inputRate, outputRate);
+            filter->up = outputRate / divisor;
+            filter->down = inputRate / divisor;
+            auto decimation = (filter->down + filter->up - 1) / filter->up;
+            filter->taps = (kTapsPerPhase * std::max(decimation, 1) + 3) / 4 * 4;
+
+            auto up = filter->up;
+            auto taps = filter->taps;
+            auto length = taps * up;
+            // In cycles per sample at the upsampled rate
+            auto cutoff = 0.5 * kPassBand * std::min(1.0, static_cast<double>(up) / filter->down) / up;
+            auto center = (length - 1) / 2.0;
+            std::vector<double> prototype(length);
+            for (int i = 0; i < length; ++i)
+            {
+                auto t = i - center;
+                auto sinc = t == 0 ? 2 * cutoff : std::sin(2 * kPi * cutoff * t) / (kPi * t);
+                auto x = 2.0 * i / (length - 1) - 1;
+                auto window = BesselI0(kKaiserBeta * std::sqrt(std::max(0.0, 1 - x * x))) / BesselI0(kKaiserBeta);
+                prototype[i] = sinc * window;
+            }
+
+            filter->coefficients.resize(static_cast<size_t>(length));
+            for (int p = 0; p < up; ++p)
+            {
+                // Unity gain at DC for every phase
+                double sum = 0;
+                for (int j = 0; j < taps; ++j)
+                    sum += prototype[p + j * up];
+                for (int j = 0; j < taps; ++j)
+                    filter->coefficients[p * taps + (taps - 1 - j)] = static_cast<float>(prototype[p + j * up] / sum);
+            }
+            return filter;
+        }
+
+        float Dot(const float* x, const float* h, int n)
+        {
+#ifdef AGORA_RTC_ENGINE_HAS_SSE2
+            auto sum = _mm_setzero_ps();
+            for (int i = 0; i < n; i += 4)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(h + i)));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+            return _mm_cvtss_f32(sum);
+#else
+            float sum = 0;
+            for (int i = 0; i < n; ++i)
+                sum += x[i] * h[i];
+            return sum;
+#endif
+        }
+
+        int16_t Saturate(float value)
+        {
+            return static_cast<int16_t>(std::lround(std::clamp(value, -32768.0f, 32767.0f)));
+        }
+    }  // namespace
+
+    // static
+    std::shared_ptr<const PolyphaseFilter> PolyphaseFilter::Get(int inputRate, int outputRate)
+    {
+        static std::mutex mutex;
+        static std::map<std::pair<int, int>, std::shared_ptr<const PolyphaseFilter>> filters;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& filter = filters[std::make_pair(inputRate, outputRate)];
+        if (filter == nullptr)
+            filter = Design(inputRate, outputRate);
+        return filter;
+    }
+
+    AudioResampler::AudioResampler()
+    {
+    }
+
+    void AudioResampler::Configure(const AudioFormat& newInput, const AudioFormat& newOutput)
+    {
+        if (newInput == input && newOutput == output)
+            return;
+        input = newInput;
+        output = newOutput;
+        filter = input.sampleRate != output.sampleRate ? PolyphaseFilter::Get(input.sampleRate, output.sampleRate) : nullptr;
+        for (auto& buffer : buffers)
+            buffer.assign(filter != nullptr ? static_cast<size_t>(filter->taps - 1) : 0, 0.0f);
+        phase = 0;
+        inputIndex = 0;
+    }
+
+    int AudioResampler::Process(const int16_t* samples, int frames, std::vector<int16_t>& out)
+    {
+        if (frames <= 0 || input.channels < 1 || output.channels < 1)
+            return 0;
+        auto channels = std::min(input.channels, output.channels);
+        auto start = out.size();
+
+        if (filter == nullptr)
+        {
+            out.resize(start + static_cast<size_t>(frames) * output.channels);
+            auto target = out.data() + start;
+            for (int i = 0; i < frames; ++i)
+            {
+                auto frame = samples + i * input.channels;
+                if (input.channels == output.channels)
+                    std::copy(frame, frame + output.channels, target + i * output.channels);
+                else if (output.channels == 1)
+                    target[i] = static_cast<int16_t>((frame[0] + frame[1]) / 2);
+                else
+                    target[2 * i] = target[2 * i + 1] = frame[0];
+            }
+            return frames;
+        }
+
+        auto history = static_cast<size_t>(filter->taps - 1);
+        for (int c = 0; c < channels; ++c)
+            buffers[c].resize(history + frames);
+        for (int i = 0; i < frames; ++i)
+        {
+            auto frame = samples + i * input.channels;
+            if (channels < input.channels)
+            {
+                buffers[0][history + i] = (frame[0] + frame[1]) * 0.5f;
+            }
+            else
+            {
+                for (int c = 0; c < channels; ++c)
+                    buffers[c][history + i] = frame[c];
+            }
+        }
+
+        auto produced = Filter(frames);
+        out.resize(start + static_cast<size_t>(produced) * output.channels);
+        auto target = out.data() + start;
+        for (int k = 0; k < produced; ++k)
+        {
+            for (int c = 0; c < output.channels; ++c)
+                target[k * output.channels + c] = Saturate(filtered[std::min(c, channels - 1)][k]);
+        }
+
+        // Keeps the last inputs for the next frame, without reallocating
+        for (int c = 0; c < channels; ++c)
+        {
+            std::copy(buffers[c].end() - history, buffers[c].end(), buffers[c].begin());
+            buffers[c].resize(history);
+        }
+        return produced;
+    }
+
+    int AudioResampler::Filter(int frames)
+    {
+        auto channels = std::min(input.channels, output.channels);
+        auto taps = filter->taps;
+        for (int c = 0; c < channels; ++c)
+            filtered[c].clear();
+        while (inputIndex < frames)
+        {
+            auto coefficients = filter->coefficients.data() + static_cast<size_t>(phase) * taps;
+            for (int c = 0; c < channels; ++c)
+                filtered[c].push_back(Dot(buffers[c].data() + inputIndex, coefficients, taps));
+            phase += filter->down;
+            inputIndex += phase / filter->up;
+            phase %= filter->up;
+        }
+        inputIndex -= frames;
+        return static_cast<int>(filtered[0].size());
+    }
+
+}  // namespace agora_rtc_engine
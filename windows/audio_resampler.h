@@ -0,0 +1,79 @@
+#ifndef AGORA_RTC_ENGINE_AUDIO_RESAMPLER_H_
+#define AGORA_RTC_ENGINE_AUDIO_RESAMPLER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace agora_rtc_engine {
+
+    struct AudioFormat
+    {
+        int sampleRate = 0;
+        // 1 or 2, interleaved.
+        int channels = 0;
+
+        bool operator==(const AudioFormat& other) const { return sampleRate == other.sampleRate && channels == other.channels; }
+        bool operator!=(const AudioFormat& other) const { return !(*this == other); }
+    };
+
+    // The phases of a windowed-sinc low-pass filter converting between two
+    // sample rates, whose ratio is reduced to |up| / |down|.
+    struct PolyphaseFilter
+    {
+        int up = 1;
+        int down = 1;
+        // Per phase, a multiple of 4 for SIMD.
+        int taps = 0;
+        // |up| phases of |taps| coefficients each, stored in reverse so
+        // that each phase is a dot product with the input in time order.
+        std::vector<float> coefficients;
+
+        // The filter for |inputRate| to |outputRate|, designed once and
+        // shared by the resamplers that use it.
+        static std::shared_ptr<const PolyphaseFilter> Get(int inputRate, int outputRate);
+    };
+
+    // Converts 16-bit PCM between sample rates and between mono and stereo,
+    // a stream of frames at a time: the filter history and phase carry over
+    // from one frame to the next.
+    //
+    // Stereo is mixed down before filtering and mono copied up after it, so
+    // that no more channels than needed are filtered. Frames already in the
+    // output format are copied through.
+    class AudioResampler
+    {
+    public:
+        AudioResampler();
+
+        // Prevent copying
+        AudioResampler(AudioResampler const&) = delete;
+        AudioResampler& operator=(AudioResampler const&) = delete;
+
+        // Starts a new stream, forgetting the history, if the formats
+        // changed.
+        void Configure(const AudioFormat& input, const AudioFormat& output);
+
+        // Converts |frames| frames, appending to |output|. Returns the frames
+        // appended.
+        int Process(const int16_t* input, int frames, std::vector<int16_t>& output);
+
+    private:
+        int Filter(int frames);
+
+        AudioFormat input;
+        AudioFormat output;
+        std::shared_ptr<const PolyphaseFilter> filter;
+
+        // Per filtered channel: the last |taps| - 1 inputs, then the current
+        // frame.
+        std::vector<float> buffers[2];
+        std::vector<float> filtered[2];
+        int phase = 0;
+        // Of the next output, in the current frame.
+        int inputIndex = 0;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_AUDIO_RESAMPLER_H_
@@ -0,0 +1,71 @@
+#include "audio_tap.h"
+
+#include <algorithm>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const size_t kReadBatch = 16;
+    }  // namespace
+
+    AudioTap::AudioTap(AudioFrameSource source, const AudioFormat& format, size_t chunks)
+        : tapSource(source),
+        tapFormat(format),
+        queue(chunks, QueueOverflow::OverwriteOldest),
+        batch(kReadBatch)
+    {
+    }
+
+    AudioFrameSource AudioTap::source() const
+    {
+        return tapSource;
+    }
+
+    const AudioFormat& AudioTap::format() const
+    {
+        return tapFormat;
+    }
+
+    void AudioTap::Write(const AudioFrameView& frame)
+    {
+        frames.fetch_add(1, std::memory_order_relaxed);
+        auto remaining = static_cast<size_t>(frame.frames) * frame.format.channels;
+        auto samples = frame.samples;
+        // Chunks hold whole frames, so that channels stay interleaved
+        auto perChunk = kChunkSamples / frame.format.channels * frame.format.channels;
+        while (remaining > 0)
+        {
+            Chunk chunk;
+            chunk.size = std::min(remaining, perChunk);
+            std::copy(samples, samples + chunk.size, chunk.samples.begin());
+            queue.Push(chunk);
+            samples += chunk.size;
+            remaining -= chunk.size;
+        }
+    }
+
+    size_t AudioTap::Read(std::vector<int16_t>& samples)
+    {
+        size_t total = 0;
+        while (true)
+        {
+            auto popped = queue.PopBatch(batch.data(), batch.size());
+            for (size_t i = 0; i < popped; ++i)
+            {
+                samples.insert(samples.end(), batch[i].samples.begin(), batch[i].samples.begin() + batch[i].size);
+                total += batch[i].size;
+            }
+            if (popped < batch.size())
+                return total;
+        }
+    }
+
+    AudioTapStats AudioTap::GetStats() const
+    {
+        AudioTapStats stats;
+        stats.frames = frames;
+        stats.dropped = queue.GetStats().overwritten;
+        return stats;
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,64 @@
+#ifndef AGORA_RTC_ENGINE_AUDIO_TAP_H_
+#define AGORA_RTC_ENGINE_AUDIO_TAP_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "audio_frame_hub.h"
+#include "bounded_queue.h"
+
+namespace agora_rtc_engine {
+
+    struct AudioTapStats
+    {
+        uint64_t frames = 0;
+        // Chunks dropped because the reader fell behind.
+        uint64_t dropped = 0;
+    };
+
+    // Hands the frames an AudioFrameHub delivers to a reader on another
+    // thread, through a queue of preallocated chunks: the audio thread only
+    // copies, and overwrites the oldest chunks if the reader falls behind.
+    class AudioTap
+    {
+    public:
+        // 10 ms at 48 kHz stereo, the most the SDK delivers at once.
+        static const size_t kChunkSamples = 960;
+
+        AudioTap(AudioFrameSource source, const AudioFormat& format, size_t chunks);
+
+        // Prevent copying
+        AudioTap(AudioTap const&) = delete;
+        AudioTap& operator=(AudioTap const&) = delete;
+
+        AudioFrameSource source() const;
+
+        const AudioFormat& format() const;
+
+        // Called on the audio thread.
+        void Write(const AudioFrameView& frame);
+
+        // Appends the samples written since the last call. Returns how many.
+        size_t Read(std::vector<int16_t>& samples);
+
+        AudioTapStats GetStats() const;
+
+    private:
+        struct Chunk
+        {
+            size_t size;
+            std::array<int16_t, kChunkSamples> samples;
+        };
+
+        AudioFrameSource tapSource;
+        AudioFormat tapFormat;
+        SpscQueue<Chunk> queue;
+        std::vector<Chunk> batch;
+        std::atomic<uint64_t> frames{0};
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_AUDIO_TAP_H_
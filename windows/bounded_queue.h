@@ -0,0 +1,306 @@
+#ifndef AGORA_RTC_ENGINE_BOUNDED_QUEUE_H_
+#define AGORA_RTC_ENGINE_BOUNDED_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace agora_rtc_engine {
+
+    // Keeps what producers and consumers write on separate cache lines.
+    const size_t kCacheLineSize = 64;
+
+    enum class QueueOverflow
+    {
+        // Pushing to a full queue fails.
+        Reject = 0,
+        // Pushing to a full queue drops its oldest element.
+        OverwriteOldest = 1,
+    };
+
+    struct BoundedQueueStats
+    {
+        uint64_t pushed = 0;
+        uint64_t popped = 0;
+        // Elements not pushed as the queue was full, and those dropped from
+        // it to make room.
+        uint64_t rejected = 0;
+        uint64_t overwritten = 0;
+    };
+
+    // A fixed-capacity queue that never blocks or allocates once
+    // constructed, for handing data from real-time callback threads, such
+    // as the SDK's audio, video and packet threads, to a thread of our own.
+    //
+    // Each slot carries a sequence number telling whose turn it is, so that
+    // producers and the consumer only touch the slots they use and their own
+    // position. Batches claim their slots with a single update of that
+    // position.
+    //
+    // A single producer, or any number with |MultiProducer|, may push; a
+    // single thread pops. Overwriting makes producers pop the oldest element
+    // themselves, so the consumer then claims slots the same way producers
+    // do. A producer may spin briefly while the consumer moves an element out
+    // of the slot it needs.
+    template <typename T, bool MultiProducer>
+    class BoundedQueue
+    {
+        static_assert(std::is_default_constructible_v<T> && std::is_move_assignable_v<T>, "elements are moved in and out of slots");
+
+    public:
+        // |capacity| is rounded up to a power of two.
+        BoundedQueue(size_t capacity, QueueOverflow overflow);
+
+        // Prevent copying
+        BoundedQueue(BoundedQueue const&) = delete;
+        BoundedQueue& operator=(BoundedQueue const&) = delete;
+
+        size_t capacity() const;
+
+        // Returns false if the queue was full and rejects overflow.
+        bool Push(T item);
+
+        // Pushes |items| in order, moving from them. Returns how many were
+        // pushed, all of them when overwriting.
+        size_t PushBatch(T* items, size_t count);
+
+        bool Pop(T& item);
+
+        // Pops up to |count| elements into |items|, returns how many.
+        size_t PopBatch(T* items, size_t count);
+
+        // A snapshot, exact only when no thread is pushing or popping.
+        size_t size() const;
+
+        BoundedQueueStats GetStats() const;
+
+    private:
+        struct alignas(kCacheLineSize) Slot
+        {
+            // Equal to the position when free for it, one more once filled.
+            std::atomic<uint64_t> sequence{0};
+            T value;
+        };
+
+        // Claims up to |count| free slots from the head, returns how many.
+        size_t ClaimPush(size_t count, uint64_t& position);
+
+        // Claims up to |count| filled slots from the tail, returns how many.
+        size_t ClaimPop(size_t count, uint64_t& position);
+
+        // Drops the oldest element to make room for the one at |position|,
+        // or waits for the consumer already moving it out.
+        void MakeRoom(uint64_t position);
+
+        static size_t RoundUpToPowerOfTwo(size_t value);
+
+        const size_t mask;
+        const QueueOverflow overflow;
+        std::unique_ptr<Slot[]> slots;
+
+        alignas(kCacheLineSize) std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> pushed{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> overwritten{0};
+
+        alignas(kCacheLineSize) std::atomic<uint64_t> tail{0};
+        std::atomic<uint64_t> popped{0};
+    };
+
+    template <typename T>
+    using SpscQueue = BoundedQueue<T, false>;
+
+    template <typename T>
+    using MpscQueue = BoundedQueue<T, true>;
+
+    template <typename T, bool MultiProducer>
+    BoundedQueue<T, MultiProducer>::BoundedQueue(size_t capacity, QueueOverflow overflow)
+        : mask(RoundUpToPowerOfTwo(capacity < 2 ? 2 : capacity) - 1),
+        overflow(overflow),
+        slots(new Slot[mask + 1])
+    {
+        for (size_t i = 0; i <= mask; ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <typename T, bool MultiProducer>
+    size_t BoundedQueue<T, MultiProducer>::capacity() const
+    {
+        return mask + 1;
+    }
+
+    template <typename T, bool MultiProducer>
+    bool BoundedQueue<T, MultiProducer>::Push(T item)
+    {
+        return PushBatch(&item, 1) == 1;
+    }
+
+    template <typename T, bool MultiProducer>
+    size_t BoundedQueue<T, MultiProducer>::PushBatch(T* items, size_t count)
+    {
+        size_t done = 0;
+        while (done < count)
+        {
+            uint64_t position;
+            auto claimed = ClaimPush(count - done, position);
+            if (claimed == 0)
+            {
+                if (overflow == QueueOverflow::Reject)
+                    break;
+                MakeRoom(position);
+                continue;
+            }
+            for (size_t i = 0; i < claimed; ++i)
+            {
+                auto& slot = slots[(position + i) & mask];
+                slot.value = std::move(items[done + i]);
+                slot.sequence.store(position + i + 1, std::memory_order_release);
+            }
+            done += claimed;
+        }
+        pushed.fetch_add(done, std::memory_order_relaxed);
+        if (done < count)
+            rejected.fetch_add(count - done, std::memory_order_relaxed);
+        return done;
+    }
+
+    template <typename T, bool MultiProducer>
+    bool BoundedQueue<T, MultiProducer>::Pop(T& item)
+    {
+        return PopBatch(&item, 1) == 1;
+    }
+
+    template <typename T, bool MultiProducer>
+    size_t BoundedQueue<T, MultiProducer>::PopBatch(T* items, size_t count)
+    {
+        uint64_t position;
+        auto claimed = ClaimPop(count, position);
+        for (size_t i = 0; i < claimed; ++i)
+        {
+            auto& slot = slots[(position + i) & mask];
+            items[i] = std::move(slot.value);
+            slot.sequence.store(position + i + mask + 1, std::memory_order_release);
+        }
+        popped.fetch_add(claimed, std::memory_order_relaxed);
+        return claimed;
+    }
+
+    template <typename T, bool MultiProducer>
+    size_t BoundedQueue<T, MultiProducer>::size() const
+    {
+        auto first = tail.load(std::memory_order_acquire);
+        auto last = head.load(std::memory_order_acquire);
+        return last > first ? static_cast<size_t>(last - first) : 0;
+    }
+
+    template <typename T, bool MultiProducer>
+    BoundedQueueStats BoundedQueue<T, MultiProducer>::GetStats() const
+    {
+        BoundedQueueStats stats;
+        stats.pushed = pushed.load(std::memory_order_relaxed);
+        stats.popped = popped.load(std::memory_order_relaxed);
+        stats.rejected = rejected.load(std::memory_order_relaxed);
+        stats.overwritten = overwritten.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    template <typename T, bool MultiProducer>
+    size_t BoundedQueue<T, MultiProducer>::ClaimPush(size_t count, uint64_t& position)
+    {
+        position = head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            size_t free = 0;
+            while (free < count && free <= mask
+                && slots[(position + free) & mask].sequence.load(std::memory_order_acquire) == position + free)
+                free++;
+            if (free == 0)
+            {
+                // Full, unless another producer moved the head on
+                if (!MultiProducer)
+                    return 0;
+                auto current = head.load(std::memory_order_relaxed);
+                if (current == position)
+                    return 0;
+                position = current;
+                continue;
+            }
+            if (!MultiProducer)
+            {
+                head.store(position + free, std::memory_order_relaxed);
+                return free;
+            }
+            if (head.compare_exchange_weak(position, position + free, std::memory_order_relaxed))
+                return free;
+        }
+    }
+
+    template <typename T, bool MultiProducer>
+    size_t BoundedQueue<T, MultiProducer>::ClaimPop(size_t count, uint64_t& position)
+    {
+        // Producers claim slots from the tail too when overwriting
+        auto shared = overflow == QueueOverflow::OverwriteOldest;
+        position = tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            size_t filled = 0;
+            while (filled < count && filled <= mask
+                && slots[(position + filled) & mask].sequence.load(std::memory_order_acquire) == position + filled + 1)
+                filled++;
+            if (filled == 0)
+            {
+                if (!shared)
+                    return 0;
+                auto current = tail.load(std::memory_order_relaxed);
+                if (current == position)
+                    return 0;
+                position = current;
+                continue;
+            }
+            if (!shared)
+            {
+                tail.store(position + filled, std::memory_order_relaxed);
+                return filled;
+            }
+            if (tail.compare_exchange_weak(position, position + filled, std::memory_order_relaxed))
+                return filled;
+        }
+    }
+
+    template <typename T, bool MultiProducer>
+    void BoundedQueue<T, MultiProducer>::MakeRoom(uint64_t position)
+    {
+        // The slot at |position| is still held by the element a lap before
+        if (tail.load(std::memory_order_relaxed) + mask + 1 == position)
+        {
+            uint64_t oldest;
+            if (ClaimPop(1, oldest) == 1)
+            {
+                auto& slot = slots[oldest & mask];
+                slot.value = T();
+                slot.sequence.store(oldest + mask + 1, std::memory_order_release);
+                overwritten.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        // Being moved out, or already free once the head is read again
+        std::this_thread::yield();
+    }
+
+    // static
+    template <typename T, bool MultiProducer>
+    size_t BoundedQueue<T, MultiProducer>::RoundUpToPowerOfTwo(size_t value)
+    {
+        size_t power = 1;
+        while (power < value)
+            power <<= 1;
+        return power;
+    }
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_BOUNDED_QUEUE_H_
@@ -0,0 +1,344 @@
+#include "channel_media_relay.h"
+
+#include <algorithm>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const int kMaxBackoffLevel = 5;
+        const auto kInitialBackoff = std::chrono::seconds(1);
+    }  // namespace
+
+    ChannelMediaRelayManager::ChannelMediaRelayManager(ApplyFunction apply, StopFunction stop, PublishFunction publish)
+        : apply(std::move(apply)), stop(std::move(stop)), publish(std::move(publish))
+    {
+    }
+
+    ChannelMediaRelayManager::~ChannelMediaRelayManager()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_one();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    void ChannelMediaRelayManager::SetSource(const std::string& token, unsigned int uid)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        source.token = token;
+        source.uid = uid;
+        stats.changes++;
+        Touch(Clock::now() + kBatchWindow);
+    }
+
+    bool ChannelMediaRelayManager::SetDestination(const std::string& channelName, const std::string& token, unsigned int uid)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = destinations.find(channelName);
+        if (it == destinations.end())
+        {
+            if (destinations.size() == kMaxDestinations)
+                return false;
+            it = destinations.emplace(channelName, Destination()).first;
+            it->second.info.channelName = channelName;
+            published.push_back(it->second.info);
+        }
+        it->second.desired.token = token;
+        it->second.desired.uid = uid;
+        stats.changes++;
+        Touch(Clock::now() + kBatchWindow);
+        PublishPending(lock);
+        return true;
+    }
+
+    void ChannelMediaRelayManager::RemoveDestination(const std::string& channelName)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = destinations.find(channelName);
+        if (it == destinations.end())
+            return;
+        SetState(it->second, RelayDestinationState::Removed, 0);
+        destinations.erase(it);
+        stats.changes++;
+        Touch(Clock::now() + kBatchWindow);
+        PublishPending(lock);
+    }
+
+    void ChannelMediaRelayManager::RemoveAllDestinations()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (destinations.empty())
+            return;
+        for (auto& entry : destinations)
+            SetState(entry.second, RelayDestinationState::Removed, 0);
+        destinations.clear();
+        stats.changes++;
+        Touch(Clock::now() + kBatchWindow);
+        PublishPending(lock);
+    }
+
+    void ChannelMediaRelayManager::Reset()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // The SDK must not be called once this returns
+        condition.wait(lock, [this] { return !calling; });
+        source = Target();
+        destinations.clear();
+        applied.clear();
+        appliedSource = Target();
+        relaying = false;
+        restart = false;
+        scheduled = false;
+        expectedIdle = 0;
+        backoffLevel = 0;
+        published.clear();
+        stats = ChannelMediaRelayStats();
+    }
+
+    void ChannelMediaRelayManager::Resume()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!destinations.empty())
+            Touch(Clock::now());
+    }
+
+    void ChannelMediaRelayManager::OnStateChanged(agora::rtc::CHANNEL_MEDIA_RELAY_STATE state, agora::rtc::CHANNEL_MEDIA_RELAY_ERROR code)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        switch (state)
+        {
+        case agora::rtc::RELAY_STATE_RUNNING:
+            backoffLevel = 0;
+            for (auto& entry : destinations)
+            {
+                if (entry.second.info.state == RelayDestinationState::Connecting)
+                    SetState(entry.second, RelayDestinationState::Running, 0);
+            }
+            break;
+        case agora::rtc::RELAY_STATE_FAILURE:
+            for (auto& entry : destinations)
+                SetState(entry.second, RelayDestinationState::Failed, code);
+            restart = true;
+            ScheduleRetry(Clock::now());
+            break;
+        case agora::rtc::RELAY_STATE_IDLE:
+            // Our own stops end here too
+            if (expectedIdle > 0)
+            {
+                expectedIdle--;
+                break;
+            }
+            // Stopped by the SDK, e.g. on leaving the channel. Resume() starts
+            // it again.
+            relaying = false;
+            applied.clear();
+            for (auto& entry : destinations)
+                SetState(entry.second, RelayDestinationState::Pending, entry.second.info.error);
+            break;
+        default:
+            break;
+        }
+        PublishPending(lock);
+    }
+
+    void ChannelMediaRelayManager::OnEvent(agora::rtc::CHANNEL_MEDIA_RELAY_EVENT code)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (code == agora::rtc::RELAY_EVENT_PACKET_UPDATE_DEST_CHANNEL)
+        {
+            for (auto& entry : destinations)
+            {
+                if (entry.second.info.state == RelayDestinationState::Connecting)
+                    SetState(entry.second, RelayDestinationState::Running, 0);
+            }
+        }
+        else if (code == agora::rtc::RELAY_EVENT_PACKET_UPDATE_DEST_CHANNEL_REFUSED)
+        {
+            // Forget what was sent so that the retry sends it again
+            for (auto& entry : destinations)
+            {
+                if (entry.second.info.state != RelayDestinationState::Connecting)
+                    continue;
+                SetState(entry.second, RelayDestinationState::Failed, entry.second.info.error);
+                applied.erase(entry.first);
+            }
+            ScheduleRetry(Clock::now());
+        }
+        PublishPending(lock);
+    }
+
+    ChannelMediaRelayStats ChannelMediaRelayManager::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto result = stats;
+        for (auto& entry : destinations)
+            result.destinations.push_back(entry.second.info);
+        return result;
+    }
+
+    void ChannelMediaRelayManager::Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping)
+        {
+            if (!scheduled)
+            {
+                condition.wait(lock);
+                continue;
+            }
+            if (Clock::now() < flushAt)
+            {
+                condition.wait_until(lock, flushAt);
+                continue;
+            }
+            scheduled = false;
+            Reconcile(lock);
+            PublishPending(lock);
+        }
+    }
+
+    void ChannelMediaRelayManager::Reconcile(std::unique_lock<std::mutex>& lock)
+    {
+        auto stopRelay = [&] {
+            relaying = false;
+            applied.clear();
+            expectedIdle++;
+            stats.stops++;
+            calling = true;
+            lock.unlock();
+            stop();
+            lock.lock();
+            calling = false;
+            condition.notify_all();
+        };
+
+        if (restart)
+        {
+            restart = false;
+            if (relaying)
+                stopRelay();
+        }
+        if (destinations.empty())
+        {
+            if (relaying)
+                stopRelay();
+            return;
+        }
+
+        std::map<std::string, Target> desired;
+        for (auto& entry : destinations)
+            desired.emplace(entry.first, entry.second.desired);
+        if (relaying && desired == applied && source == appliedSource)
+            return;
+
+        // The configuration points into these copies while the lock is released
+        auto sourceTarget = source;
+        std::vector<std::string> names;
+        std::vector<agora::rtc::ChannelMediaInfo> infos;
+        for (auto& entry : desired)
+            names.push_back(entry.first);
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            auto& target = desired[names[i]];
+            agora::rtc::ChannelMediaInfo info;
+            info.channelName = names[i].c_str();
+            info.token = target.token.empty() ? nullptr : target.token.c_str();
+            info.uid = target.uid;
+            infos.push_back(info);
+        }
+        agora::rtc::ChannelMediaInfo sourceInfo;
+        sourceInfo.channelName = nullptr;
+        sourceInfo.token = sourceTarget.token.empty() ? nullptr : sourceTarget.token.c_str();
+        sourceInfo.uid = sourceTarget.uid;
+        agora::rtc::ChannelMediaRelayConfiguration configuration;
+        configuration.srcInfo = &sourceInfo;
+        configuration.destInfos = infos.data();
+        configuration.destCount = static_cast<int>(infos.size());
+
+        auto update = relaying;
+        if (update)
+            stats.updates++;
+        else
+            stats.starts++;
+        calling = true;
+        lock.unlock();
+        auto ret = apply(configuration, update);
+        lock.lock();
+        calling = false;
+        condition.notify_all();
+
+        if (ret != 0)
+        {
+            for (auto& entry : destinations)
+            {
+                auto it = applied.find(entry.first);
+                if (it == applied.end() || it->second != entry.second.desired)
+                    SetState(entry.second, RelayDestinationState::Failed, ret);
+            }
+            ScheduleRetry(Clock::now());
+            return;
+        }
+
+        for (auto& entry : destinations)
+        {
+            auto sent = desired.find(entry.first);
+            if (sent == desired.end())
+                continue;
+            auto it = applied.find(entry.first);
+            if (it == applied.end() || it->second != sent->second)
+                SetState(entry.second, RelayDestinationState::Connecting, 0);
+        }
+        relaying = true;
+        applied = std::move(desired);
+        appliedSource = sourceTarget;
+    }
+
+    void ChannelMediaRelayManager::Touch(Clock::time_point at)
+    {
+        if (!scheduled || at < flushAt)
+            flushAt = at;
+        scheduled = true;
+        if (!worker.joinable())
+            worker = std::thread([this] { Run(); });
+        else
+            condition.notify_one();
+    }
+
+    void ChannelMediaRelayManager::ScheduleRetry(Clock::time_point now)
+    {
+        auto delay = kInitialBackoff * (1 << backoffLevel);
+        backoffLevel = std::min(backoffLevel + 1, kMaxBackoffLevel);
+        stats.retries++;
+        for (auto& entry : destinations)
+        {
+            if (entry.second.info.state == RelayDestinationState::Failed)
+                entry.second.info.retries++;
+        }
+        Touch(now + delay);
+    }
+
+    void ChannelMediaRelayManager::SetState(Destination& destination, RelayDestinationState state, int error)
+    {
+        if (destination.info.state == state && destination.info.error == error)
+            return;
+        destination.info.state = state;
+        destination.info.error = error;
+        published.push_back(destination.info);
+    }
+
+    void ChannelMediaRelayManager::PublishPending(std::unique_lock<std::mutex>& lock)
+    {
+        if (published.empty())
+            return;
+        std::vector<RelayDestinationInfo> pending;
+        pending.swap(published);
+        lock.unlock();
+        for (auto& destination : pending)
+            publish(destination);
+        lock.lock();
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,167 @@
+#ifndef AGORA_RTC_ENGINE_CHANNEL_MEDIA_RELAY_H_
+#define AGORA_RTC_ENGINE_CHANNEL_MEDIA_RELAY_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IAgoraRtcEngine.h"
+
+namespace agora_rtc_engine {
+
+    enum class RelayDestinationState
+    {
+        // Waiting for the batching window or a retry.
+        Pending = 0,
+        // Sent to the SDK, not confirmed yet.
+        Connecting = 1,
+        Running = 2,
+        Failed = 3,
+        // Published once when a destination is dropped, then forgotten.
+        Removed = 4,
+    };
+
+    struct RelayDestinationInfo
+    {
+        std::string channelName;
+        RelayDestinationState state = RelayDestinationState::Pending;
+        // The last CHANNEL_MEDIA_RELAY_ERROR, or an SDK error code when negative.
+        int error = 0;
+        int retries = 0;
+    };
+
+    struct ChannelMediaRelayStats
+    {
+        std::vector<RelayDestinationInfo> destinations;
+        uint64_t changes = 0;
+        uint64_t starts = 0;
+        uint64_t updates = 0;
+        uint64_t stops = 0;
+        uint64_t retries = 0;
+    };
+
+    // Keeps the desired set of relay destination channels and reconciles the
+    // SDK with it.
+    //
+    // Changes made within kBatchWindow of the first one are merged into a
+    // single startChannelMediaRelay or updateChannelMediaRelay call, and
+    // nothing is called when the set ends up unchanged. Failed starts and
+    // refused updates are retried with exponential backoff. The state of each
+    // destination is published as it changes.
+    class ChannelMediaRelayManager
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Calls updateChannelMediaRelay when |update|, startChannelMediaRelay
+        // otherwise, and returns its result.
+        using ApplyFunction = std::function<int(const agora::rtc::ChannelMediaRelayConfiguration& configuration, bool update)>;
+        using StopFunction = std::function<int()>;
+        // Called on the relay thread or the SDK thread.
+        using PublishFunction = std::function<void(const RelayDestinationInfo& destination)>;
+
+        // The SDK relays to at most four channels.
+        static const size_t kMaxDestinations = 4;
+        static constexpr std::chrono::milliseconds kBatchWindow{100};
+
+        ChannelMediaRelayManager(ApplyFunction apply, StopFunction stop, PublishFunction publish);
+
+        ~ChannelMediaRelayManager();
+
+        // Prevent copying
+        ChannelMediaRelayManager(ChannelMediaRelayManager const&) = delete;
+        ChannelMediaRelayManager& operator=(ChannelMediaRelayManager const&) = delete;
+
+        // The token and uid of the source channel, the defaults use those of
+        // the current channel.
+        void SetSource(const std::string& token, unsigned int uid);
+
+        // Adds a destination or changes its token or uid. Returns false if
+        // there are already kMaxDestinations.
+        bool SetDestination(const std::string& channelName, const std::string& token, unsigned int uid);
+
+        void RemoveDestination(const std::string& channelName);
+
+        // Removes every destination, which stops the relay.
+        void RemoveAllDestinations();
+
+        // Forgets everything without calling the SDK again, e.g. before the
+        // engine is released. Waits for a call in progress.
+        void Reset();
+
+        // Reapplies the destinations, e.g. after joining a channel again.
+        void Resume();
+
+        void OnStateChanged(agora::rtc::CHANNEL_MEDIA_RELAY_STATE state, agora::rtc::CHANNEL_MEDIA_RELAY_ERROR code);
+
+        void OnEvent(agora::rtc::CHANNEL_MEDIA_RELAY_EVENT code);
+
+        ChannelMediaRelayStats GetStats() const;
+
+    private:
+        struct Target
+        {
+            std::string token;
+            unsigned int uid = 0;
+
+            bool operator==(const Target& other) const { return token == other.token && uid == other.uid; }
+            bool operator!=(const Target& other) const { return !(*this == other); }
+        };
+
+        struct Destination
+        {
+            Target desired;
+            RelayDestinationInfo info;
+        };
+
+        void Run();
+
+        // Applies the desired set if it differs from the applied one.
+        void Reconcile(std::unique_lock<std::mutex>& lock);
+
+        // Schedules a flush, called with |mutex| held.
+        void Touch(Clock::time_point at);
+
+        void ScheduleRetry(Clock::time_point now);
+
+        // Called with |mutex| held, publishes outside of it later.
+        void SetState(Destination& destination, RelayDestinationState state, int error);
+
+        void PublishPending(std::unique_lock<std::mutex>& lock);
+
+        ApplyFunction apply;
+        StopFunction stop;
+        PublishFunction publish;
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        Target source;
+        std::map<std::string, Destination> destinations;
+        // What the SDK was last given, empty while the relay is stopped.
+        std::map<std::string, Target> applied;
+        Target appliedSource;
+        bool relaying = false;
+        // Stop and start again on the next flush, after a relay failure.
+        bool restart = false;
+        // IDLE states caused by our own stops, which are not a stop by the SDK.
+        int expectedIdle = 0;
+        bool scheduled = false;
+        Clock::time_point flushAt;
+        int backoffLevel = 0;
+        std::vector<RelayDestinationInfo> published;
+        ChannelMediaRelayStats stats;
+        // Whether the relay thread is calling the SDK.
+        bool calling = false;
+        bool stopping = false;
+
+        std::thread worker;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_CHANNEL_MEDIA_RELAY_H_
@@ -0,0 +1,224 @@
+#include "channel_switcher.h"
+
+#include <algorithm>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // CHANNEL_PROFILE_TYPE and CLIENT_ROLE_TYPE values
+        const int kProfileLiveBroadcasting = 1;
+        const int kRoleAudience = 2;
+    }  // namespace
+
+    ChannelSwitcher::ChannelSwitcher(SwitchFunction switchChannel, LeaveFunction leave, JoinFunction join)
+        : switchChannel(std::move(switchChannel)), leave(std::move(leave)), join(std::move(join))
+    {
+    }
+
+    void ChannelSwitcher::SetChannelProfile(int newProfile)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        profile = newProfile;
+    }
+
+    void ChannelSwitcher::SetClientRole(int newRole)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        role = newRole;
+    }
+
+    uint64_t ChannelSwitcher::Start(const std::string& channelId, const std::string& newToken, Clock::time_point newRequested, DoneFunction newDone)
+    {
+        uint64_t id;
+        bool inChannel;
+        bool trySwitch;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (state != State::Idle)
+                return 0;
+            id = ++lastId;
+            current = ChannelSwitchResult();
+            current.id = id;
+            current.fromChannel = channel;
+            current.toChannel = channelId;
+            current.tokenMs = MillisBetween(newRequested, Clock::now());
+            token = newToken;
+            requested = newRequested;
+            done = std::move(newDone);
+            switches++;
+            inChannel = !channel.empty();
+            trySwitch = inChannel && profile == kProfileLiveBroadcasting && role == kRoleAudience;
+            current.mode = trySwitch ? ChannelSwitchMode::Switch : ChannelSwitchMode::Rejoin;
+            state = trySwitch || !inChannel ? State::Joining : State::Leaving;
+        }
+
+        if (trySwitch)
+        {
+            if (switchChannel(newToken, channelId) == 0)
+                return id;
+            // Not an audience after all, e.g. the role changed in the SDK
+            std::lock_guard<std::mutex> lock(mutex);
+            if (state == State::Idle || current.id != id)
+                return id;
+            current.mode = ChannelSwitchMode::Rejoin;
+            state = State::Leaving;
+        }
+        if (!inChannel)
+        {
+            join(id, newToken, channelId);
+            return id;
+        }
+
+        auto error = leave();
+        if (error != 0)
+            OnFailed(id, error);
+        return id;
+    }
+
+    bool ChannelSwitcher::OnTimeout(uint64_t id)
+    {
+        DoneFunction callback;
+        ChannelSwitchResult result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (state == State::Idle || current.id != id)
+                return false;
+            // An empty channel has no frames to wait for
+            auto joined = state == State::Receiving;
+            if (joined)
+                withoutFrames++;
+            callback = Complete(joined, 0, result);
+        }
+        if (callback)
+            callback(result);
+        return true;
+    }
+
+    void ChannelSwitcher::OnFailed(uint64_t id, int error)
+    {
+        DoneFunction callback;
+        ChannelSwitchResult result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (state == State::Idle || current.id != id)
+                return;
+            callback = Complete(false, error, result);
+        }
+        if (callback)
+            callback(result);
+    }
+
+    void ChannelSwitcher::OnJoinChannelSuccess(const std::string& channelId, Clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        channel = channelId;
+        if (state == State::Joining && channelId == current.toChannel)
+        {
+            current.joinedMs = MillisBetween(requested, now);
+            state = State::Receiving;
+        }
+    }
+
+    void ChannelSwitcher::OnLeaveChannel(Clock::time_point now)
+    {
+        std::string joinToken;
+        std::string joinChannel;
+        uint64_t id = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            channel.clear();
+            if (state != State::Leaving && !(state == State::Joining && current.mode == ChannelSwitchMode::Switch))
+                return;
+            current.leftMs = MillisBetween(requested, now);
+            if (state == State::Joining)
+                return;
+            state = State::Joining;
+            id = current.id;
+            joinToken = token;
+            joinChannel = current.toChannel;
+        }
+        join(id, joinToken, joinChannel);
+    }
+
+    void ChannelSwitcher::OnFirstRemoteFrame(Clock::time_point now)
+    {
+        DoneFunction callback;
+        ChannelSwitchResult result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (state != State::Receiving)
+                return;
+            current.firstFrameMs = MillisBetween(requested, now);
+            callback = Complete(true, 0, result);
+        }
+        if (callback)
+            callback(result);
+    }
+
+    void ChannelSwitcher::Reset()
+    {
+        DoneFunction callback;
+        ChannelSwitchResult result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            channel.clear();
+            if (state != State::Idle)
+                callback = Complete(false, 0, result);
+        }
+        if (callback)
+            callback(result);
+    }
+
+    ChannelSwitchStats ChannelSwitcher::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ChannelSwitchStats stats;
+        stats.switches = switches;
+        stats.switched = switched;
+        stats.rejoined = rejoined;
+        stats.failures = failures;
+        stats.withoutFrames = withoutFrames;
+        if (joinedCount > 0)
+            stats.meanJoinedMs = joinedMs / static_cast<int64_t>(joinedCount);
+        auto withFrames = switched + rejoined - withoutFrames;
+        if (withFrames > 0)
+            stats.meanFirstFrameMs = firstFrameMs / static_cast<int64_t>(withFrames);
+        stats.maxFirstFrameMs = maxFirstFrameMs;
+        return stats;
+    }
+
+    ChannelSwitcher::DoneFunction ChannelSwitcher::Complete(bool ok, int error, ChannelSwitchResult& result)
+    {
+        current.ok = ok;
+        current.error = error;
+        if (!ok)
+        {
+            failures++;
+        }
+        else
+        {
+            if (current.mode == ChannelSwitchMode::Switch)
+                switched++;
+            else
+                rejoined++;
+            joinedMs += current.joinedMs;
+            joinedCount++;
+            if (current.firstFrameMs >= 0)
+            {
+                firstFrameMs += current.firstFrameMs;
+                maxFirstFrameMs = std::max(maxFirstFrameMs, current.firstFrameMs);
+            }
+        }
+        state = State::Idle;
+        token.clear();
+        result = current;
+        return std::move(done);
+    }
+
+    // static
+    int64_t ChannelSwitcher::MillisBetween(Clock::time_point from, Clock::time_point to)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+    }
+
+}  // namespace agora_rtc_engine
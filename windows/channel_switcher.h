@@ -0,0 +1,152 @@
+#ifndef AGORA_RTC_ENGINE_CHANNEL_SWITCHER_H_
+#define AGORA_RTC_ENGINE_CHANNEL_SWITCHER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace agora_rtc_engine {
+
+    enum class ChannelSwitchMode
+    {
+        // switchChannel, for the audience of a live broadcast
+        Switch = 0,
+        // leaveChannel, then joinChannel once left
+        Rejoin = 1,
+    };
+
+    struct ChannelSwitchResult
+    {
+        uint64_t id = 0;
+        std::string fromChannel;
+        std::string toChannel;
+        ChannelSwitchMode mode = ChannelSwitchMode::Switch;
+        bool ok = false;
+        // The failed SDK call's error code, 0 if it timed out.
+        int error = 0;
+        // From the request to the token being available, to having left the
+        // previous channel, to having joined the new one and to the first
+        // remote audio or video frame. -1 when it did not happen.
+        int64_t tokenMs = 0;
+        int64_t leftMs = -1;
+        int64_t joinedMs = -1;
+        int64_t firstFrameMs = -1;
+    };
+
+    struct ChannelSwitchStats
+    {
+        uint64_t switches = 0;
+        // Completed with switchChannel, the others rejoined.
+        uint64_t switched = 0;
+        uint64_t rejoined = 0;
+        uint64_t failures = 0;
+        // Joined, without a remote frame before the timeout.
+        uint64_t withoutFrames = 0;
+        int64_t meanJoinedMs = 0;
+        int64_t meanFirstFrameMs = 0;
+        int64_t maxFirstFrameMs = 0;
+    };
+
+    // Moves the engine from one channel to another without releasing it, so
+    // that the audio, video and encoder configuration and the capture devices
+    // stay as they are.
+    //
+    // The audience of a live broadcast switches with switchChannel, in a
+    // single call. Other roles, and audiences the SDK refuses to switch,
+    // leave and join again as soon as onLeaveChannel confirms it. A switch is
+    // done at the first remote frame, or when the timeout passes with none.
+    class ChannelSwitcher
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Returns an SDK error code.
+        using SwitchFunction = std::function<int(const std::string& token, const std::string& channelId)>;
+        using LeaveFunction = std::function<int()>;
+        // Called on the SDK thread, a failed call is reported with OnFailed.
+        using JoinFunction = std::function<void(uint64_t id, const std::string& token, const std::string& channelId)>;
+        // Called on the SDK thread or the one that completed the switch.
+        using DoneFunction = std::function<void(const ChannelSwitchResult& result)>;
+
+        ChannelSwitcher(SwitchFunction switchChannel, LeaveFunction leave, JoinFunction join);
+
+        // Prevent copying
+        ChannelSwitcher(ChannelSwitcher const&) = delete;
+        ChannelSwitcher& operator=(ChannelSwitcher const&) = delete;
+
+        // CHANNEL_PROFILE_TYPE and CLIENT_ROLE_TYPE, as set on the engine.
+        void SetChannelProfile(int profile);
+        void SetClientRole(int role);
+
+        // Starts switching to |channelId| with |token|, requested at
+        // |requested| and before the token was acquired. Returns the switch
+        // id, or 0 if one is in progress.
+        uint64_t Start(const std::string& channelId, const std::string& token, Clock::time_point requested, DoneFunction done);
+
+        // Ends switch |id| if it is still in progress. Returns false if it
+        // was not.
+        bool OnTimeout(uint64_t id);
+
+        // Fails switch |id| with the SDK's |error|.
+        void OnFailed(uint64_t id, int error);
+
+        void OnJoinChannelSuccess(const std::string& channelId, Clock::time_point now);
+
+        void OnLeaveChannel(Clock::time_point now);
+
+        void OnFirstRemoteFrame(Clock::time_point now);
+
+        // Fails the switch in progress and forgets the channel, e.g. when the
+        // engine is released.
+        void Reset();
+
+        ChannelSwitchStats GetStats() const;
+
+    private:
+        enum class State
+        {
+            Idle,
+            Leaving,
+            Joining,
+            // Joined, waiting for the first remote frame
+            Receiving,
+        };
+
+        // Ends the switch in progress, called with |mutex| held. Returns the
+        // function to call with the result, outside of the lock.
+        DoneFunction Complete(bool ok, int error, ChannelSwitchResult& result);
+
+        static int64_t MillisBetween(Clock::time_point from, Clock::time_point to);
+
+        SwitchFunction switchChannel;
+        LeaveFunction leave;
+        JoinFunction join;
+
+        mutable std::mutex mutex;
+        int profile = 0;
+        int role = 0;
+        // The channel the engine is in, empty when none.
+        std::string channel;
+
+        State state = State::Idle;
+        uint64_t lastId = 0;
+        ChannelSwitchResult current;
+        std::string token;
+        Clock::time_point requested;
+        DoneFunction done;
+
+        uint64_t switches = 0;
+        uint64_t switched = 0;
+        uint64_t rejoined = 0;
+        uint64_t failures = 0;
+        uint64_t withoutFrames = 0;
+        int64_t joinedMs = 0;
+        uint64_t joinedCount = 0;
+        int64_t firstFrameMs = 0;
+        int64_t maxFirstFrameMs = 0;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_CHANNEL_SWITCHER_H_
@@ -0,0 +1,330 @@
+#include "data_stream_transport.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "lz4_block.h"
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const uint8_t kMagic = 0xa7;
+        const size_t kRecordHeaderSize = 5;
+
+        const uint8_t kFirstFragment = 1;
+        const uint8_t kLastFragment = 2;
+        const uint8_t kCompressed = 4;
+
+        // Smaller messages rarely shrink.
+        const size_t kMinCompressSize = 64;
+        // A fragment smaller than this goes into the next packet instead.
+        const size_t kMinFragmentSize = 64;
+        // Bounds the memory a sender can make us hold.
+        const size_t kMaxMessageSize = 16 * 1024 * 1024;
+
+        // Between attempts to send a packet that failed, doubling each time
+        const std::chrono::milliseconds kMinRetryDelay(50);
+        const std::chrono::milliseconds kMaxRetryDelay(2000);
+
+        void Store16(uint8_t* p, size_t value)
+        {
+            p[0] = static_cast<uint8_t>(value);
+            p[1] = static_cast<uint8_t>(value >> 8);
+        }
+
+        uint16_t Load16(const uint8_t* p)
+        {
+            return static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+    }  // namespace
+
+    DataStreamTransport::DataStreamTransport(const DataTransportOptions& options, SendFunction send, DeliverFunction deliver)
+        : options(options), send(std::move(send)), deliver(std::move(deliver)), opened(Clock::now())
+    {
+        lastRefill = opened;
+        retryDelay = kMinRetryDelay;
+        packet.reserve(kMaxPacketSize);
+        pacer = std::thread([this] { Run(); });
+    }
+
+    DataStreamTransport::~DataStreamTransport()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_one();
+        pacer.join();
+    }
+
+    bool DataStreamTransport::Send(std::vector<uint8_t> message)
+    {
+        Outgoing outgoing;
+        outgoing.originalSize = message.size();
+        if (options.compress && message.size() >= kMinCompressSize)
+        {
+            std::vector<uint8_t> compressed(4 + Lz4CompressBound(message.size()));
+            auto size = static_cast<uint32_t>(message.size());
+            std::memcpy(compressed.data(), &size, 4);
+            compressed.resize(4 + Lz4Compress(message.data(), message.size(), compressed.data() + 4));
+            if (compressed.size() < message.size())
+            {
+                message = std::move(compressed);
+                outgoing.compressed = true;
+            }
+        }
+        outgoing.data = std::move(message);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queuedBytes + outgoing.data.size() > options.maxQueueBytes)
+            {
+                rejectedMessages++;
+                return false;
+            }
+            outgoing.id = nextId++;
+            queuedBytes += outgoing.data.size();
+            queue.push_back(std::move(outgoing));
+        }
+        condition.notify_one();
+        return true;
+    }
+
+    bool DataStreamTransport::OnStreamMessage(unsigned int uid, const uint8_t* data, size_t size)
+    {
+        if (size == 0 || data[0] != kMagic)
+            return false;
+
+        std::lock_guard<std::mutex> lock(receiveMutex);
+        auto& message = incoming[uid];
+        size_t offset = 1;
+        while (offset < size)
+        {
+            if (size - offset < kRecordHeaderSize)
+            {
+                droppedMessages++;
+                message.active = false;
+                break;
+            }
+            auto flags = data[offset];
+            auto id = Load16(data + offset + 1);
+            size_t length = Load16(data + offset + 3);
+            offset += kRecordHeaderSize;
+            if (length > size - offset)
+            {
+                droppedMessages++;
+                message.active = false;
+                break;
+            }
+
+            if (flags & kFirstFragment)
+            {
+                if (message.active)
+                    droppedMessages++;
+                message.active = true;
+                message.id = id;
+                message.compressed = (flags & kCompressed) != 0;
+                message.data.clear();
+            }
+            else if (!message.active || message.id != id)
+            {
+                // The start of this message was lost
+                if (message.active)
+                    droppedMessages++;
+                message.active = false;
+                offset += length;
+                continue;
+            }
+
+            if (message.data.size() + length > kMaxMessageSize)
+            {
+                droppedMessages++;
+                message.active = false;
+                offset += length;
+                continue;
+            }
+            message.data.insert(message.data.end(), data + offset, data + offset + length);
+            offset += length;
+
+            if (flags & kLastFragment)
+            {
+                message.active = false;
+                Deliver(uid, message);
+            }
+        }
+        return true;
+    }
+
+    void DataStreamTransport::RemoveUser(unsigned int uid)
+    {
+        std::lock_guard<std::mutex> lock(receiveMutex);
+        incoming.erase(uid);
+    }
+
+    DataTransportStats DataStreamTransport::GetStats() const
+    {
+        DataTransportStats stats;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.queuedMessages = queue.size();
+            stats.queuedBytes = queuedBytes;
+        }
+        stats.sentMessages = sentMessages;
+        stats.sentPackets = sentPackets;
+        stats.sentBytes = sentBytes;
+        stats.payloadBytes = payloadBytes;
+        stats.rejectedMessages = rejectedMessages;
+        stats.failedPackets = failedPackets;
+        stats.receivedMessages = receivedMessages;
+        stats.receivedBytes = receivedBytes;
+        stats.droppedMessages = droppedMessages;
+        auto seconds = std::chrono::duration<double>(Clock::now() - opened).count();
+        if (seconds > 0)
+            stats.throughput = static_cast<double>(stats.payloadBytes) / seconds;
+        return stats;
+    }
+
+    void DataStreamTransport::Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping)
+        {
+            lock.unlock();
+            auto wait = Pump(Clock::now());
+            lock.lock();
+            if (stopping)
+                break;
+            if (wait == Clock::duration::max())
+                condition.wait(lock, [this] { return stopping || !queue.empty(); });
+            else
+                condition.wait_for(lock, wait);
+        }
+    }
+
+    DataStreamTransport::Clock::duration DataStreamTransport::Pump(Clock::time_point now)
+    {
+        // Allow a quarter of a second of burst, but at least one full packet
+        auto packetBurst = std::max(1.0, options.packetsPerSecond / 4);
+        auto byteBurst = std::max(static_cast<double>(kMaxPacketSize), options.bytesPerSecond / 4);
+        auto elapsed = std::chrono::duration<double>(now - lastRefill).count();
+        lastRefill = now;
+        packetTokens = std::min(packetBurst, packetTokens + elapsed * options.packetsPerSecond);
+        byteTokens = std::min(byteBurst, byteTokens + elapsed * options.bytesPerSecond);
+
+        while (true)
+        {
+            if (packetTokens < 1)
+                return std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>((1 - packetTokens) / options.packetsPerSecond));
+
+            if (retrying)
+            {
+                if (byteTokens < static_cast<double>(packet.size()))
+                    return std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>((static_cast<double>(packet.size()) - byteTokens) / options.bytesPerSecond));
+            }
+            else
+            {
+                auto capacity = std::min(kMaxPacketSize, static_cast<size_t>(byteTokens));
+                std::lock_guard<std::mutex> lock(mutex);
+                if (queue.empty())
+                    return Clock::duration::max();
+                // Wait for enough budget to send the whole head of the queue
+                // or at least a fragment worth sending.
+                auto remaining = queue.front().data.size() - queue.front().offset;
+                auto needed = 1 + kRecordHeaderSize + std::min(remaining, kMinFragmentSize);
+                if (capacity < needed)
+                    return std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>((static_cast<double>(needed) - byteTokens) / options.bytesPerSecond));
+                BuildPacket(capacity, packet);
+            }
+
+            packetTokens -= 1;
+            byteTokens -= static_cast<double>(packet.size());
+            if (!send(packet.data(), packet.size()))
+            {
+                // The fragments in it must arrive before any later ones
+                failedPackets++;
+                retrying = true;
+                auto wait = retryDelay;
+                retryDelay = std::min<Clock::duration>(retryDelay * 2, kMaxRetryDelay);
+                return wait;
+            }
+            retrying = false;
+            retryDelay = kMinRetryDelay;
+            sentPackets++;
+            sentBytes += packet.size();
+        }
+    }
+
+    void DataStreamTransport::BuildPacket(size_t capacity, std::vector<uint8_t>& out)
+    {
+        out.clear();
+        out.push_back(kMagic);
+        while (!queue.empty() && out.size() + kRecordHeaderSize <= capacity)
+        {
+            auto& message = queue.front();
+            auto remaining = message.data.size() - message.offset;
+            auto room = capacity - out.size() - kRecordHeaderSize;
+            if (room < remaining && room < kMinFragmentSize && out.size() > 1)
+                break;
+
+            auto chunk = std::min(remaining, room);
+            uint8_t flags = message.compressed ? kCompressed : 0;
+            if (message.offset == 0)
+                flags |= kFirstFragment;
+            if (message.offset + chunk == message.data.size())
+                flags |= kLastFragment;
+
+            auto offset = out.size();
+            out.resize(offset + kRecordHeaderSize + chunk);
+            out[offset] = flags;
+            Store16(out.data() + offset + 1, message.id);
+            Store16(out.data() + offset + 3, chunk);
+            if (chunk > 0)
+                std::memcpy(out.data() + offset + kRecordHeaderSize, message.data.data() + message.offset, chunk);
+            message.offset += chunk;
+            queuedBytes -= chunk;
+
+            if (message.offset < message.data.size())
+                break;
+            sentMessages++;
+            payloadBytes += message.originalSize;
+            queue.pop_front();
+        }
+    }
+
+    void DataStreamTransport::Deliver(unsigned int uid, Incoming& message)
+    {
+        std::vector<uint8_t> data;
+        if (message.compressed)
+        {
+            uint32_t size = 0;
+            if (message.data.size() < 4)
+            {
+                droppedMessages++;
+                return;
+            }
+            std::memcpy(&size, message.data.data(), 4);
+            if (size > kMaxMessageSize)
+            {
+                droppedMessages++;
+                return;
+            }
+            data.resize(size);
+            if (!Lz4Decompress(message.data.data() + 4, message.data.size() - 4, data.data(), size))
+            {
+                droppedMessages++;
+                return;
+            }
+        }
+        else
+        {
+            data.swap(message.data);
+        }
+        receivedMessages++;
+        receivedBytes += data.size();
+        deliver(uid, std::move(data));
+    }
+
+}  // namespace agora_rtc_engine
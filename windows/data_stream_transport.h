@@ -0,0 +1,163 @@
+#ifndef AGORA_RTC_ENGINE_DATA_STREAM_TRANSPORT_H_
+#define AGORA_RTC_ENGINE_DATA_STREAM_TRANSPORT_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace agora_rtc_engine {
+
+    struct DataTransportOptions
+    {
+        // Compress messages with LZ4 when it makes them smaller.
+        bool compress = true;
+        // sendStreamMessage quotas: 30 packets and 6 KB per second.
+        double packetsPerSecond = 30;
+        double bytesPerSecond = 6 * 1024;
+        // Send() is rejected beyond this many bytes waiting to be sent.
+        size_t maxQueueBytes = 1024 * 1024;
+    };
+
+    struct DataTransportStats
+    {
+        uint64_t queuedMessages = 0;
+        uint64_t queuedBytes = 0;
+        uint64_t sentMessages = 0;
+        uint64_t sentPackets = 0;
+        // Bytes handed to sendStreamMessage, and the messages they carried
+        // before compression.
+        uint64_t sentBytes = 0;
+        uint64_t payloadBytes = 0;
+        uint64_t rejectedMessages = 0;
+        // sendStreamMessage failures, each followed by sending the same
+        // packet again.
+        uint64_t failedPackets = 0;
+        uint64_t receivedMessages = 0;
+        uint64_t receivedBytes = 0;
+        // Incoming messages lost to missing fragments or bad data.
+        uint64_t droppedMessages = 0;
+        // Payload bytes per second since the transport was opened.
+        double throughput = 0;
+    };
+
+    // Sends messages of any size over one reliable, ordered data stream.
+    //
+    // Messages are queued and a pacing thread packs them into stream packets
+    // of at most kMaxPacketSize bytes: small messages are batched into one
+    // packet, large ones are fragmented. Two token buckets keep the packet and
+    // byte rates within the sendStreamMessage quotas. A packet that fails to
+    // send is sent again, with a growing delay, before anything after it, so
+    // that no fragment is lost while the transport is open.
+    //
+    // Packet layout: a magic byte, then records of
+    // [flags:1][message id:2][length:2][payload], little endian. The first
+    // fragment of a compressed message starts with its original size.
+    class DataStreamTransport
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Sends one packet, returns false on failure.
+        using SendFunction = std::function<bool(const uint8_t* data, size_t size)>;
+        // Receives a reassembled message, on the thread calling OnStreamMessage.
+        using DeliverFunction = std::function<void(unsigned int uid, std::vector<uint8_t> message)>;
+
+        static constexpr size_t kMaxPacketSize = 1024;
+
+        DataStreamTransport(const DataTransportOptions& options, SendFunction send, DeliverFunction deliver);
+
+        // Stops the pacing thread, dropping what is still queued.
+        ~DataStreamTransport();
+
+        // Prevent copying
+        DataStreamTransport(DataStreamTransport const&) = delete;
+        DataStreamTransport& operator=(DataStreamTransport const&) = delete;
+
+        // Queues a message, returns false if the queue is full.
+        bool Send(std::vector<uint8_t> message);
+
+        // Handles a packet from onStreamMessage. Returns false if it was not
+        // sent by a DataStreamTransport.
+        bool OnStreamMessage(unsigned int uid, const uint8_t* data, size_t size);
+
+        // Drops the partially received message of |uid|.
+        void RemoveUser(unsigned int uid);
+
+        DataTransportStats GetStats() const;
+
+    private:
+        struct Outgoing
+        {
+            std::vector<uint8_t> data;
+            size_t offset = 0;
+            size_t originalSize = 0;
+            uint16_t id = 0;
+            bool compressed = false;
+        };
+
+        struct Incoming
+        {
+            bool active = false;
+            uint16_t id = 0;
+            bool compressed = false;
+            std::vector<uint8_t> data;
+        };
+
+        void Run();
+
+        // Sends what the token buckets allow. Returns how long to wait before
+        // the next call, or Clock::duration::max() when the queue is empty.
+        Clock::duration Pump(Clock::time_point now);
+
+        // Fills |packet| from the head of the queue with at most |capacity|
+        // bytes. Called with |mutex| held.
+        void BuildPacket(size_t capacity, std::vector<uint8_t>& packet);
+
+        void Deliver(unsigned int uid, Incoming& message);
+
+        DataTransportOptions options;
+        SendFunction send;
+        DeliverFunction deliver;
+        Clock::time_point opened;
+
+        // Owned by the pacing thread
+        double packetTokens = 0;
+        double byteTokens = 0;
+        Clock::time_point lastRefill;
+        std::vector<uint8_t> packet;
+        // Whether |packet| failed to send and is to be sent again
+        bool retrying = false;
+        Clock::duration retryDelay;
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Outgoing> queue;
+        size_t queuedBytes = 0;
+        uint16_t nextId = 0;
+        bool stopping = false;
+
+        std::mutex receiveMutex;
+        std::unordered_map<unsigned int, Incoming> incoming;
+
+        std::atomic<uint64_t> sentMessages{0};
+        std::atomic<uint64_t> sentPackets{0};
+        std::atomic<uint64_t> sentBytes{0};
+        std::atomic<uint64_t> payloadBytes{0};
+        std::atomic<uint64_t> rejectedMessages{0};
+        std::atomic<uint64_t> failedPackets{0};
+        std::atomic<uint64_t> receivedMessages{0};
+        std::atomic<uint64_t> receivedBytes{0};
+        std::atomic<uint64_t> droppedMessages{0};
+
+        std::thread pacer;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_DATA_STREAM_TRANSPORT_H_
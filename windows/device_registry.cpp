@@ -0,0 +1,233 @@
+#include "device_registry.h"
+
+// The enumeration calls use COM on the calling thread.
+#include <windows.h>
+
+#include <algorithm>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // Unplugging a headset raises several notifications in a row.
+        const auto kSettleDelay = std::chrono::milliseconds(250);
+
+        const unsigned int kAllKinds = (1u << kDeviceKindCount) - 1;
+
+        // Copies the devices of a collection, then releases it.
+        template <typename T>
+        bool ReadCollection(T* collection, const std::string& current, std::vector<DeviceInfo>& devices)
+        {
+            if (collection == nullptr)
+                return false;
+            char name[agora::rtc::MAX_DEVICE_ID_LENGTH];
+            char id[agora::rtc::MAX_DEVICE_ID_LENGTH];
+            auto count = collection->getCount();
+            for (int i = 0; i < count; ++i)
+            {
+                name[0] = id[0] = '\0';
+                if (collection->getDevice(i, name, id) != 0)
+                    continue;
+                DeviceInfo device;
+                device.id = id;
+                device.name = name;
+                device.isDefault = device.id == current;
+                devices.push_back(std::move(device));
+            }
+            collection->release();
+            return true;
+        }
+
+        const DeviceInfo* Find(const std::vector<DeviceInfo>& devices, const std::string& id)
+        {
+            auto it = std::find_if(devices.begin(), devices.end(), [&id](const DeviceInfo& device) {
+                return device.id == id;
+            });
+            return it != devices.end() ? &*it : nullptr;
+        }
+    }  // namespace
+
+    DeviceRegistry::DeviceRegistry(ChangeFunction publish)
+        : publish(std::move(publish))
+    {
+    }
+
+    DeviceRegistry::~DeviceRegistry()
+    {
+        Stop();
+    }
+
+    void DeviceRegistry::Start(agora::rtc::IRtcEngine* engine)
+    {
+        Stop();
+        std::lock_guard<std::mutex> lock(mutex);
+        this->engine = engine;
+        running = true;
+        pending = kAllKinds;
+        refreshAt = Clock::now();
+        worker = std::thread([this] { Run(); });
+    }
+
+    void DeviceRegistry::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running)
+                return;
+            running = false;
+        }
+        condition.notify_one();
+        worker.join();
+
+        std::vector<DevicesFunction> waiting;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            engine = nullptr;
+            pending = 0;
+            for (auto& cache : caches)
+            {
+                for (auto& callback : cache.waiting)
+                    waiting.push_back(std::move(callback));
+                cache = Cache();
+            }
+        }
+        // Answer the waiting queries rather than dropping them
+        for (auto& callback : waiting)
+            callback(std::vector<DeviceInfo>());
+    }
+
+    void DeviceRegistry::Refresh(DeviceKind kind)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+            return;
+        refreshAt = Clock::now() + kSettleDelay;
+        pending |= 1u << static_cast<int>(kind);
+        condition.notify_one();
+    }
+
+    void DeviceRegistry::RefreshAll()
+    {
+        for (int i = 0; i < kDeviceKindCount; ++i)
+            Refresh(static_cast<DeviceKind>(i));
+    }
+
+    void DeviceRegistry::GetDevices(DeviceKind kind, DevicesFunction callback)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto& cache = caches[static_cast<int>(kind)];
+        if (running && !cache.ready)
+        {
+            cache.waiting.push_back(std::move(callback));
+            return;
+        }
+        auto devices = cache.devices;
+        lock.unlock();
+        callback(devices);
+    }
+
+    void DeviceRegistry::Run()
+    {
+        auto initialized = SUCCEEDED(::CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running)
+        {
+            if (pending == 0)
+            {
+                condition.wait(lock);
+                continue;
+            }
+            if (Clock::now() < refreshAt)
+            {
+                condition.wait_until(lock, refreshAt);
+                continue;
+            }
+            auto kinds = pending;
+            pending = 0;
+            lock.unlock();
+
+            std::vector<DeviceChange> changes;
+            for (int i = 0; i < kDeviceKindCount; ++i)
+            {
+                if ((kinds & (1u << i)) == 0)
+                    continue;
+                auto kind = static_cast<DeviceKind>(i);
+                std::vector<DeviceInfo> devices;
+                auto success = Enumerate(kind, devices);
+
+                std::vector<DevicesFunction> waiting;
+                {
+                    std::lock_guard<std::mutex> cacheLock(mutex);
+                    auto& cache = caches[i];
+                    if (success)
+                    {
+                        if (cache.seeded)
+                            Diff(kind, cache.devices, devices, changes);
+                        cache.devices = devices;
+                        cache.seeded = true;
+                    }
+                    cache.ready = true;
+                    waiting.swap(cache.waiting);
+                }
+                for (auto& callback : waiting)
+                    callback(devices);
+            }
+            if (!changes.empty())
+                publish(changes);
+            lock.lock();
+        }
+        lock.unlock();
+        if (initialized)
+            ::CoUninitialize();
+    }
+
+    bool DeviceRegistry::Enumerate(DeviceKind kind, std::vector<DeviceInfo>& devices)
+    {
+        char current[agora::rtc::MAX_DEVICE_ID_LENGTH] = {};
+        if (kind == DeviceKind::Video)
+        {
+            agora::rtc::AVideoDeviceManager manager(engine);
+            if (!manager)
+                return false;
+            manager->getDevice(current);
+            return ReadCollection(manager->enumerateVideoDevices(), current, devices);
+        }
+
+        agora::rtc::AAudioDeviceManager manager(engine);
+        if (!manager)
+            return false;
+        if (kind == DeviceKind::Playback)
+        {
+            manager->getPlaybackDevice(current);
+            return ReadCollection(manager->enumeratePlaybackDevices(), current, devices);
+        }
+        manager->getRecordingDevice(current);
+        return ReadCollection(manager->enumerateRecordingDevices(), current, devices);
+    }
+
+    // static
+    void DeviceRegistry::Diff(DeviceKind kind, const std::vector<DeviceInfo>& before, const std::vector<DeviceInfo>& after,
+        std::vector<DeviceChange>& changes)
+    {
+        auto add = [&](DeviceChangeType type, const DeviceInfo& device) {
+            DeviceChange change;
+            change.kind = kind;
+            change.type = type;
+            change.device = device;
+            changes.push_back(std::move(change));
+        };
+        for (const auto& device : before)
+        {
+            if (Find(after, device.id) == nullptr)
+                add(DeviceChangeType::Removed, device);
+        }
+        for (const auto& device : after)
+        {
+            auto previous = Find(before, device.id);
+            if (previous == nullptr)
+                add(DeviceChangeType::Added, device);
+            if (device.isDefault && (previous == nullptr || !previous->isDefault))
+                add(DeviceChangeType::DefaultChanged, device);
+        }
+    }
+
+}  // namespace agora_rtc_engine
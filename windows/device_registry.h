@@ -0,0 +1,120 @@
+#ifndef AGORA_RTC_ENGINE_DEVICE_REGISTRY_H_
+#define AGORA_RTC_ENGINE_DEVICE_REGISTRY_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IAgoraRtcEngine.h"
+
+namespace agora_rtc_engine {
+
+    enum class DeviceKind
+    {
+        Playback = 0,
+        Recording = 1,
+        Video = 2,
+    };
+
+    const int kDeviceKindCount = 3;
+
+    struct DeviceInfo
+    {
+        std::string id;
+        std::string name;
+        // The device the engine uses, the system default unless one was set.
+        bool isDefault = false;
+    };
+
+    enum class DeviceChangeType
+    {
+        Added = 0,
+        Removed = 1,
+        DefaultChanged = 2,
+    };
+
+    struct DeviceChange
+    {
+        DeviceKind kind = DeviceKind::Playback;
+        DeviceChangeType type = DeviceChangeType::Added;
+        DeviceInfo device;
+    };
+
+    // Caches the audio and video device lists of the engine.
+    //
+    // The enumeration calls are slow, so they run on a background thread when
+    // the registry starts and whenever a device changes state, once no
+    // hot-plug notification has arrived for a while. Queries are answered from
+    // the cache. The first enumeration of each kind only fills the cache, the
+    // differences found by later ones are published.
+    class DeviceRegistry
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Called on the registry thread.
+        using ChangeFunction = std::function<void(const std::vector<DeviceChange>& changes)>;
+        using DevicesFunction = std::function<void(const std::vector<DeviceInfo>& devices)>;
+
+        explicit DeviceRegistry(ChangeFunction publish);
+
+        ~DeviceRegistry();
+
+        // Prevent copying
+        DeviceRegistry(DeviceRegistry const&) = delete;
+        DeviceRegistry& operator=(DeviceRegistry const&) = delete;
+
+        // Enumerates every kind on the registry thread.
+        void Start(agora::rtc::IRtcEngine* engine);
+
+        // Stops the registry thread and clears the cache. The engine is not
+        // used once this returns.
+        void Stop();
+
+        // Enumerates |kind| again once no call has been made for the settle
+        // delay.
+        void Refresh(DeviceKind kind);
+
+        void RefreshAll();
+
+        // Calls |callback| with the cached devices, or once the first
+        // enumeration of |kind| completes.
+        void GetDevices(DeviceKind kind, DevicesFunction callback);
+
+    private:
+        struct Cache
+        {
+            bool ready = false;
+            // Whether |devices| holds an enumeration to compare with
+            bool seeded = false;
+            std::vector<DeviceInfo> devices;
+            std::vector<DevicesFunction> waiting;
+        };
+
+        void Run();
+
+        bool Enumerate(DeviceKind kind, std::vector<DeviceInfo>& devices);
+
+        static void Diff(DeviceKind kind, const std::vector<DeviceInfo>& before, const std::vector<DeviceInfo>& after,
+            std::vector<DeviceChange>& changes);
+
+        ChangeFunction publish;
+        agora::rtc::IRtcEngine* engine = nullptr;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        Cache caches[kDeviceKindCount];
+        // Kinds to enumerate once |refreshAt| is reached.
+        unsigned int pending = 0;
+        Clock::time_point refreshAt;
+        bool running = false;
+
+        std::thread worker;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_DEVICE_REGISTRY_H_
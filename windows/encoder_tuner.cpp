@@ -0,0 +1,177 @@
+#include "encoder_tuner.h"
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // QUALITY_TYPE values
+        const int kQualityGood = 2;
+        const int kQualityPoor = 3;
+        const int kQualityDown = 6;
+
+        // Communication profile base bitrates of the SDK's recommended table
+        const EncoderLevel kDefaultLevels[] = {
+            {320, 180, 15, 140},
+            {424, 240, 15, 220},
+            {640, 360, 15, 400},
+            {640, 360, 30, 600},
+            {1280, 720, 15, 1130},
+            {1280, 720, 30, 1710},
+        };
+
+        // The encoder is lagging below this share of the level's frame rate.
+        const double kLaggingFrameRate = 0.75;
+
+        bool IsKnownQuality(int quality)
+        {
+            return quality >= 1 && quality <= kQualityDown;
+        }
+    }  // namespace
+
+    std::vector<EncoderLevel> DefaultEncoderLevels()
+    {
+        return std::vector<EncoderLevel>(std::begin(kDefaultLevels), std::end(kDefaultLevels));
+    }
+
+    EncoderTuner::EncoderTuner(ApplyFunction apply, DecisionFunction publish)
+        : apply(std::move(apply)), publish(std::move(publish))
+    {
+    }
+
+    bool EncoderTuner::Start(const EncoderTunerOptions& options, Clock::time_point now)
+    {
+        auto checked = options;
+        if (checked.levels.empty())
+            checked.levels = DefaultEncoderLevels();
+        auto count = static_cast<int>(checked.levels.size());
+        if (checked.startLevel < 0)
+            checked.startLevel = count - 1;
+        if (checked.startLevel >= count || checked.cpuLow >= checked.cpuHigh || checked.downSamples < 1 || checked.upSamples < 1)
+            return false;
+
+        TuningDecision decision;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->options = checked;
+            running = true;
+            started = now;
+            lastStep = now;
+            steppedDown = false;
+            downCount = 0;
+            upCount = 0;
+            encoderOutputFrameRate = -1;
+            log.clear();
+            decision = Decide(checked.startLevel, TuningReason::Start, now);
+        }
+        apply(decision.level);
+        publish(decision);
+        return true;
+    }
+
+    void EncoderTuner::Stop()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+
+    void EncoderTuner::OnRtcStats(double cpuAppUsage, double cpuTotalUsage, Clock::time_point now)
+    {
+        TuningDecision decision;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running || !Evaluate(cpuAppUsage, cpuTotalUsage, now, decision))
+                return;
+        }
+        apply(decision.level);
+        publish(decision);
+    }
+
+    void EncoderTuner::OnLocalVideoStats(int encoderOutputFrameRate)
+    {
+        if (encoderOutputFrameRate <= 0)
+            return;
+        std::lock_guard<std::mutex> lock(mutex);
+        this->encoderOutputFrameRate = encoderOutputFrameRate;
+    }
+
+    void EncoderTuner::OnNetworkQuality(int txQuality)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Keep the last known quality while the SDK is still detecting
+        if (IsKnownQuality(txQuality))
+            this->txQuality = txQuality;
+    }
+
+    std::vector<TuningDecision> EncoderTuner::GetDecisions() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::vector<TuningDecision>(log.begin(), log.end());
+    }
+
+    bool EncoderTuner::Evaluate(double cpuAppUsage, double cpuTotalUsage, Clock::time_point now, TuningDecision& decision)
+    {
+        this->cpuAppUsage = cpuAppUsage;
+        this->cpuTotalUsage = cpuTotalUsage;
+
+        // Only the frame rate reported since the last step is meaningful
+        auto lagging = encoderOutputFrameRate >= 0 &&
+            encoderOutputFrameRate < options.levels[static_cast<size_t>(level)].frameRate * kLaggingFrameRate;
+        auto reason = TuningReason::Recovered;
+        if (cpuTotalUsage > options.cpuHigh)
+            reason = TuningReason::CpuHigh;
+        else if (lagging)
+            reason = TuningReason::EncoderLagging;
+        else if (txQuality >= kQualityPoor)
+            reason = TuningReason::NetworkPoor;
+
+        auto clear = reason == TuningReason::Recovered && cpuTotalUsage < options.cpuLow &&
+            (txQuality == 0 || txQuality <= kQualityGood);
+        downCount = reason != TuningReason::Recovered ? downCount + 1 : 0;
+        upCount = clear ? upCount + 1 : 0;
+
+        if (now - lastStep < std::chrono::milliseconds(options.minIntervalMs))
+            return false;
+        if (downCount >= options.downSamples && level > 0)
+        {
+            decision = Decide(level - 1, reason, now);
+            return true;
+        }
+        auto held = steppedDown && now - lastStepDown < std::chrono::milliseconds(options.upHoldMs);
+        if (upCount >= options.upSamples && !held && level + 1 < static_cast<int>(options.levels.size()))
+        {
+            decision = Decide(level + 1, TuningReason::Recovered, now);
+            return true;
+        }
+        return false;
+    }
+
+    TuningDecision EncoderTuner::Decide(int toLevel, TuningReason reason, Clock::time_point now)
+    {
+        TuningDecision decision;
+        decision.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - started).count();
+        decision.fromLevel = level;
+        decision.toLevel = toLevel;
+        decision.level = options.levels[static_cast<size_t>(toLevel)];
+        decision.reason = reason;
+        decision.cpuTotalUsage = cpuTotalUsage;
+        decision.cpuAppUsage = cpuAppUsage;
+        decision.txQuality = txQuality;
+        decision.encoderOutputFrameRate = encoderOutputFrameRate;
+
+        if (toLevel < level)
+        {
+            steppedDown = true;
+            lastStepDown = now;
+        }
+        level = toLevel;
+        lastStep = now;
+        downCount = 0;
+        upCount = 0;
+        encoderOutputFrameRate = -1;
+
+        log.push_back(decision);
+        if (log.size() > kMaxLogSize)
+            log.pop_front();
+        return decision;
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,139 @@
+#ifndef AGORA_RTC_ENGINE_ENCODER_TUNER_H_
+#define AGORA_RTC_ENGINE_ENCODER_TUNER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace agora_rtc_engine {
+
+    struct EncoderLevel
+    {
+        int width = 0;
+        int height = 0;
+        int frameRate = 0;
+        // Kbps
+        int bitrate = 0;
+    };
+
+    // The ladder used when none is given, from the lightest level.
+    std::vector<EncoderLevel> DefaultEncoderLevels();
+
+    struct EncoderTunerOptions
+    {
+        // From the lightest to the heaviest, a default ladder when empty.
+        std::vector<EncoderLevel> levels;
+        // The heaviest level when negative.
+        int startLevel = -1;
+        // Steps down above |cpuHigh| percent of total CPU usage and may step
+        // up again below |cpuLow|.
+        double cpuHigh = 85;
+        double cpuLow = 60;
+        // Consecutive onRtcStats reports, two seconds apart, a condition must
+        // hold for before stepping.
+        int downSamples = 2;
+        int upSamples = 5;
+        // Minimum time between two steps, and before stepping up after
+        // stepping down.
+        int minIntervalMs = 6000;
+        int upHoldMs = 20000;
+    };
+
+    enum class TuningReason
+    {
+        Start = 0,
+        CpuHigh = 1,
+        EncoderLagging = 2,
+        NetworkPoor = 3,
+        Recovered = 4,
+    };
+
+    struct TuningDecision
+    {
+        // Since the tuner was started.
+        int64_t timeMs = 0;
+        int fromLevel = 0;
+        int toLevel = 0;
+        EncoderLevel level;
+        TuningReason reason = TuningReason::Start;
+        // The inputs the decision was based on.
+        double cpuTotalUsage = 0;
+        double cpuAppUsage = 0;
+        int txQuality = 0;
+        int encoderOutputFrameRate = 0;
+    };
+
+    // Steps the video encoder configuration along a ladder of levels from the
+    // CPU usage, encoder output frame rate and uplink quality.
+    //
+    // Pressure on any input steps down after |downSamples| reports, and all
+    // inputs being clear steps up after |upSamples| reports. The gap between
+    // the CPU thresholds, the sample counts and the minimum intervals keep it
+    // from oscillating. The tuner does no I/O or timing of its own, so stats
+    // traces can be replayed against it with any clock. Every decision is
+    // kept in a bounded log and published.
+    class EncoderTuner
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Called outside of the lock, e.g. to call setVideoEncoderConfiguration.
+        using ApplyFunction = std::function<void(const EncoderLevel& level)>;
+        using DecisionFunction = std::function<void(const TuningDecision& decision)>;
+
+        static const size_t kMaxLogSize = 64;
+
+        EncoderTuner(ApplyFunction apply, DecisionFunction publish);
+
+        // Prevent copying
+        EncoderTuner(EncoderTuner const&) = delete;
+        EncoderTuner& operator=(EncoderTuner const&) = delete;
+
+        // Applies the start level. Returns false if |options| are invalid.
+        bool Start(const EncoderTunerOptions& options, Clock::time_point now);
+
+        void Stop();
+
+        // Evaluates the latest inputs, called for every onRtcStats.
+        void OnRtcStats(double cpuAppUsage, double cpuTotalUsage, Clock::time_point now);
+
+        // A frame rate of 0, reported while the local video is muted or not
+        // captured, is ignored rather than taken for a lagging encoder.
+        void OnLocalVideoStats(int encoderOutputFrameRate);
+
+        // The local uplink quality, a QUALITY_TYPE.
+        void OnNetworkQuality(int txQuality);
+
+        std::vector<TuningDecision> GetDecisions() const;
+
+    private:
+        // Returns whether a decision was made, called with |mutex| held.
+        bool Evaluate(double cpuAppUsage, double cpuTotalUsage, Clock::time_point now, TuningDecision& decision);
+
+        TuningDecision Decide(int toLevel, TuningReason reason, Clock::time_point now);
+
+        ApplyFunction apply;
+        DecisionFunction publish;
+
+        mutable std::mutex mutex;
+        bool running = false;
+        EncoderTunerOptions options;
+        int level = 0;
+        Clock::time_point started;
+        Clock::time_point lastStep;
+        Clock::time_point lastStepDown;
+        bool steppedDown = false;
+        int downCount = 0;
+        int upCount = 0;
+        int txQuality = 0;
+        int encoderOutputFrameRate = -1;
+        double cpuAppUsage = 0;
+        double cpuTotalUsage = 0;
+        std::deque<TuningDecision> log;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_ENCODER_TUNER_H_
@@ -0,0 +1,161 @@
+#include "engine_broker.h"
+
+#include <algorithm>
+
+#include "event_forwarder.h"
+
+using namespace agora::rtc;
+using agora::media::IVideoFrameObserver;
+
+namespace agora_rtc_engine {
+
+    // static
+    EngineBroker& EngineBroker::Instance()
+    {
+        // Outlives the plugins, whichever order they are destroyed in at exit
+        static auto* broker = new EngineBroker();
+        return *broker;
+    }
+
+    EngineBroker::EngineBroker()
+    {
+    }
+
+    IRtcEngine* EngineBroker::Attach(const std::string& newAppId, IRtcEngineEventHandler* handler, IVideoFrameObserver* observer, OwnershipFunction granted, bool& owner, int& error)
+    {
+        std::lock_guard<std::mutex> lock(lifecycle);
+        owner = false;
+        error = 0;
+        if (engine == nullptr)
+        {
+            auto newEngine = createAgoraRtcEngine();
+            RtcEngineContext ctx;
+            ctx.eventHandler = this;
+            ctx.appId = newAppId.c_str();
+            auto result = newEngine->initialize(ctx);
+            if (result != 0)
+            {
+                newEngine->release();
+                error = result < 0 ? -result : result;
+                return nullptr;
+            }
+            engine = newEngine;
+            appId = newAppId;
+            owner = true;
+            RegisterVideoFrameObserver(true);
+        }
+        else if (newAppId != appId)
+        {
+            // The SDK allows one engine, hence one app id, per process
+            error = agora::ERR_INVALID_APP_ID;
+            return nullptr;
+        }
+
+        std::unique_lock<std::shared_mutex> clientsLock(clientsMutex);
+        clients.push_back(Client{handler, observer, std::move(granted), owner});
+        return engine;
+    }
+
+    bool EngineBroker::Detach(IRtcEngineEventHandler* handler)
+    {
+        std::lock_guard<std::mutex> lock(lifecycle);
+        bool last;
+        OwnershipFunction granted;
+        {
+            // Waits for the callbacks under way
+            std::unique_lock<std::shared_mutex> clientsLock(clientsMutex);
+            auto client = std::find_if(clients.begin(), clients.end(), [handler](const Client& client) {
+                return client.handler == handler;
+            });
+            if (client == clients.end())
+                return false;
+            auto owner = client->owner;
+            clients.erase(client);
+            last = clients.empty();
+            if (owner && !last)
+            {
+                clients.front().owner = true;
+                granted = clients.front().granted;
+            }
+        }
+
+        // Under lifecycle, so that the new owner is still attached
+        if (granted)
+            granted();
+
+        if (last && engine != nullptr)
+        {
+            RegisterVideoFrameObserver(false);
+            // Outside of clientsMutex, as releasing waits for the SDK's
+            // threads
+            engine->release();
+            engine = nullptr;
+            appId.clear();
+        }
+        return true;
+    }
+
+    EngineBrokerStats EngineBroker::GetStats() const
+    {
+        EngineBrokerStats stats;
+        {
+            std::shared_lock<std::shared_mutex> lock(clientsMutex);
+            stats.clients = static_cast<int>(clients.size());
+        }
+        stats.callbacks = callbacks;
+        stats.encodings = encodings;
+        stats.sharedEncodings = sharedEncodings;
+        return stats;
+    }
+
+    void EngineBroker::RegisterVideoFrameObserver(bool enable)
+    {
+        agora::util::AutoPtr<agora::media::IMediaEngine> mediaEngine;
+        if (mediaEngine.queryInterface(engine, agora::AGORA_IID_MEDIA_ENGINE))
+            mediaEngine->registerVideoFrameObserver(enable ? this : nullptr);
+    }
+
+    void EngineBroker::Count(const SharedEventEncoding& encoding)
+    {
+        callbacks.fetch_add(1, std::memory_order_relaxed);
+        if (encoding.encoded())
+            encodings.fetch_add(1, std::memory_order_relaxed);
+        sharedEncodings.fetch_add(encoding.reuses(), std::memory_order_relaxed);
+    }
+
+    // Each window's forwarder encodes the callback only if no window before
+    // it did.
+#define AGORA_RTC_ENGINE_EVENT_DISPATCH(id, name, parameters, arguments) \
+    void EngineBroker::name parameters \
+    { \
+        std::shared_lock<std::shared_mutex> lock(clientsMutex); \
+        SharedEventEncoding encoding; \
+        for (const auto& client : clients) \
+            client.handler->name arguments; \
+        Count(encoding); \
+    }
+    AGORA_RTC_ENGINE_EVENTS(AGORA_RTC_ENGINE_EVENT_DISPATCH, AGORA_RTC_ENGINE_EVENT_DISPATCH)
+#undef AGORA_RTC_ENGINE_EVENT_DISPATCH
+
+#pragma region IVideoFrameObserver
+    bool EngineBroker::onCaptureVideoFrame(VideoFrame& videoFrame)
+    {
+        std::shared_lock<std::shared_mutex> lock(clientsMutex);
+        auto keep = clients.empty();
+        for (const auto& client : clients)
+            keep = client.observer->onCaptureVideoFrame(videoFrame) || keep;
+        return keep;
+    }
+
+    bool EngineBroker::onRenderVideoFrame(unsigned int uid, VideoFrame& videoFrame)
+    {
+        // Dropped only if no window wants it
+        std::shared_lock<std::shared_mutex> lock(clientsMutex);
+        auto keep = clients.empty();
+        for (const auto& client : clients)
+            keep = client.observer->onRenderVideoFrame(uid, videoFrame) || keep;
+        return keep;
+    }
+#pragma endregion
+
+}  // namespace agora_rtc_engine
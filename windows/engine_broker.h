@@ -0,0 +1,117 @@
+#ifndef AGORA_RTC_ENGINE_ENGINE_BROKER_H_
+#define AGORA_RTC_ENGINE_ENGINE_BROKER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "IAgoraMediaEngine.h"
+#include "IAgoraRtcEngine.h"
+
+#include "rtc_engine_events.h"
+
+namespace agora_rtc_engine {
+
+    class SharedEventEncoding;
+
+    struct EngineBrokerStats
+    {
+        // The windows attached to the engine.
+        int clients = 0;
+        // Callbacks from the engine, and the encodings the windows sharing
+        // them were spared.
+        uint64_t callbacks = 0;
+        uint64_t encodings = 0;
+        uint64_t sharedEncodings = 0;
+    };
+
+    // Shares the process's one IRtcEngine between the windows of an app, each
+    // with a Flutter engine and a plugin of its own.
+    //
+    // The SDK takes a single event handler and video frame observer, so the
+    // broker registers itself and dispatches every callback to each window
+    // attached. Windows subscribe to events with their own forwarders; an
+    // event several of them subscribed to is encoded once, for the first, and
+    // the others send the same message.
+    //
+    // The observers the SDK takes one of besides, of packets, metadata and
+    // audio frames, belong to the window that owns the engine: the one that
+    // created it, then when the owner detaches, the first of the others.
+    class EngineBroker : public agora::rtc::IRtcEngineEventHandler, public agora::media::IVideoFrameObserver
+    {
+    public:
+        // The process's broker, never destroyed.
+        static EngineBroker& Instance();
+
+        EngineBroker();
+
+        // Prevent copying
+        EngineBroker(EngineBroker const&) = delete;
+        EngineBroker& operator=(EngineBroker const&) = delete;
+
+        // Called on the detaching thread when the owner detaches, to register
+        // the owner's observers from the window taking over.
+        using OwnershipFunction = std::function<void()>;
+
+        // Dispatches the engine's callbacks to |handler| and video frames to
+        // |observer|, creating and initializing the engine for |appId| if it
+        // does not exist, in which case |owner| is set. Otherwise |granted|
+        // is called if this window becomes the owner later. Returns nullptr
+        // with an SDK error code in |error| if it was created for another
+        // app id or could not be initialized.
+        agora::rtc::IRtcEngine* Attach(const std::string& appId, agora::rtc::IRtcEngineEventHandler* handler, agora::media::IVideoFrameObserver* observer, OwnershipFunction granted, bool& owner, int& error);
+
+        // Stops dispatching to |handler| and the observer attached with it,
+        // neither called once this returns. The owner should unregister its
+        // observers first. The last window to detach releases the engine.
+        // Returns false if |handler| was not attached.
+        bool Detach(agora::rtc::IRtcEngineEventHandler* handler);
+
+        EngineBrokerStats GetStats() const;
+
+#define AGORA_RTC_ENGINE_EVENT_OVERRIDE(id, name, parameters, arguments) \
+        void name parameters override;
+        AGORA_RTC_ENGINE_EVENTS(AGORA_RTC_ENGINE_EVENT_OVERRIDE, AGORA_RTC_ENGINE_EVENT_OVERRIDE)
+#undef AGORA_RTC_ENGINE_EVENT_OVERRIDE
+
+#pragma region IVideoFrameObserver
+        bool onCaptureVideoFrame(VideoFrame& videoFrame) override;
+        bool onRenderVideoFrame(unsigned int uid, VideoFrame& videoFrame) override;
+#pragma endregion
+
+    private:
+        struct Client
+        {
+            agora::rtc::IRtcEngineEventHandler* handler;
+            agora::media::IVideoFrameObserver* observer;
+            OwnershipFunction granted;
+            bool owner;
+        };
+
+        void RegisterVideoFrameObserver(bool enable);
+
+        // Counts a dispatched callback and how it was encoded.
+        void Count(const SharedEventEncoding& encoding);
+
+        // Serializes attaching and detaching, held while the engine is
+        // created or released.
+        std::mutex lifecycle;
+        agora::rtc::IRtcEngine* engine = nullptr;
+        std::string appId;
+
+        // Held shared while dispatching, on the SDK's event and video
+        // threads.
+        mutable std::shared_mutex clientsMutex;
+        std::vector<Client> clients;
+        std::atomic<uint64_t> callbacks{0};
+        std::atomic<uint64_t> encodings{0};
+        std::atomic<uint64_t> sharedEncodings{0};
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_ENGINE_BROKER_H_
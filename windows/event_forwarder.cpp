@@ -0,0 +1,308 @@
+#include "event_forwarder.h"
+
+#include <flutter/standard_message_codec.h>
+
+#include <tuple>
+#include <utility>
+
+#include "stats_encoder.h"
+
+using namespace agora::rtc;
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+namespace agora_rtc_engine {
+
+    namespace {
+        struct EventInfo
+        {
+            const char* name = nullptr;
+            std::vector<EncodableValue> keys;
+        };
+
+        // Splits a stringized argument list such as "(uid, elapsed)".
+        std::vector<EncodableValue> ParseKeys(const std::string& arguments)
+        {
+            std::vector<EncodableValue> keys;
+            std::string key;
+            for (auto c : arguments)
+            {
+                if (c == '(' || c == ' ')
+                    continue;
+                if (c == ',' || c == ')')
+                {
+                    if (!key.empty())
+                        keys.push_back(EncodableValue(key));
+                    key.clear();
+                }
+                else
+                    key += c;
+            }
+            return keys;
+        }
+
+        // Indexed by event id; the map keys are the parameter names.
+        const std::vector<EventInfo>& Events()
+        {
+            static const std::vector<EventInfo> events = [] {
+                std::vector<EventInfo> list(kRtcEngineEventCount);
+#define AGORA_RTC_ENGINE_EVENT_INFO(id, name, parameters, arguments) \
+                list[id] = EventInfo{#name, ParseKeys(#arguments)};
+                AGORA_RTC_ENGINE_EVENTS(AGORA_RTC_ENGINE_EVENT_INFO, AGORA_RTC_ENGINE_EVENT_INFO)
+#undef AGORA_RTC_ENGINE_EVENT_INFO
+                return list;
+            }();
+            return events;
+        }
+
+        EncodableValue toValue(const char* value)
+        {
+            return value ? EncodableValue(std::string(value)) : EncodableValue();
+        }
+
+        template <typename T>
+        EncodableValue toValue(T value)
+        {
+            return EncodeScalar(value);
+        }
+
+        EncodableMap toMap(const LastmileProbeOneWayResult& result)
+        {
+            return EncodableMap{
+                {"packetLossRate", (int64_t)result.packetLossRate},
+                {"jitter", (int64_t)result.jitter},
+                {"availableBandwidth", (int64_t)result.availableBandwidth},
+            };
+        }
+
+        EncodableValue toValue(const LastmileProbeResult& result)
+        {
+            return EncodableMap{
+                {"state", (int)result.state},
+                {"uplinkReport", toMap(result.uplinkReport)},
+                {"downlinkReport", toMap(result.downlinkReport)},
+                {"rtt", (int64_t)result.rtt},
+            };
+        }
+
+        EncodableValue toValue(const UserInfo& info)
+        {
+            return EncodableMap{
+                {"uid", (int64_t)info.uid},
+                {"userAccount", std::string(info.userAccount)},
+            };
+        }
+
+        template <typename T>
+        void EncodeInto(const T& value, EncodableValue& slot)
+        {
+            slot = toValue(value);
+        }
+
+        // Stats update the map from the previous event in place.
+#define AGORA_RTC_STATS_ENCODE_INTO(type, fields) \
+        void EncodeInto(const type& stats, EncodableValue& slot) \
+        { \
+            if (auto map = std::get_if<EncodableMap>(&slot)) \
+                EncodeStatsInto(stats, *map); \
+            else \
+                slot = EncodeStats(stats); \
+        }
+        AGORA_RTC_STATS_STRUCTS(AGORA_RTC_STATS_ENCODE_INTO)
+#undef AGORA_RTC_STATS_ENCODE_INTO
+
+        // The arguments of the last event of each kind on this thread. Every
+        // event has the same keys each time, so updating them in place spares
+        // rebuilding the map and, for stats reported every two seconds per
+        // user, allocating anything but the message.
+        EncodableValue& LastArguments(RtcEngineEvent event)
+        {
+            thread_local std::vector<EncodableValue> arguments(kRtcEngineEventCount);
+            auto i = static_cast<int>(event);
+            auto& value = arguments[i];
+            if (value.IsNull())
+                value = EncodableMap{{EncodableValue("event"), EncodableValue(std::string(Events()[i].name))}};
+            return value;
+        }
+
+        template <typename... Args, size_t... I>
+        void EncodeInto(const std::vector<EncodableValue>& keys, const std::tuple<Args...>& arguments, EncodableMap& map, std::index_sequence<I...>)
+        {
+            (void)keys;
+            (void)arguments;
+            (void)map;
+            (EncodeInto(std::get<I>(arguments), map[keys[I]]), ...);
+        }
+
+        template <typename... Args>
+        EventMessage Encode(RtcEngineEvent event, const std::tuple<Args...>& arguments)
+        {
+            auto& value = LastArguments(event);
+            EncodeInto(Events()[static_cast<int>(event)].keys, arguments, std::get<EncodableMap>(value), std::index_sequence_for<Args...>());
+            return flutter::StandardMessageCodec::GetInstance().EncodeMessage(value);
+        }
+    }  // namespace
+
+    EventMessage EncodeEventMessage(const std::string& name, EncodableMap arguments)
+    {
+        arguments[EncodableValue("event")] = name;
+        return flutter::StandardMessageCodec::GetInstance().EncodeMessage(EncodableValue(std::move(arguments)));
+    }
+
+    thread_local SharedEventEncoding* SharedEventEncoding::current = nullptr;
+
+    SharedEventEncoding::SharedEventEncoding()
+        : previous(current)
+    {
+        current = this;
+    }
+
+    SharedEventEncoding::~SharedEventEncoding()
+    {
+        current = previous;
+    }
+
+    bool SharedEventEncoding::encoded() const
+    {
+        return message != nullptr;
+    }
+
+    int SharedEventEncoding::reuses() const
+    {
+        return reused;
+    }
+
+    EventForwarder::EventForwarder(IRtcEngineEventHandler* target, SendFunction send)
+        : target(target),
+        send(std::move(send))
+    {
+        for (auto& word : mask)
+            word = 0;
+        for (int i = 0; i < kRtcEngineEventCount; ++i)
+        {
+            received[i] = 0;
+            forwarded[i] = 0;
+        }
+    }
+
+    bool EventForwarder::Subscribe(const std::string& name, bool subscribe)
+    {
+        const auto& events = Events();
+        for (int i = 0; i < kRtcEngineEventCount; ++i)
+        {
+            if (events[i].name == nullptr || name != events[i].name)
+                continue;
+            auto bit = uint64_t(1) << (i % 64);
+            if (subscribe)
+                mask[i / 64].fetch_or(bit, std::memory_order_relaxed);
+            else
+                mask[i / 64].fetch_and(~bit, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    bool EventForwarder::subscribed(RtcEngineEvent event) const
+    {
+        auto i = static_cast<int>(event);
+        return (mask[i / 64].load(std::memory_order_relaxed) >> (i % 64)) & 1;
+    }
+
+    std::vector<EventCounters> EventForwarder::GetCounters() const
+    {
+        const auto& events = Events();
+        std::vector<EventCounters> counters;
+        for (int i = 0; i < kRtcEngineEventCount; ++i)
+        {
+            if (events[i].name == nullptr)
+                continue;
+            EventCounters event;
+            event.name = events[i].name;
+            event.received = received[i];
+            event.forwarded = forwarded[i];
+            counters.push_back(event);
+        }
+        return counters;
+    }
+
+    bool EventForwarder::Receive(RtcEngineEvent event)
+    {
+        received[static_cast<int>(event)].fetch_add(1, std::memory_order_relaxed);
+        return subscribed(event);
+    }
+
+    template <typename Function>
+    void EventForwarder::Send(RtcEngineEvent event, Function encode)
+    {
+        auto i = static_cast<int>(event);
+        forwarded[i].fetch_add(1, std::memory_order_relaxed);
+        auto shared = SharedEventEncoding::current;
+        if (shared != nullptr && shared->event == i)
+        {
+            shared->reused++;
+            send(shared->message);
+            return;
+        }
+        EventMessage message = encode();
+        if (shared != nullptr)
+        {
+            shared->event = i;
+            shared->message = message;
+        }
+        send(std::move(message));
+    }
+
+    // The plugin handles each callback first, as it did before forwarding
+    // moved here.
+#define AGORA_RTC_ENGINE_EVENT_FORWARD(id, name, parameters, arguments) \
+    void EventForwarder::name parameters \
+    { \
+        target->name arguments; \
+        if (Receive(RtcEngineEvent::name)) \
+            Send(RtcEngineEvent::name, [&] { return Encode(RtcEngineEvent::name, std::forward_as_tuple arguments); }); \
+    }
+#define AGORA_RTC_ENGINE_EVENT_SKIP(id, name, parameters, arguments)
+    AGORA_RTC_ENGINE_EVENTS(AGORA_RTC_ENGINE_EVENT_FORWARD, AGORA_RTC_ENGINE_EVENT_SKIP)
+#undef AGORA_RTC_ENGINE_EVENT_SKIP
+#undef AGORA_RTC_ENGINE_EVENT_FORWARD
+
+    void EventForwarder::onAudioVolumeIndication(const AudioVolumeInfo* speakers, unsigned int speakerNumber, int totalVolume)
+    {
+        target->onAudioVolumeIndication(speakers, speakerNumber, totalVolume);
+        if (!Receive(RtcEngineEvent::onAudioVolumeIndication))
+            return;
+        Send(RtcEngineEvent::onAudioVolumeIndication, [&] {
+            EncodableList list;
+            for (unsigned int i = 0; speakers && i < speakerNumber; ++i)
+            {
+                list.push_back(EncodableMap{
+                    {"uid", (int64_t)speakers[i].uid},
+                    {"volume", (int64_t)speakers[i].volume},
+                    {"vad", (int64_t)speakers[i].vad},
+                });
+            }
+            return EncodeEventMessage("onAudioVolumeIndication", EncodableMap{
+                {"speakers", list},
+                {"speakerNumber", (int64_t)speakerNumber},
+                {"totalVolume", totalVolume},
+            });
+        });
+    }
+
+    void EventForwarder::onStreamMessage(uid_t uid, int streamId, const char* data, size_t length)
+    {
+        target->onStreamMessage(uid, streamId, data, length);
+        if (!Receive(RtcEngineEvent::onStreamMessage))
+            return;
+        Send(RtcEngineEvent::onStreamMessage, [&] {
+            auto bytes = reinterpret_cast<const uint8_t*>(data);
+            return EncodeEventMessage("onStreamMessage", EncodableMap{
+                {"uid", (int64_t)uid},
+                {"streamId", streamId},
+                {"data", data ? std::vector<uint8_t>(bytes, bytes + length) : std::vector<uint8_t>()},
+            });
+        });
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,114 @@
+#ifndef AGORA_RTC_ENGINE_EVENT_FORWARDER_H_
+#define AGORA_RTC_ENGINE_EVENT_FORWARDER_H_
+
+#include <flutter/encodable_value.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IAgoraRtcEngine.h"
+
+#include "rtc_engine_events.h"
+
+namespace agora_rtc_engine {
+
+    struct EventCounters
+    {
+        const char* name = nullptr;
+        // Callbacks from the engine, and those of them sent to Dart.
+        uint64_t received = 0;
+        uint64_t forwarded = 0;
+    };
+
+    // An event as sent to Dart: its arguments, with the event's name under
+    // "event", encoded by the standard message codec.
+    using EventMessage = std::shared_ptr<const std::vector<uint8_t>>;
+
+    EventMessage EncodeEventMessage(const std::string& name, flutter::EncodableMap arguments);
+
+    // Shares the encoding of a callback between the forwarders it is
+    // dispatched to, such as those of several windows on one engine. While
+    // one is alive on a thread, the first forwarder to send the callback
+    // encodes it and the others send the same message.
+    class SharedEventEncoding
+    {
+    public:
+        SharedEventEncoding();
+        ~SharedEventEncoding();
+
+        // Prevent copying
+        SharedEventEncoding(SharedEventEncoding const&) = delete;
+        SharedEventEncoding& operator=(SharedEventEncoding const&) = delete;
+
+        // Whether a forwarder encoded the callback, and how many more sent
+        // that message instead of encoding their own.
+        bool encoded() const;
+        int reuses() const;
+
+    private:
+        friend class EventForwarder;
+
+        static thread_local SharedEventEncoding* current;
+
+        SharedEventEncoding* previous;
+        int event = -1;
+        EventMessage message;
+        int reused = 0;
+    };
+
+    // Forwards every engine callback to |target|, then sends the subscribed
+    // ones to Dart with their arguments in a map keyed by parameter name.
+    //
+    // Subscriptions are a bitmask read on every callback, so that unwanted
+    // events such as onAudioVolumeIndication or the per-uid onNetworkQuality
+    // cost no more than a counter increment.
+    class EventForwarder : public agora::rtc::IRtcEngineEventHandler
+    {
+    public:
+        // Called on the SDK thread with each subscribed event.
+        using SendFunction = std::function<void(EventMessage message)>;
+
+        EventForwarder(agora::rtc::IRtcEngineEventHandler* target, SendFunction send);
+
+        // Prevent copying
+        EventForwarder(EventForwarder const&) = delete;
+        EventForwarder& operator=(EventForwarder const&) = delete;
+
+        // Returns false if |name| is not an IRtcEngineEventHandler callback.
+        bool Subscribe(const std::string& name, bool subscribe);
+
+        bool subscribed(RtcEngineEvent event) const;
+
+        std::vector<EventCounters> GetCounters() const;
+
+#define AGORA_RTC_ENGINE_EVENT_OVERRIDE(id, name, parameters, arguments) \
+        void name parameters override;
+        AGORA_RTC_ENGINE_EVENTS(AGORA_RTC_ENGINE_EVENT_OVERRIDE, AGORA_RTC_ENGINE_EVENT_OVERRIDE)
+#undef AGORA_RTC_ENGINE_EVENT_OVERRIDE
+
+    private:
+        static const int kMaskWords = (kRtcEngineEventCount + 63) / 64;
+
+        // Counts the callback, returns whether it is to be sent.
+        bool Receive(RtcEngineEvent event);
+
+        // Sends the message returned by |encode|, unless the callback was
+        // already encoded for another forwarder.
+        template <typename Function>
+        void Send(RtcEngineEvent event, Function encode);
+
+        agora::rtc::IRtcEngineEventHandler* target;
+        SendFunction send;
+
+        std::atomic<uint64_t> mask[kMaskWords];
+        std::atomic<uint64_t> received[kRtcEngineEventCount];
+        std::atomic<uint64_t> forwarded[kRtcEngineEventCount];
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_EVENT_FORWARDER_H_
@@ -0,0 +1,489 @@
+#include "event_trace.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+using namespace agora::rtc;
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const uint8_t kMagic[] = {'A', 'E', 'T', 'R'};
+        const uint8_t kVersion = 1;
+
+        // Written to the file once this much is buffered
+        const size_t kFlushSize = 64 * 1024;
+
+        using Clock = std::chrono::steady_clock;
+
+        int64_t NanosSince(Clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        }
+
+        void PutVarint(std::vector<uint8_t>& out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        void PutBytes(std::vector<uint8_t>& out, const void* data, size_t size)
+        {
+            auto bytes = static_cast<const uint8_t*>(data);
+            out.insert(out.end(), bytes, bytes + size);
+        }
+
+        struct Reader
+        {
+            const uint8_t* data;
+            const uint8_t* end;
+            bool ok = true;
+
+            uint64_t Varint()
+            {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7)
+                {
+                    if (data == end)
+                        break;
+                    auto byte = *data++;
+                    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                    if ((byte & 0x80) == 0)
+                        return value;
+                }
+                ok = false;
+                return 0;
+            }
+
+            const uint8_t* Bytes(size_t size)
+            {
+                if (!ok || static_cast<size_t>(end - data) < size)
+                {
+                    ok = false;
+                    return nullptr;
+                }
+                auto bytes = data;
+                data += size;
+                return bytes;
+            }
+        };
+
+        // A C string argument, which may be null.
+        struct StoredString
+        {
+            std::string value;
+            bool null = true;
+        };
+
+        // How each parameter type is held between decoding and the call.
+        template <typename T>
+        struct Argument
+        {
+            using Stored = std::remove_cv_t<std::remove_reference_t<T>>;
+
+            static T Pass(Stored& value) { return value; }
+        };
+
+        template <>
+        struct Argument<const char*>
+        {
+            using Stored = StoredString;
+
+            static const char* Pass(Stored& value) { return value.null ? nullptr : value.value.c_str(); }
+        };
+
+        void Encode(std::vector<uint8_t>& out, const char* value)
+        {
+            if (!value)
+            {
+                PutVarint(out, 0);
+                return;
+            }
+            auto size = std::strlen(value);
+            PutVarint(out, size + 1);
+            PutBytes(out, value, size);
+        }
+
+        template <typename T>
+        void Encode(std::vector<uint8_t>& out, const T& value)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+                out.push_back(value ? 1 : 0);
+            else if constexpr (std::is_enum_v<T>)
+                Encode(out, static_cast<std::underlying_type_t<T>>(value));
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+                PutVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(value) >> 63));
+            else if constexpr (std::is_integral_v<T>)
+                PutVarint(out, value);
+            else if constexpr (std::is_floating_point_v<T>)
+                PutBytes(out, &value, sizeof(T));
+            else
+            {
+                // SDK structs are plain data; their size goes first so traces
+                // survive fields being appended in later SDK versions.
+                static_assert(std::is_trivially_copyable_v<T>, "unsupported event argument");
+                PutVarint(out, sizeof(T));
+                PutBytes(out, &value, sizeof(T));
+            }
+        }
+
+        template <typename... Args>
+        void EncodeAll(std::vector<uint8_t>& out, const std::tuple<Args...>& arguments)
+        {
+            std::apply([&out](const auto&... values) { (Encode(out, values), ...); }, arguments);
+        }
+
+        void Decode(Reader& reader, StoredString& value)
+        {
+            auto size = reader.Varint();
+            value.null = size == 0;
+            if (size == 0)
+                return;
+            auto bytes = reader.Bytes(static_cast<size_t>(size - 1));
+            if (bytes)
+                value.value.assign(reinterpret_cast<const char*>(bytes), static_cast<size_t>(size - 1));
+        }
+
+        template <typename T>
+        void Decode(Reader& reader, T& value)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                auto bytes = reader.Bytes(1);
+                value = bytes && *bytes != 0;
+            }
+            else if constexpr (std::is_enum_v<T>)
+            {
+                std::underlying_type_t<T> raw = 0;
+                Decode(reader, raw);
+                value = static_cast<T>(raw);
+            }
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+            {
+                auto raw = reader.Varint();
+                value = static_cast<T>(static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1));
+            }
+            else if constexpr (std::is_integral_v<T>)
+                value = static_cast<T>(reader.Varint());
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                auto bytes = reader.Bytes(sizeof(T));
+                if (bytes)
+                    std::memcpy(&value, bytes, sizeof(T));
+            }
+            else
+            {
+                // Fields missing from older traces are left zeroed
+                auto size = static_cast<size_t>(reader.Varint());
+                auto bytes = reader.Bytes(size);
+                if (bytes)
+                    std::memcpy(&value, bytes, size < sizeof(T) ? size : sizeof(T));
+            }
+        }
+
+        // Calls |call| and adds the time it took to |stats|.
+        template <typename F>
+        void Time(EventReplayStats& stats, F call)
+        {
+            auto start = Clock::now();
+            call();
+            auto nanos = NanosSince(start);
+            stats.handlerNanos += nanos;
+            if (nanos > stats.maxHandlerNanos)
+                stats.maxHandlerNanos = nanos;
+        }
+
+        template <typename... Args, size_t... I>
+        bool Invoke(IRtcEngineEventHandler* target, void (IRtcEngineEventHandler::*member)(Args...),
+                    Reader& reader, EventReplayStats& stats, std::index_sequence<I...>)
+        {
+            std::tuple<typename Argument<Args>::Stored...> values{};
+            (Decode(reader, std::get<I>(values)), ...);
+            if (!reader.ok)
+                return false;
+            Time(stats, [&] { (target->*member)(Argument<Args>::Pass(std::get<I>(values))...); });
+            return true;
+        }
+
+        template <typename... Args>
+        bool Invoke(IRtcEngineEventHandler* target, void (IRtcEngineEventHandler::*member)(Args...),
+                    Reader& reader, EventReplayStats& stats)
+        {
+            return Invoke(target, member, reader, stats, std::index_sequence_for<Args...>());
+        }
+    }  // namespace
+
+    EventRecorder::EventRecorder(IRtcEngineEventHandler* target)
+        : target(target)
+    {
+    }
+
+    EventRecorder::~EventRecorder()
+    {
+        Stop();
+    }
+
+    bool EventRecorder::Start(const std::string& path)
+    {
+        Stop();
+        std::lock_guard<std::mutex> lock(mutex);
+        file.open(std::filesystem::u8path(path), std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        buffer.clear();
+        PutBytes(buffer, kMagic, sizeof(kMagic));
+        buffer.push_back(kVersion);
+        recorded = EventRecordingStats();
+        recorded.bytes = buffer.size();
+        last = Clock::now();
+        recording = true;
+        return true;
+    }
+
+    EventRecordingStats EventRecorder::Stop()
+    {
+        recording = false;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (file.is_open())
+        {
+            file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            file.close();
+            buffer.clear();
+        }
+        return recorded;
+    }
+
+    void EventRecorder::Record(RtcEngineEvent event, const std::vector<uint8_t>& arguments)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Stop() may have run since the caller checked
+        if (!file.is_open())
+            return;
+        auto now = Clock::now();
+        auto size = buffer.size();
+        PutVarint(buffer, static_cast<uint64_t>(event));
+        PutVarint(buffer, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()));
+        PutVarint(buffer, arguments.size());
+        buffer.insert(buffer.end(), arguments.begin(), arguments.end());
+        last = now;
+        recorded.events++;
+        recorded.bytes += buffer.size() - size;
+        if (buffer.size() >= kFlushSize)
+        {
+            file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+
+    // Arguments are encoded before forwarding so that timestamps are those of
+    // the callbacks arriving, not of the handler returning.
+#define AGORA_RTC_ENGINE_EVENT_RECORD(id, name, parameters, arguments) \
+    void EventRecorder::name parameters \
+    { \
+        if (recording.load(std::memory_order_relaxed)) \
+        { \
+            thread_local std::vector<uint8_t> encoded; \
+            encoded.clear(); \
+            EncodeAll(encoded, std::forward_as_tuple arguments); \
+            Record(RtcEngineEvent::name, encoded); \
+        } \
+        target->name arguments; \
+    }
+#define AGORA_RTC_ENGINE_EVENT_SKIP(id, name, parameters, arguments)
+    AGORA_RTC_ENGINE_EVENTS(AGORA_RTC_ENGINE_EVENT_RECORD, AGORA_RTC_ENGINE_EVENT_SKIP)
+#undef AGORA_RTC_ENGINE_EVENT_SKIP
+#undef AGORA_RTC_ENGINE_EVENT_RECORD
+
+    void EventRecorder::onAudioVolumeIndication(const AudioVolumeInfo* speakers, unsigned int speakerNumber, int totalVolume)
+    {
+        if (recording.load(std::memory_order_relaxed))
+        {
+            thread_local std::vector<uint8_t> encoded;
+            encoded.clear();
+            Encode(encoded, speakerNumber);
+            Encode(encoded, totalVolume);
+            for (unsigned int i = 0; speakers && i < speakerNumber; ++i)
+            {
+                Encode(encoded, speakers[i].uid);
+                Encode(encoded, speakers[i].volume);
+                Encode(encoded, speakers[i].vad);
+            }
+            Record(RtcEngineEvent::onAudioVolumeIndication, encoded);
+        }
+        target->onAudioVolumeIndication(speakers, speakerNumber, totalVolume);
+    }
+
+    void EventRecorder::onStreamMessage(uid_t uid, int streamId, const char* data, size_t length)
+    {
+        if (recording.load(std::memory_order_relaxed))
+        {
+            thread_local std::vector<uint8_t> encoded;
+            encoded.clear();
+            Encode(encoded, uid);
+            Encode(encoded, streamId);
+            Encode(encoded, data ? length : 0);
+            if (data)
+                PutBytes(encoded, data, length);
+            Record(RtcEngineEvent::onStreamMessage, encoded);
+        }
+        target->onStreamMessage(uid, streamId, data, length);
+    }
+
+    EventReplayer::EventReplayer(IRtcEngineEventHandler* target)
+        : target(target)
+    {
+    }
+
+    EventReplayer::~EventReplayer()
+    {
+        Stop();
+    }
+
+    bool EventReplayer::Start(const std::string& path, double speed, DoneFunction done)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (running)
+            return false;
+        lock.unlock();
+        if (worker.joinable())
+            worker.join();
+
+        std::ifstream file(std::filesystem::u8path(path), std::ios::binary);
+        if (!file)
+            return false;
+        trace.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (trace.size() < sizeof(kMagic) + 1 || std::memcmp(trace.data(), kMagic, sizeof(kMagic)) != 0 ||
+            trace[sizeof(kMagic)] != kVersion)
+            return false;
+
+        lock.lock();
+        running = true;
+        stopping = false;
+        worker = std::thread([this, speed, done] { Run(speed, done); });
+        return true;
+    }
+
+    void EventReplayer::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_one();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    void EventReplayer::Run(double speed, DoneFunction done)
+    {
+        EventReplayStats stats;
+        Reader reader{trace.data() + sizeof(kMagic) + 1, trace.data() + trace.size()};
+        auto start = Clock::now();
+        int64_t recordedNanos = 0;
+        auto ok = true;
+        while (reader.data != reader.end)
+        {
+            auto event = reader.Varint();
+            auto delta = reader.Varint();
+            auto size = static_cast<size_t>(reader.Varint());
+            auto arguments = reader.Bytes(size);
+            if (!reader.ok)
+            {
+                ok = false;
+                break;
+            }
+
+            recordedNanos += static_cast<int64_t>(delta);
+            std::unique_lock<std::mutex> lock(mutex);
+            if (speed > 0)
+            {
+                auto due = start + std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(recordedNanos) / speed));
+                condition.wait_until(lock, due, [this] { return stopping; });
+            }
+            if (stopping)
+                break;
+            lock.unlock();
+
+            if (event < static_cast<uint64_t>(kRtcEngineEventCount) &&
+                Dispatch(static_cast<int>(event), arguments, size, stats))
+                stats.events++;
+            else
+                stats.skipped++;
+        }
+        stats.durationNanos = NanosSince(start);
+        if (stats.durationNanos > 0)
+            stats.eventsPerSecond = static_cast<double>(stats.events) * 1e9 / static_cast<double>(stats.durationNanos);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        if (done)
+            done(ok, stats);
+    }
+
+    bool EventReplayer::Dispatch(int event, const uint8_t* payload, size_t size, EventReplayStats& stats)
+    {
+        Reader reader{payload, payload + size};
+        switch (static_cast<RtcEngineEvent>(event))
+        {
+#define AGORA_RTC_ENGINE_EVENT_REPLAY(id, name, parameters, arguments) \
+        case RtcEngineEvent::name: \
+            return Invoke(target, &IRtcEngineEventHandler::name, reader, stats);
+#define AGORA_RTC_ENGINE_EVENT_SKIP(id, name, parameters, arguments)
+            AGORA_RTC_ENGINE_EVENTS(AGORA_RTC_ENGINE_EVENT_REPLAY, AGORA_RTC_ENGINE_EVENT_SKIP)
+#undef AGORA_RTC_ENGINE_EVENT_SKIP
+#undef AGORA_RTC_ENGINE_EVENT_REPLAY
+
+        case RtcEngineEvent::onAudioVolumeIndication:
+        {
+            unsigned int speakerNumber = 0;
+            int totalVolume = 0;
+            Decode(reader, speakerNumber);
+            Decode(reader, totalVolume);
+            // Each speaker takes at least three bytes
+            if (!reader.ok || speakerNumber > size / 3)
+                return false;
+            std::vector<AudioVolumeInfo> speakers(speakerNumber);
+            for (auto& speaker : speakers)
+            {
+                Decode(reader, speaker.uid);
+                Decode(reader, speaker.volume);
+                Decode(reader, speaker.vad);
+            }
+            if (!reader.ok)
+                return false;
+            Time(stats, [&] { target->onAudioVolumeIndication(speakers.data(), speakerNumber, totalVolume); });
+            return true;
+        }
+
+        case RtcEngineEvent::onStreamMessage:
+        {
+            uid_t uid = 0;
+            int streamId = 0;
+            size_t length = 0;
+            Decode(reader, uid);
+            Decode(reader, streamId);
+            Decode(reader, length);
+            auto bytes = reader.Bytes(length);
+            if (!reader.ok)
+                return false;
+            Time(stats, [&] {
+                target->onStreamMessage(uid, streamId, reinterpret_cast<const char*>(bytes), length);
+            });
+            return true;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+}  // namespace agora_rtc_engine
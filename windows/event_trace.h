@@ -0,0 +1,124 @@
+#ifndef AGORA_RTC_ENGINE_EVENT_TRACE_H_
+#define AGORA_RTC_ENGINE_EVENT_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IAgoraRtcEngine.h"
+
+#include "rtc_engine_events.h"
+
+namespace agora_rtc_engine {
+
+    struct EventRecordingStats
+    {
+        uint64_t events = 0;
+        uint64_t bytes = 0;
+    };
+
+    struct EventReplayStats
+    {
+        uint64_t events = 0;
+        // Records with an unknown id or bad arguments.
+        uint64_t skipped = 0;
+        int64_t durationNanos = 0;
+        // Time spent inside the handler, i.e. the event path itself.
+        int64_t handlerNanos = 0;
+        int64_t maxHandlerNanos = 0;
+        double eventsPerSecond = 0;
+    };
+
+    // The engine's event handler when recording is wanted: forwards every
+    // callback to |target| and, while recording, also appends it to a trace.
+    //
+    // Trace layout: the magic "AETR" and a version byte, then one record per
+    // callback of [event id][nanoseconds since the previous record][argument
+    // length][arguments], all varints. Signed integers are zigzag encoded,
+    // strings are their length plus one (0 for null) and their bytes, structs
+    // their size and their bytes.
+    class EventRecorder : public agora::rtc::IRtcEngineEventHandler
+    {
+    public:
+        explicit EventRecorder(agora::rtc::IRtcEngineEventHandler* target);
+
+        ~EventRecorder();
+
+        // Prevent copying
+        EventRecorder(EventRecorder const&) = delete;
+        EventRecorder& operator=(EventRecorder const&) = delete;
+
+        // Starts a new trace at |path|, ending the current one.
+        bool Start(const std::string& path);
+
+        // Writes what is buffered and closes the trace.
+        EventRecordingStats Stop();
+
+#define AGORA_RTC_ENGINE_EVENT_OVERRIDE(id, name, parameters, arguments) \
+        void name parameters override;
+        AGORA_RTC_ENGINE_EVENTS(AGORA_RTC_ENGINE_EVENT_OVERRIDE, AGORA_RTC_ENGINE_EVENT_OVERRIDE)
+#undef AGORA_RTC_ENGINE_EVENT_OVERRIDE
+
+    private:
+        void Record(RtcEngineEvent event, const std::vector<uint8_t>& arguments);
+
+        agora::rtc::IRtcEngineEventHandler* target;
+        std::atomic<bool> recording{false};
+
+        std::mutex mutex;
+        std::ofstream file;
+        std::vector<uint8_t> buffer;
+        std::chrono::steady_clock::time_point last;
+        EventRecordingStats recorded;
+    };
+
+    // Feeds a trace back into an event handler on a thread of its own,
+    // either at the recorded pace or as fast as the handler allows.
+    class EventReplayer
+    {
+    public:
+        // Called on the replay thread once the trace ends or fails.
+        using DoneFunction = std::function<void(bool ok, const EventReplayStats& stats)>;
+
+        explicit EventReplayer(agora::rtc::IRtcEngineEventHandler* target);
+
+        ~EventReplayer();
+
+        // Prevent copying
+        EventReplayer(EventReplayer const&) = delete;
+        EventReplayer& operator=(EventReplayer const&) = delete;
+
+        // Replays |path| at |speed| times the recorded pace, 0 for unlimited.
+        // Fails if a replay is running or the trace cannot be read.
+        bool Start(const std::string& path, double speed, DoneFunction done);
+
+        // Stops the running replay, its DoneFunction still being called.
+        void Stop();
+
+    private:
+        void Run(double speed, DoneFunction done);
+
+        // Decodes one record and calls the handler, returns false if it is
+        // malformed.
+        bool Dispatch(int event, const uint8_t* payload, size_t size, EventReplayStats& stats);
+
+        agora::rtc::IRtcEngineEventHandler* target;
+        std::vector<uint8_t> trace;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool stopping = false;
+        bool running = false;
+        std::thread worker;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_EVENT_TRACE_H_
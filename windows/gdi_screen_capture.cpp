@@ -0,0 +1,100 @@
+#include "gdi_screen_capture.h"
+
+namespace agora_rtc_engine {
+
+    GdiScreenCapture::GdiScreenCapture(RECT rect)
+        : rect(rect)
+    {
+    }
+
+    GdiScreenCapture::GdiScreenCapture(HWND window)
+        : window(window)
+    {
+    }
+
+    GdiScreenCapture::~GdiScreenCapture()
+    {
+        ReleaseBitmap();
+    }
+
+    bool GdiScreenCapture::Capture(ScreenFrame& frame)
+    {
+        RECT bounds = rect;
+        if (window != nullptr && (!::IsWindow(window) || !::GetWindowRect(window, &bounds)))
+            return false;
+        if (!EnsureBitmap(bounds.right - bounds.left, bounds.bottom - bounds.top))
+            return false;
+
+        bool captured;
+        if (window != nullptr)
+        {
+            // Renders the window itself, so overlapping windows do not show
+            captured = ::PrintWindow(window, memoryDC, PW_RENDERFULLCONTENT) != FALSE;
+        }
+        else
+        {
+            auto screenDC = ::GetDC(nullptr);
+            // CAPTUREBLT includes layered windows such as tooltips
+            captured = ::BitBlt(memoryDC, 0, 0, width, height, screenDC, bounds.left, bounds.top, SRCCOPY | CAPTUREBLT) != FALSE;
+            ::ReleaseDC(nullptr, screenDC);
+        }
+        if (!captured)
+            return false;
+        ::GdiFlush();
+
+        frame.data = pixels;
+        frame.width = width;
+        frame.height = height;
+        frame.stride = width * 4;
+        return true;
+    }
+
+    bool GdiScreenCapture::EnsureBitmap(int newWidth, int newHeight)
+    {
+        if (newWidth <= 0 || newHeight <= 0)
+            return false;
+        if (bitmap != nullptr && newWidth == width && newHeight == height)
+            return true;
+        ReleaseBitmap();
+
+        BITMAPINFO info = {};
+        info.bmiHeader.biSize = sizeof(info.bmiHeader);
+        info.bmiHeader.biWidth = newWidth;
+        // Negative for top-down rows, as video frames are
+        info.bmiHeader.biHeight = -newHeight;
+        info.bmiHeader.biPlanes = 1;
+        info.bmiHeader.biBitCount = 32;
+        info.bmiHeader.biCompression = BI_RGB;
+
+        memoryDC = ::CreateCompatibleDC(nullptr);
+        void* bits = nullptr;
+        bitmap = ::CreateDIBSection(memoryDC, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+        if (memoryDC == nullptr || bitmap == nullptr)
+        {
+            ReleaseBitmap();
+            return false;
+        }
+        previousBitmap = ::SelectObject(memoryDC, bitmap);
+        pixels = static_cast<uint8_t*>(bits);
+        width = newWidth;
+        height = newHeight;
+        return true;
+    }
+
+    void GdiScreenCapture::ReleaseBitmap()
+    {
+        if (memoryDC != nullptr && previousBitmap != nullptr)
+            ::SelectObject(memoryDC, previousBitmap);
+        if (bitmap != nullptr)
+            ::DeleteObject(bitmap);
+        if (memoryDC != nullptr)
+            ::DeleteDC(memoryDC);
+        memoryDC = nullptr;
+        bitmap = nullptr;
+        previousBitmap = nullptr;
+        pixels = nullptr;
+        width = 0;
+        height = 0;
+    }
+
+}  // namespace agora_rtc_engine
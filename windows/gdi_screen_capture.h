@@ -0,0 +1,47 @@
+#ifndef AGORA_RTC_ENGINE_GDI_SCREEN_CAPTURE_H_
+#define AGORA_RTC_ENGINE_GDI_SCREEN_CAPTURE_H_
+
+#include <windows.h>
+
+#include "screen_share_source.h"
+
+namespace agora_rtc_engine {
+
+    // Captures a rectangle of the virtual screen, or a window even when it is
+    // covered, into a top-down BGRA bitmap reused between captures.
+    class GdiScreenCapture : public ScreenCaptureBackend
+    {
+    public:
+        // Captures |rect|, in virtual screen coordinates.
+        explicit GdiScreenCapture(RECT rect);
+
+        // Captures |window|, following its size.
+        explicit GdiScreenCapture(HWND window);
+
+        ~GdiScreenCapture() override;
+
+        // Prevent copying
+        GdiScreenCapture(GdiScreenCapture const&) = delete;
+        GdiScreenCapture& operator=(GdiScreenCapture const&) = delete;
+
+        bool Capture(ScreenFrame& frame) override;
+
+    private:
+        bool EnsureBitmap(int width, int height);
+
+        void ReleaseBitmap();
+
+        HWND window = nullptr;
+        RECT rect = {};
+
+        HDC memoryDC = nullptr;
+        HBITMAP bitmap = nullptr;
+        HGDIOBJ previousBitmap = nullptr;
+        uint8_t* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_GDI_SCREEN_CAPTURE_H_
@@ -0,0 +1,109 @@
+#include "image_encoder.h"
+
+// This must be included before wincodec.h.
+#include <windows.h>
+
+#include <objidl.h>
+#include <wincodec.h>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // Releases a COM interface when going out of scope.
+        template <typename T>
+        class ComPtr
+        {
+        public:
+            ComPtr() = default;
+            ~ComPtr()
+            {
+                if (pointer != nullptr)
+                    pointer->Release();
+            }
+
+            // Prevent copying
+            ComPtr(ComPtr const&) = delete;
+            ComPtr& operator=(ComPtr const&) = delete;
+
+            T* operator->() const { return pointer; }
+            T* get() const { return pointer; }
+            T** put() { return &pointer; }
+
+        private:
+            T* pointer = nullptr;
+        };
+
+        bool Encode(const uint8_t* bgr, int width, int height, int stride,
+            ImageFormat format, float quality, std::vector<uint8_t>& encoded)
+        {
+            ComPtr<IWICImagingFactory> factory;
+            if (FAILED(::CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+                IID_PPV_ARGS(factory.put()))))
+                return false;
+
+            ComPtr<IStream> stream;
+            if (FAILED(::CreateStreamOnHGlobal(nullptr, TRUE, stream.put())))
+                return false;
+
+            ComPtr<IWICBitmapEncoder> encoder;
+            auto container = format == ImageFormat::Jpeg ? GUID_ContainerFormatJpeg : GUID_ContainerFormatPng;
+            if (FAILED(factory->CreateEncoder(container, nullptr, encoder.put())) ||
+                FAILED(encoder->Initialize(stream.get(), WICBitmapEncoderNoCache)))
+                return false;
+
+            ComPtr<IWICBitmapFrameEncode> frame;
+            ComPtr<IPropertyBag2> properties;
+            if (FAILED(encoder->CreateNewFrame(frame.put(), properties.put())))
+                return false;
+
+            if (format == ImageFormat::Jpeg)
+            {
+                PROPBAG2 option = {};
+                option.pstrName = const_cast<LPOLESTR>(L"ImageQuality");
+                VARIANT value;
+                ::VariantInit(&value);
+                value.vt = VT_R4;
+                value.fltVal = quality;
+                properties->Write(1, &option, &value);
+            }
+
+            WICPixelFormatGUID pixelFormat = GUID_WICPixelFormat24bppBGR;
+            if (FAILED(frame->Initialize(properties.get())) ||
+                FAILED(frame->SetSize(static_cast<UINT>(width), static_cast<UINT>(height))) ||
+                FAILED(frame->SetPixelFormat(&pixelFormat)) ||
+                !IsEqualGUID(pixelFormat, GUID_WICPixelFormat24bppBGR))
+                return false;
+
+            auto size = static_cast<UINT>(stride) * static_cast<UINT>(height);
+            if (FAILED(frame->WritePixels(static_cast<UINT>(height), static_cast<UINT>(stride), size,
+                const_cast<BYTE*>(bgr))) ||
+                FAILED(frame->Commit()) ||
+                FAILED(encoder->Commit()))
+                return false;
+
+            HGLOBAL global = nullptr;
+            if (FAILED(::GetHGlobalFromStream(stream.get(), &global)))
+                return false;
+            STATSTG stat = {};
+            if (FAILED(stream->Stat(&stat, STATFLAG_NONAME)))
+                return false;
+            auto data = static_cast<const uint8_t*>(::GlobalLock(global));
+            if (data == nullptr)
+                return false;
+            encoded.assign(data, data + static_cast<size_t>(stat.cbSize.QuadPart));
+            ::GlobalUnlock(global);
+            return true;
+        }
+    }  // namespace
+
+    bool EncodeImage(const uint8_t* bgr, int width, int height, int stride,
+        ImageFormat format, float quality, std::vector<uint8_t>& encoded)
+    {
+        auto initialized = SUCCEEDED(::CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+        auto success = Encode(bgr, width, height, stride, format, quality, encoded);
+        if (initialized)
+            ::CoUninitialize();
+        return success;
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,26 @@
+#ifndef AGORA_RTC_ENGINE_IMAGE_ENCODER_H_
+#define AGORA_RTC_ENGINE_IMAGE_ENCODER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace agora_rtc_engine {
+
+    // Must match the order of the Dart `ImageFormat` enum.
+    enum class ImageFormat
+    {
+        Png = 0,
+        Jpeg = 1,
+    };
+
+    // Encodes a 24-bit BGR image with the Windows Imaging Component.
+    //
+    // Initializes COM on the calling thread for the duration of the call, so it
+    // can be used from any worker thread. |quality| in [0, 1] only applies to
+    // JPEG. Returns false if any step of the encoding fails.
+    bool EncodeImage(const uint8_t* bgr, int width, int height, int stride,
+        ImageFormat format, float quality, std::vector<uint8_t>& encoded);
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_IMAGE_ENCODER_H_
@@ -0,0 +1,205 @@
+#include "log_mel_extractor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const size_t kReadBatch = 32;
+        // Keeps silence finite
+        const float kPowerFloor = 1e-10f;
+        const double kPi = 3.14159265358979323846;
+
+        // The Slaney mel scale: linear below 1 kHz, logarithmic above.
+        double HzToMel(double hz)
+        {
+            const double linear = 200.0 / 3;
+            const double logStep = std::log(6.4) / 27;
+            if (hz < 1000)
+                return hz / linear;
+            return 1000 / linear + std::log(hz / 1000) / logStep;
+        }
+
+        double MelToHz(double mel)
+        {
+            const double linear = 200.0 / 3;
+            const double logStep = std::log(6.4) / 27;
+            if (mel < 1000 / linear)
+                return mel * linear;
+            return 1000 * std::exp(logStep * (mel - 1000 / linear));
+        }
+    }  // namespace
+
+    LogMelExtractor::LogMelExtractor(AudioFrameSource source, size_t frames)
+        : extractorSource(source),
+        fft(kLogMelFftSize),
+        window(kLogMelWindow),
+        windowed(kLogMelFftSize, 0.0f),
+        power(kLogMelFftSize / 2 + 1),
+        queue(frames, QueueOverflow::OverwriteOldest),
+        batch(kReadBatch)
+    {
+        // Periodic Hann
+        for (int i = 0; i < kLogMelWindow; ++i)
+            window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2 * kPi * i / kLogMelWindow));
+
+        // Triangles between adjacent mel points, normalized to equal area
+        auto maxMel = HzToMel(kLogMelSampleRate / 2.0);
+        std::vector<double> edges(kLogMelBins + 2);
+        for (int m = 0; m < kLogMelBins + 2; ++m)
+            edges[m] = MelToHz(maxMel * m / (kLogMelBins + 1));
+        auto binHz = static_cast<double>(kLogMelSampleRate) / kLogMelFftSize;
+        for (int m = 0; m < kLogMelBins; ++m)
+        {
+            MelBand band;
+            band.first = -1;
+            auto lower = edges[m];
+            auto center = edges[m + 1];
+            auto upper = edges[m + 2];
+            auto norm = 2 / (upper - lower);
+            for (int k = 0; k <= kLogMelFftSize / 2; ++k)
+            {
+                auto hz = k * binHz;
+                auto weight = std::max(0.0, std::min((hz - lower) / (center - lower), (upper - hz) / (upper - center)));
+                if (weight <= 0)
+                {
+                    if (band.first >= 0)
+                        break;
+                    continue;
+                }
+                if (band.first < 0)
+                    band.first = k;
+                band.weights.resize(static_cast<size_t>(k - band.first), 0.0f);
+                band.weights.push_back(static_cast<float>(weight * norm));
+            }
+            if (band.first < 0)
+                band.first = 0;
+            bands.push_back(std::move(band));
+        }
+
+        samples.reserve(kLogMelWindow + kLogMelSampleRate / 100);
+    }
+
+    AudioFrameSource LogMelExtractor::source() const
+    {
+        return extractorSource;
+    }
+
+    void LogMelExtractor::Write(const AudioFrameView& frame)
+    {
+        if (frame.format.sampleRate != kLogMelSampleRate || frame.format.channels != 1)
+            return;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frame.frames; ++i)
+            samples.push_back(frame.samples[i] / 32768.0f);
+        size_t consumed = 0;
+        while (samples.size() - consumed >= kLogMelWindow)
+        {
+            std::transform(window.begin(), window.end(), samples.begin() + consumed, windowed.begin(), std::multiplies<float>());
+            Extract();
+            consumed += kLogMelHop;
+        }
+        samples.erase(samples.begin(), samples.begin() + consumed);
+        inputFrames.fetch_add(static_cast<uint64_t>(frame.frames), std::memory_order_relaxed);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        processingNanos.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+    }
+
+    void LogMelExtractor::Extract()
+    {
+        // |windowed| stays zero past the window, padding it to the FFT size
+        fft.PowerSpectrum(windowed.data(), power.data());
+        LogMelFrame frame;
+        frame.index = nextIndex++;
+        for (int m = 0; m < kLogMelBins; ++m)
+        {
+            const auto& band = bands[m];
+            float energy = 0;
+            for (size_t k = 0; k < band.weights.size(); ++k)
+                energy += band.weights[k] * power[band.first + k];
+            frame.bins[m] = std::log10(std::max(energy, kPowerFloor));
+        }
+        queue.Push(frame);
+        extracted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t LogMelExtractor::Read(std::vector<float>& features, uint64_t& first)
+    {
+        size_t total = 0;
+        while (true)
+        {
+            auto popped = queue.PopBatch(batch.data(), batch.size());
+            for (size_t i = 0; i < popped; ++i)
+            {
+                if (total == 0)
+                    first = batch[i].index;
+                features.insert(features.end(), batch[i].bins.begin(), batch[i].bins.end());
+                total++;
+            }
+            if (popped < batch.size())
+                return total;
+        }
+    }
+
+    LogMelStats LogMelExtractor::GetStats() const
+    {
+        LogMelStats stats;
+        stats.frames = extracted;
+        stats.dropped = queue.GetStats().overwritten;
+        auto audioNanos = static_cast<double>(inputFrames.load()) * 1e9 / kLogMelSampleRate;
+        if (audioNanos > 0)
+            stats.realTimeFactor = static_cast<double>(processingNanos.load()) / audioNanos;
+        return stats;
+    }
+
+    LogMelBenchmark BenchmarkLogMel(int seconds)
+    {
+        LogMelBenchmark benchmark;
+        const int frameSamples = kLogMelSampleRate / 100;
+        auto total = static_cast<size_t>(seconds) * kLogMelSampleRate;
+        // A gliding tone over noise, so that every band has energy
+        std::vector<int16_t> audio(total);
+        uint32_t noise = 1;
+        double phase = 0;
+        for (size_t i = 0; i < total; ++i)
+        {
+            noise = noise * 1664525u + 1013904223u;
+            auto hz = 200 + 3000.0 * static_cast<int>(i % kLogMelSampleRate) / kLogMelSampleRate;
+            phase += 2 * kPi * hz / kLogMelSampleRate;
+            audio[i] = static_cast<int16_t>(8000 * std::sin(phase) + static_cast<int32_t>(noise >> 16) / 16 - 2048);
+        }
+
+        LogMelExtractor extractor(AudioFrameSource::Record, 1024);
+        std::vector<float> features;
+        uint64_t first;
+        AudioFrameView frame;
+        frame.format.sampleRate = kLogMelSampleRate;
+        frame.format.channels = 1;
+        frame.frames = frameSamples;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset + frameSamples <= total; offset += frameSamples)
+        {
+            frame.samples = audio.data() + offset;
+            extractor.Write(frame);
+            // Once a second, as a reader would
+            if ((offset / frameSamples) % 100 == 99)
+            {
+                features.clear();
+                extractor.Read(features, first);
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        benchmark.audioSeconds = static_cast<double>(total) / kLogMelSampleRate;
+        benchmark.frames = extractor.GetStats().frames;
+        if (benchmark.frames > 0)
+            benchmark.nanosPerFrame = elapsed / static_cast<double>(benchmark.frames);
+        if (benchmark.audioSeconds > 0)
+            benchmark.realTimeFactor = elapsed / (benchmark.audioSeconds * 1e9);
+        return benchmark;
+    }
+
+}  // namespace agora_rtc_engine
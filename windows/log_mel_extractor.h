@@ -0,0 +1,114 @@
+#ifndef AGORA_RTC_ENGINE_LOG_MEL_EXTRACTOR_H_
+#define AGORA_RTC_ENGINE_LOG_MEL_EXTRACTOR_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "audio_frame_hub.h"
+#include "bounded_queue.h"
+#include "real_fft.h"
+
+namespace agora_rtc_engine {
+
+    // 25 ms windows every 10 ms of 16 kHz mono, as speech recognizers
+    // expect.
+    const int kLogMelSampleRate = 16000;
+    const int kLogMelBins = 80;
+    const int kLogMelWindow = 400;
+    const int kLogMelHop = 160;
+    const int kLogMelFftSize = 512;
+
+    struct LogMelFrame
+    {
+        // Of the frame since the extractor started, one every 10 ms.
+        uint64_t index;
+        // log10 of each band's power, for 16-bit full scale samples in
+        // [-1, 1).
+        std::array<float, kLogMelBins> bins;
+    };
+
+    struct LogMelStats
+    {
+        uint64_t frames = 0;
+        // Frames dropped because the reader fell behind.
+        uint64_t dropped = 0;
+        // Time spent extracting over the duration of the audio.
+        double realTimeFactor = 0;
+    };
+
+    // Turns the 16 kHz mono frames an AudioFrameHub delivers into log-mel
+    // features on the audio thread, then hands them to a reader on another
+    // thread through a ring of preallocated frames, overwriting the oldest
+    // if the reader falls behind.
+    //
+    // Each hop takes a Hann-windowed power spectrum, sums it into Slaney
+    // mel bands from 0 to 8 kHz, and compresses it with log10, the
+    // features Whisper-style models are trained on.
+    class LogMelExtractor
+    {
+    public:
+        LogMelExtractor(AudioFrameSource source, size_t frames);
+
+        // Prevent copying
+        LogMelExtractor(LogMelExtractor const&) = delete;
+        LogMelExtractor& operator=(LogMelExtractor const&) = delete;
+
+        AudioFrameSource source() const;
+
+        // Called on the audio thread, with 16 kHz mono frames.
+        void Write(const AudioFrameView& frame);
+
+        // Appends the frames extracted since the last call, kLogMelBins
+        // values each, and sets |first| to the index of the first one.
+        // Returns how many.
+        size_t Read(std::vector<float>& features, uint64_t& first);
+
+        LogMelStats GetStats() const;
+
+    private:
+        // A band's weights, from FFT bin |first| on.
+        struct MelBand
+        {
+            int first;
+            std::vector<float> weights;
+        };
+
+        void Extract();
+
+        AudioFrameSource extractorSource;
+        RealFft fft;
+        std::vector<float> window;
+        std::vector<MelBand> bands;
+
+        // Audio thread: the samples not yet a whole hop past the last window
+        std::vector<float> samples;
+        std::vector<float> windowed;
+        std::vector<float> power;
+        uint64_t nextIndex = 0;
+
+        SpscQueue<LogMelFrame> queue;
+        std::vector<LogMelFrame> batch;
+
+        std::atomic<uint64_t> extracted{0};
+        std::atomic<uint64_t> inputFrames{0};
+        std::atomic<uint64_t> processingNanos{0};
+    };
+
+    struct LogMelBenchmark
+    {
+        double audioSeconds = 0;
+        uint64_t frames = 0;
+        double nanosPerFrame = 0;
+        // Extraction time over audio time, on one core.
+        double realTimeFactor = 0;
+    };
+
+    // Extracts the features of |seconds| of synthetic speech-band audio on
+    // the calling thread, fed in 10 ms frames as the SDK does.
+    LogMelBenchmark BenchmarkLogMel(int seconds);
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_LOG_MEL_EXTRACTOR_H_
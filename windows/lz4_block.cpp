@@ -0,0 +1,155 @@
+#include "lz4_block.h"
+
+#include <cstring>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const size_t kMinMatch = 4;
+        // The format requires the last 5 bytes to be literals and the last
+        // match to start at least 12 bytes before the end.
+        const size_t kLastLiterals = 5;
+        const size_t kMatchLimit = 12;
+        const size_t kMaxOffset = 65535;
+        const int kHashBits = 12;
+
+        uint32_t Read32(const uint8_t* p)
+        {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint32_t Hash(uint32_t value)
+        {
+            return (value * 2654435761u) >> (32 - kHashBits);
+        }
+
+        uint8_t* WriteLength(uint8_t* out, size_t length)
+        {
+            while (length >= 255)
+            {
+                *out++ = 255;
+                length -= 255;
+            }
+            *out++ = static_cast<uint8_t>(length);
+            return out;
+        }
+
+        uint8_t* WriteSequence(uint8_t* out, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength)
+        {
+            auto token = out++;
+            *token = static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+            if (literalLength >= 15)
+                out = WriteLength(out, literalLength - 15);
+            // Empty input may come with null pointers, which memcpy must
+            // not be given even for no bytes
+            if (literalLength > 0)
+                std::memcpy(out, literals, literalLength);
+            out += literalLength;
+            if (matchLength == 0)
+                return out;
+
+            *out++ = static_cast<uint8_t>(offset);
+            *out++ = static_cast<uint8_t>(offset >> 8);
+            auto extra = matchLength - kMinMatch;
+            *token = static_cast<uint8_t>(*token | (extra < 15 ? extra : 15));
+            if (extra >= 15)
+                out = WriteLength(out, extra - 15);
+            return out;
+        }
+
+        bool ReadLength(const uint8_t*& in, const uint8_t* end, size_t& length)
+        {
+            uint8_t byte;
+            do
+            {
+                if (in >= end)
+                    return false;
+                byte = *in++;
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+    }  // namespace
+
+    size_t Lz4CompressBound(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    size_t Lz4Compress(const uint8_t* in, size_t size, uint8_t* out)
+    {
+        auto start = out;
+        size_t anchor = 0;
+        if (size > kMatchLimit)
+        {
+            // Positions are stored off by one, 0 marks an empty slot
+            uint32_t table[1 << kHashBits] = {};
+            size_t position = 0;
+            while (position < size - kMatchLimit)
+            {
+                auto value = Read32(in + position);
+                auto& slot = table[Hash(value)];
+                size_t candidate = slot;
+                slot = static_cast<uint32_t>(position + 1);
+                if (candidate == 0 || position - (candidate - 1) > kMaxOffset || Read32(in + candidate - 1) != value)
+                {
+                    position++;
+                    continue;
+                }
+                candidate--;
+
+                auto length = kMinMatch;
+                while (position + length < size - kLastLiterals && in[candidate + length] == in[position + length])
+                    length++;
+                out = WriteSequence(out, in + anchor, position - anchor, position - candidate, length);
+                position += length;
+                anchor = position;
+            }
+        }
+        out = WriteSequence(out, in + anchor, size - anchor, 0, 0);
+        return static_cast<size_t>(out - start);
+    }
+
+    bool Lz4Decompress(const uint8_t* in, size_t size, uint8_t* out, size_t outSize)
+    {
+        auto end = in + size;
+        size_t written = 0;
+        while (in < end)
+        {
+            auto token = *in++;
+            size_t literalLength = token >> 4;
+            if (literalLength == 15 && !ReadLength(in, end, literalLength))
+                return false;
+            if (literalLength > static_cast<size_t>(end - in) || literalLength > outSize - written)
+                return false;
+            if (literalLength > 0)
+                std::memcpy(out + written, in, literalLength);
+            in += literalLength;
+            written += literalLength;
+            // The last sequence has no match
+            if (in == end)
+                break;
+
+            if (end - in < 2)
+                return false;
+            size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+            in += 2;
+            if (offset == 0 || offset > written)
+                return false;
+            size_t matchLength = token & 15;
+            if (matchLength == 15 && !ReadLength(in, end, matchLength))
+                return false;
+            matchLength += kMinMatch;
+            if (matchLength > outSize - written)
+                return false;
+            // Matches may overlap their own output
+            for (size_t i = 0; i < matchLength; ++i)
+                out[written + i] = out[written + i - offset];
+            written += matchLength;
+        }
+        return written == outSize;
+    }
+
+}  // namespace agora_rtc_engine
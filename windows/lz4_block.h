@@ -0,0 +1,25 @@
+#ifndef AGORA_RTC_ENGINE_LZ4_BLOCK_H_
+#define AGORA_RTC_ENGINE_LZ4_BLOCK_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace agora_rtc_engine {
+
+    // A minimal codec for the LZ4 block format, enough for the small messages
+    // of the data stream transport and readable by any LZ4 decoder.
+
+    // Size of the output buffer Lz4Compress needs for |size| bytes of input.
+    size_t Lz4CompressBound(size_t size);
+
+    // Compresses |size| bytes of |in| into |out|, which must hold at least
+    // Lz4CompressBound(|size|) bytes. Returns the compressed size.
+    size_t Lz4Compress(const uint8_t* in, size_t size, uint8_t* out);
+
+    // Decompresses a block that expands to exactly |outSize| bytes. Returns
+    // false if the block is malformed or does not match |outSize|.
+    bool Lz4Decompress(const uint8_t* in, size_t size, uint8_t* out, size_t outSize);
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_LZ4_BLOCK_H_
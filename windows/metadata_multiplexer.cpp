@@ -0,0 +1,204 @@
+#include "metadata_multiplexer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const uint8_t kMagic = 0x6d;
+        const size_t kRecordHeaderSize = 3;
+        const int kMaxQueueLength = 256;
+    }  // namespace
+
+    MetadataMultiplexer::MetadataMultiplexer(DeliverFunction deliver)
+        : deliver(std::move(deliver))
+    {
+    }
+
+    bool MetadataMultiplexer::SetChannel(int channel, const MetadataChannelOptions& options)
+    {
+        if (channel < 0 || channel >= kMaxChannels || options.queueLength < 1 || options.queueLength > kMaxQueueLength)
+            return false;
+        auto queueLength = static_cast<size_t>(options.latestOnly ? 1 : options.queueLength);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& state = channels[channel];
+        state.active = true;
+        state.options = options;
+        state.storage.resize(queueLength * kMaxMessageSize);
+        state.sizes.assign(queueLength, 0);
+        state.head = 0;
+        state.count = 0;
+        UpdateOrder();
+        return true;
+    }
+
+    void MetadataMultiplexer::RemoveChannel(int channel)
+    {
+        if (channel < 0 || channel >= kMaxChannels)
+            return;
+        std::lock_guard<std::mutex> lock(mutex);
+        channels[channel] = Channel();
+        UpdateOrder();
+    }
+
+    void MetadataMultiplexer::Reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& channel : channels)
+            channel = Channel();
+        UpdateOrder();
+        slots = 0;
+        usedSlots = 0;
+        packedBytes = 0;
+        for (auto& count : received)
+            count = 0;
+        malformed = 0;
+    }
+
+    bool MetadataMultiplexer::Send(int channel, const uint8_t* data, size_t size)
+    {
+        if (channel < 0 || channel >= kMaxChannels)
+            return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& state = channels[channel];
+        if (!state.active || size > kMaxMessageSize)
+        {
+            state.rejected++;
+            return false;
+        }
+        auto queueLength = static_cast<int>(state.sizes.size());
+        if (state.count == queueLength)
+        {
+            // Newer side data supersedes the oldest
+            state.head = (state.head + 1) % queueLength;
+            state.count--;
+            state.dropped++;
+        }
+        auto slot = static_cast<size_t>((state.head + state.count) % queueLength);
+        if (size > 0)
+            std::memcpy(state.storage.data() + slot * kMaxMessageSize, data, size);
+        state.sizes[slot] = static_cast<uint16_t>(size);
+        state.count++;
+        return true;
+    }
+
+    MetadataStats MetadataMultiplexer::GetStats() const
+    {
+        MetadataStats stats;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < kMaxChannels; ++i)
+        {
+            auto& state = channels[i];
+            uint64_t count = received[i];
+            if (!state.active && count == 0 && state.rejected == 0)
+                continue;
+            MetadataChannelStats channel;
+            channel.channel = i;
+            channel.queued = static_cast<uint64_t>(state.count);
+            channel.sent = state.sent;
+            channel.dropped = state.dropped;
+            channel.rejected = state.rejected;
+            channel.received = count;
+            stats.channels.push_back(channel);
+        }
+        stats.slots = slots;
+        stats.usedSlots = usedSlots;
+        stats.packedBytes = packedBytes;
+        if (slots > 0)
+            stats.fillRate = static_cast<double>(packedBytes) / static_cast<double>(slots * kMaxMetadataSize);
+        stats.malformed = malformed;
+        return stats;
+    }
+
+    int MetadataMultiplexer::getMaxMetadataSize()
+    {
+        return static_cast<int>(kMaxMetadataSize);
+    }
+
+    bool MetadataMultiplexer::onReadyToSendMetadata(Metadata& metadata)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots++;
+        auto out = metadata.buffer;
+        size_t used = 1;
+        for (int i = 0; i < orderCount; ++i)
+        {
+            auto& state = channels[order[i]];
+            auto queueLength = static_cast<int>(state.sizes.size());
+            while (state.count > 0)
+            {
+                auto slot = static_cast<size_t>(state.head);
+                size_t size = state.sizes[slot];
+                if (used + kRecordHeaderSize + size > kMaxMetadataSize)
+                    break;
+                out[used] = static_cast<uint8_t>(order[i]);
+                out[used + 1] = static_cast<uint8_t>(size);
+                out[used + 2] = static_cast<uint8_t>(size >> 8);
+                if (size > 0)
+                    std::memcpy(out + used + kRecordHeaderSize, state.storage.data() + slot * kMaxMessageSize, size);
+                used += kRecordHeaderSize + size;
+                state.head = (state.head + 1) % queueLength;
+                state.count--;
+                state.sent++;
+            }
+        }
+        if (used == 1)
+        {
+            metadata.size = 0;
+            return false;
+        }
+        out[0] = kMagic;
+        metadata.size = static_cast<unsigned int>(used);
+        usedSlots++;
+        packedBytes += used;
+        return true;
+    }
+
+    void MetadataMultiplexer::onMetadataReceived(const Metadata& metadata)
+    {
+        auto data = metadata.buffer;
+        size_t size = metadata.size;
+        if (data == nullptr || size == 0 || data[0] != kMagic)
+        {
+            malformed++;
+            return;
+        }
+        size_t offset = 1;
+        while (offset < size)
+        {
+            if (size - offset < kRecordHeaderSize)
+            {
+                malformed++;
+                return;
+            }
+            int channel = data[offset];
+            size_t length = static_cast<size_t>(data[offset + 1] | (data[offset + 2] << 8));
+            offset += kRecordHeaderSize;
+            if (channel >= kMaxChannels || length > size - offset)
+            {
+                malformed++;
+                return;
+            }
+            received[channel]++;
+            if (deliver)
+                deliver(metadata.uid, channel, data + offset, length, metadata.timeStampMs);
+            offset += length;
+        }
+    }
+
+    void MetadataMultiplexer::UpdateOrder()
+    {
+        orderCount = 0;
+        for (int i = 0; i < kMaxChannels; ++i)
+        {
+            if (channels[i].active)
+                order[orderCount++] = i;
+        }
+        std::stable_sort(order, order + orderCount, [this](int a, int b) {
+            return channels[a].options.priority > channels[b].options.priority;
+        });
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,130 @@
+#ifndef AGORA_RTC_ENGINE_METADATA_MULTIPLEXER_H_
+#define AGORA_RTC_ENGINE_METADATA_MULTIPLEXER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "IAgoraRtcEngine.h"
+
+namespace agora_rtc_engine {
+
+    struct MetadataChannelOptions
+    {
+        // Channels with a higher priority are packed first.
+        int priority = 0;
+        // Messages waiting for a slot, the oldest is dropped when full.
+        int queueLength = 8;
+        // Keeps only the newest message, e.g. for cursor positions.
+        bool latestOnly = false;
+    };
+
+    struct MetadataChannelStats
+    {
+        int channel = 0;
+        uint64_t queued = 0;
+        uint64_t sent = 0;
+        // Replaced or pushed out of a full queue before being sent.
+        uint64_t dropped = 0;
+        // Too large, or sent on a channel that was not set.
+        uint64_t rejected = 0;
+        uint64_t received = 0;
+    };
+
+    struct MetadataStats
+    {
+        std::vector<MetadataChannelStats> channels;
+        // Metadata slots offered by the SDK, and those that carried messages.
+        uint64_t slots = 0;
+        uint64_t usedSlots = 0;
+        uint64_t packedBytes = 0;
+        // Share of the offered metadata bytes that were used.
+        double fillRate = 0;
+        // Received metadata that was not packed by a MetadataMultiplexer.
+        uint64_t malformed = 0;
+    };
+
+    // Multiplexes logical channels of small messages over video metadata.
+    //
+    // Each channel queues messages into storage preallocated by SetChannel.
+    // Whenever the SDK offers a metadata slot, messages are packed into it in
+    // priority order: a message that does not fit stays queued and lower
+    // priority channels fill what is left. Received metadata is split back
+    // into messages and handed to the deliver function with the timestamp of
+    // the video frame it was attached to.
+    //
+    // Slot layout: a magic byte, then records of
+    // [channel:1][length:2][payload], little endian.
+    class MetadataMultiplexer : public agora::rtc::IMetadataObserver
+    {
+    public:
+        // Called on the SDK thread. |data| is only valid during the call.
+        using DeliverFunction = std::function<void(unsigned int uid, int channel, const uint8_t* data, size_t size, int64_t timeStampMs)>;
+
+        static const int kMaxChannels = 32;
+        // The largest metadata the SDK supports.
+        static const size_t kMaxMetadataSize = 1024;
+        static const size_t kMaxMessageSize = kMaxMetadataSize - 4;
+
+        explicit MetadataMultiplexer(DeliverFunction deliver);
+
+        // Prevent copying
+        MetadataMultiplexer(MetadataMultiplexer const&) = delete;
+        MetadataMultiplexer& operator=(MetadataMultiplexer const&) = delete;
+
+        // Adds or reconfigures |channel|, dropping its queued messages.
+        // Returns false if |channel| or |options| is out of range.
+        bool SetChannel(int channel, const MetadataChannelOptions& options);
+
+        void RemoveChannel(int channel);
+
+        // Removes all channels and clears the counters.
+        void Reset();
+
+        // Queues a message, returns false if it was rejected.
+        bool Send(int channel, const uint8_t* data, size_t size);
+
+        MetadataStats GetStats() const;
+
+        int getMaxMetadataSize() override;
+        bool onReadyToSendMetadata(Metadata& metadata) override;
+        void onMetadataReceived(const Metadata& metadata) override;
+
+    private:
+        struct Channel
+        {
+            bool active = false;
+            MetadataChannelOptions options;
+            // |queueLength| slots of kMaxMessageSize bytes
+            std::vector<uint8_t> storage;
+            std::vector<uint16_t> sizes;
+            int head = 0;
+            int count = 0;
+            uint64_t sent = 0;
+            uint64_t dropped = 0;
+            uint64_t rejected = 0;
+        };
+
+        void UpdateOrder();
+
+        DeliverFunction deliver;
+
+        mutable std::mutex mutex;
+        Channel channels[kMaxChannels];
+        // Active channels, highest priority first.
+        int order[kMaxChannels] = {};
+        int orderCount = 0;
+        uint64_t slots = 0;
+        uint64_t usedSlots = 0;
+        uint64_t packedBytes = 0;
+
+        // Updated on the receiving thread without the lock
+        std::atomic<uint64_t> received[kMaxChannels] = {};
+        std::atomic<uint64_t> malformed{0};
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_METADATA_MULTIPLEXER_H_
@@ -0,0 +1,306 @@
+#include "network_preflight.h"
+
+#include <algorithm>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // QUALITY_TYPE values
+        const int kQualityExcellent = 1;
+        const int kQualityGood = 2;
+        const int kQualityPoor = 3;
+
+        // LASTMILE_PROBE_RESULT_STATE values
+        const int kProbeComplete = 1;
+
+        // AUDIO_PROFILE_TYPE values
+        const int kAudioSpeechStandard = 1;
+        const int kAudioMusicStandard = 2;
+        const int kAudioMusicHighQuality = 4;
+
+        // NETWORK_TYPE_UNKNOWN
+        const int kNetworkUnknown = -1;
+
+        // The SDK accepts expected bitrates in this range, in Kbps.
+        const int kMinProbeBitrate = 100;
+        const int kMaxProbeBitrate = 5000;
+
+        int64_t MillisBetween(NetworkPreflight::Clock::time_point from, NetworkPreflight::Clock::time_point to)
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+        }
+    }  // namespace
+
+    NetworkPreflight::NetworkPreflight(StartFunction start, DoneFunction refined)
+        : start(std::move(start)), refined(std::move(refined))
+    {
+    }
+
+    uint64_t NetworkPreflight::Run(const PreflightOptions& options, Clock::time_point now, DoneFunction done)
+    {
+        auto checked = options;
+        if (checked.levels.empty())
+            checked.levels = DefaultEncoderLevels();
+
+        bool cached = false;
+        bool answered = false;
+        PreflightPlan plan;
+        uint64_t started = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests++;
+            auto key = CacheKey(checked.networkId);
+            auto entry = key.empty() ? cache.end() : cache.find(key);
+            if (entry != cache.end() && !checked.forceProbe && now - entry->second.measured < std::chrono::milliseconds(checked.cacheTtlMs))
+            {
+                cacheHits++;
+                cached = true;
+                plan = Plan(entry->second.measurement, checked.levels, checked.headroom);
+                plan.cached = true;
+                plan.refined = true;
+                plan.ageMs = MillisBetween(entry->second.measured, now);
+            }
+            else if (probe != 0 && measurement.quality != 0)
+            {
+                // The running probe has already reported the quality
+                answered = true;
+                probeNetworkIds.push_back(checked.networkId);
+                plan = Plan(measurement, checked.levels, checked.headroom);
+                plan.probeMs = MillisBetween(probeStarted, now);
+            }
+            else
+            {
+                if (probe == 0)
+                    probeNetworkIds.clear();
+                probeNetworkIds.push_back(checked.networkId);
+                waiters.push_back(Waiter{checked, std::move(done)});
+                if (probe != 0)
+                    return probe;
+                started = probe = ++lastProbe;
+                probes++;
+                probeStarted = now;
+                probeOptions = checked;
+                networkChanged = false;
+                measurement = LastmileMeasurement();
+            }
+        }
+        if (cached || answered)
+        {
+            done(plan);
+            return 0;
+        }
+
+        auto bitrate = std::clamp(checked.levels.back().bitrate, kMinProbeBitrate, kMaxProbeBitrate);
+        if (start(bitrate, bitrate))
+            return started;
+
+        // Completes the waiters with a plan from no measurement at all
+        std::vector<std::pair<Waiter, PreflightPlan>> completed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (probe == started)
+            {
+                completed = Answer(false, now);
+                probe = 0;
+            }
+        }
+        for (auto& waiter : completed)
+            waiter.first.done(waiter.second);
+        return 0;
+    }
+
+    bool NetworkPreflight::OnTimeout(uint64_t timedOutProbe, Clock::time_point now)
+    {
+        std::vector<std::pair<Waiter, PreflightPlan>> completed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (probe == 0 || probe != timedOutProbe)
+                return false;
+            timeouts++;
+            completed = Answer(true, now);
+            probe = 0;
+        }
+        for (auto& waiter : completed)
+            waiter.first.done(waiter.second);
+        return true;
+    }
+
+    void NetworkPreflight::OnLastmileQuality(int quality, Clock::time_point now)
+    {
+        std::vector<std::pair<Waiter, PreflightPlan>> completed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // Reported until the probe is stopped, the first report answers
+            if (probe == 0 || quality == 0)
+                return;
+            measurement.quality = quality;
+            completed = Answer(false, now);
+        }
+        for (auto& waiter : completed)
+            waiter.first.done(waiter.second);
+    }
+
+    bool NetworkPreflight::OnLastmileProbeResult(const LastmileMeasurement& result, Clock::time_point now)
+    {
+        std::vector<std::pair<Waiter, PreflightPlan>> completed;
+        bool refine = false;
+        PreflightPlan plan;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (probe == 0)
+                return false;
+            auto quality = measurement.quality;
+            measurement = result;
+            measurement.quality = quality;
+            // A failed probe says little about the network
+            if (!networkChanged && measurement.state == kProbeComplete)
+            {
+                // Keyed by each request's network id, they may differ
+                for (const auto& networkId : probeNetworkIds)
+                {
+                    auto key = CacheKey(networkId);
+                    if (!key.empty())
+                        cache[key] = CacheEntry{measurement, now};
+                }
+                while (cache.size() > kMaxCachedNetworks)
+                {
+                    auto oldest = std::min_element(cache.begin(), cache.end(), [](const auto& a, const auto& b) {
+                        return a.second.measured < b.second.measured;
+                    });
+                    cache.erase(oldest);
+                }
+            }
+            // Without a quality report the requests are still waiting
+            refine = waiters.empty() && measurement.state == kProbeComplete;
+            if (refine)
+            {
+                plan = Plan(measurement, probeOptions.levels, probeOptions.headroom);
+                plan.refined = true;
+                plan.probeMs = MillisBetween(probeStarted, now);
+            }
+            completed = Answer(false, now);
+            probe = 0;
+        }
+        for (auto& waiter : completed)
+            waiter.first.done(waiter.second);
+        if (refine && refined)
+            refined(plan);
+        return true;
+    }
+
+    void NetworkPreflight::OnNetworkTypeChanged(int type)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (type != networkType && probe != 0)
+            networkChanged = true;
+        networkType = type;
+    }
+
+    void NetworkPreflight::ClearCache()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.clear();
+    }
+
+    PreflightStats NetworkPreflight::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        PreflightStats stats;
+        stats.requests = requests;
+        stats.cacheHits = cacheHits;
+        stats.probes = probes;
+        stats.timeouts = timeouts;
+        stats.cachedNetworks = cache.size();
+        stats.networkType = networkType;
+        return stats;
+    }
+
+    std::vector<std::pair<NetworkPreflight::Waiter, PreflightPlan>> NetworkPreflight::Answer(bool timedOut, Clock::time_point now)
+    {
+        std::vector<std::pair<Waiter, PreflightPlan>> completed;
+        for (auto& waiter : waiters)
+        {
+            auto plan = Plan(measurement, waiter.options.levels, waiter.options.headroom);
+            plan.refined = measurement.state == kProbeComplete;
+            plan.timedOut = timedOut;
+            plan.probeMs = MillisBetween(probeStarted, now);
+            completed.emplace_back(std::move(waiter), plan);
+        }
+        waiters.clear();
+        return completed;
+    }
+
+    std::string NetworkPreflight::CacheKey(const std::string& networkId) const
+    {
+        // Every network would share the entry otherwise
+        if (networkType == kNetworkUnknown && networkId.empty())
+            return std::string();
+        return std::to_string(networkType) + ":" + networkId;
+    }
+
+    // static
+    PreflightPlan NetworkPreflight::Plan(const LastmileMeasurement& measurement, const std::vector<EncoderLevel>& levels, double headroom)
+    {
+        PreflightPlan plan;
+        plan.measurement = measurement;
+        auto count = static_cast<int>(levels.size());
+        if (count == 0)
+            return plan;
+
+        if (measurement.state == kProbeComplete && measurement.uplink.availableBandwidth > 0)
+        {
+            auto usable = measurement.uplink.availableBandwidth * headroom;
+            // Loss eats into what retransmissions and FEC leave for media
+            if (measurement.uplink.packetLossRate >= 10)
+                usable *= 0.5;
+            else if (measurement.uplink.packetLossRate >= 5)
+                usable *= 0.75;
+
+            plan.level = 0;
+            for (int i = count - 1; i > 0; --i)
+            {
+                if (levels[i].bitrate <= usable)
+                {
+                    plan.level = i;
+                    break;
+                }
+            }
+            if (usable >= 1000 && measurement.uplink.packetLossRate < 3)
+                plan.audioProfile = kAudioMusicHighQuality;
+            else if (usable >= 300)
+                plan.audioProfile = kAudioMusicStandard;
+            else
+                plan.audioProfile = kAudioSpeechStandard;
+        }
+        else
+        {
+            switch (measurement.quality)
+            {
+            case kQualityExcellent:
+                plan.level = count - 1;
+                plan.audioProfile = kAudioMusicStandard;
+                break;
+            case kQualityGood:
+                plan.level = (count - 1) * 2 / 3;
+                plan.audioProfile = kAudioMusicStandard;
+                break;
+            case kQualityPoor:
+                plan.level = (count - 1) / 3;
+                plan.audioProfile = kAudioSpeechStandard;
+                break;
+            default:
+                // Unknown or worse, start light and let the SDK adapt up
+                plan.level = 0;
+                plan.audioProfile = kAudioSpeechStandard;
+                break;
+            }
+        }
+
+        // Long round trips slow down recovery from congestion
+        if (measurement.rtt > 300 && plan.level > 0)
+            plan.level--;
+        plan.video = levels[plan.level];
+        return plan;
+    }
+
+}  // namespace agora_rtc_engine
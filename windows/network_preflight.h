@@ -0,0 +1,190 @@
+#ifndef AGORA_RTC_ENGINE_NETWORK_PREFLIGHT_H_
+#define AGORA_RTC_ENGINE_NETWORK_PREFLIGHT_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "encoder_tuner.h"
+
+namespace agora_rtc_engine {
+
+    struct LastmileOneWay
+    {
+        // Percent
+        int packetLossRate = 0;
+        int jitter = 0;
+        // Kbps, 0 when not estimated
+        int availableBandwidth = 0;
+    };
+
+    struct LastmileMeasurement
+    {
+        // A LASTMILE_PROBE_RESULT_STATE, 0 when the probe result did not
+        // arrive.
+        int state = 0;
+        // A QUALITY_TYPE from onLastmileQuality, 0 when it did not arrive.
+        int quality = 0;
+        LastmileOneWay uplink;
+        LastmileOneWay downlink;
+        int rtt = 0;
+    };
+
+    struct PreflightOptions
+    {
+        // From the lightest to the heaviest, a default ladder when empty.
+        std::vector<EncoderLevel> levels;
+        // Tells apart networks of the same type, e.g. a Wi-Fi SSID. Results
+        // are only cached for an unknown network type when it is set.
+        std::string networkId;
+        // How long a measurement is reused for.
+        int cacheTtlMs = 10 * 60 * 1000;
+        // Measures again even when a cached result is fresh.
+        bool forceProbe = false;
+        // The probe is abandoned after this long. The SDK reports the quality
+        // within about 2 seconds and the probe result within 30.
+        int timeoutMs = 35000;
+        // Share of the measured uplink bandwidth the video may use.
+        double headroom = 0.7;
+    };
+
+    struct PreflightPlan
+    {
+        // Index in the levels, e.g. a start level for encoder auto-tuning.
+        int level = 0;
+        EncoderLevel video;
+        // An AUDIO_PROFILE_TYPE
+        int audioProfile = 0;
+        LastmileMeasurement measurement;
+        // Served from the cache without probing.
+        bool cached = false;
+        // From the probe result, not only the last-mile quality.
+        bool refined = false;
+        // The probe reported nothing in time, the plan is a guess.
+        bool timedOut = false;
+        // Age of the measurement
+        int64_t ageMs = 0;
+        // Time spent waiting for the probe
+        int64_t probeMs = 0;
+    };
+
+    struct PreflightStats
+    {
+        uint64_t requests = 0;
+        uint64_t cacheHits = 0;
+        uint64_t probes = 0;
+        uint64_t timeouts = 0;
+        size_t cachedNetworks = 0;
+        int networkType = -1;
+    };
+
+    // Measures the last mile before joining, with startLastmileProbeTest,
+    // and picks the initial encoder configuration and audio profile from it.
+    //
+    // Requests are answered from the first onLastmileQuality, about two
+    // seconds into the probe, rather than waiting for the bandwidth estimate
+    // of onLastmileProbeResult. That result refines the plan: it is published
+    // and cached per network, keyed by the type reported by
+    // onNetworkTypeChanged and an optional id from the app, so joining again
+    // on a known network starts from the refined plan without probing.
+    // Requests made while a probe runs share it.
+    class NetworkPreflight
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Starts the SDK probe, expecting the given bitrates in Kbps.
+        using StartFunction = std::function<bool(int uplinkKbps, int downlinkKbps)>;
+        // Called without the lock held, on the thread reporting the result,
+        // or the calling one for cached results.
+        using DoneFunction = std::function<void(const PreflightPlan& plan)>;
+
+        static const size_t kMaxCachedNetworks = 16;
+
+        // |refined| is called with the plan from each probe result completing
+        // a probe whose requests were answered from the quality alone.
+        NetworkPreflight(StartFunction start, DoneFunction refined);
+
+        // Prevent copying
+        NetworkPreflight(NetworkPreflight const&) = delete;
+        NetworkPreflight& operator=(NetworkPreflight const&) = delete;
+
+        // Calls |done| with a plan from the cache, or once the probe reports
+        // the quality. Returns the probe to pass to OnTimeout after
+        // options.timeoutMs, 0 if no probe was started or it failed to start.
+        uint64_t Run(const PreflightOptions& options, Clock::time_point now, DoneFunction done);
+
+        // Ends |probe|, answering the requests still waiting with a guess, if
+        // still running. Returns whether it was, in which case the SDK probe
+        // should be stopped.
+        bool OnTimeout(uint64_t probe, Clock::time_point now);
+
+        // Answers the requests waiting for the running probe.
+        void OnLastmileQuality(int quality, Clock::time_point now);
+
+        // Completes the running probe. Returns whether one was running.
+        bool OnLastmileProbeResult(const LastmileMeasurement& result, Clock::time_point now);
+
+        void OnNetworkTypeChanged(int type);
+
+        // Forgets the cached measurements, e.g. after a VPN was connected.
+        void ClearCache();
+
+        PreflightStats GetStats() const;
+
+        // Picks the heaviest level the measured uplink carries, falling back
+        // to the reported quality when there is no bandwidth estimate.
+        static PreflightPlan Plan(const LastmileMeasurement& measurement, const std::vector<EncoderLevel>& levels, double headroom);
+
+    private:
+        struct CacheEntry
+        {
+            LastmileMeasurement measurement;
+            Clock::time_point measured;
+        };
+
+        struct Waiter
+        {
+            PreflightOptions options;
+            DoneFunction done;
+        };
+
+        // Plans for the waiting requests from the measurement so far, called
+        // with |mutex| held. Returns the waiters to call.
+        std::vector<std::pair<Waiter, PreflightPlan>> Answer(bool timedOut, Clock::time_point now);
+
+        std::string CacheKey(const std::string& networkId) const;
+
+        StartFunction start;
+        DoneFunction refined;
+
+        mutable std::mutex mutex;
+        int networkType = -1;
+        std::map<std::string, CacheEntry> cache;
+
+        // The running probe, 0 when none is.
+        uint64_t probe = 0;
+        uint64_t lastProbe = 0;
+        Clock::time_point probeStarted;
+        // The options of the request that started the probe, to refine with.
+        PreflightOptions probeOptions;
+        // Of every request sharing the probe, to cache its result under.
+        std::vector<std::string> probeNetworkIds;
+        // The network changed during the probe, its result is not cached.
+        bool networkChanged = false;
+        LastmileMeasurement measurement;
+        // Requests the probe has not answered yet
+        std::vector<Waiter> waiters;
+
+        uint64_t requests = 0;
+        uint64_t cacheHits = 0;
+        uint64_t probes = 0;
+        uint64_t timeouts = 0;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_NETWORK_PREFLIGHT_H_
@@ -0,0 +1,283 @@
+#include "packet_capture.h"
+
+#include <cstring>
+#include <filesystem>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // Per direction, about a second of HD video.
+        const size_t kRingCapacity = 4 * 1024 * 1024;
+
+        const auto kDrainInterval = std::chrono::milliseconds(20);
+
+        const uint32_t kWrapMarker = 0xffffffff;
+
+        // pcapng block types and options
+        const uint32_t kSectionHeaderBlock = 0x0a0d0d0a;
+        const uint32_t kInterfaceDescriptionBlock = 1;
+        const uint32_t kEnhancedPacketBlock = 6;
+        const uint16_t kLinkTypeUser0 = 147;
+        const uint16_t kOptionEnd = 0;
+        const uint16_t kOptionInterfaceName = 2;
+        const uint16_t kOptionTimestampResolution = 9;
+        const uint16_t kOptionPacketFlags = 2;
+        const uint32_t kFlagInbound = 1;
+        const uint32_t kFlagOutbound = 2;
+
+        // Interface ids, one per media type
+        const uint32_t kAudioInterface = 0;
+        const uint32_t kVideoInterface = 1;
+
+        size_t Align(size_t size, size_t alignment)
+        {
+            return (size + alignment - 1) & ~(alignment - 1);
+        }
+
+        template <typename T>
+        void Append(std::vector<uint8_t>& buffer, T value)
+        {
+            auto offset = buffer.size();
+            buffer.resize(offset + sizeof(T));
+            std::memcpy(buffer.data() + offset, &value, sizeof(T));
+        }
+
+        void AppendPadded(std::vector<uint8_t>& buffer, const void* data, size_t size)
+        {
+            auto offset = buffer.size();
+            buffer.resize(offset + Align(size, 4), 0);
+            if (size > 0)
+                std::memcpy(buffer.data() + offset, data, size);
+        }
+
+        void AppendOption(std::vector<uint8_t>& buffer, uint16_t code, const void* data, size_t size)
+        {
+            Append(buffer, code);
+            Append(buffer, static_cast<uint16_t>(size));
+            AppendPadded(buffer, data, size);
+        }
+
+        std::string FilePath(const std::string& path, int index)
+        {
+            return index == 0 ? path : path + "." + std::to_string(index);
+        }
+    }  // namespace
+
+    PacketCapture::Ring::Ring(size_t capacity)
+        : buffer(capacity)
+    {
+    }
+
+    bool PacketCapture::Ring::Push(const Header& header, const uint8_t* data)
+    {
+        auto capacity = buffer.size();
+        auto size = Align(sizeof(Header) + header.capturedLength, 8);
+        auto write = head.load(std::memory_order_relaxed);
+        auto read = tail.load(std::memory_order_acquire);
+        auto offset = static_cast<size_t>(write % capacity);
+        // Records never wrap, the end of the buffer is skipped instead
+        auto skip = offset + size > capacity ? capacity - offset : 0;
+        if (capacity - static_cast<size_t>(write - read) < skip + size)
+            return false;
+        if (skip > 0)
+        {
+            std::memcpy(buffer.data() + offset, &kWrapMarker, sizeof(kWrapMarker));
+            offset = 0;
+        }
+        auto record = header;
+        record.recordSize = static_cast<uint32_t>(size);
+        std::memcpy(buffer.data() + offset, &record, sizeof(Header));
+        std::memcpy(buffer.data() + offset + sizeof(Header), data, header.capturedLength);
+        head.store(write + skip + size, std::memory_order_release);
+        return true;
+    }
+
+    template <typename F>
+    size_t PacketCapture::Ring::Drain(F consume)
+    {
+        auto capacity = buffer.size();
+        auto read = tail.load(std::memory_order_relaxed);
+        auto write = head.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (read < write)
+        {
+            auto offset = static_cast<size_t>(read % capacity);
+            uint32_t recordSize;
+            std::memcpy(&recordSize, buffer.data() + offset, sizeof(recordSize));
+            if (recordSize == kWrapMarker)
+            {
+                read += capacity - offset;
+                continue;
+            }
+            Header header;
+            std::memcpy(&header, buffer.data() + offset, sizeof(Header));
+            consume(header, buffer.data() + offset + sizeof(Header));
+            read += recordSize;
+            count++;
+        }
+        tail.store(read, std::memory_order_release);
+        return count;
+    }
+
+    PacketCapture::PacketCapture(const PacketCaptureOptions& options)
+        : options(options)
+    {
+        for (auto& ring : rings)
+            ring = std::make_unique<Ring>(kRingCapacity);
+    }
+
+    PacketCapture::~PacketCapture()
+    {
+        Stop();
+    }
+
+    bool PacketCapture::Start()
+    {
+        steadyOrigin = std::chrono::steady_clock::now();
+        wallOriginNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        if (!OpenFile())
+            return false;
+        running = true;
+        writer = std::thread([this] { Run(); });
+        return true;
+    }
+
+    void PacketCapture::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running)
+                return;
+            running = false;
+        }
+        condition.notify_one();
+        writer.join();
+        file.close();
+    }
+
+    void PacketCapture::Capture(PacketDirection direction, const uint8_t* data, size_t size)
+    {
+        Ring::Header header = {};
+        header.originalLength = static_cast<uint32_t>(size);
+        header.capturedLength = static_cast<uint32_t>(
+            options.snapLength > 0 && size > options.snapLength ? options.snapLength : size);
+        header.timestampNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - steadyOrigin).count();
+        if (rings[static_cast<int>(direction)]->Push(header, data))
+            captured++;
+        else
+            dropped++;
+    }
+
+    PacketCaptureStats PacketCapture::GetStats() const
+    {
+        PacketCaptureStats stats;
+        stats.captured = captured;
+        stats.dropped = dropped;
+        stats.bytesWritten = bytesWritten;
+        stats.files = files;
+        return stats;
+    }
+
+    void PacketCapture::Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running)
+        {
+            // Polling keeps the packet path free of any wake-up call
+            condition.wait_for(lock, kDrainInterval);
+            lock.unlock();
+            DrainRings();
+            lock.lock();
+        }
+        lock.unlock();
+        DrainRings();
+        file.flush();
+    }
+
+    void PacketCapture::DrainRings()
+    {
+        for (int i = 0; i < kPacketDirectionCount; ++i)
+        {
+            auto direction = static_cast<PacketDirection>(i);
+            rings[i]->Drain([this, direction](const Ring::Header& header, const uint8_t* data) {
+                WriteEnhancedPacket(direction, header, data);
+            });
+        }
+    }
+
+    bool PacketCapture::OpenFile()
+    {
+        auto index = files.load();
+        if (file.is_open())
+            file.close();
+        if (options.maxFiles > 0 && index >= options.maxFiles)
+        {
+            std::error_code error;
+            std::filesystem::remove(std::filesystem::u8path(FilePath(options.path, index - options.maxFiles)), error);
+        }
+        file.open(std::filesystem::u8path(FilePath(options.path, index)), std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        files++;
+        fileSize = 0;
+
+        // Section Header Block: byte-order magic, version 1.0, unknown length
+        blockBuffer.clear();
+        Append<uint32_t>(blockBuffer, 0x1a2b3c4d);
+        Append<uint16_t>(blockBuffer, 1);
+        Append<uint16_t>(blockBuffer, 0);
+        Append<int64_t>(blockBuffer, -1);
+        WriteBlock(kSectionHeaderBlock, blockBuffer);
+
+        const char* names[] = {"audio", "video"};
+        for (auto name : names)
+        {
+            blockBuffer.clear();
+            Append<uint16_t>(blockBuffer, kLinkTypeUser0);
+            Append<uint16_t>(blockBuffer, 0);
+            Append<uint32_t>(blockBuffer, static_cast<uint32_t>(options.snapLength));
+            AppendOption(blockBuffer, kOptionInterfaceName, name, std::strlen(name));
+            uint8_t nanoseconds = 9;
+            AppendOption(blockBuffer, kOptionTimestampResolution, &nanoseconds, 1);
+            AppendOption(blockBuffer, kOptionEnd, nullptr, 0);
+            WriteBlock(kInterfaceDescriptionBlock, blockBuffer);
+        }
+        return true;
+    }
+
+    void PacketCapture::WriteEnhancedPacket(PacketDirection direction, const Ring::Header& header, const uint8_t* data)
+    {
+        if (options.maxFileSize > 0 && fileSize >= options.maxFileSize && !OpenFile())
+            return;
+
+        auto timestamp = static_cast<uint64_t>(wallOriginNanos + header.timestampNanos);
+        auto audio = direction == PacketDirection::SendAudio || direction == PacketDirection::ReceiveAudio;
+        auto outbound = direction == PacketDirection::SendAudio || direction == PacketDirection::SendVideo;
+
+        blockBuffer.clear();
+        Append<uint32_t>(blockBuffer, audio ? kAudioInterface : kVideoInterface);
+        Append<uint32_t>(blockBuffer, static_cast<uint32_t>(timestamp >> 32));
+        Append<uint32_t>(blockBuffer, static_cast<uint32_t>(timestamp));
+        Append<uint32_t>(blockBuffer, header.capturedLength);
+        Append<uint32_t>(blockBuffer, header.originalLength);
+        AppendPadded(blockBuffer, data, header.capturedLength);
+        uint32_t flags = outbound ? kFlagOutbound : kFlagInbound;
+        AppendOption(blockBuffer, kOptionPacketFlags, &flags, sizeof(flags));
+        AppendOption(blockBuffer, kOptionEnd, nullptr, 0);
+        WriteBlock(kEnhancedPacketBlock, blockBuffer);
+    }
+
+    void PacketCapture::WriteBlock(uint32_t type, const std::vector<uint8_t>& body)
+    {
+        auto total = static_cast<uint32_t>(body.size() + 12);
+        file.write(reinterpret_cast<const char*>(&type), sizeof(type));
+        file.write(reinterpret_cast<const char*>(&total), sizeof(total));
+        file.write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+        file.write(reinterpret_cast<const char*>(&total), sizeof(total));
+        fileSize += total;
+        bytesWritten += total;
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,130 @@
+#ifndef AGORA_RTC_ENGINE_PACKET_CAPTURE_H_
+#define AGORA_RTC_ENGINE_PACKET_CAPTURE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "packet_pipeline.h"
+
+namespace agora_rtc_engine {
+
+    struct PacketCaptureOptions
+    {
+        // Files are named <path>, <path>.1, <path>.2, ...
+        std::string path;
+        // Bytes of each packet kept, 0 keeps whole packets.
+        size_t snapLength = 0;
+        // A new file is started once this size is exceeded, 0 never rotates.
+        uint64_t maxFileSize = 0;
+        // Oldest files are deleted beyond this count, 0 keeps all of them.
+        int maxFiles = 0;
+    };
+
+    struct PacketCaptureStats
+    {
+        uint64_t captured = 0;
+        // Packets lost because the writer fell behind.
+        uint64_t dropped = 0;
+        uint64_t bytesWritten = 0;
+        int files = 0;
+    };
+
+    // Records media packets to pcapng files.
+    //
+    // The packet threads only copy into one single-producer ring per
+    // direction, without locks or allocation; a background thread drains the
+    // rings and writes Enhanced Packet Blocks with nanosecond timestamps, an
+    // interface per media type and the direction in epb_flags.
+    class PacketCapture
+    {
+    public:
+        explicit PacketCapture(const PacketCaptureOptions& options);
+
+        ~PacketCapture();
+
+        // Prevent copying
+        PacketCapture(PacketCapture const&) = delete;
+        PacketCapture& operator=(PacketCapture const&) = delete;
+
+        // Opens the first file and starts the writer thread.
+        bool Start();
+
+        // Writes what is still queued, then stops the writer thread.
+        void Stop();
+
+        // Called on the packet threads.
+        void Capture(PacketDirection direction, const uint8_t* data, size_t size);
+
+        PacketCaptureStats GetStats() const;
+
+    private:
+        // A single-producer, single-consumer ring of variable-sized records.
+        class Ring
+        {
+        public:
+            struct Header
+            {
+                uint32_t recordSize;
+                uint32_t originalLength;
+                int64_t timestampNanos;
+                uint32_t capturedLength;
+                uint32_t reserved;
+            };
+
+            explicit Ring(size_t capacity);
+
+            bool Push(const Header& header, const uint8_t* data);
+
+            // Calls |consume| with each queued record, returns the count.
+            template <typename F>
+            size_t Drain(F consume);
+
+        private:
+            std::vector<uint8_t> buffer;
+            alignas(64) std::atomic<uint64_t> head{0};
+            alignas(64) std::atomic<uint64_t> tail{0};
+        };
+
+        void Run();
+
+        void DrainRings();
+
+        bool OpenFile();
+
+        void WriteEnhancedPacket(PacketDirection direction, const Ring::Header& header, const uint8_t* data);
+
+        void WriteBlock(uint32_t type, const std::vector<uint8_t>& body);
+
+        PacketCaptureOptions options;
+        std::unique_ptr<Ring> rings[kPacketDirectionCount];
+
+        // Maps steady clock readings taken on the packet path to wall time.
+        std::chrono::steady_clock::time_point steadyOrigin;
+        int64_t wallOriginNanos = 0;
+
+        std::atomic<uint64_t> captured{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> bytesWritten{0};
+        std::atomic<int> files{0};
+
+        std::ofstream file;
+        uint64_t fileSize = 0;
+        std::vector<uint8_t> blockBuffer;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool running = false;
+        std::thread writer;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_PACKET_CAPTURE_H_
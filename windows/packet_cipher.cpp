@@ -0,0 +1,64 @@
+#include "packet_cipher.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+namespace agora_rtc_engine {
+
+    // static
+    std::unique_ptr<AesPacketCipher> AesPacketCipher::Create(PacketCipherMode mode, const uint8_t* key, size_t keySize)
+    {
+        if (mode == PacketCipherMode::None)
+            return nullptr;
+        std::unique_ptr<AesPacketCipher> packetCipher(new AesPacketCipher(mode == PacketCipherMode::AesGcm));
+        if (!packetCipher->cipher.SetKey(key, keySize))
+            return nullptr;
+        return packetCipher;
+    }
+
+    AesPacketCipher::AesPacketCipher(bool authenticated)
+        : authenticated(authenticated)
+    {
+        // Users share the key, so the salt keeps their nonces apart
+        std::random_device random;
+        for (size_t i = 0; i < sizeof(salt); i += 4)
+        {
+            auto value = random();
+            std::memcpy(salt + i, &value, 4);
+        }
+    }
+
+    size_t AesPacketCipher::Overhead() const
+    {
+        return AesGcm::kNonceSize + (authenticated ? AesGcm::kTagSize : 0);
+    }
+
+    size_t AesPacketCipher::Encode(const uint8_t* in, size_t size, uint8_t* out)
+    {
+        auto sequence = counter.fetch_add(1, std::memory_order_relaxed);
+        // A repeated nonce under the same key would reveal the plain text
+        if (sequence > UINT32_MAX)
+            return 0;
+        std::memcpy(out, salt, sizeof(salt));
+        out[8] = uint8_t(sequence >> 24);
+        out[9] = uint8_t(sequence >> 16);
+        out[10] = uint8_t(sequence >> 8);
+        out[11] = uint8_t(sequence);
+        auto body = out + AesGcm::kNonceSize;
+        cipher.Seal(out, in, size, body, authenticated ? body + size : nullptr);
+        return size + Overhead();
+    }
+
+    size_t AesPacketCipher::Decode(const uint8_t* in, size_t size, uint8_t* out)
+    {
+        if (size <= Overhead())
+            return 0;
+        auto bodySize = size - Overhead();
+        auto body = in + AesGcm::kNonceSize;
+        if (!cipher.Open(in, body, bodySize, out, authenticated ? body + bodySize : nullptr))
+            return 0;
+        return bodySize;
+    }
+
+}  // namespace agora_rtc_engine
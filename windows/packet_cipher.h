@@ -0,0 +1,57 @@
+#ifndef AGORA_RTC_ENGINE_PACKET_CIPHER_H_
+#define AGORA_RTC_ENGINE_PACKET_CIPHER_H_
+
+#include <atomic>
+#include <memory>
+
+#include "aes_gcm.h"
+#include "packet_transform.h"
+
+namespace agora_rtc_engine {
+
+    // Must match the order of the Dart `PacketCipher` enum.
+    enum class PacketCipherMode
+    {
+        None = 0,
+        AesCtr = 1,
+        AesGcm = 2,
+    };
+
+    // Encrypts packets with AES-CTR or AES-GCM under a key shared by all users
+    // of the channel.
+    //
+    // Every packet is prefixed with its 12-byte nonce: a random per-instance
+    // salt followed by a 32-bit packet counter. AES-GCM packets also end with
+    // a 16-byte tag, and packets failing authentication are dropped. Once the
+    // counter is exhausted, outgoing packets are dropped rather than reuse a
+    // nonce, until a new instance is created with a new salt.
+    class AesPacketCipher : public PacketTransform
+    {
+    public:
+        // Returns null if |keySize| is not 16, 24 or 32 bytes.
+        static std::unique_ptr<AesPacketCipher> Create(PacketCipherMode mode, const uint8_t* key, size_t keySize);
+
+        size_t Overhead() const override;
+
+        size_t Encode(const uint8_t* in, size_t size, uint8_t* out) override;
+
+        size_t Decode(const uint8_t* in, size_t size, uint8_t* out) override;
+
+        bool accelerated() const { return cipher.accelerated(); }
+
+        // Uses the portable AES code path, see AesGcm.
+        void DisableAcceleration() { cipher.DisableAcceleration(); }
+
+    private:
+        AesPacketCipher(bool authenticated);
+
+        AesGcm cipher;
+        bool authenticated;
+        uint8_t salt[8];
+        // Wider than the nonce's counter, so that it cannot wrap around
+        std::atomic<uint64_t> counter{0};
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_PACKET_CIPHER_H_
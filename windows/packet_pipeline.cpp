@@ -0,0 +1,126 @@
+#include "packet_pipeline.h"
+
+#include "packet_capture.h"
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // Room for the overhead of any transform.
+        const size_t kScratchSize = PacketPipeline::kMaxPacketSize + 64;
+    }  // namespace
+
+    PacketPipeline::PacketPipeline()
+    {
+        for (auto& direction : directions)
+            direction.scratch.resize(kScratchSize);
+    }
+
+    void PacketPipeline::SetTransform(std::shared_ptr<PacketTransform> newTransform)
+    {
+        std::atomic_store(&transform, std::move(newTransform));
+    }
+
+    void PacketPipeline::SetCapture(std::shared_ptr<PacketCapture> newCapture)
+    {
+        std::atomic_store(&capture, std::move(newCapture));
+    }
+
+    bool PacketPipeline::active() const
+    {
+        return std::atomic_load(&transform) != nullptr || std::atomic_load(&capture) != nullptr;
+    }
+
+    void PacketPipeline::GetStats(PacketDirectionStats (&stats)[kPacketDirectionCount]) const
+    {
+        for (int i = 0; i < kPacketDirectionCount; ++i)
+        {
+            const auto& direction = directions[i];
+            stats[i].packets = direction.packets;
+            stats[i].bytes = direction.bytes;
+            stats[i].dropped = direction.dropped;
+            stats[i].totalNanos = direction.totalNanos;
+            stats[i].maxNanos = direction.maxNanos;
+        }
+    }
+
+    void PacketPipeline::ResetStats()
+    {
+        for (auto& direction : directions)
+        {
+            direction.packets = 0;
+            direction.bytes = 0;
+            direction.dropped = 0;
+            direction.totalNanos = 0;
+            direction.maxNanos = 0;
+        }
+    }
+
+    bool PacketPipeline::onSendAudioPacket(Packet& packet)
+    {
+        return Process(PacketDirection::SendAudio, packet);
+    }
+
+    bool PacketPipeline::onSendVideoPacket(Packet& packet)
+    {
+        return Process(PacketDirection::SendVideo, packet);
+    }
+
+    bool PacketPipeline::onReceiveAudioPacket(Packet& packet)
+    {
+        return Process(PacketDirection::ReceiveAudio, packet);
+    }
+
+    bool PacketPipeline::onReceiveVideoPacket(Packet& packet)
+    {
+        return Process(PacketDirection::ReceiveVideo, packet);
+    }
+
+    bool PacketPipeline::Process(PacketDirection type, Packet& packet)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto& direction = directions[static_cast<int>(type)];
+        auto currentTransform = std::atomic_load(&transform);
+        auto currentCapture = std::atomic_load(&capture);
+        if (currentTransform == nullptr && currentCapture == nullptr)
+            return true;
+
+        auto outbound = type == PacketDirection::SendAudio || type == PacketDirection::SendVideo;
+        if (currentCapture != nullptr && !outbound)
+            currentCapture->Capture(type, packet.buffer, packet.size);
+
+        size_t size = packet.size;
+        if (currentTransform != nullptr)
+        {
+            if (packet.size > kMaxPacketSize)
+                size = 0;
+            else if (outbound)
+                size = currentTransform->Encode(packet.buffer, packet.size, direction.scratch.data());
+            else
+                size = currentTransform->Decode(packet.buffer, packet.size, direction.scratch.data());
+        }
+
+        if (size != 0)
+        {
+            direction.packets++;
+            direction.bytes += packet.size;
+            if (currentTransform != nullptr)
+            {
+                packet.buffer = direction.scratch.data();
+                packet.size = static_cast<unsigned int>(size);
+            }
+            if (currentCapture != nullptr && outbound)
+                currentCapture->Capture(type, packet.buffer, packet.size);
+        }
+        else
+        {
+            direction.dropped++;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        direction.totalNanos += elapsed;
+        if (elapsed > direction.maxNanos)
+            direction.maxNanos = elapsed;
+        return size != 0;
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,94 @@
+#ifndef AGORA_RTC_ENGINE_PACKET_PIPELINE_H_
+#define AGORA_RTC_ENGINE_PACKET_PIPELINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "IAgoraRtcEngine.h"
+
+#include "packet_transform.h"
+
+namespace agora_rtc_engine {
+
+    enum class PacketDirection
+    {
+        SendAudio = 0,
+        SendVideo = 1,
+        ReceiveAudio = 2,
+        ReceiveVideo = 3,
+    };
+
+    const int kPacketDirectionCount = 4;
+
+    struct PacketDirectionStats
+    {
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        uint64_t dropped = 0;
+        int64_t totalNanos = 0;
+        int64_t maxNanos = 0;
+    };
+
+    class PacketCapture;
+
+    // The plugin's IPacketObserver, running an optional PacketTransform on
+    // every media packet and optionally recording them as they are on the
+    // wire, i.e. after the transform when sending and before it on receipt.
+    //
+    // Each direction owns a preallocated scratch buffer that the transformed
+    // packet is written to and that |Packet::buffer| is pointed at, so nothing
+    // is allocated per packet. The SDK calls each direction from one thread at
+    // a time and consumes the packet before the next call.
+    class PacketPipeline : public agora::rtc::IPacketObserver
+    {
+    public:
+        // Largest packet handled, larger ones are dropped rather than sent in
+        // the clear.
+        static const size_t kMaxPacketSize = 4096;
+
+        PacketPipeline();
+
+        // Safe to call while packets are flowing. Pass null to remove it.
+        void SetTransform(std::shared_ptr<PacketTransform> transform);
+
+        // Safe to call while packets are flowing. Pass null to remove it.
+        void SetCapture(std::shared_ptr<PacketCapture> capture);
+
+        // Whether the pipeline has any work to do, i.e. needs to be registered.
+        bool active() const;
+
+        void GetStats(PacketDirectionStats (&stats)[kPacketDirectionCount]) const;
+
+        void ResetStats();
+
+        bool onSendAudioPacket(Packet& packet) override;
+        bool onSendVideoPacket(Packet& packet) override;
+        bool onReceiveAudioPacket(Packet& packet) override;
+        bool onReceiveVideoPacket(Packet& packet) override;
+
+    private:
+        struct Direction
+        {
+            std::vector<uint8_t> scratch;
+            std::atomic<uint64_t> packets{0};
+            std::atomic<uint64_t> bytes{0};
+            std::atomic<uint64_t> dropped{0};
+            std::atomic<int64_t> totalNanos{0};
+            std::atomic<int64_t> maxNanos{0};
+        };
+
+        bool Process(PacketDirection direction, Packet& packet);
+
+        // Accessed with std::atomic_load/atomic_store only.
+        std::shared_ptr<PacketTransform> transform;
+        std::shared_ptr<PacketCapture> capture;
+
+        Direction directions[kPacketDirectionCount];
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_PACKET_PIPELINE_H_
@@ -0,0 +1,32 @@
+#ifndef AGORA_RTC_ENGINE_PACKET_TRANSFORM_H_
+#define AGORA_RTC_ENGINE_PACKET_TRANSFORM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace agora_rtc_engine {
+
+    // A reversible transform applied to every media packet, e.g. a cipher.
+    //
+    // Both methods run on the SDK packet threads, possibly concurrently, and
+    // must not allocate or block.
+    class PacketTransform
+    {
+    public:
+        virtual ~PacketTransform() = default;
+
+        // Largest number of bytes Encode adds to a packet.
+        virtual size_t Overhead() const = 0;
+
+        // Transforms an outgoing packet into |out|, which holds at least
+        // |size| + Overhead() bytes. Returns the new size, or 0 to drop it.
+        virtual size_t Encode(const uint8_t* in, size_t size, uint8_t* out) = 0;
+
+        // Reverses Encode for an incoming packet into |out|, which holds at
+        // least |size| bytes. Returns the new size, or 0 to drop it.
+        virtual size_t Decode(const uint8_t* in, size_t size, uint8_t* out) = 0;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_PACKET_TRANSFORM_H_
@@ -0,0 +1,85 @@
+#include "platform_task_runner.h"
+
+#include <algorithm>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const wchar_t kWindowClassName[] = L"AgoraRtcEnginePlatformTaskRunner";
+
+        const UINT kRunTasksMessage = WM_APP + 1;
+
+        const UINT_PTR kDelayedTasksTimer = 1;
+
+        HINSTANCE ModuleInstance()
+        {
+            HMODULE module = nullptr;
+            ::GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                 reinterpret_cast<LPCWSTR>(&ModuleInstance), &module);
+            return module;
+        }
+    }  // namespace
+
+    PlatformTaskRunner::PlatformTaskRunner()
+        : queue([this]() { return ::PostMessageW(window, kRunTasksMessage, 0, 0) != FALSE; })
+    {
+        WNDCLASSEXW windowClass = {};
+        windowClass.cbSize = sizeof(windowClass);
+        windowClass.lpfnWndProc = WindowProc;
+        windowClass.hInstance = ModuleInstance();
+        windowClass.lpszClassName = kWindowClassName;
+        // Fails harmlessly when another instance registered it
+        ::RegisterClassExW(&windowClass);
+        window = ::CreateWindowExW(0, kWindowClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr,
+                                   windowClass.hInstance, nullptr);
+        if (window != nullptr)
+            ::SetWindowLongPtrW(window, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+    }
+
+    PlatformTaskRunner::~PlatformTaskRunner()
+    {
+        if (window != nullptr)
+            ::DestroyWindow(window);
+    }
+
+    void PlatformTaskRunner::Post(Task task)
+    {
+        queue.Post(std::move(task));
+    }
+
+    void PlatformTaskRunner::PostDelayed(Task task, TaskQueue::Clock::duration delay)
+    {
+        queue.PostDelayed(std::move(task), delay);
+    }
+
+    TaskQueueStats PlatformTaskRunner::GetStats() const
+    {
+        return queue.GetStats();
+    }
+
+    LRESULT CALLBACK PlatformTaskRunner::WindowProc(HWND window, UINT message, WPARAM wparam, LPARAM lparam)
+    {
+        auto runner = reinterpret_cast<PlatformTaskRunner*>(::GetWindowLongPtrW(window, GWLP_USERDATA));
+        if (runner != nullptr && (message == kRunTasksMessage || (message == WM_TIMER && wparam == kDelayedTasksTimer)))
+        {
+            runner->RunPending();
+            return 0;
+        }
+        return ::DefWindowProcW(window, message, wparam, lparam);
+    }
+
+    void PlatformTaskRunner::RunPending()
+    {
+        auto next = queue.RunPending();
+        if (next == TaskQueue::Clock::time_point::max())
+        {
+            ::KillTimer(window, kDelayedTasksTimer);
+            return;
+        }
+        // USER timers have a resolution of about 15 ms, rounding up avoids
+        // waking before the task is due.
+        auto delay = std::chrono::ceil<std::chrono::milliseconds>(next - TaskQueue::Clock::now()).count();
+        ::SetTimer(window, kDelayedTasksTimer, static_cast<UINT>(std::clamp<long long>(delay, USER_TIMER_MINIMUM, USER_TIMER_MAXIMUM)), nullptr);
+    }
+
+}  // namespace agora_rtc_engine
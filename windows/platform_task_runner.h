@@ -0,0 +1,50 @@
+#ifndef AGORA_RTC_ENGINE_PLATFORM_TASK_RUNNER_H_
+#define AGORA_RTC_ENGINE_PLATFORM_TASK_RUNNER_H_
+
+#include <windows.h>
+
+#include "task_queue.h"
+
+namespace agora_rtc_engine {
+
+    // Runs tasks on the Flutter platform thread, e.g. sending events to Dart
+    // or completing method calls from SDK and worker threads.
+    //
+    // Tasks are run by a message-only window, which the runner's message loop
+    // dispatches to: a custom message wakes it for posted tasks and a timer
+    // for delayed ones.
+    class PlatformTaskRunner
+    {
+    public:
+        using Task = TaskQueue::Task;
+
+        // Must be called on the platform thread.
+        PlatformTaskRunner();
+
+        // Drops the tasks not run yet.
+        ~PlatformTaskRunner();
+
+        // Prevent copying
+        PlatformTaskRunner(PlatformTaskRunner const&) = delete;
+        PlatformTaskRunner& operator=(PlatformTaskRunner const&) = delete;
+
+        // Safe to call from any thread.
+        void Post(Task task);
+
+        // Safe to call from any thread.
+        void PostDelayed(Task task, TaskQueue::Clock::duration delay);
+
+        TaskQueueStats GetStats() const;
+
+    private:
+        static LRESULT CALLBACK WindowProc(HWND window, UINT message, WPARAM wparam, LPARAM lparam);
+
+        void RunPending();
+
+        HWND window = nullptr;
+        TaskQueue queue;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_PLATFORM_TASK_RUNNER_H_
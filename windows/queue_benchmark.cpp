@@ -0,0 +1,121 @@
+#include "queue_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const size_t kCapacity = 1024;
+        const size_t kBatchSize = 32;
+
+        // A deque guarded by a mutex, with the queues' Push and PopBatch.
+        class MutexQueue
+        {
+        public:
+            bool Push(uint64_t item)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (items.size() >= kCapacity)
+                    return false;
+                items.push_back(item);
+                return true;
+            }
+
+            size_t PopBatch(uint64_t* out, size_t count)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto popped = std::min(count, items.size());
+                std::copy(items.begin(), items.begin() + popped, out);
+                items.erase(items.begin(), items.begin() + popped);
+                return popped;
+            }
+
+        private:
+            std::mutex mutex;
+            std::deque<uint64_t> items;
+        };
+
+        // Runs |produce| on |producers| threads, each with its share of
+        // |items|, while the calling thread pops them all. Returns the mean
+        // nanoseconds per item.
+        template <typename Queue, typename Produce>
+        double Measure(Queue& queue, uint64_t items, int producers, Produce produce)
+        {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+            for (int i = 0; i < producers; ++i)
+            {
+                auto count = items / producers + (static_cast<uint64_t>(i) < items % producers ? 1 : 0);
+                threads.emplace_back([&queue, &produce, count]() { produce(queue, count); });
+            }
+            uint64_t buffer[kBatchSize];
+            uint64_t received = 0;
+            while (received < items)
+            {
+                auto popped = queue.PopBatch(buffer, kBatchSize);
+                if (popped == 0)
+                    std::this_thread::yield();
+                received += popped;
+            }
+            for (auto& thread : threads)
+                thread.join();
+            auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            return static_cast<double>(nanos) / static_cast<double>(items);
+        }
+
+        // Pushes one at a time, retrying while the queue is full.
+        template <typename Queue>
+        void ProduceEach(Queue& queue, uint64_t count)
+        {
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                while (!queue.Push(i))
+                    std::this_thread::yield();
+            }
+        }
+    }  // namespace
+
+    QueueBenchmark BenchmarkQueues(uint64_t items, int producers)
+    {
+        QueueBenchmark benchmark;
+        benchmark.items = std::max<uint64_t>(items, 1);
+        benchmark.producers = std::max(producers, 1);
+        {
+            SpscQueue<uint64_t> queue(kCapacity, QueueOverflow::Reject);
+            benchmark.spscNanos = Measure(queue, benchmark.items, 1, ProduceEach<SpscQueue<uint64_t>>);
+        }
+        {
+            SpscQueue<uint64_t> queue(kCapacity, QueueOverflow::Reject);
+            benchmark.spscBatchNanos = Measure(queue, benchmark.items, 1, [](SpscQueue<uint64_t>& queue, uint64_t count) {
+                uint64_t batch[kBatchSize];
+                for (uint64_t i = 0; i < count;)
+                {
+                    auto size = static_cast<size_t>(std::min<uint64_t>(kBatchSize, count - i));
+                    for (size_t j = 0; j < size; ++j)
+                        batch[j] = i + j;
+                    auto pushed = queue.PushBatch(batch, size);
+                    if (pushed == 0)
+                        std::this_thread::yield();
+                    i += pushed;
+                }
+            });
+        }
+        {
+            MpscQueue<uint64_t> queue(kCapacity, QueueOverflow::Reject);
+            benchmark.mpscNanos = Measure(queue, benchmark.items, benchmark.producers, ProduceEach<MpscQueue<uint64_t>>);
+        }
+        {
+            MutexQueue queue;
+            benchmark.mutexNanos = Measure(queue, benchmark.items, benchmark.producers, ProduceEach<MutexQueue>);
+        }
+        return benchmark;
+    }
+
+}  // namespace agora_rtc_engine
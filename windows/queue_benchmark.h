@@ -0,0 +1,27 @@
+#ifndef AGORA_RTC_ENGINE_QUEUE_BENCHMARK_H_
+#define AGORA_RTC_ENGINE_QUEUE_BENCHMARK_H_
+
+#include <cstdint>
+
+namespace agora_rtc_engine {
+
+    struct QueueBenchmark
+    {
+        uint64_t items = 0;
+        int producers = 0;
+        // Mean time per item, from the first push to the last pop.
+        double spscNanos = 0;
+        double spscBatchNanos = 0;
+        double mpscNanos = 0;
+        // A deque guarded by a mutex, as the native pipelines used.
+        double mutexNanos = 0;
+    };
+
+    // Passes |items| integers through each queue, from one producer thread
+    // to the consumer and then from |producers| threads for the MPSC queue
+    // and the mutex.
+    QueueBenchmark BenchmarkQueues(uint64_t items, int producers);
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_QUEUE_BENCHMARK_H_
@@ -0,0 +1,132 @@
+#include "real_fft.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#define AGORA_RTC_ENGINE_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const double kPi = 3.14159265358979323846;
+    }  // namespace
+
+    RealFft::RealFft(int size)
+        : fftSize(size),
+        half(size / 2),
+        bitReversed(static_cast<size_t>(size / 2)),
+        real(static_cast<size_t>(size / 2)),
+        imag(static_cast<size_t>(size / 2))
+    {
+        auto bits = 0;
+        while ((1 << bits) < half)
+            bits++;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(half); ++i)
+        {
+            uint32_t reversed = 0;
+            for (int b = 0; b < bits; ++b)
+                reversed |= ((i >> b) & 1) << (bits - 1 - b);
+            bitReversed[i] = reversed;
+        }
+
+        // Stage with butterflies |span| apart: twiddles e^(-i pi j / span)
+        for (int span = 1; span < half; span *= 2)
+        {
+            for (int j = 0; j < span; ++j)
+            {
+                auto angle = -kPi * j / span;
+                twiddleReal.push_back(static_cast<float>(std::cos(angle)));
+                twiddleImag.push_back(static_cast<float>(std::sin(angle)));
+            }
+        }
+
+        for (int k = 0; k <= half; ++k)
+        {
+            auto angle = -2 * kPi * k / fftSize;
+            splitReal.push_back(static_cast<float>(std::cos(angle)));
+            splitImag.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+
+    int RealFft::size() const
+    {
+        return fftSize;
+    }
+
+    void RealFft::PowerSpectrum(const float* input, float* power)
+    {
+        // Even samples as the real parts, odd ones as the imaginary parts
+        for (int i = 0; i < half; ++i)
+        {
+            real[bitReversed[i]] = input[2 * i];
+            imag[bitReversed[i]] = input[2 * i + 1];
+        }
+        Transform();
+
+        // X[k] = E[k] + e^(-2 pi i k / size) O[k], where E and O are the
+        // spectra of the even and odd samples:
+        // E[k] = (Z[k] + conj(Z[half - k])) / 2
+        // O[k] = (Z[k] - conj(Z[half - k])) / 2i
+        for (int k = 0; k <= half; ++k)
+        {
+            auto a = k % half;
+            auto b = (half - k) % half;
+            auto evenReal = 0.5f * (real[a] + real[b]);
+            auto evenImag = 0.5f * (imag[a] - imag[b]);
+            auto oddReal = 0.5f * (imag[a] + imag[b]);
+            auto oddImag = -0.5f * (real[a] - real[b]);
+            auto x = evenReal + splitReal[k] * oddReal - splitImag[k] * oddImag;
+            auto y = evenImag + splitReal[k] * oddImag + splitImag[k] * oddReal;
+            power[k] = x * x + y * y;
+        }
+    }
+
+    void RealFft::Transform()
+    {
+        auto re = real.data();
+        auto im = imag.data();
+        auto twiddles = size_t{0};
+        for (int span = 1; span < half; twiddles += span, span *= 2)
+        {
+            auto wr = twiddleReal.data() + twiddles;
+            auto wi = twiddleImag.data() + twiddles;
+            for (int start = 0; start < half; start += 2 * span)
+            {
+                auto ar = re + start;
+                auto ai = im + start;
+                auto br = ar + span;
+                auto bi = ai + span;
+                int j = 0;
+#ifdef AGORA_RTC_ENGINE_HAS_SSE2
+                for (; j + 4 <= span; j += 4)
+                {
+                    auto twr = _mm_loadu_ps(wr + j);
+                    auto twi = _mm_loadu_ps(wi + j);
+                    auto xr = _mm_loadu_ps(br + j);
+                    auto xi = _mm_loadu_ps(bi + j);
+                    auto tr = _mm_sub_ps(_mm_mul_ps(xr, twr), _mm_mul_ps(xi, twi));
+                    auto ti = _mm_add_ps(_mm_mul_ps(xr, twi), _mm_mul_ps(xi, twr));
+                    auto yr = _mm_loadu_ps(ar + j);
+                    auto yi = _mm_loadu_ps(ai + j);
+                    _mm_storeu_ps(br + j, _mm_sub_ps(yr, tr));
+                    _mm_storeu_ps(bi + j, _mm_sub_ps(yi, ti));
+                    _mm_storeu_ps(ar + j, _mm_add_ps(yr, tr));
+                    _mm_storeu_ps(ai + j, _mm_add_ps(yi, ti));
+                }
+#endif
+                for (; j < span; ++j)
+                {
+                    auto tr = br[j] * wr[j] - bi[j] * wi[j];
+                    auto ti = br[j] * wi[j] + bi[j] * wr[j];
+                    br[j] = ar[j] - tr;
+                    bi[j] = ai[j] - ti;
+                    ar[j] += tr;
+                    ai[j] += ti;
+                }
+            }
+        }
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,50 @@
+#ifndef AGORA_RTC_ENGINE_REAL_FFT_H_
+#define AGORA_RTC_ENGINE_REAL_FFT_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace agora_rtc_engine {
+
+    // A fast Fourier transform of real input whose size is a power of two.
+    //
+    // The input is packed into a complex transform of half the size, whose
+    // result is then split into the spectrum of the real input. Real and
+    // imaginary parts are kept in separate arrays, so that the butterflies
+    // of every stage but the first two run four at a time with SSE2.
+    class RealFft
+    {
+    public:
+        // |size| is a power of two, at least 16.
+        explicit RealFft(int size);
+
+        // Prevent copying
+        RealFft(RealFft const&) = delete;
+        RealFft& operator=(RealFft const&) = delete;
+
+        int size() const;
+
+        // Writes the |size| / 2 + 1 squared magnitudes of the spectrum of
+        // |input|'s |size| samples to |power|.
+        void PowerSpectrum(const float* input, float* power);
+
+    private:
+        void Transform();
+
+        const int fftSize;
+        // Of the complex transform, |fftSize| / 2
+        const int half;
+        std::vector<uint32_t> bitReversed;
+        // Per stage, the twiddles of its butterflies
+        std::vector<float> twiddleReal;
+        std::vector<float> twiddleImag;
+        // To split the complex transform into the real spectrum
+        std::vector<float> splitReal;
+        std::vector<float> splitImag;
+        std::vector<float> real;
+        std::vector<float> imag;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_REAL_FFT_H_
@@ -0,0 +1,105 @@
+#ifndef AGORA_RTC_ENGINE_RTC_ENGINE_EVENTS_H_
+#define AGORA_RTC_ENGINE_RTC_ENGINE_EVENTS_H_
+
+#include <cstdint>
+
+#include "IAgoraRtcEngine.h"
+
+// Every IRtcEngineEventHandler callback, as
+//   X(id, name, parameters, arguments)
+// when the arguments are scalars, C strings and structs, or
+//   S(id, name, parameters, arguments)
+// when they pass an array or buffer with its length, which need handling of
+// their own.
+//
+// Ids are stored in event traces: append new callbacks, never renumber.
+#define AGORA_RTC_ENGINE_EVENTS(X, S) \
+    X(1, onWarning, (int warn, const char* msg), (warn, msg)) \
+    X(2, onError, (int err, const char* msg), (err, msg)) \
+    X(3, onJoinChannelSuccess, (const char* channel, agora::rtc::uid_t uid, int elapsed), (channel, uid, elapsed)) \
+    X(4, onRejoinChannelSuccess, (const char* channel, agora::rtc::uid_t uid, int elapsed), (channel, uid, elapsed)) \
+    X(5, onLeaveChannel, (const agora::rtc::RtcStats& stats), (stats)) \
+    X(6, onClientRoleChanged, (agora::rtc::CLIENT_ROLE_TYPE oldRole, agora::rtc::CLIENT_ROLE_TYPE newRole), (oldRole, newRole)) \
+    X(7, onUserJoined, (agora::rtc::uid_t uid, int elapsed), (uid, elapsed)) \
+    X(8, onUserOffline, (agora::rtc::uid_t uid, agora::rtc::USER_OFFLINE_REASON_TYPE reason), (uid, reason)) \
+    X(9, onLastmileQuality, (int quality), (quality)) \
+    X(10, onLastmileProbeResult, (const agora::rtc::LastmileProbeResult& result), (result)) \
+    X(11, onConnectionInterrupted, (), ()) \
+    X(12, onConnectionLost, (), ()) \
+    X(13, onConnectionBanned, (), ()) \
+    X(14, onApiCallExecuted, (int err, const char* api, const char* result), (err, api, result)) \
+    X(15, onRequestToken, (), ()) \
+    X(16, onTokenPrivilegeWillExpire, (const char* token), (token)) \
+    X(17, onAudioQuality, (agora::rtc::uid_t uid, int quality, unsigned short delay, unsigned short lost), (uid, quality, delay, lost)) \
+    X(18, onRtcStats, (const agora::rtc::RtcStats& stats), (stats)) \
+    X(19, onNetworkQuality, (agora::rtc::uid_t uid, int txQuality, int rxQuality), (uid, txQuality, rxQuality)) \
+    X(20, onLocalVideoStats, (const agora::rtc::LocalVideoStats& stats), (stats)) \
+    X(21, onRemoteVideoStats, (const agora::rtc::RemoteVideoStats& stats), (stats)) \
+    X(22, onLocalAudioStats, (const agora::rtc::LocalAudioStats& stats), (stats)) \
+    X(23, onRemoteAudioStats, (const agora::rtc::RemoteAudioStats& stats), (stats)) \
+    X(24, onLocalAudioStateChanged, (agora::rtc::LOCAL_AUDIO_STREAM_STATE state, agora::rtc::LOCAL_AUDIO_STREAM_ERROR error), (state, error)) \
+    X(25, onRemoteAudioStateChanged, (agora::rtc::uid_t uid, agora::rtc::REMOTE_AUDIO_STATE state, agora::rtc::REMOTE_AUDIO_STATE_REASON reason, int elapsed), (uid, state, reason, elapsed)) \
+    S(26, onAudioVolumeIndication, (const agora::rtc::AudioVolumeInfo* speakers, unsigned int speakerNumber, int totalVolume), (speakers, speakerNumber, totalVolume)) \
+    X(27, onActiveSpeaker, (agora::rtc::uid_t uid), (uid)) \
+    X(28, onVideoStopped, (), ()) \
+    X(29, onFirstLocalVideoFrame, (int width, int height, int elapsed), (width, height, elapsed)) \
+    X(30, onFirstRemoteVideoDecoded, (agora::rtc::uid_t uid, int width, int height, int elapsed), (uid, width, height, elapsed)) \
+    X(31, onFirstRemoteVideoFrame, (agora::rtc::uid_t uid, int width, int height, int elapsed), (uid, width, height, elapsed)) \
+    X(32, onUserMuteAudio, (agora::rtc::uid_t uid, bool muted), (uid, muted)) \
+    X(33, onUserMuteVideo, (agora::rtc::uid_t uid, bool muted), (uid, muted)) \
+    X(34, onUserEnableVideo, (agora::rtc::uid_t uid, bool enabled), (uid, enabled)) \
+    X(35, onAudioDeviceStateChanged, (const char* deviceId, int deviceType, int deviceState), (deviceId, deviceType, deviceState)) \
+    X(36, onAudioDeviceVolumeChanged, (agora::rtc::MEDIA_DEVICE_TYPE deviceType, int volume, bool muted), (deviceType, volume, muted)) \
+    X(37, onCameraReady, (), ()) \
+    X(38, onCameraFocusAreaChanged, (int x, int y, int width, int height), (x, y, width, height)) \
+    X(39, onCameraExposureAreaChanged, (int x, int y, int width, int height), (x, y, width, height)) \
+    X(40, onAudioMixingFinished, (), ()) \
+    X(41, onAudioMixingStateChanged, (agora::rtc::AUDIO_MIXING_STATE_TYPE state, agora::rtc::AUDIO_MIXING_ERROR_TYPE errorCode), (state, errorCode)) \
+    X(42, onRemoteAudioMixingBegin, (), ()) \
+    X(43, onRemoteAudioMixingEnd, (), ()) \
+    X(44, onAudioEffectFinished, (int soundId), (soundId)) \
+    X(45, onFirstRemoteAudioDecoded, (agora::rtc::uid_t uid, int elapsed), (uid, elapsed)) \
+    X(46, onVideoDeviceStateChanged, (const char* deviceId, int deviceType, int deviceState), (deviceId, deviceType, deviceState)) \
+    X(47, onLocalVideoStateChanged, (agora::rtc::LOCAL_VIDEO_STREAM_STATE localVideoState, agora::rtc::LOCAL_VIDEO_STREAM_ERROR error), (localVideoState, error)) \
+    X(48, onVideoSizeChanged, (agora::rtc::uid_t uid, int width, int height, int rotation), (uid, width, height, rotation)) \
+    X(49, onRemoteVideoStateChanged, (agora::rtc::uid_t uid, agora::rtc::REMOTE_VIDEO_STATE state, agora::rtc::REMOTE_VIDEO_STATE_REASON reason, int elapsed), (uid, state, reason, elapsed)) \
+    X(50, onUserEnableLocalVideo, (agora::rtc::uid_t uid, bool enabled), (uid, enabled)) \
+    S(51, onStreamMessage, (agora::rtc::uid_t uid, int streamId, const char* data, size_t length), (uid, streamId, data, length)) \
+    X(52, onStreamMessageError, (agora::rtc::uid_t uid, int streamId, int code, int missed, int cached), (uid, streamId, code, missed, cached)) \
+    X(53, onMediaEngineLoadSuccess, (), ()) \
+    X(54, onMediaEngineStartCallSuccess, (), ()) \
+    X(55, onChannelMediaRelayStateChanged, (agora::rtc::CHANNEL_MEDIA_RELAY_STATE state, agora::rtc::CHANNEL_MEDIA_RELAY_ERROR code), (state, code)) \
+    X(56, onChannelMediaRelayEvent, (agora::rtc::CHANNEL_MEDIA_RELAY_EVENT code), (code)) \
+    X(57, onFirstLocalAudioFrame, (int elapsed), (elapsed)) \
+    X(58, onFirstRemoteAudioFrame, (agora::rtc::uid_t uid, int elapsed), (uid, elapsed)) \
+    X(59, onRtmpStreamingStateChanged, (const char* url, agora::rtc::RTMP_STREAM_PUBLISH_STATE state, agora::rtc::RTMP_STREAM_PUBLISH_ERROR errCode), (url, state, errCode)) \
+    X(60, onStreamPublished, (const char* url, int error), (url, error)) \
+    X(61, onStreamUnpublished, (const char* url), (url)) \
+    X(62, onTranscodingUpdated, (), ()) \
+    X(63, onStreamInjectedStatus, (const char* url, agora::rtc::uid_t uid, int status), (url, uid, status)) \
+    X(64, onAudioRouteChanged, (agora::rtc::AUDIO_ROUTE_TYPE routing), (routing)) \
+    X(65, onLocalPublishFallbackToAudioOnly, (bool isFallbackOrRecover), (isFallbackOrRecover)) \
+    X(66, onRemoteSubscribeFallbackToAudioOnly, (agora::rtc::uid_t uid, bool isFallbackOrRecover), (uid, isFallbackOrRecover)) \
+    X(67, onRemoteAudioTransportStats, (agora::rtc::uid_t uid, unsigned short delay, unsigned short lost, unsigned short rxKBitRate), (uid, delay, lost, rxKBitRate)) \
+    X(68, onRemoteVideoTransportStats, (agora::rtc::uid_t uid, unsigned short delay, unsigned short lost, unsigned short rxKBitRate), (uid, delay, lost, rxKBitRate)) \
+    X(69, onMicrophoneEnabled, (bool enabled), (enabled)) \
+    X(70, onConnectionStateChanged, (agora::rtc::CONNECTION_STATE_TYPE state, agora::rtc::CONNECTION_CHANGED_REASON_TYPE reason), (state, reason)) \
+    X(71, onNetworkTypeChanged, (agora::rtc::NETWORK_TYPE type), (type)) \
+    X(72, onLocalUserRegistered, (agora::rtc::uid_t uid, const char* userAccount), (uid, userAccount)) \
+    X(73, onUserInfoUpdated, (agora::rtc::uid_t uid, const agora::rtc::UserInfo& info), (uid, info))
+
+namespace agora_rtc_engine {
+
+    enum class RtcEngineEvent : uint16_t
+    {
+#define AGORA_RTC_ENGINE_EVENT_ID(id, name, parameters, arguments) name = id,
+        AGORA_RTC_ENGINE_EVENTS(AGORA_RTC_ENGINE_EVENT_ID, AGORA_RTC_ENGINE_EVENT_ID)
+#undef AGORA_RTC_ENGINE_EVENT_ID
+    };
+
+    // One more than the largest id.
+    const int kRtcEngineEventCount = 74;
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_RTC_ENGINE_EVENTS_H_
@@ -0,0 +1,80 @@
+// Generated by tools/generate_rtc_stats_schema.py from IAgoraRtcEngine.h,
+// do not edit.
+#ifndef AGORA_RTC_ENGINE_RTC_STATS_SCHEMA_H_
+#define AGORA_RTC_ENGINE_RTC_STATS_SCHEMA_H_
+
+// X(type, fields) for each stats struct, where fields(F) calls
+// F(member, key) for each of its members.
+#define AGORA_RTC_STATS_STRUCTS(X) \
+    X(RtcStats, AGORA_RTC_STATS_FIELDS_RTC_STATS) \
+    X(LocalVideoStats, AGORA_RTC_STATS_FIELDS_LOCAL_VIDEO_STATS) \
+    X(RemoteVideoStats, AGORA_RTC_STATS_FIELDS_REMOTE_VIDEO_STATS) \
+    X(LocalAudioStats, AGORA_RTC_STATS_FIELDS_LOCAL_AUDIO_STATS) \
+    X(RemoteAudioStats, AGORA_RTC_STATS_FIELDS_REMOTE_AUDIO_STATS)
+
+#define AGORA_RTC_STATS_FIELDS_RTC_STATS(F) \
+    F(duration, "totalDuration") \
+    F(txBytes, "txBytes") \
+    F(rxBytes, "rxBytes") \
+    F(txAudioBytes, "txAudioBytes") \
+    F(txVideoBytes, "txVideoBytes") \
+    F(rxAudioBytes, "rxAudioBytes") \
+    F(rxVideoBytes, "rxVideoBytes") \
+    F(txKBitRate, "txKBitrate") \
+    F(rxKBitRate, "rxKBitrate") \
+    F(rxAudioKBitRate, "rxAudioKBitrate") \
+    F(txAudioKBitRate, "txAudioKBitrate") \
+    F(rxVideoKBitRate, "rxVideoKBitrate") \
+    F(txVideoKBitRate, "txVideoKBitrate") \
+    F(lastmileDelay, "lastmileDelay") \
+    F(txPacketLossRate, "txPacketLossRate") \
+    F(rxPacketLossRate, "rxPacketLossRate") \
+    F(userCount, "users") \
+    F(cpuAppUsage, "cpuAppUsage") \
+    F(cpuTotalUsage, "cpuTotalUsage")
+
+#define AGORA_RTC_STATS_FIELDS_LOCAL_VIDEO_STATS(F) \
+    F(sentBitrate, "sentBitrate") \
+    F(sentFrameRate, "sentFrameRate") \
+    F(encoderOutputFrameRate, "encoderOutputFrameRate") \
+    F(rendererOutputFrameRate, "rendererOutputFrameRate") \
+    F(targetBitrate, "targetBitrate") \
+    F(targetFrameRate, "targetFrameRate") \
+    F(qualityAdaptIndication, "qualityAdaptIndication") \
+    F(encodedBitrate, "encodedBitrate") \
+    F(encodedFrameWidth, "encodedFrameWidth") \
+    F(encodedFrameHeight, "encodedFrameHeight") \
+    F(encodedFrameCount, "encodedFrameCount") \
+    F(codecType, "codecType")
+
+#define AGORA_RTC_STATS_FIELDS_REMOTE_VIDEO_STATS(F) \
+    F(uid, "uid") \
+    F(delay, "delay") \
+    F(width, "width") \
+    F(height, "height") \
+    F(receivedBitrate, "receivedBitrate") \
+    F(decoderOutputFrameRate, "decoderOutputFrameRate") \
+    F(rendererOutputFrameRate, "rendererOutputFrameRate") \
+    F(packetLossRate, "packetLossRate") \
+    F(rxStreamType, "rxStreamType") \
+    F(totalFrozenTime, "totalFrozenTime") \
+    F(frozenRate, "frozenRate")
+
+#define AGORA_RTC_STATS_FIELDS_LOCAL_AUDIO_STATS(F) \
+    F(numChannels, "numChannels") \
+    F(sentSampleRate, "sentSampleRate") \
+    F(sentBitrate, "sentBitrate")
+
+#define AGORA_RTC_STATS_FIELDS_REMOTE_AUDIO_STATS(F) \
+    F(uid, "uid") \
+    F(quality, "quality") \
+    F(networkTransportDelay, "networkTransportDelay") \
+    F(jitterBufferDelay, "jitterBufferDelay") \
+    F(audioLossRate, "audioLossRate") \
+    F(numChannels, "numChannels") \
+    F(receivedSampleRate, "receivedSampleRate") \
+    F(receivedBitrate, "receivedBitrate") \
+    F(totalFrozenTime, "totalFrozenTime") \
+    F(frozenRate, "frozenRate")
+
+#endif  // AGORA_RTC_ENGINE_RTC_STATS_SCHEMA_H_
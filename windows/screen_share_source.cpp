@@ -0,0 +1,277 @@
+#include "screen_share_source.h"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define AGORA_RTC_ENGINE_HAS_CRC32C 1
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace agora_rtc_engine {
+
+    namespace {
+        using HashFunction = uint32_t (*)(uint32_t hash, const uint8_t* data, size_t length);
+
+        inline uint64_t Load64(const uint8_t* data)
+        {
+            uint64_t value;
+            std::copy(data, data + sizeof(value), reinterpret_cast<uint8_t*>(&value));
+            return value;
+        }
+
+        inline uint32_t Load32(const uint8_t* data)
+        {
+            uint32_t value;
+            std::copy(data, data + sizeof(value), reinterpret_cast<uint8_t*>(&value));
+            return value;
+        }
+
+        // Not a CRC, only needs to change when the pixels do.
+        uint32_t MultiplyHash(uint32_t hash, const uint8_t* data, size_t length)
+        {
+            uint64_t h = hash;
+            for (; length >= 8; data += 8, length -= 8)
+            {
+                h = (h ^ Load64(data)) * 0x9E3779B97F4A7C15ull;
+                h = (h << 31) | (h >> 33);
+            }
+            // Rows are whole BGRA pixels
+            if (length >= 4)
+                h = ((h ^ Load32(data)) * 0x9E3779B97F4A7C15ull) >> 7;
+            return static_cast<uint32_t>(h ^ (h >> 32));
+        }
+
+#ifdef AGORA_RTC_ENGINE_HAS_CRC32C
+#if defined(__GNUC__)
+        __attribute__((target("sse4.2")))
+#endif
+        uint32_t Crc32cHash(uint32_t hash, const uint8_t* data, size_t length)
+        {
+            uint64_t crc = hash;
+            for (; length >= 8; data += 8, length -= 8)
+                crc = _mm_crc32_u64(crc, Load64(data));
+            auto crc32 = static_cast<uint32_t>(crc);
+            if (length >= 4)
+                crc32 = _mm_crc32_u32(crc32, Load32(data));
+            return crc32;
+        }
+
+        bool HasSse42()
+        {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 20)) != 0;
+#else
+            return __builtin_cpu_supports("sse4.2");
+#endif
+        }
+#endif
+
+        HashFunction SelectHash()
+        {
+#ifdef AGORA_RTC_ENGINE_HAS_CRC32C
+            if (HasSse42())
+                return Crc32cHash;
+#endif
+            return MultiplyHash;
+        }
+
+        int64_t NanosSince(ScreenShareSource::Clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(ScreenShareSource::Clock::now() - start).count();
+        }
+    }  // namespace
+
+    ScreenShareSource::ScreenShareSource(PushFunction push)
+        : push(std::move(push))
+    {
+    }
+
+    ScreenShareSource::~ScreenShareSource()
+    {
+        Stop();
+    }
+
+    void ScreenShareSource::Start(const ScreenShareOptions& options, std::unique_ptr<ScreenCaptureBackend> backend)
+    {
+        Stop();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = false;
+            started = Clock::now();
+        }
+        maxFrameRate = std::max(options.maxFrameRate, 1);
+        captured = 0;
+        pushed = 0;
+        skipped = 0;
+        failed = 0;
+        changedFrames = 0;
+        frameRate = 0;
+        dirtyTileSum = 0;
+        captureNanos = 0;
+        hashNanos = 0;
+        worker = std::thread(&ScreenShareSource::Run, this, options, std::move(backend));
+    }
+
+    void ScreenShareSource::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        if (worker.joinable())
+            worker.join();
+        frameRate = 0;
+    }
+
+    bool ScreenShareSource::running() const
+    {
+        return worker.joinable();
+    }
+
+    ScreenShareStats ScreenShareSource::GetStats() const
+    {
+        ScreenShareStats stats;
+        stats.captured = captured;
+        stats.pushed = pushed;
+        stats.skipped = skipped;
+        stats.failed = failed;
+        stats.frameRate = frameRate;
+        auto changed = changedFrames.load();
+        if (changed > 0)
+            stats.dirtyTileRatio = dirtyTileSum / static_cast<double>(changed);
+        auto succeeded = static_cast<int64_t>(stats.captured);
+        if (succeeded > 0)
+        {
+            stats.meanCaptureNanos = captureNanos / succeeded;
+            stats.meanHashNanos = hashNanos / succeeded;
+        }
+        if (running())
+        {
+            Clock::time_point start;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                start = started;
+            }
+            auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            auto fixedRate = static_cast<uint64_t>(seconds * maxFrameRate);
+            stats.savedFrames = fixedRate > stats.pushed ? fixedRate - stats.pushed : 0;
+        }
+        return stats;
+    }
+
+    // static
+    size_t ScreenShareSource::HashTiles(const ScreenFrame& frame, std::vector<uint32_t>& hashes)
+    {
+        static const HashFunction hash = SelectHash();
+
+        auto columns = static_cast<size_t>((frame.width + kTileSize - 1) / kTileSize);
+        auto rows = static_cast<size_t>((frame.height + kTileSize - 1) / kTileSize);
+        auto resized = hashes.size() != columns * rows;
+        hashes.resize(columns * rows);
+
+        // Walks the image row by row, each row feeding the tiles it crosses,
+        // rather than tile by tile across rows.
+        std::vector<uint32_t> band(columns);
+        size_t changed = 0;
+        const auto tileBytes = static_cast<size_t>(kTileSize) * 4;
+        const auto rowBytes = static_cast<size_t>(frame.width) * 4;
+        for (size_t tileRow = 0; tileRow < rows; ++tileRow)
+        {
+            std::fill(band.begin(), band.end(), ~0u);
+            auto first = tileRow * kTileSize;
+            auto last = std::min(first + kTileSize, static_cast<size_t>(frame.height));
+            for (auto y = first; y < last; ++y)
+            {
+                auto line = frame.data + y * static_cast<size_t>(frame.stride);
+                for (size_t column = 0; column < columns; ++column)
+                {
+                    auto offset = column * tileBytes;
+                    band[column] = hash(band[column], line + offset, std::min(tileBytes, rowBytes - offset));
+                }
+            }
+            for (size_t column = 0; column < columns; ++column)
+            {
+                auto& previous = hashes[tileRow * columns + column];
+                if (resized || previous != band[column])
+                    changed++;
+                previous = band[column];
+            }
+        }
+        return changed;
+    }
+
+    void ScreenShareSource::Run(ScreenShareOptions options, std::unique_ptr<ScreenCaptureBackend> backend)
+    {
+        using std::chrono::milliseconds;
+        const auto fastest = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(options.maxFrameRate, 1)));
+        const auto slowest = std::max(fastest, std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / std::max(options.minFrameRate, 1))));
+        const auto refresh = milliseconds(std::max(options.refreshIntervalMs, 0));
+
+        std::vector<uint32_t> hashes;
+        auto interval = fastest;
+        auto due = Clock::now();
+        Clock::time_point lastPush;
+        bool first = true;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (condition.wait_until(lock, due, [this]() { return stopping; }))
+                    break;
+            }
+
+            auto start = Clock::now();
+            ScreenFrame frame;
+            if (!backend->Capture(frame) || frame.data == nullptr || frame.width <= 0 || frame.height <= 0)
+            {
+                failed++;
+                due = start + slowest;
+                continue;
+            }
+            captureNanos += NanosSince(start);
+            captured++;
+
+            auto hashStart = Clock::now();
+            auto tiles = static_cast<double>(((frame.width + kTileSize - 1) / kTileSize) * ((frame.height + kTileSize - 1) / kTileSize));
+            auto changed = HashTiles(frame, hashes);
+            hashNanos += NanosSince(hashStart);
+
+            auto now = Clock::now();
+            if (changed > 0)
+            {
+                changedFrames++;
+                dirtyTileSum = dirtyTileSum + static_cast<double>(changed) / tiles;
+                interval = fastest;
+            }
+            else
+            {
+                interval = std::min(slowest, std::chrono::duration_cast<Clock::duration>(interval * 1.5));
+            }
+
+            if (changed > 0 || first || (refresh.count() > 0 && now - lastPush >= refresh))
+            {
+                push(frame, std::chrono::duration_cast<milliseconds>(now.time_since_epoch()).count());
+                pushed++;
+                lastPush = now;
+                first = false;
+            }
+            else
+            {
+                skipped++;
+            }
+
+            frameRate = 1.0 / std::chrono::duration<double>(interval).count();
+            // Paced from the capture start, a slow capture does not drift the rate
+            due = std::max(start + interval, now);
+        }
+        backend.reset();
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,128 @@
+#ifndef AGORA_RTC_ENGINE_SCREEN_SHARE_SOURCE_H_
+#define AGORA_RTC_ENGINE_SCREEN_SHARE_SOURCE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace agora_rtc_engine {
+
+    // A captured 32-bit BGRA image, valid until the next capture.
+    struct ScreenFrame
+    {
+        const uint8_t* data = nullptr;
+        int width = 0;
+        int height = 0;
+        // Bytes per row
+        int stride = 0;
+    };
+
+    // Where screen images come from, e.g. GDI on Windows or a synthetic
+    // source when exercising the pipeline elsewhere. Called on the capture
+    // thread only.
+    class ScreenCaptureBackend
+    {
+    public:
+        virtual ~ScreenCaptureBackend() = default;
+
+        virtual bool Capture(ScreenFrame& frame) = 0;
+    };
+
+    struct ScreenShareOptions
+    {
+        // Capture rate while the content changes, and when it stays still.
+        int maxFrameRate = 15;
+        int minFrameRate = 1;
+        // An unchanged frame is still pushed this often, so that receivers
+        // joining late get a picture. 0 never repeats frames.
+        int refreshIntervalMs = 2000;
+    };
+
+    struct ScreenShareStats
+    {
+        uint64_t captured = 0;
+        uint64_t pushed = 0;
+        // Unchanged frames not pushed.
+        uint64_t skipped = 0;
+        uint64_t failed = 0;
+        // Frames a fixed-rate capture at maxFrameRate would have pushed on
+        // top of those pushed.
+        uint64_t savedFrames = 0;
+        double frameRate = 0;
+        // Mean fraction of tiles changed in the frames that changed.
+        double dirtyTileRatio = 0;
+        int64_t meanCaptureNanos = 0;
+        int64_t meanHashNanos = 0;
+    };
+
+    // Shares a screen or window by pushing its images as an external video
+    // source, only when they change.
+    //
+    // Each frame is split into tiles that are hashed with CRC32C, in hardware
+    // where available, and compared with the hashes of the previous frame.
+    // The capture rate jumps to maxFrameRate as soon as anything changes and
+    // decays towards minFrameRate while nothing does.
+    class ScreenShareSource
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Called on the capture thread with each frame to send.
+        using PushFunction = std::function<void(const ScreenFrame& frame, int64_t timestampMs)>;
+
+        static const int kTileSize = 32;
+
+        explicit ScreenShareSource(PushFunction push);
+
+        ~ScreenShareSource();
+
+        // Prevent copying
+        ScreenShareSource(ScreenShareSource const&) = delete;
+        ScreenShareSource& operator=(ScreenShareSource const&) = delete;
+
+        // Starts capturing from |backend| on a thread of its own, replacing
+        // the current backend.
+        void Start(const ScreenShareOptions& options, std::unique_ptr<ScreenCaptureBackend> backend);
+
+        void Stop();
+
+        bool running() const;
+
+        ScreenShareStats GetStats() const;
+
+        // Hashes the tiles of |frame| into |hashes|, row by row. Returns the
+        // number of tiles that differ from the hashes already there, all of
+        // them if the count of tiles changed.
+        static size_t HashTiles(const ScreenFrame& frame, std::vector<uint32_t>& hashes);
+
+    private:
+        void Run(ScreenShareOptions options, std::unique_ptr<ScreenCaptureBackend> backend);
+
+        PushFunction push;
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        bool stopping = false;
+        std::thread worker;
+
+        Clock::time_point started;
+        std::atomic<int> maxFrameRate{0};
+        std::atomic<uint64_t> captured{0};
+        std::atomic<uint64_t> pushed{0};
+        std::atomic<uint64_t> skipped{0};
+        std::atomic<uint64_t> failed{0};
+        std::atomic<uint64_t> changedFrames{0};
+        std::atomic<double> frameRate{0};
+        std::atomic<double> dirtyTileSum{0};
+        std::atomic<int64_t> captureNanos{0};
+        std::atomic<int64_t> hashNanos{0};
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_SCREEN_SHARE_SOURCE_H_
@@ -0,0 +1,155 @@
+#include "stats_encoder.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <numeric>
+
+using namespace agora::rtc;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // The keys of a struct's fields in map order, with the index of the
+        // field each one belongs to.
+        template <size_t N>
+        struct StatsKeys
+        {
+            std::array<EncodableValue, N> keys;
+            std::array<size_t, N> fields;
+
+            explicit StatsKeys(const std::array<const char*, N>& names)
+            {
+                std::array<EncodableValue, N> unsorted;
+                for (size_t i = 0; i < N; ++i)
+                    unsorted[i] = EncodableValue(std::string(names[i]));
+                std::iota(fields.begin(), fields.end(), size_t(0));
+                std::sort(fields.begin(), fields.end(), [&unsorted](size_t a, size_t b) {
+                    return unsorted[a] < unsorted[b];
+                });
+                for (size_t i = 0; i < N; ++i)
+                    keys[i] = unsorted[fields[i]];
+            }
+        };
+
+        template <size_t N>
+        EncodableMap Build(const StatsKeys<N>& keys, std::array<EncodableValue, N>& values)
+        {
+            EncodableMap map;
+            for (size_t i = 0; i < N; ++i)
+                map.emplace_hint(map.end(), keys.keys[i], std::move(values[keys.fields[i]]));
+            return map;
+        }
+
+        template <size_t N>
+        void Update(const StatsKeys<N>& keys, std::array<EncodableValue, N>& values, EncodableMap& map)
+        {
+            if (map.size() == N)
+            {
+                size_t i = 0;
+                auto entry = map.begin();
+                for (; i < N && entry->first == keys.keys[i]; ++i, ++entry)
+                    entry->second = std::move(values[keys.fields[i]]);
+                if (i == N)
+                    return;
+            }
+            // Not from an earlier call, the values left are still in place
+            map = Build(keys, values);
+        }
+
+        // The RtcStats encoder before the schema, for comparison.
+        EncodableMap EncodeHandwritten(const RtcStats& stats)
+        {
+            return EncodableMap{
+                {"totalDuration", (int)stats.duration},
+                {"txBytes", (int)stats.txBytes},
+                {"rxBytes", (int)stats.rxBytes},
+                {"txAudioBytes", (int)stats.txAudioBytes},
+                {"txVideoBytes", (int)stats.txVideoBytes},
+                {"rxAudioBytes", (int)stats.rxAudioBytes},
+                {"rxVideoBytes", (int)stats.rxVideoBytes},
+                {"txKBitrate", (int)stats.txKBitRate},
+                {"rxKBitrate", (int)stats.rxKBitRate},
+                {"txAudioKBitrate", (int)stats.txAudioKBitRate},
+                {"rxAudioKBitrate", (int)stats.rxAudioKBitRate},
+                {"txVideoKBitrate", (int)stats.txVideoKBitRate},
+                {"rxVideoKBitrate", (int)stats.rxVideoKBitRate},
+                {"lastmileDelay", (int)stats.lastmileDelay},
+                {"txPacketLossRate", (int)stats.txPacketLossRate},
+                {"rxPacketLossRate", (int)stats.rxPacketLossRate},
+                {"users", (int)stats.userCount},
+                {"cpuAppUsage", stats.cpuAppUsage},
+                {"cpuTotalUsage", stats.cpuTotalUsage},
+            };
+        }
+
+        template <typename Function>
+        int64_t MeanNanos(int iterations, Function function)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+                function(i);
+            auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            return nanos / iterations;
+        }
+    }  // namespace
+
+#define AGORA_RTC_STATS_COUNT(member, key) +1
+#define AGORA_RTC_STATS_NAME(member, key) key,
+#define AGORA_RTC_STATS_VALUE(member, key) EncodeScalar(stats.member),
+#define AGORA_RTC_STATS_ENCODER(type, fields) \
+    namespace { \
+        const size_t k##type##Fields = 0 fields(AGORA_RTC_STATS_COUNT); \
+        const StatsKeys<k##type##Fields>& type##Keys() \
+        { \
+            static const StatsKeys<k##type##Fields> keys(std::array<const char*, k##type##Fields>{{fields(AGORA_RTC_STATS_NAME)}}); \
+            return keys; \
+        } \
+    } \
+    EncodableMap EncodeStats(const type& stats) \
+    { \
+        std::array<EncodableValue, k##type##Fields> values{{fields(AGORA_RTC_STATS_VALUE)}}; \
+        return Build(type##Keys(), values); \
+    } \
+    void EncodeStatsInto(const type& stats, EncodableMap& map) \
+    { \
+        std::array<EncodableValue, k##type##Fields> values{{fields(AGORA_RTC_STATS_VALUE)}}; \
+        Update(type##Keys(), values, map); \
+    }
+    AGORA_RTC_STATS_STRUCTS(AGORA_RTC_STATS_ENCODER)
+#undef AGORA_RTC_STATS_ENCODER
+#undef AGORA_RTC_STATS_VALUE
+#undef AGORA_RTC_STATS_NAME
+#undef AGORA_RTC_STATS_COUNT
+
+    StatsEncodingBenchmark BenchmarkStatsEncoding(int iterations)
+    {
+        StatsEncodingBenchmark benchmark;
+        benchmark.iterations = std::max(iterations, 1);
+        RtcStats stats;
+        stats.txBytes = 3000000000u;
+        stats.cpuAppUsage = 12.5;
+        size_t sink = 0;
+        benchmark.handwrittenNanos = MeanNanos(benchmark.iterations, [&](int i) {
+            stats.duration = static_cast<unsigned int>(i);
+            sink += EncodeHandwritten(stats).size();
+        });
+        benchmark.generatedNanos = MeanNanos(benchmark.iterations, [&](int i) {
+            stats.duration = static_cast<unsigned int>(i);
+            sink += EncodeStats(stats).size();
+        });
+        EncodableMap map;
+        benchmark.inPlaceNanos = MeanNanos(benchmark.iterations, [&](int i) {
+            stats.duration = static_cast<unsigned int>(i);
+            EncodeStatsInto(stats, map);
+            sink += map.size();
+        });
+        // Keeps the encoding from being optimized away
+        if (sink == 0)
+            benchmark.iterations = 0;
+        return benchmark;
+    }
+
+}  // namespace agora_rtc_engine
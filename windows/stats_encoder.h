@@ -0,0 +1,62 @@
+#ifndef AGORA_RTC_ENGINE_STATS_ENCODER_H_
+#define AGORA_RTC_ENGINE_STATS_ENCODER_H_
+
+#include <flutter/encodable_value.h>
+
+#include <cstdint>
+#include <type_traits>
+
+#include "IAgoraRtcEngine.h"
+
+#include "rtc_stats_schema.h"
+
+namespace agora_rtc_engine {
+
+    // Encodes a scalar without losing range: enums and integers that fit as
+    // int, others such as unsigned 32-bit byte counters as int64, and
+    // floating point numbers as double.
+    template <typename T>
+    flutter::EncodableValue EncodeScalar(T value)
+    {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "unsupported scalar");
+        if constexpr (std::is_enum_v<T>)
+            return flutter::EncodableValue(static_cast<int32_t>(value));
+        else if constexpr (std::is_same_v<T, bool>)
+            return flutter::EncodableValue(value);
+        else if constexpr (std::is_floating_point_v<T>)
+            return flutter::EncodableValue(static_cast<double>(value));
+        else if constexpr (sizeof(T) < sizeof(int32_t) || (std::is_signed_v<T> && sizeof(T) == sizeof(int32_t)))
+            return flutter::EncodableValue(static_cast<int32_t>(value));
+        else
+            return flutter::EncodableValue(static_cast<int64_t>(value));
+    }
+
+    // Encoders for the SDK's stats structs, generated from the fields listed
+    // in rtc_stats_schema.h.
+    //
+    // Keys are built once per struct and kept sorted, so that encoding only
+    // copies them into the map, each appended at its end. EncodeStatsInto
+    // updates a map from an earlier call in place instead, allocating
+    // nothing when it already holds every key.
+#define AGORA_RTC_STATS_ENCODER_DECLARATION(type, fields) \
+    flutter::EncodableMap EncodeStats(const agora::rtc::type& stats); \
+    void EncodeStatsInto(const agora::rtc::type& stats, flutter::EncodableMap& map);
+    AGORA_RTC_STATS_STRUCTS(AGORA_RTC_STATS_ENCODER_DECLARATION)
+#undef AGORA_RTC_STATS_ENCODER_DECLARATION
+
+    struct StatsEncodingBenchmark
+    {
+        int iterations = 0;
+        // Mean time to encode RtcStats.
+        int64_t handwrittenNanos = 0;
+        int64_t generatedNanos = 0;
+        int64_t inPlaceNanos = 0;
+    };
+
+    // Times the generated RtcStats encoders against the handwritten one they
+    // replaced.
+    StatsEncodingBenchmark BenchmarkStatsEncoding(int iterations);
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_STATS_ENCODER_H_
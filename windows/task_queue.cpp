@@ -0,0 +1,115 @@
+#include "task_queue.h"
+
+#include <algorithm>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        struct LaterFirst
+        {
+            template <typename T>
+            bool operator()(const T& a, const T& b) const
+            {
+                return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+            }
+        };
+    }  // namespace
+
+    TaskQueue::TaskQueue(WakeFunction wake)
+        : wake(std::move(wake))
+    {
+    }
+
+    TaskQueue::~TaskQueue()
+    {
+        auto node = head.exchange(nullptr);
+        while (node)
+        {
+            auto next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    void TaskQueue::Post(Task task)
+    {
+        Push(new Node{std::move(task), Clock::time_point::min()});
+    }
+
+    void TaskQueue::PostDelayed(Task task, Clock::duration delay)
+    {
+        Push(new Node{std::move(task), Clock::now() + delay});
+    }
+
+    void TaskQueue::Push(Node* node)
+    {
+        posted++;
+        node->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        if (!wakePending.exchange(true, std::memory_order_acq_rel))
+        {
+            if (wake())
+                wakeups++;
+            else
+                // Left to the next post, e.g. once the message queue has room
+                wakePending.store(false, std::memory_order_release);
+        }
+    }
+
+    TaskQueue::Clock::time_point TaskQueue::RunPending()
+    {
+        // Cleared first, so that a post racing with this call wakes again
+        wakePending.store(false, std::memory_order_release);
+        auto node = head.exchange(nullptr, std::memory_order_acquire);
+
+        // The list is newest first
+        Node* ordered = nullptr;
+        while (node)
+        {
+            auto next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+        }
+
+        while (ordered)
+        {
+            auto next = ordered->next;
+            if (ordered->due == Clock::time_point::min())
+            {
+                ordered->task();
+                run++;
+            }
+            else
+            {
+                delayed.push_back(Delayed{ordered->due, nextSequence++, std::move(ordered->task)});
+                std::push_heap(delayed.begin(), delayed.end(), LaterFirst());
+            }
+            delete ordered;
+            ordered = next;
+        }
+
+        auto now = Clock::now();
+        while (!delayed.empty() && delayed.front().due <= now)
+        {
+            std::pop_heap(delayed.begin(), delayed.end(), LaterFirst());
+            auto task = std::move(delayed.back().task);
+            delayed.pop_back();
+            task();
+            run++;
+        }
+        return delayed.empty() ? Clock::time_point::max() : delayed.front().due;
+    }
+
+    TaskQueueStats TaskQueue::GetStats() const
+    {
+        TaskQueueStats stats;
+        stats.posted = posted;
+        stats.run = run;
+        stats.wakeups = wakeups;
+        return stats;
+    }
+
+}  // namespace agora_rtc_engine
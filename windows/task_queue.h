@@ -0,0 +1,90 @@
+#ifndef AGORA_RTC_ENGINE_TASK_QUEUE_H_
+#define AGORA_RTC_ENGINE_TASK_QUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace agora_rtc_engine {
+
+    struct TaskQueueStats
+    {
+        uint64_t posted = 0;
+        uint64_t run = 0;
+        // Times the owner was woken, at most once per RunPending call.
+        uint64_t wakeups = 0;
+    };
+
+    // Tasks posted from any thread and run on the single thread that calls
+    // RunPending, immediately or after a delay.
+    //
+    // Posting pushes onto a lock-free list and only wakes the owner when the
+    // queue was idle, so a burst of posts costs a single wakeup. Delayed tasks
+    // are moved to a heap owned by the running thread.
+    class TaskQueue
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Task = std::function<void()>;
+        // Called on the posting thread, must make the owner call RunPending.
+        // Returns false if the owner could not be woken, so that the next
+        // post tries again.
+        using WakeFunction = std::function<bool()>;
+
+        explicit TaskQueue(WakeFunction wake);
+
+        // Drops the tasks not run yet.
+        ~TaskQueue();
+
+        // Prevent copying
+        TaskQueue(TaskQueue const&) = delete;
+        TaskQueue& operator=(TaskQueue const&) = delete;
+
+        void Post(Task task);
+
+        void PostDelayed(Task task, Clock::duration delay);
+
+        // Runs the posted tasks in order, then the delayed ones that are due.
+        // Tasks they post run on the next call. Returns when the next delayed
+        // task is due, or Clock::time_point::max() if there is none.
+        Clock::time_point RunPending();
+
+        TaskQueueStats GetStats() const;
+
+    private:
+        struct Node
+        {
+            Task task;
+            // Clock::time_point::min() for immediate tasks
+            Clock::time_point due;
+            Node* next = nullptr;
+        };
+
+        struct Delayed
+        {
+            Clock::time_point due;
+            // Keeps tasks due at the same time in posting order
+            uint64_t sequence;
+            Task task;
+        };
+
+        void Push(Node* node);
+
+        WakeFunction wake;
+        std::atomic<Node*> head{nullptr};
+        std::atomic<bool> wakePending{false};
+
+        // Owned by the running thread
+        std::vector<Delayed> delayed;
+        uint64_t nextSequence = 0;
+
+        std::atomic<uint64_t> posted{0};
+        std::atomic<uint64_t> run{0};
+        std::atomic<uint64_t> wakeups{0};
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_TASK_QUEUE_H_
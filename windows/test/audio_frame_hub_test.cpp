@@ -0,0 +1,153 @@
+#include "audio_frame_hub.h"
+
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::AudioFormat;
+using agora_rtc_engine::AudioFrameHub;
+using agora_rtc_engine::AudioFrameSource;
+using agora_rtc_engine::AudioFrameView;
+
+namespace {
+
+    using AudioFrame = agora::media::IAudioFrameObserver::AudioFrame;
+
+    // A 10 ms frame of a ramp in |format|.
+    struct Frame
+    {
+        explicit Frame(const AudioFormat& format)
+            : samples(static_cast<size_t>(format.sampleRate / 100) * format.channels)
+        {
+            for (size_t i = 0; i < samples.size(); ++i)
+                samples[i] = static_cast<int16_t>(i);
+            frame.type = agora::media::IAudioFrameObserver::FRAME_TYPE_PCM16;
+            frame.samples = format.sampleRate / 100;
+            frame.bytesPerSample = 2;
+            frame.channels = format.channels;
+            frame.samplesPerSec = format.sampleRate;
+            frame.buffer = samples.data();
+            frame.renderTimeMs = 1234;
+        }
+
+        std::vector<int16_t> samples;
+        AudioFrame frame{};
+    };
+
+    // What a consumer was delivered.
+    struct Received
+    {
+        AudioFrameHub::DeliverFunction Function()
+        {
+            return [this](const AudioFrameView& view) { views.push_back(view); };
+        }
+
+        std::vector<AudioFrameView> views;
+    };
+
+    void TestNegotiatesTheWidestFormat()
+    {
+        AudioFrameHub hub;
+        EXPECT(!hub.active());
+        EXPECT(hub.Negotiate(AudioFrameSource::Record).sampleRate == 0);
+
+        hub.AddConsumer(AudioFrameSource::Record, AudioFormat{16000, 1}, [](const AudioFrameView&) {});
+        hub.AddConsumer(AudioFrameSource::Record, AudioFormat{22050, 2}, [](const AudioFrameView&) {});
+        EXPECT(hub.active());
+        // Rounded up to a rate the SDK offers
+        EXPECT(hub.Negotiate(AudioFrameSource::Record) == (AudioFormat{32000, 2}));
+
+        // Mixed audio is always mono
+        auto mixed = hub.AddConsumer(AudioFrameSource::Mixed, AudioFormat{96000, 2}, [](const AudioFrameView&) {});
+        EXPECT(hub.Negotiate(AudioFrameSource::Mixed) == (AudioFormat{48000, 1}));
+        EXPECT(hub.RemoveConsumer(mixed));
+        EXPECT(!hub.RemoveConsumer(mixed));
+        EXPECT(hub.Negotiate(AudioFrameSource::Mixed).sampleRate == 0);
+    }
+
+    void TestMatchingConsumersGetTheSdkBuffer()
+    {
+        AudioFrameHub hub;
+        AudioFormat native{48000, 2};
+        AudioFormat narrow{16000, 1};
+        Received first, second, converted;
+        hub.AddConsumer(AudioFrameSource::Playback, native, first.Function());
+        hub.AddConsumer(AudioFrameSource::Playback, native, second.Function());
+        hub.AddConsumer(AudioFrameSource::Playback, narrow, converted.Function());
+        EXPECT(hub.Negotiate(AudioFrameSource::Playback) == native);
+
+        Frame frame(native);
+        for (int i = 0; i < 3; ++i)
+            EXPECT(hub.onPlaybackAudioFrame(frame.frame));
+
+        for (auto* received : {&first, &second})
+        {
+            EXPECT(received->views.size() == 3);
+            for (const auto& view : received->views)
+            {
+                EXPECT(view.samples == frame.samples.data());
+                EXPECT(view.frames == 480 && view.format == native);
+                EXPECT(view.renderTimeMs == 1234);
+            }
+        }
+        EXPECT(converted.views.size() == 3);
+        for (const auto& view : converted.views)
+        {
+            EXPECT(view.samples != frame.samples.data());
+            EXPECT(view.frames == 160 && view.format == narrow);
+        }
+
+        auto stats = hub.GetStats();
+        EXPECT(stats.frames == 3);
+        EXPECT(stats.passedThrough == 6);
+        EXPECT(stats.converted == 3);
+        EXPECT(stats.skipped == 0);
+    }
+
+    void TestSourcesAreKeptApart()
+    {
+        AudioFrameHub hub;
+        AudioFormat format{16000, 1};
+        Received record, playback;
+        hub.AddConsumer(AudioFrameSource::Record, format, record.Function());
+        auto id = hub.AddConsumer(AudioFrameSource::Playback, format, playback.Function());
+        Frame frame(format);
+        hub.onRecordAudioFrame(frame.frame);
+        EXPECT(record.views.size() == 1 && playback.views.empty());
+
+        // Removed consumers are no longer delivered to
+        hub.RemoveConsumer(id);
+        hub.onPlaybackAudioFrame(frame.frame);
+        EXPECT(playback.views.empty());
+        hub.Clear();
+        hub.onRecordAudioFrame(frame.frame);
+        EXPECT(record.views.size() == 1);
+        EXPECT(!hub.active());
+    }
+
+    void TestUnsupportedFramesAreIgnored()
+    {
+        AudioFrameHub hub;
+        AudioFormat format{16000, 1};
+        Received received;
+        hub.AddConsumer(AudioFrameSource::Record, format, received.Function());
+        Frame frame(format);
+        frame.frame.bytesPerSample = 4;
+        hub.onRecordAudioFrame(frame.frame);
+        frame.frame.bytesPerSample = 2;
+        frame.frame.buffer = nullptr;
+        hub.onRecordAudioFrame(frame.frame);
+        EXPECT(received.views.empty());
+        EXPECT(hub.GetStats().frames == 0);
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestNegotiatesTheWidestFormat);
+    RUN_TEST(TestMatchingConsumersGetTheSdkBuffer);
+    RUN_TEST(TestSourcesAreKeptApart);
+    RUN_TEST(TestUnsupportedFramesAreIgnored);
+    return TestResult();
+}
@@ -0,0 +1,160 @@
+#include "audio_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::AudioFormat;
+using agora_rtc_engine::AudioResampler;
+
+namespace {
+
+    const double kPi = 3.14159265358979323846;
+    const double kToneHz = 1000;
+    const double kAmplitude = 10000;
+
+    // One second of a 1 kHz tone, the same in every channel.
+    std::vector<int16_t> Tone(const AudioFormat& format)
+    {
+        std::vector<int16_t> samples;
+        for (int i = 0; i < format.sampleRate; ++i)
+        {
+            auto value = static_cast<int16_t>(std::lround(kAmplitude * std::sin(2 * kPi * kToneHz * i / format.sampleRate)));
+            for (int c = 0; c < format.channels; ++c)
+                samples.push_back(value);
+        }
+        return samples;
+    }
+
+    // Converts |input| 10 ms at a time, checking that every frame comes out
+    // at the output rate.
+    std::vector<int16_t> Convert(const AudioFormat& inputFormat, const AudioFormat& outputFormat, const std::vector<int16_t>& input)
+    {
+        AudioResampler resampler;
+        resampler.Configure(inputFormat, outputFormat);
+        auto inputFrames = inputFormat.sampleRate / 100;
+        auto frameSamples = static_cast<size_t>(inputFrames) * inputFormat.channels;
+        std::vector<int16_t> output;
+        for (size_t offset = 0; offset + frameSamples <= input.size(); offset += frameSamples)
+            EXPECT(resampler.Process(input.data() + offset, inputFrames, output) == outputFormat.sampleRate / 100);
+        EXPECT(output.size() == static_cast<size_t>(outputFormat.sampleRate) * outputFormat.channels);
+        return output;
+    }
+
+    // Checks that the second half of |output|, past the filter's delay, is
+    // the tone at its amplitude in every channel.
+    void CheckTone(const AudioFormat& format, const std::vector<int16_t>& output)
+    {
+        auto frames = static_cast<int>(output.size()) / format.channels;
+        for (int c = 0; c < format.channels; ++c)
+        {
+            double peak = 0;
+            double energy = 0;
+            auto crossings = 0;
+            for (int i = frames / 2; i < frames; ++i)
+            {
+                double value = output[i * format.channels + c];
+                peak = std::max(peak, std::abs(value));
+                energy += value * value;
+                if (i > frames / 2 && (value >= 0) != (output[(i - 1) * format.channels + c] >= 0))
+                    crossings++;
+            }
+            auto rms = std::sqrt(energy / (frames - frames / 2));
+            // At 16 kHz the crest may fall between two samples
+            EXPECT(peak > kAmplitude * 0.9 && peak < kAmplitude * 1.02);
+            EXPECT(std::abs(rms - kAmplitude / std::sqrt(2.0)) < kAmplitude * 0.02);
+            // Two per period over half a second
+            EXPECT(std::abs(crossings - static_cast<int>(kToneHz)) <= 2);
+        }
+    }
+
+    void CheckRates(int inputRate, int outputRate)
+    {
+        std::fprintf(stderr, "  %d to %d\n", inputRate, outputRate);
+        AudioFormat input{inputRate, 1};
+        AudioFormat output{outputRate, 1};
+        CheckTone(output, Convert(input, output, Tone(input)));
+    }
+
+    void TestDownsampling()
+    {
+        CheckRates(48000, 16000);
+        CheckRates(44100, 16000);
+    }
+
+    void TestUpsampling()
+    {
+        CheckRates(16000, 48000);
+        CheckRates(8000, 48000);
+    }
+
+    void TestStereoToMono()
+    {
+        // Mixed down at the same rate
+        AudioResampler resampler;
+        resampler.Configure(AudioFormat{48000, 2}, AudioFormat{48000, 1});
+        const int16_t stereo[] = {1000, 3000, -1000, -3000, 32767, 32767};
+        std::vector<int16_t> mono;
+        EXPECT(resampler.Process(stereo, 3, mono) == 3);
+        EXPECT(mono == std::vector<int16_t>({2000, -2000, 32767}));
+
+        // And while converting
+        AudioFormat input{48000, 2};
+        AudioFormat output{16000, 1};
+        CheckTone(output, Convert(input, output, Tone(input)));
+    }
+
+    void TestMonoToStereo()
+    {
+        AudioResampler resampler;
+        resampler.Configure(AudioFormat{16000, 1}, AudioFormat{16000, 2});
+        const int16_t mono[] = {5, -7};
+        std::vector<int16_t> stereo;
+        EXPECT(resampler.Process(mono, 2, stereo) == 2);
+        EXPECT(stereo == std::vector<int16_t>({5, 5, -7, -7}));
+
+        AudioFormat input{16000, 1};
+        AudioFormat output{48000, 2};
+        CheckTone(output, Convert(input, output, Tone(input)));
+    }
+
+    void TestHistoryCarriesOverFrames()
+    {
+        // The same output 10 ms at a time as in one go, for a ratio whose
+        // phase does not restart at frame boundaries
+        AudioFormat input{44100, 1};
+        AudioFormat output{16000, 1};
+        auto tone = Tone(input);
+        auto framed = Convert(input, output, tone);
+
+        AudioResampler resampler;
+        resampler.Configure(input, output);
+        std::vector<int16_t> whole;
+        EXPECT(resampler.Process(tone.data(), input.sampleRate, whole) == output.sampleRate);
+        EXPECT(framed == whole);
+
+        // Configuring the same formats again keeps the stream going
+        std::vector<int16_t> next;
+        resampler.Configure(input, output);
+        resampler.Process(tone.data(), input.sampleRate / 100, next);
+        AudioResampler fresh;
+        fresh.Configure(input, output);
+        std::vector<int16_t> restarted;
+        fresh.Process(tone.data(), input.sampleRate / 100, restarted);
+        EXPECT(next.size() == restarted.size() && next != restarted);
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestDownsampling);
+    RUN_TEST(TestUpsampling);
+    RUN_TEST(TestStereoToMono);
+    RUN_TEST(TestMonoToStereo);
+    RUN_TEST(TestHistoryCarriesOverFrames);
+    return TestResult();
+}
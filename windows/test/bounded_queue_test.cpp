@@ -0,0 +1,200 @@
+#include "bounded_queue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::BoundedQueue;
+using agora_rtc_engine::MpscQueue;
+using agora_rtc_engine::QueueOverflow;
+using agora_rtc_engine::SpscQueue;
+
+// Stress tests, meant to be run under ThreadSanitizer as well, see
+// CMakeLists.txt.
+
+namespace {
+
+    const uint64_t kItemsPerProducer = 200000;
+    const size_t kBatch = 16;
+
+    uint64_t Item(uint64_t producer, uint64_t index)
+    {
+        return (producer << 32) | index;
+    }
+
+    // Pushes |kItemsPerProducer| items tagged with |producer| in order,
+    // retrying those rejected.
+    template <bool MultiProducer>
+    void Produce(BoundedQueue<uint64_t, MultiProducer>& queue, uint64_t producer, bool batched)
+    {
+        uint64_t index = 0;
+        std::vector<uint64_t> batch;
+        while (index < kItemsPerProducer)
+        {
+            if (!batched)
+            {
+                if (queue.Push(Item(producer, index)))
+                    index++;
+                else
+                    std::this_thread::yield();
+                continue;
+            }
+            batch.clear();
+            for (uint64_t i = index; i < kItemsPerProducer && batch.size() < kBatch; ++i)
+                batch.push_back(Item(producer, i));
+            auto pushed = queue.PushBatch(batch.data(), batch.size());
+            index += pushed;
+            if (pushed == 0)
+                std::this_thread::yield();
+        }
+    }
+
+    // Runs |producers| producers against one consumer and checks that each
+    // producer's items come out in order, every one of them unless
+    // overwritten, and that the counters add up.
+    template <bool MultiProducer>
+    void Stress(int producers, QueueOverflow overflow, bool batched)
+    {
+        BoundedQueue<uint64_t, MultiProducer> queue(256, overflow);
+        std::atomic<int> running{producers};
+        std::vector<uint64_t> next(producers, 0);
+        uint64_t consumed = 0;
+        auto ordered = true;
+
+        auto check = [&](uint64_t item) {
+            auto producer = item >> 32;
+            auto index = item & 0xffffffff;
+            if (producer >= next.size() || index < next[producer]
+                || (overflow == QueueOverflow::Reject && index != next[producer]))
+                ordered = false;
+            else
+                next[producer] = index + 1;
+            consumed++;
+        };
+
+        std::thread consumer([&]() {
+            uint64_t items[kBatch];
+            while (true)
+            {
+                auto done = running.load() == 0;
+                auto count = batched ? queue.PopBatch(items, kBatch) : (queue.Pop(items[0]) ? 1 : 0);
+                for (size_t i = 0; i < count; ++i)
+                    check(items[i]);
+                if (count == 0)
+                {
+                    if (done)
+                        break;
+                    std::this_thread::yield();
+                }
+            }
+        });
+        std::vector<std::thread> threads;
+        for (int producer = 0; producer < producers; ++producer)
+        {
+            threads.emplace_back([&queue, &running, producer, batched]() {
+                Produce(queue, producer, batched);
+                running--;
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        consumer.join();
+
+        auto stats = queue.GetStats();
+        auto total = kItemsPerProducer * producers;
+        EXPECT(ordered);
+        EXPECT(queue.size() == 0);
+        EXPECT(stats.popped == consumed);
+        EXPECT(stats.pushed == total);
+        EXPECT(stats.pushed == stats.popped + stats.overwritten);
+        if (overflow == QueueOverflow::Reject)
+        {
+            EXPECT(stats.overwritten == 0);
+            EXPECT(consumed == total);
+        }
+        else
+            EXPECT(stats.rejected == 0);
+    }
+
+    void TestRoundsCapacityUp()
+    {
+        SpscQueue<int> queue(5, QueueOverflow::Reject);
+        EXPECT(queue.capacity() == 8);
+        for (int i = 0; i < 8; ++i)
+            EXPECT(queue.Push(i));
+        EXPECT(!queue.Push(8));
+        EXPECT(queue.size() == 8);
+        int item = -1;
+        EXPECT(queue.Pop(item) && item == 0);
+        EXPECT(queue.GetStats().rejected == 1);
+    }
+
+    void TestOverwritesOldest()
+    {
+        SpscQueue<int> queue(4, QueueOverflow::OverwriteOldest);
+        int items[] = {0, 1, 2, 3, 4, 5};
+        EXPECT(queue.PushBatch(items, 6) == 6);
+        int popped[4] = {};
+        EXPECT(queue.PopBatch(popped, 4) == 4);
+        EXPECT(popped[0] == 2 && popped[3] == 5);
+        EXPECT(queue.GetStats().overwritten == 2);
+    }
+
+    void TestSpscReject()
+    {
+        Stress<false>(1, QueueOverflow::Reject, false);
+    }
+
+    void TestSpscRejectBatched()
+    {
+        Stress<false>(1, QueueOverflow::Reject, true);
+    }
+
+    void TestSpscOverwrite()
+    {
+        Stress<false>(1, QueueOverflow::OverwriteOldest, false);
+    }
+
+    void TestSpscOverwriteBatched()
+    {
+        Stress<false>(1, QueueOverflow::OverwriteOldest, true);
+    }
+
+    void TestMpscReject()
+    {
+        Stress<true>(4, QueueOverflow::Reject, false);
+    }
+
+    void TestMpscRejectBatched()
+    {
+        Stress<true>(4, QueueOverflow::Reject, true);
+    }
+
+    void TestMpscOverwrite()
+    {
+        Stress<true>(4, QueueOverflow::OverwriteOldest, false);
+    }
+
+    void TestMpscOverwriteBatched()
+    {
+        Stress<true>(4, QueueOverflow::OverwriteOldest, true);
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestRoundsCapacityUp);
+    RUN_TEST(TestOverwritesOldest);
+    RUN_TEST(TestSpscReject);
+    RUN_TEST(TestSpscRejectBatched);
+    RUN_TEST(TestSpscOverwrite);
+    RUN_TEST(TestSpscOverwriteBatched);
+    RUN_TEST(TestMpscReject);
+    RUN_TEST(TestMpscRejectBatched);
+    RUN_TEST(TestMpscOverwrite);
+    RUN_TEST(TestMpscOverwriteBatched);
+    return TestResult();
+}
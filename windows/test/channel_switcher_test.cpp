@@ -0,0 +1,249 @@
+#include "channel_switcher.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::ChannelSwitcher;
+using agora_rtc_engine::ChannelSwitchMode;
+using agora_rtc_engine::ChannelSwitchResult;
+
+namespace {
+
+    using Clock = ChannelSwitcher::Clock;
+
+    // CHANNEL_PROFILE_TYPE and CLIENT_ROLE_TYPE values
+    const int kProfileLiveBroadcasting = 1;
+    const int kRoleBroadcaster = 1;
+    const int kRoleAudience = 2;
+
+    // Records the SDK calls a switcher makes, and what it reported.
+    struct Engine
+    {
+        Engine()
+            : switcher(
+                [this](const std::string& token, const std::string& channelId) {
+                    calls.push_back("switch " + channelId + " " + token);
+                    return switchError;
+                },
+                [this]() {
+                    calls.push_back("leave");
+                    return leaveError;
+                },
+                [this](uint64_t id, const std::string& token, const std::string& channelId) {
+                    joinId = id;
+                    calls.push_back("join " + channelId + " " + token);
+                })
+        {
+        }
+
+        ChannelSwitcher::DoneFunction Done()
+        {
+            return [this](const ChannelSwitchResult& result) { results.push_back(result); };
+        }
+
+        // Joins |channelId| from no channel, as the first join would.
+        void JoinFirst(const std::string& channelId)
+        {
+            auto id = switcher.Start(channelId, "token", Clock::now(), Done());
+            switcher.OnJoinChannelSuccess(channelId, Clock::now());
+            switcher.OnTimeout(id);
+            calls.clear();
+            results.clear();
+        }
+
+        int switchError = 0;
+        int leaveError = 0;
+        uint64_t joinId = 0;
+        std::vector<std::string> calls;
+        std::vector<ChannelSwitchResult> results;
+        ChannelSwitcher switcher;
+    };
+
+    Clock::time_point After(Clock::time_point start, int ms)
+    {
+        return start + std::chrono::milliseconds(ms);
+    }
+
+    void TestFirstJoin()
+    {
+        Engine engine;
+        auto requested = Clock::now();
+        auto id = engine.switcher.Start("a", "t1", requested, engine.Done());
+        EXPECT(id != 0);
+        // Nothing to leave
+        EXPECT(engine.calls == std::vector<std::string>({"join a t1"}));
+        EXPECT(engine.joinId == id);
+
+        // Another channel's join does not complete it
+        engine.switcher.OnJoinChannelSuccess("b", After(requested, 50));
+        engine.switcher.OnFirstRemoteFrame(After(requested, 60));
+        EXPECT(engine.results.empty());
+
+        engine.switcher.OnJoinChannelSuccess("a", After(requested, 100));
+        EXPECT(engine.results.empty());
+        engine.switcher.OnFirstRemoteFrame(After(requested, 250));
+        EXPECT(engine.results.size() == 1);
+        auto result = engine.results[0];
+        EXPECT(result.id == id && result.ok && result.error == 0);
+        EXPECT(result.fromChannel.empty() && result.toChannel == "a");
+        EXPECT(result.mode == ChannelSwitchMode::Rejoin);
+        EXPECT(result.leftMs == -1 && result.joinedMs == 100 && result.firstFrameMs == 250);
+
+        // Later frames and timeouts find nothing in progress
+        engine.switcher.OnFirstRemoteFrame(After(requested, 300));
+        EXPECT(!engine.switcher.OnTimeout(id));
+        EXPECT(engine.results.size() == 1);
+    }
+
+    void TestAudienceSwitches()
+    {
+        Engine engine;
+        engine.switcher.SetChannelProfile(kProfileLiveBroadcasting);
+        engine.switcher.SetClientRole(kRoleAudience);
+        engine.JoinFirst("a");
+
+        auto requested = Clock::now();
+        auto id = engine.switcher.Start("b", "t2", requested, engine.Done());
+        EXPECT(engine.calls == std::vector<std::string>({"switch b t2"}));
+        // The SDK leaves the old channel on its own, without a join
+        engine.switcher.OnLeaveChannel(After(requested, 30));
+        EXPECT(engine.calls.size() == 1);
+        engine.switcher.OnJoinChannelSuccess("b", After(requested, 80));
+        engine.switcher.OnFirstRemoteFrame(After(requested, 120));
+
+        EXPECT(engine.results.size() == 1);
+        auto result = engine.results[0];
+        EXPECT(result.id == id && result.ok);
+        EXPECT(result.mode == ChannelSwitchMode::Switch);
+        EXPECT(result.fromChannel == "a" && result.toChannel == "b");
+        EXPECT(result.leftMs == 30 && result.joinedMs == 80 && result.firstFrameMs == 120);
+
+        auto stats = engine.switcher.GetStats();
+        EXPECT(stats.switches == 2);
+        EXPECT(stats.switched == 1);
+        EXPECT(stats.meanFirstFrameMs == 120 && stats.maxFirstFrameMs == 120);
+    }
+
+    void TestRefusedSwitchRejoins()
+    {
+        Engine engine;
+        engine.switcher.SetChannelProfile(kProfileLiveBroadcasting);
+        engine.switcher.SetClientRole(kRoleAudience);
+        engine.JoinFirst("a");
+
+        engine.switchError = -5;
+        auto requested = Clock::now();
+        engine.switcher.Start("b", "t2", requested, engine.Done());
+        EXPECT(engine.calls == std::vector<std::string>({"switch b t2", "leave"}));
+        engine.switcher.OnLeaveChannel(After(requested, 40));
+        EXPECT(engine.calls.size() == 3 && engine.calls[2] == "join b t2");
+        engine.switcher.OnJoinChannelSuccess("b", After(requested, 90));
+        engine.switcher.OnFirstRemoteFrame(After(requested, 100));
+        EXPECT(engine.results.size() == 1 && engine.results[0].ok);
+        EXPECT(engine.results[0].mode == ChannelSwitchMode::Rejoin);
+        EXPECT(engine.results[0].leftMs == 40);
+    }
+
+    void TestBroadcastersRejoin()
+    {
+        Engine engine;
+        engine.switcher.SetChannelProfile(kProfileLiveBroadcasting);
+        engine.switcher.SetClientRole(kRoleBroadcaster);
+        engine.JoinFirst("a");
+
+        auto requested = Clock::now();
+        auto id = engine.switcher.Start("b", "t2", requested, engine.Done());
+        EXPECT(engine.calls == std::vector<std::string>({"leave"}));
+        // One switch at a time
+        EXPECT(engine.switcher.Start("c", "t3", requested, engine.Done()) == 0);
+
+        // Joined only once the SDK has left
+        engine.switcher.OnLeaveChannel(After(requested, 20));
+        EXPECT(engine.calls.size() == 2 && engine.calls[1] == "join b t2");
+        EXPECT(engine.joinId == id);
+        engine.switcher.OnJoinChannelSuccess("b", After(requested, 70));
+        engine.switcher.OnFirstRemoteFrame(After(requested, 90));
+        EXPECT(engine.results.size() == 1 && engine.results[0].ok);
+        EXPECT(engine.results[0].mode == ChannelSwitchMode::Rejoin);
+        EXPECT(engine.switcher.GetStats().rejoined == 2);
+    }
+
+    void TestTimeouts()
+    {
+        // Joined without frames, an empty channel: done
+        Engine engine;
+        auto requested = Clock::now();
+        auto id = engine.switcher.Start("a", "t1", requested, engine.Done());
+        engine.switcher.OnJoinChannelSuccess("a", After(requested, 60));
+        EXPECT(engine.switcher.OnTimeout(id));
+        EXPECT(engine.results.size() == 1 && engine.results[0].ok);
+        EXPECT(engine.results[0].joinedMs == 60 && engine.results[0].firstFrameMs == -1);
+        EXPECT(engine.switcher.GetStats().withoutFrames == 1);
+
+        // Not joined: failed, with no SDK error
+        id = engine.switcher.Start("b", "t2", requested, engine.Done());
+        EXPECT(engine.switcher.OnTimeout(id));
+        EXPECT(engine.results.size() == 2 && !engine.results[1].ok && engine.results[1].error == 0);
+        EXPECT(engine.results[1].leftMs == -1 && engine.results[1].joinedMs == -1);
+
+        // The join arriving late does not resurrect it
+        engine.switcher.OnLeaveChannel(After(requested, 100));
+        engine.switcher.OnJoinChannelSuccess("b", After(requested, 200));
+        engine.switcher.OnFirstRemoteFrame(After(requested, 300));
+        EXPECT(engine.results.size() == 2);
+
+        auto stats = engine.switcher.GetStats();
+        EXPECT(stats.switches == 2 && stats.rejoined == 1 && stats.failures == 1);
+        EXPECT(stats.meanJoinedMs == 60 && stats.meanFirstFrameMs == 0);
+    }
+
+    void TestFailures()
+    {
+        Engine engine;
+        engine.JoinFirst("a");
+
+        // leaveChannel failing
+        engine.leaveError = -7;
+        engine.switcher.Start("b", "t2", Clock::now(), engine.Done());
+        EXPECT(engine.results.size() == 1 && !engine.results[0].ok && engine.results[0].error == -7);
+
+        // joinChannel failing, reported by the plugin
+        engine.leaveError = 0;
+        auto id = engine.switcher.Start("b", "t2", Clock::now(), engine.Done());
+        engine.switcher.OnLeaveChannel(Clock::now());
+        engine.switcher.OnFailed(id + 1, -2);
+        EXPECT(engine.results.size() == 1);
+        engine.switcher.OnFailed(id, -2);
+        EXPECT(engine.results.size() == 2 && !engine.results[1].ok && engine.results[1].error == -2);
+        EXPECT(engine.switcher.GetStats().failures == 2);
+    }
+
+    void TestResetFailsTheSwitchInProgress()
+    {
+        Engine engine;
+        engine.JoinFirst("a");
+        engine.switcher.Start("b", "t2", Clock::now(), engine.Done());
+        engine.switcher.Reset();
+        EXPECT(engine.results.size() == 1 && !engine.results[0].ok);
+
+        // Released engines are in no channel, so the next switch joins
+        engine.calls.clear();
+        engine.switcher.Start("c", "t3", Clock::now(), engine.Done());
+        EXPECT(engine.calls == std::vector<std::string>({"join c t3"}));
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestFirstJoin);
+    RUN_TEST(TestAudienceSwitches);
+    RUN_TEST(TestRefusedSwitchRejoins);
+    RUN_TEST(TestBroadcastersRejoin);
+    RUN_TEST(TestTimeouts);
+    RUN_TEST(TestFailures);
+    RUN_TEST(TestResetFailsTheSwitchInProgress);
+    return TestResult();
+}
@@ -0,0 +1,189 @@
+#include "data_stream_transport.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::DataStreamTransport;
+using agora_rtc_engine::DataTransportOptions;
+
+namespace {
+
+    // Carries the packets of one transport to another, failing the first
+    // |failures| sends.
+    class Link
+    {
+    public:
+        explicit Link(int failures)
+            : failures(failures),
+            receiver(Options(), [](const uint8_t*, size_t) { return true; },
+                [this](unsigned int, std::vector<uint8_t> message) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    messages.push_back(std::move(message));
+                    condition.notify_all();
+                })
+        {
+        }
+
+        static DataTransportOptions Options(bool compress = false)
+        {
+            DataTransportOptions options;
+            options.compress = compress;
+            options.packetsPerSecond = 1000;
+            options.bytesPerSecond = 1024 * 1024;
+            return options;
+        }
+
+        DataStreamTransport::SendFunction Sender()
+        {
+            return [this](const uint8_t* data, size_t size) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (failures > 0)
+                    {
+                        failures--;
+                        return false;
+                    }
+                    packets++;
+                    bytes += size;
+                }
+                receiver.OnStreamMessage(1, data, size);
+                return true;
+            };
+        }
+
+        std::vector<std::vector<uint8_t>> Wait(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait_for(lock, std::chrono::seconds(5), [this, count]() { return messages.size() >= count; });
+            return messages;
+        }
+
+        // The packets carried and their bytes, counted before they are
+        // delivered, unlike the sender's stats.
+        size_t Packets()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return packets;
+        }
+
+        size_t Bytes()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return bytes;
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable condition;
+        int failures;
+        size_t packets = 0;
+        size_t bytes = 0;
+        std::vector<std::vector<uint8_t>> messages;
+        DataStreamTransport receiver;
+    };
+
+    std::vector<uint8_t> Message(size_t size, uint8_t seed)
+    {
+        std::vector<uint8_t> message(size);
+        for (size_t i = 0; i < size; i++)
+            message[i] = static_cast<uint8_t>(seed + i * 7);
+        return message;
+    }
+
+    // Bytes the compressor can't shrink.
+    std::vector<uint8_t> Noise(size_t size, uint32_t seed)
+    {
+        std::vector<uint8_t> message(size);
+        for (auto& byte : message)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            byte = static_cast<uint8_t>(seed >> 24);
+        }
+        return message;
+    }
+
+    void TestDeliversFragmentedMessage()
+    {
+        Link link(0);
+        DataStreamTransport sender(Link::Options(), link.Sender(), [](unsigned int, std::vector<uint8_t>) {});
+        auto message = Message(5000, 1);
+        EXPECT(sender.Send(message));
+        auto received = link.Wait(1);
+        EXPECT(received.size() == 1);
+        EXPECT(!received.empty() && received[0] == message);
+        EXPECT(sender.GetStats().sentPackets > 1);
+    }
+
+    void TestFailedPacketsAreSentAgainInOrder()
+    {
+        Link link(3);
+        DataStreamTransport sender(Link::Options(), link.Sender(), [](unsigned int, std::vector<uint8_t>) {});
+        auto large = Message(5000, 1);
+        auto small = Message(10, 2);
+        EXPECT(sender.Send(large));
+        EXPECT(sender.Send(small));
+        auto received = link.Wait(2);
+        EXPECT(received.size() == 2);
+        EXPECT(received.size() == 2 && received[0] == large && received[1] == small);
+        auto stats = sender.GetStats();
+        EXPECT(stats.failedPackets == 3);
+        EXPECT(stats.sentMessages == 2);
+    }
+
+    void TestCompressesCompressibleMessages()
+    {
+        Link link(0);
+        DataStreamTransport sender(Link::Options(true), link.Sender(), [](unsigned int, std::vector<uint8_t>) {});
+        auto message = Message(1000, 3);
+        EXPECT(sender.Send(message));
+        auto received = link.Wait(1);
+        EXPECT(received.size() == 1 && received[0] == message);
+        EXPECT(link.Bytes() < message.size() / 2);
+    }
+
+    void TestSendsIncompressibleMessagesAsTheyAre()
+    {
+        Link link(0);
+        DataStreamTransport sender(Link::Options(true), link.Sender(), [](unsigned int, std::vector<uint8_t>) {});
+        auto message = Noise(1000, 4);
+        EXPECT(sender.Send(message));
+        auto received = link.Wait(1);
+        EXPECT(received.size() == 1 && received[0] == message);
+        // Not prefixed with the original size
+        EXPECT(link.Bytes() >= message.size() && link.Bytes() < message.size() + 16);
+    }
+
+    void TestDeliversFragmentedCompressedMessage()
+    {
+        // Noise with repeated stretches, still several packets once
+        // compressed, followed by a small message batched after it
+        Link link(0);
+        DataStreamTransport sender(Link::Options(true), link.Sender(), [](unsigned int, std::vector<uint8_t>) {});
+        auto noise = Noise(1500, 5);
+        std::vector<uint8_t> large;
+        for (int i = 0; i < 4; ++i)
+            large.insert(large.end(), noise.begin(), noise.end());
+        auto small = Message(100, 6);
+        EXPECT(sender.Send(large));
+        EXPECT(sender.Send(small));
+        auto received = link.Wait(2);
+        EXPECT(received.size() == 2 && received[0] == large && received[1] == small);
+        EXPECT(link.Packets() > 1);
+        EXPECT(link.Bytes() < large.size() / 2);
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestDeliversFragmentedMessage);
+    RUN_TEST(TestFailedPacketsAreSentAgainInOrder);
+    RUN_TEST(TestCompressesCompressibleMessages);
+    RUN_TEST(TestSendsIncompressibleMessagesAsTheyAre);
+    RUN_TEST(TestDeliversFragmentedCompressedMessage);
+    return TestResult();
+}
@@ -0,0 +1,119 @@
+#include "encoder_tuner.h"
+
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::EncoderLevel;
+using agora_rtc_engine::EncoderTuner;
+using agora_rtc_engine::EncoderTunerOptions;
+using agora_rtc_engine::TuningDecision;
+using agora_rtc_engine::TuningReason;
+
+namespace {
+
+    // Stats as the SDK reports them every two seconds, held from the end of
+    // the previous phase until |untilMs|.
+    struct Phase
+    {
+        int untilMs;
+        double cpuAppUsage;
+        double cpuTotalUsage;
+        int encoderOutputFrameRate;
+        int txQuality;
+    };
+
+    const int kStatsIntervalMs = 2000;
+
+    // Replays |phases| against a tuner started with the default options and
+    // returns its decisions, the start included.
+    std::vector<TuningDecision> Replay(const std::vector<Phase>& phases)
+    {
+        std::vector<EncoderLevel> applied;
+        EncoderTuner tuner([&applied](const EncoderLevel& level) { applied.push_back(level); },
+            [](const TuningDecision&) {});
+        auto start = EncoderTuner::Clock::time_point();
+        EXPECT(tuner.Start(EncoderTunerOptions(), start));
+
+        auto timeMs = 0;
+        for (const auto& phase : phases)
+        {
+            for (timeMs += kStatsIntervalMs; timeMs <= phase.untilMs; timeMs += kStatsIntervalMs)
+            {
+                tuner.OnNetworkQuality(phase.txQuality);
+                tuner.OnLocalVideoStats(phase.encoderOutputFrameRate);
+                tuner.OnRtcStats(phase.cpuAppUsage, phase.cpuTotalUsage, start + std::chrono::milliseconds(timeMs));
+            }
+            timeMs -= kStatsIntervalMs;
+        }
+        auto decisions = tuner.GetDecisions();
+        EXPECT(applied.size() == decisions.size());
+        return decisions;
+    }
+
+    bool IsStep(const TuningDecision& decision, int64_t timeMs, int fromLevel, int toLevel, TuningReason reason)
+    {
+        return decision.timeMs == timeMs && decision.fromLevel == fromLevel && decision.toLevel == toLevel &&
+            decision.reason == reason;
+    }
+
+    void TestMutedVideoDoesNotStepDown()
+    {
+        // The encoder outputs nothing while the local video is muted
+        auto decisions = Replay({
+            {10000, 10, 30, 30, 1},
+            {60000, 10, 30, 0, 1},
+        });
+        EXPECT(decisions.size() == 1);
+        EXPECT(!decisions.empty() && IsStep(decisions[0], 0, 0, 5, TuningReason::Start));
+    }
+
+    void TestLaggingEncoderStepsDown()
+    {
+        // 12 fps out of 30 at the top level, enough for the 15 fps below it
+        auto decisions = Replay({
+            {20000, 10, 30, 12, 1},
+        });
+        EXPECT(decisions.size() == 2);
+        EXPECT(decisions.size() == 2 && IsStep(decisions[1], 6000, 5, 4, TuningReason::EncoderLagging));
+    }
+
+    void TestCpuHighStepsDownThenRecovers()
+    {
+        auto decisions = Replay({
+            {20000, 30, 90, 30, 1},
+            {80000, 10, 40, 30, 1},
+        });
+        EXPECT(decisions.size() == 7);
+        if (decisions.size() != 7)
+            return;
+        // One step per minimum interval while the CPU is busy
+        EXPECT(IsStep(decisions[1], 6000, 5, 4, TuningReason::CpuHigh));
+        EXPECT(IsStep(decisions[2], 12000, 4, 3, TuningReason::CpuHigh));
+        EXPECT(IsStep(decisions[3], 18000, 3, 2, TuningReason::CpuHigh));
+        // Held for 20 s after the last step down, then one step per five
+        // clear reports
+        EXPECT(IsStep(decisions[4], 38000, 2, 3, TuningReason::Recovered));
+        EXPECT(IsStep(decisions[5], 48000, 3, 4, TuningReason::Recovered));
+        EXPECT(IsStep(decisions[6], 58000, 4, 5, TuningReason::Recovered));
+    }
+
+    void TestPoorNetworkStepsDown()
+    {
+        auto decisions = Replay({
+            {10000, 10, 30, 30, 4},
+        });
+        EXPECT(decisions.size() == 2);
+        EXPECT(decisions.size() == 2 && IsStep(decisions[1], 6000, 5, 4, TuningReason::NetworkPoor));
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestMutedVideoDoesNotStepDown);
+    RUN_TEST(TestLaggingEncoderStepsDown);
+    RUN_TEST(TestCpuHighStepsDownThenRecovers);
+    RUN_TEST(TestPoorNetworkStepsDown);
+    return TestResult();
+}
@@ -0,0 +1,149 @@
+#include "event_trace.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using agora::rtc::AudioVolumeInfo;
+using agora::rtc::IRtcEngineEventHandler;
+using agora::rtc::RemoteAudioStats;
+using agora::rtc::RemoteVideoStats;
+using agora::rtc::RtcStats;
+using agora::rtc::uid_t;
+using agora_rtc_engine::EventRecorder;
+using agora_rtc_engine::EventReplayer;
+using agora_rtc_engine::EventReplayStats;
+
+// Replays an event trace into a handler that only counts the callbacks, and
+// reports the throughput of the decoding and dispatch:
+//
+//   event_replay_benchmark [trace [speed]]
+//
+// Without a trace, one is recorded first from a synthetic ten minute call of
+// 17 users, with the stats and volume callbacks the SDK makes in one.
+
+namespace {
+
+    const unsigned int kUsers = 17;
+    const int kSeconds = 600;
+
+    class CountingHandler : public IRtcEngineEventHandler
+    {
+    public:
+        void onUserJoined(uid_t, int) override { calls++; }
+        void onUserOffline(uid_t, agora::rtc::USER_OFFLINE_REASON_TYPE) override { calls++; }
+        void onRtcStats(const RtcStats&) override { calls++; }
+        void onNetworkQuality(uid_t, int, int) override { calls++; }
+        void onRemoteAudioStats(const RemoteAudioStats&) override { calls++; }
+        void onRemoteVideoStats(const RemoteVideoStats&) override { calls++; }
+        void onAudioVolumeIndication(const AudioVolumeInfo*, unsigned int, int) override { calls++; }
+
+        // Only touched by the replay thread, read once it is done.
+        uint64_t calls = 0;
+    };
+
+    void RecordSyntheticCall(const std::string& path)
+    {
+        IRtcEngineEventHandler sink;
+        EventRecorder recorder(&sink);
+        EXPECT(recorder.Start(path));
+        for (uid_t uid = 1; uid <= kUsers; uid++)
+            recorder.onUserJoined(uid, 0);
+        AudioVolumeInfo speakers[3] = {};
+        for (int tick = 0; tick < kSeconds * 10; tick++)
+        {
+            // Volume indications every 200 ms, stats every 2 s
+            if (tick % 2 == 0)
+            {
+                for (unsigned int i = 0; i < 3; i++)
+                {
+                    speakers[i].uid = (static_cast<unsigned int>(tick) + i) % kUsers + 1;
+                    speakers[i].volume = 100 + i;
+                    speakers[i].vad = 1;
+                }
+                recorder.onAudioVolumeIndication(speakers, 3, 120);
+            }
+            if (tick % 20 != 0)
+                continue;
+            RtcStats rtcStats;
+            rtcStats.duration = static_cast<unsigned int>(tick / 10);
+            rtcStats.userCount = kUsers;
+            recorder.onRtcStats(rtcStats);
+            for (uid_t uid = 0; uid <= kUsers; uid++)
+                recorder.onNetworkQuality(uid, 1, 1);
+            for (uid_t uid = 1; uid <= kUsers; uid++)
+            {
+                RemoteAudioStats audioStats;
+                audioStats.uid = uid;
+                recorder.onRemoteAudioStats(audioStats);
+                RemoteVideoStats videoStats;
+                videoStats.uid = uid;
+                recorder.onRemoteVideoStats(videoStats);
+            }
+        }
+        for (uid_t uid = 1; uid <= kUsers; uid++)
+            recorder.onUserOffline(uid, agora::rtc::USER_OFFLINE_QUIT);
+        auto recorded = recorder.Stop();
+        std::printf("recorded %llu events, %llu bytes\n", static_cast<unsigned long long>(recorded.events),
+            static_cast<unsigned long long>(recorded.bytes));
+    }
+
+    bool Replay(const std::string& path, double speed, CountingHandler& handler, EventReplayStats& stats)
+    {
+        EventReplayer replayer(&handler);
+        std::mutex mutex;
+        std::condition_variable condition;
+        auto done = false;
+        auto ok = false;
+        auto started = replayer.Start(path, speed, [&](bool success, const EventReplayStats& replayed) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ok = success;
+            stats = replayed;
+            done = true;
+            condition.notify_all();
+        });
+        if (!started)
+            return false;
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&done] { return done; });
+        return ok;
+    }
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string path;
+    auto synthetic = argc < 2;
+    if (synthetic)
+    {
+        path = (std::filesystem::temp_directory_path() / "event_replay_benchmark.trace").string();
+        RecordSyntheticCall(path);
+    }
+    else
+        path = argv[1];
+    auto speed = argc > 2 ? std::atof(argv[2]) : 0.0;
+
+    CountingHandler handler;
+    EventReplayStats stats;
+    auto ok = Replay(path, speed, handler, stats);
+    EXPECT(ok);
+    EXPECT(stats.skipped == 0);
+    if (synthetic)
+    {
+        EXPECT(handler.calls == stats.events);
+        std::filesystem::remove(path);
+    }
+    std::printf("replayed %llu events (%llu skipped) in %.1f ms: %.0f events/s, %.0f ns average and %lld ns max in the handler\n",
+        static_cast<unsigned long long>(stats.events), static_cast<unsigned long long>(stats.skipped),
+        static_cast<double>(stats.durationNanos) / 1e6, stats.eventsPerSecond,
+        stats.events > 0 ? static_cast<double>(stats.handlerNanos) / static_cast<double>(stats.events) : 0.0,
+        static_cast<long long>(stats.maxHandlerNanos));
+    return TestResult();
+}
@@ -0,0 +1,21 @@
+#include "image_encoder.h"
+
+namespace agora_rtc_engine {
+
+    // Stands in for the WIC encoder off Windows: the "encoded" image is the
+    // format followed by the dimensions and the BGR rows.
+    bool EncodeImage(const uint8_t* bgr, int width, int height, int stride,
+        ImageFormat format, float /* quality */, std::vector<uint8_t>& encoded)
+    {
+        if (bgr == nullptr || width <= 0 || height <= 0)
+            return false;
+        encoded.clear();
+        encoded.push_back(static_cast<uint8_t>(format));
+        encoded.push_back(static_cast<uint8_t>(width));
+        encoded.push_back(static_cast<uint8_t>(height));
+        for (int row = 0; row < height; ++row)
+            encoded.insert(encoded.end(), bgr + row * stride, bgr + row * stride + width * 3);
+        return true;
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,108 @@
+#include "lz4_block.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::Lz4Compress;
+using agora_rtc_engine::Lz4CompressBound;
+using agora_rtc_engine::Lz4Decompress;
+
+namespace {
+
+    // Bytes no match can be found in.
+    std::vector<uint8_t> Noise(size_t size, uint32_t seed)
+    {
+        std::vector<uint8_t> bytes(size);
+        for (auto& byte : bytes)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            byte = static_cast<uint8_t>(seed >> 24);
+        }
+        return bytes;
+    }
+
+    std::vector<uint8_t> Text(size_t size)
+    {
+        const std::string sentence = "{\"uid\":42,\"event\":\"volume\",\"level\":7},";
+        std::vector<uint8_t> bytes(size);
+        for (size_t i = 0; i < size; ++i)
+            bytes[i] = static_cast<uint8_t>(sentence[i % sentence.size()]);
+        return bytes;
+    }
+
+    // Compresses and decompresses |in|, returning the compressed size.
+    size_t RoundTrip(const std::vector<uint8_t>& in)
+    {
+        std::vector<uint8_t> compressed(Lz4CompressBound(in.size()));
+        auto size = Lz4Compress(in.data(), in.size(), compressed.data());
+        EXPECT(size > 0 && size <= compressed.size());
+        std::vector<uint8_t> out(in.size());
+        EXPECT(Lz4Decompress(compressed.data(), size, out.data(), out.size()));
+        EXPECT(out == in);
+        return size;
+    }
+
+    void TestEmptyInput()
+    {
+        // A single token without literals, from and into null pointers
+        uint8_t block[16];
+        EXPECT(Lz4Compress(nullptr, 0, block) == 1);
+        EXPECT(block[0] == 0);
+        EXPECT(Lz4Decompress(block, 1, nullptr, 0));
+        EXPECT(RoundTrip(std::vector<uint8_t>()) == 1);
+    }
+
+    void TestRoundTrips()
+    {
+        // Around the 12 bytes below which nothing is matched, and long
+        // enough for the 255-byte length extensions
+        for (size_t size : {1, 4, 11, 12, 13, 20, 100, 300, 1000, 5000, 70000})
+        {
+            EXPECT(RoundTrip(Text(size)) <= Lz4CompressBound(size));
+            EXPECT(RoundTrip(Noise(size, static_cast<uint32_t>(size))) <= Lz4CompressBound(size));
+        }
+        // A run overlapping its own output
+        EXPECT(RoundTrip(std::vector<uint8_t>(1000, 0x61)) < 20);
+    }
+
+    void TestCompressibleShrinks()
+    {
+        EXPECT(RoundTrip(Text(5000)) < 500);
+        // Noise doesn't, and stays within the bound
+        auto noise = RoundTrip(Noise(5000, 1));
+        EXPECT(noise >= 5000 && noise <= Lz4CompressBound(5000));
+    }
+
+    void TestMalformedBlocksAreRejected()
+    {
+        auto in = Text(1000);
+        std::vector<uint8_t> compressed(Lz4CompressBound(in.size()));
+        compressed.resize(Lz4Compress(in.data(), in.size(), compressed.data()));
+        std::vector<uint8_t> out(in.size() + 1);
+
+        // The wrong size either way
+        EXPECT(!Lz4Decompress(compressed.data(), compressed.size(), out.data(), in.size() - 1));
+        EXPECT(!Lz4Decompress(compressed.data(), compressed.size(), out.data(), in.size() + 1));
+        // Truncated
+        EXPECT(!Lz4Decompress(compressed.data(), compressed.size() - 1, out.data(), in.size()));
+        EXPECT(!Lz4Decompress(compressed.data(), 2, out.data(), in.size()));
+        // A match before the start of the output
+        const uint8_t before[] = {0x10, 0x61, 0x02, 0x00, 0x50, 0x61, 0x61, 0x61, 0x61, 0x61};
+        EXPECT(!Lz4Decompress(before, sizeof(before), out.data(), 10));
+        // A zero offset
+        const uint8_t zero[] = {0x10, 0x61, 0x00, 0x00, 0x50, 0x61, 0x61, 0x61, 0x61, 0x61};
+        EXPECT(!Lz4Decompress(zero, sizeof(zero), out.data(), 10));
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestEmptyInput);
+    RUN_TEST(TestRoundTrips);
+    RUN_TEST(TestCompressibleShrinks);
+    RUN_TEST(TestMalformedBlocksAreRejected);
+    return TestResult();
+}
@@ -0,0 +1,147 @@
+#include "network_preflight.h"
+
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::LastmileMeasurement;
+using agora_rtc_engine::NetworkPreflight;
+using agora_rtc_engine::PreflightOptions;
+using agora_rtc_engine::PreflightPlan;
+
+namespace {
+
+    using Clock = NetworkPreflight::Clock;
+
+    const Clock::time_point kStart = Clock::time_point() + std::chrono::hours(1);
+    // QUALITY_TYPE_EXCELLENT and NETWORK_TYPE_WIFI
+    const int kQualityExcellent = 1;
+    const int kNetworkWifi = 2;
+    // Index of the 640x360 15 fps level, 400 Kbps, in the default ladder
+    const int kLevel360p = 2;
+
+    // Records the plans the requests and refinements are completed with.
+    struct Plans
+    {
+        NetworkPreflight::DoneFunction Add()
+        {
+            return [this](const PreflightPlan& plan) { answered.push_back(plan); };
+        }
+
+        std::vector<PreflightPlan> answered;
+        std::vector<PreflightPlan> refined;
+    };
+
+    LastmileMeasurement ProbeResult(int uplinkKbps)
+    {
+        LastmileMeasurement result;
+        // LASTMILE_PROBE_RESULT_COMPLETE
+        result.state = 1;
+        result.uplink.availableBandwidth = uplinkKbps;
+        result.downlink.availableBandwidth = uplinkKbps;
+        result.rtt = 40;
+        return result;
+    }
+
+    PreflightOptions WifiOptions()
+    {
+        PreflightOptions options;
+        options.networkId = "office";
+        return options;
+    }
+
+    void TestAnswersFromQualityThenRefines()
+    {
+        Plans plans;
+        auto starts = 0;
+        NetworkPreflight preflight([&starts](int, int) { return ++starts > 0; },
+            [&plans](const PreflightPlan& plan) { plans.refined.push_back(plan); });
+        preflight.OnNetworkTypeChanged(kNetworkWifi);
+
+        auto probe = preflight.Run(WifiOptions(), kStart, plans.Add());
+        EXPECT(probe != 0);
+        EXPECT(starts == 1);
+        EXPECT(plans.answered.empty());
+
+        preflight.OnLastmileQuality(kQualityExcellent, kStart + std::chrono::seconds(2));
+        EXPECT(plans.answered.size() == 1);
+        if (plans.answered.size() == 1)
+        {
+            EXPECT(!plans.answered[0].refined);
+            EXPECT(plans.answered[0].probeMs == 2000);
+            // The heaviest level for an excellent quality
+            EXPECT(plans.answered[0].level == 5);
+        }
+
+        // Another request during the probe is answered at once
+        EXPECT(preflight.Run(WifiOptions(), kStart + std::chrono::seconds(3), plans.Add()) == 0);
+        EXPECT(plans.answered.size() == 2);
+        EXPECT(starts == 1);
+
+        // 600 Kbps with 70% headroom carries 400 Kbps
+        EXPECT(preflight.OnLastmileProbeResult(ProbeResult(600), kStart + std::chrono::seconds(30)));
+        EXPECT(plans.answered.size() == 2);
+        EXPECT(plans.refined.size() == 1);
+        if (plans.refined.size() == 1)
+        {
+            EXPECT(plans.refined[0].refined);
+            EXPECT(plans.refined[0].level == kLevel360p);
+            EXPECT(plans.refined[0].measurement.quality == kQualityExcellent);
+        }
+
+        // The refined plan is cached for the network
+        EXPECT(preflight.Run(WifiOptions(), kStart + std::chrono::minutes(1), plans.Add()) == 0);
+        EXPECT(plans.answered.size() == 3);
+        if (plans.answered.size() == 3)
+        {
+            EXPECT(plans.answered[2].cached);
+            EXPECT(plans.answered[2].refined);
+            EXPECT(plans.answered[2].level == kLevel360p);
+        }
+        EXPECT(starts == 1);
+    }
+
+    void TestProbeResultAnswersWithoutQuality()
+    {
+        Plans plans;
+        NetworkPreflight preflight([](int, int) { return true; },
+            [&plans](const PreflightPlan& plan) { plans.refined.push_back(plan); });
+        preflight.Run(PreflightOptions(), kStart, plans.Add());
+        EXPECT(preflight.OnLastmileProbeResult(ProbeResult(600), kStart + std::chrono::seconds(30)));
+        EXPECT(plans.answered.size() == 1);
+        EXPECT(!plans.answered.empty() && plans.answered[0].refined && plans.answered[0].level == kLevel360p);
+        EXPECT(plans.refined.empty());
+    }
+
+    void TestTimeoutAnswersWithAGuess()
+    {
+        Plans plans;
+        NetworkPreflight preflight([](int, int) { return true; }, nullptr);
+        auto probe = preflight.Run(PreflightOptions(), kStart, plans.Add());
+        EXPECT(preflight.OnTimeout(probe, kStart + std::chrono::seconds(35)));
+        EXPECT(plans.answered.size() == 1);
+        EXPECT(!plans.answered.empty() && plans.answered[0].timedOut && plans.answered[0].level == 0);
+        EXPECT(!preflight.OnTimeout(probe, kStart + std::chrono::seconds(36)));
+        EXPECT(preflight.GetStats().timeouts == 1);
+    }
+
+    void TestFailedStartAnswersAtOnce()
+    {
+        // E.g. without an engine
+        Plans plans;
+        NetworkPreflight preflight([](int, int) { return false; }, nullptr);
+        EXPECT(preflight.Run(PreflightOptions(), kStart, plans.Add()) == 0);
+        EXPECT(plans.answered.size() == 1);
+        EXPECT(!plans.answered.empty() && plans.answered[0].level == 0 && !plans.answered[0].refined);
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestAnswersFromQualityThenRefines);
+    RUN_TEST(TestProbeResultAnswersWithoutQuality);
+    RUN_TEST(TestTimeoutAnswersWithAGuess);
+    RUN_TEST(TestFailedStartAnswersAtOnce);
+    return TestResult();
+}
@@ -0,0 +1,263 @@
+#include "packet_cipher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "aes_gcm.h"
+#include "packet_pipeline.h"
+#include "test.h"
+
+using agora_rtc_engine::AesGcm;
+using agora_rtc_engine::AesPacketCipher;
+using agora_rtc_engine::PacketCipherMode;
+using agora_rtc_engine::PacketDirectionStats;
+using agora_rtc_engine::PacketPipeline;
+
+// Counts the allocations of the whole program, to check that the packet
+// path makes none.
+namespace {
+    std::atomic<uint64_t> allocations{0};
+}
+
+void* operator new(size_t size)
+{
+    allocations++;
+    if (auto p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+    std::vector<uint8_t> FromHex(const std::string& hex)
+    {
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i + 1 < hex.size(); i += 2)
+            bytes.push_back(static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+        return bytes;
+    }
+
+    // From the GCM specification's test cases, without additional data.
+    struct KnownAnswer
+    {
+        const char* name;
+        const char* key;
+        const char* cipherText;
+        const char* tag;
+    };
+
+    const char kNonce[] = "cafebabefacedbaddecaf888";
+    const char kPlainText[] =
+        "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+        "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255";
+
+    const KnownAnswer kKnownAnswers[] = {
+        {"3, AES-128", "feffe9928665731c6d6a8f9467308308",
+            "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+            "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985",
+            "4d5c2af327cd64a62cf35abd2ba6fab4"},
+        {"9, AES-192", "feffe9928665731c6d6a8f9467308308feffe9928665731c",
+            "3980ca0b3c00e841eb06fac4872a2757859e1ceaa6efd984628593b40ca1e19c"
+            "7d773d00c144c525ac619d18c84a3f4718e2448b2fe324d9ccda2710acade256",
+            "9924a7c8587336bfb118024db8674a14"},
+        {"15, AES-256", "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+            "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+            "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662898015ad",
+            "b094dac5d93471bdec1a502270e3cc6c"},
+    };
+
+    const uint8_t kKey[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+    void CheckKnownAnswers(bool accelerated)
+    {
+        auto nonce = FromHex(kNonce);
+        auto plainText = FromHex(kPlainText);
+        for (const auto& answer : kKnownAnswers)
+        {
+            std::fprintf(stderr, "  test case %s\n", answer.name);
+            auto key = FromHex(answer.key);
+            AesGcm cipher;
+            EXPECT(cipher.SetKey(key.data(), key.size()));
+            if (!accelerated)
+                cipher.DisableAcceleration();
+
+            std::vector<uint8_t> out(plainText.size());
+            uint8_t tag[AesGcm::kTagSize];
+            cipher.Seal(nonce.data(), plainText.data(), plainText.size(), out.data(), tag);
+            EXPECT(out == FromHex(answer.cipherText));
+            EXPECT(std::vector<uint8_t>(tag, tag + sizeof(tag)) == FromHex(answer.tag));
+
+            std::vector<uint8_t> opened(out.size());
+            EXPECT(cipher.Open(nonce.data(), out.data(), out.size(), opened.data(), tag));
+            EXPECT(opened == plainText);
+        }
+    }
+
+    void TestKnownAnswersAccelerated()
+    {
+        AesGcm probe;
+        probe.SetKey(kKey, sizeof(kKey));
+        if (!probe.accelerated())
+        {
+            std::fprintf(stderr, "  skipped, the CPU lacks AES-NI\n");
+            return;
+        }
+        CheckKnownAnswers(true);
+    }
+
+    void TestKnownAnswersPortable()
+    {
+        CheckKnownAnswers(false);
+    }
+
+    // Seals and opens every size up to a few blocks, on both paths, so that
+    // partial blocks and the four-block loop are covered.
+    void TestRoundTrips()
+    {
+        for (auto mode : {PacketCipherMode::AesCtr, PacketCipherMode::AesGcm})
+        {
+            for (auto accelerated : {true, false})
+            {
+                auto cipher = AesPacketCipher::Create(mode, kKey, sizeof(kKey));
+                EXPECT(cipher != nullptr);
+                if (cipher == nullptr)
+                    return;
+                if (!accelerated)
+                    cipher->DisableAcceleration();
+                for (size_t size = 1; size <= 200; ++size)
+                {
+                    std::vector<uint8_t> in(size);
+                    for (size_t i = 0; i < size; ++i)
+                        in[i] = static_cast<uint8_t>(i * 7 + size);
+                    std::vector<uint8_t> sealed(size + cipher->Overhead());
+                    EXPECT(cipher->Encode(in.data(), size, sealed.data()) == sealed.size());
+                    std::vector<uint8_t> opened(sealed.size());
+                    EXPECT(cipher->Decode(sealed.data(), sealed.size(), opened.data()) == size);
+                    opened.resize(size);
+                    EXPECT(opened == in);
+                }
+            }
+        }
+    }
+
+    void TestPathsInteroperate()
+    {
+        auto accelerated = AesPacketCipher::Create(PacketCipherMode::AesGcm, kKey, sizeof(kKey));
+        auto portable = AesPacketCipher::Create(PacketCipherMode::AesGcm, kKey, sizeof(kKey));
+        portable->DisableAcceleration();
+        std::vector<uint8_t> in(333, 0x5a);
+        std::vector<uint8_t> sealed(in.size() + accelerated->Overhead());
+        accelerated->Encode(in.data(), in.size(), sealed.data());
+        std::vector<uint8_t> opened(sealed.size());
+        EXPECT(portable->Decode(sealed.data(), sealed.size(), opened.data()) == in.size());
+        EXPECT(std::equal(in.begin(), in.end(), opened.begin()));
+    }
+
+    void TestTamperedPacketsAreRejected()
+    {
+        auto cipher = AesPacketCipher::Create(PacketCipherMode::AesGcm, kKey, sizeof(kKey));
+        std::vector<uint8_t> in(100, 0x33);
+        std::vector<uint8_t> sealed(in.size() + cipher->Overhead());
+        cipher->Encode(in.data(), in.size(), sealed.data());
+        std::vector<uint8_t> opened(sealed.size());
+
+        // The nonce, the body and the tag are each authenticated
+        for (auto index : {size_t(0), AesGcm::kNonceSize + 10, sealed.size() - 1})
+        {
+            auto tampered = sealed;
+            tampered[index] ^= 0x01;
+            EXPECT(cipher->Decode(tampered.data(), tampered.size(), opened.data()) == 0);
+        }
+        // Truncated to the overhead
+        EXPECT(cipher->Decode(sealed.data(), cipher->Overhead(), opened.data()) == 0);
+
+        // Another key
+        uint8_t otherKey[16] = {};
+        auto other = AesPacketCipher::Create(PacketCipherMode::AesGcm, otherKey, sizeof(otherKey));
+        EXPECT(other->Decode(sealed.data(), sealed.size(), opened.data()) == 0);
+        EXPECT(cipher->Decode(sealed.data(), sealed.size(), opened.data()) == in.size());
+    }
+
+    void TestInvalidKeysAreRefused()
+    {
+        EXPECT(AesPacketCipher::Create(PacketCipherMode::AesGcm, kKey, 15) == nullptr);
+        EXPECT(AesPacketCipher::Create(PacketCipherMode::None, kKey, sizeof(kKey)) == nullptr);
+    }
+
+    // Sends packets through one pipeline and receives them through another,
+    // as two users would, checking that neither allocates.
+    void TestPipelineDoesNotAllocate()
+    {
+        PacketPipeline sender;
+        PacketPipeline receiver;
+        sender.SetTransform(std::shared_ptr<AesPacketCipher>(AesPacketCipher::Create(PacketCipherMode::AesGcm, kKey, sizeof(kKey))));
+        receiver.SetTransform(std::shared_ptr<AesPacketCipher>(AesPacketCipher::Create(PacketCipherMode::AesGcm, kKey, sizeof(kKey))));
+        EXPECT(sender.active());
+
+        std::vector<uint8_t> payload(1200);
+        std::vector<uint8_t> wire(PacketPipeline::kMaxPacketSize + 64);
+        const uint8_t* sendScratch = nullptr;
+        auto intact = true;
+        auto before = allocations.load();
+        for (int i = 0; i < 1000; ++i)
+        {
+            payload[0] = static_cast<uint8_t>(i);
+            PacketPipeline::Packet packet{payload.data(), static_cast<unsigned int>(payload.size())};
+            auto sent = i % 2 ? sender.onSendAudioPacket(packet) : sender.onSendVideoPacket(packet);
+            EXPECT(sent);
+            if (i == 1)
+                sendScratch = packet.buffer;
+            else if (i % 2 && packet.buffer != sendScratch)
+                intact = false;
+            // Off the scratch buffer, as the SDK sends it before the next one
+            std::copy(packet.buffer, packet.buffer + packet.size, wire.begin());
+
+            PacketPipeline::Packet received{wire.data(), packet.size};
+            auto accepted = i % 2 ? receiver.onReceiveAudioPacket(received) : receiver.onReceiveVideoPacket(received);
+            if (!accepted || received.size != payload.size()
+                || !std::equal(payload.begin(), payload.end(), received.buffer))
+                intact = false;
+        }
+        EXPECT(allocations.load() == before);
+        EXPECT(intact);
+
+        // Too large to encrypt, dropped rather than sent in the clear
+        std::vector<uint8_t> large(PacketPipeline::kMaxPacketSize + 1);
+        PacketPipeline::Packet packet{large.data(), static_cast<unsigned int>(large.size())};
+        EXPECT(!sender.onSendVideoPacket(packet));
+
+        PacketDirectionStats stats[agora_rtc_engine::kPacketDirectionCount];
+        sender.GetStats(stats);
+        EXPECT(stats[0].packets == 500 && stats[1].packets == 500);
+        EXPECT(stats[1].dropped == 1);
+        receiver.GetStats(stats);
+        EXPECT(stats[2].packets == 500 && stats[3].packets == 500);
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestKnownAnswersAccelerated);
+    RUN_TEST(TestKnownAnswersPortable);
+    RUN_TEST(TestRoundTrips);
+    RUN_TEST(TestPathsInteroperate);
+    RUN_TEST(TestTamperedPacketsAreRejected);
+    RUN_TEST(TestInvalidKeysAreRefused);
+    RUN_TEST(TestPipelineDoesNotAllocate);
+    return TestResult();
+}
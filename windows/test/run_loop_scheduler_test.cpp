@@ -0,0 +1,87 @@
+#include "run_loop_scheduler.h"
+
+#include "test.h"
+
+// The example runner's run loop policy, which has no Windows dependencies.
+
+namespace {
+
+    using Clock = RunLoopScheduler::Clock;
+    using TimePoint = RunLoopScheduler::TimePoint;
+
+    const TimePoint kStart = TimePoint() + std::chrono::seconds(1);
+
+    void TestFlutterRunsFirst()
+    {
+        RunLoopScheduler scheduler;
+        EXPECT(scheduler.TimeUntilFlutterEvent(kStart) == Clock::duration::zero());
+        EXPECT(scheduler.OnWindowsMessagesDrained(kStart));
+    }
+
+    void TestWaitsForTheReportedDeadline()
+    {
+        RunLoopScheduler scheduler;
+        scheduler.OnFlutterMessagesProcessed(kStart, kStart + std::chrono::milliseconds(10));
+        EXPECT(scheduler.TimeUntilFlutterEvent(kStart) == std::chrono::milliseconds(10));
+        EXPECT(!scheduler.OnWindowsMessagesDrained(kStart + std::chrono::milliseconds(9)));
+        EXPECT(scheduler.TimeUntilFlutterEvent(kStart + std::chrono::milliseconds(10)) == Clock::duration::zero());
+        EXPECT(scheduler.OnWindowsMessagesDrained(kStart + std::chrono::milliseconds(10)));
+
+        // A passed deadline is replaced by the next one Flutter reports
+        scheduler.OnFlutterMessagesProcessed(kStart + std::chrono::milliseconds(10), TimePoint::max());
+        EXPECT(scheduler.TimeUntilFlutterEvent(kStart + std::chrono::seconds(5)) == Clock::duration::max());
+        EXPECT(!scheduler.OnWindowsMessagesDrained(kStart + std::chrono::seconds(5)));
+    }
+
+    void TestLongQueuesYieldToFlutter()
+    {
+        RunLoopScheduler scheduler(4);
+        scheduler.OnFlutterMessagesProcessed(kStart, TimePoint::max());
+        EXPECT(!scheduler.OnWindowsMessage(kStart));
+        EXPECT(!scheduler.OnWindowsMessage(kStart));
+        EXPECT(!scheduler.OnWindowsMessage(kStart));
+        EXPECT(scheduler.OnWindowsMessage(kStart));
+        scheduler.OnFlutterMessagesProcessed(kStart, TimePoint::max());
+        EXPECT(!scheduler.OnWindowsMessage(kStart));
+        // A due deadline does not wait for the budget
+        scheduler.OnFlutterMessagesProcessed(kStart, kStart + std::chrono::milliseconds(1));
+        EXPECT(scheduler.OnWindowsMessage(kStart + std::chrono::milliseconds(1)));
+    }
+
+    void TestDrainingMessagesRunsFlutter()
+    {
+        // Native messages may have posted platform channel replies
+        RunLoopScheduler scheduler;
+        scheduler.OnFlutterMessagesProcessed(kStart, TimePoint::max());
+        scheduler.OnWindowsMessage(kStart);
+        EXPECT(scheduler.OnWindowsMessagesDrained(kStart));
+    }
+
+    void TestMeasuresLatencyOfDeadlines()
+    {
+        RunLoopScheduler scheduler;
+        // Not measured: the initial work has no deadline
+        scheduler.OnFlutterMessagesProcessed(kStart, kStart + std::chrono::milliseconds(10));
+        scheduler.OnFlutterMessagesProcessed(kStart + std::chrono::milliseconds(13), kStart + std::chrono::milliseconds(20));
+        scheduler.OnFlutterMessagesProcessed(kStart + std::chrono::milliseconds(21), TimePoint::max());
+        // Not measured: no deadline was due
+        scheduler.OnFlutterMessagesProcessed(kStart + std::chrono::milliseconds(30), TimePoint::max());
+
+        const auto& metrics = scheduler.metrics();
+        EXPECT(metrics.flutter_batches == 4);
+        EXPECT(metrics.latency_samples == 2);
+        EXPECT(metrics.max_latency == std::chrono::milliseconds(3));
+        EXPECT(metrics.mean_latency() == std::chrono::milliseconds(2));
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestFlutterRunsFirst);
+    RUN_TEST(TestWaitsForTheReportedDeadline);
+    RUN_TEST(TestLongQueuesYieldToFlutter);
+    RUN_TEST(TestDrainingMessagesRunsFlutter);
+    RUN_TEST(TestMeasuresLatencyOfDeadlines);
+    return TestResult();
+}
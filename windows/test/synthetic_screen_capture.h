@@ -0,0 +1,71 @@
+#ifndef AGORA_RTC_ENGINE_TEST_SYNTHETIC_SCREEN_CAPTURE_H_
+#define AGORA_RTC_ENGINE_TEST_SYNTHETIC_SCREEN_CAPTURE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "screen_share_source.h"
+
+namespace agora_rtc_engine {
+namespace test {
+
+    // Stands in for GDI off Windows: a gray screen with a white square that
+    // moves one square width every |changeEvery| captures, 0 for never.
+    // Fails every capture while |failing| is set.
+    class SyntheticScreenCapture : public ScreenCaptureBackend
+    {
+    public:
+        static const int kSquareSize = 64;
+
+        SyntheticScreenCapture(int width, int height, int changeEvery)
+            : width(width), height(height), changeEvery(changeEvery),
+            pixels(static_cast<size_t>(width) * height * 4)
+        {
+        }
+
+        bool Capture(ScreenFrame& frame) override
+        {
+            if (failing)
+                return false;
+            if (changeEvery > 0 && captures % changeEvery == 0)
+                position = (position + kSquareSize) % (width - kSquareSize);
+            captures++;
+            Draw();
+            frame.data = pixels.data();
+            frame.width = width;
+            frame.height = height;
+            frame.stride = width * 4;
+            return true;
+        }
+
+        std::atomic<bool> failing{false};
+
+    private:
+        void Draw()
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                auto row = pixels.data() + static_cast<size_t>(y) * width * 4;
+                for (int x = 0; x < width; ++x)
+                {
+                    auto inSquare = x >= position && x < position + kSquareSize && y < kSquareSize;
+                    auto value = static_cast<uint8_t>(inSquare ? 255 : 128);
+                    row[x * 4] = row[x * 4 + 1] = row[x * 4 + 2] = value;
+                    row[x * 4 + 3] = 255;
+                }
+            }
+        }
+
+        int width;
+        int height;
+        int changeEvery;
+        int captures = 0;
+        int position = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+}  // namespace test
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_TEST_SYNTHETIC_SCREEN_CAPTURE_H_
@@ -0,0 +1,72 @@
+#include "task_queue.h"
+
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::TaskQueue;
+
+namespace {
+
+    void TestBurstWakesOnce()
+    {
+        auto wakes = 0;
+        TaskQueue queue([&wakes]() {
+            wakes++;
+            return true;
+        });
+        std::vector<int> order;
+        for (int i = 0; i < 3; i++)
+            queue.Post([&order, i]() { order.push_back(i); });
+        EXPECT(wakes == 1);
+        queue.RunPending();
+        EXPECT((order == std::vector<int>{0, 1, 2}));
+        queue.Post([]() {});
+        EXPECT(wakes == 2);
+        EXPECT(queue.GetStats().wakeups == 2);
+    }
+
+    void TestFailedWakeIsRetried()
+    {
+        // E.g. PostMessageW failing on a full message queue
+        auto attempts = 0;
+        auto fail = true;
+        TaskQueue queue([&attempts, &fail]() {
+            attempts++;
+            return !fail;
+        });
+        queue.Post([]() {});
+        EXPECT(attempts == 1);
+        fail = false;
+        queue.Post([]() {});
+        EXPECT(attempts == 2);
+        queue.Post([]() {});
+        EXPECT(attempts == 2);
+        EXPECT(queue.GetStats().wakeups == 1);
+    }
+
+    void TestDelayedTasksRunWhenDue()
+    {
+        TaskQueue queue([]() { return true; });
+        std::vector<int> order;
+        queue.PostDelayed([&order]() { order.push_back(2); }, std::chrono::milliseconds(20));
+        queue.PostDelayed([&order]() { order.push_back(1); }, std::chrono::milliseconds(10));
+        queue.Post([&order]() { order.push_back(0); });
+        auto next = queue.RunPending();
+        EXPECT((order == std::vector<int>{0}));
+        EXPECT(next != TaskQueue::Clock::time_point::max());
+        std::this_thread::sleep_until(next + std::chrono::milliseconds(15));
+        EXPECT(queue.RunPending() == TaskQueue::Clock::time_point::max());
+        EXPECT((order == std::vector<int>{0, 1, 2}));
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestBurstWakesOnce);
+    RUN_TEST(TestFailedWakeIsRetried);
+    RUN_TEST(TestDelayedTasksRunWhenDue);
+    return TestResult();
+}
@@ -0,0 +1,46 @@
+#ifndef AGORA_RTC_ENGINE_TEST_TEST_H_
+#define AGORA_RTC_ENGINE_TEST_TEST_H_
+
+#include <cstdio>
+
+// Just enough of a test framework for the component tests: each test is a
+// function called from main, which returns TestResult().
+
+namespace agora_rtc_engine {
+namespace test {
+
+    inline int& Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+}  // namespace test
+}  // namespace agora_rtc_engine
+
+#define EXPECT(condition)                                                           \
+    do                                                                              \
+    {                                                                               \
+        if (!(condition))                                                           \
+        {                                                                           \
+            std::fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+            agora_rtc_engine::test::Failures()++;                                   \
+        }                                                                           \
+    } while (0)
+
+#define RUN_TEST(test)                          \
+    do                                          \
+    {                                           \
+        std::fprintf(stderr, "%s\n", #test);    \
+        test();                                 \
+    } while (0)
+
+inline int TestResult()
+{
+    if (agora_rtc_engine::test::Failures() == 0)
+        return 0;
+    std::fprintf(stderr, "%d expectation(s) failed\n", agora_rtc_engine::test::Failures());
+    return 1;
+}
+
+#endif  // AGORA_RTC_ENGINE_TEST_TEST_H_
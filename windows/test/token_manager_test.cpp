@@ -0,0 +1,357 @@
+#include "token_manager.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::CallbackTokenProvider;
+using agora_rtc_engine::StubTokenProvider;
+using agora_rtc_engine::TokenGrant;
+using agora_rtc_engine::TokenManager;
+using agora_rtc_engine::TokenManagerOptions;
+using agora_rtc_engine::TokenReason;
+using agora_rtc_engine::TokenRequest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Polls |condition| for up to |timeoutMs|.
+    bool WaitUntil(const std::function<bool()>& condition, int timeoutMs)
+    {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!condition())
+        {
+            if (Clock::now() >= deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    // The tokens the manager renewed the engine's with.
+    struct Renewals
+    {
+        TokenManager::RenewFunction Function()
+        {
+            return [this](const std::string& token) {
+                std::lock_guard<std::mutex> lock(mutex);
+                tokens.push_back(token);
+            };
+        }
+
+        size_t size()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return tokens.size();
+        }
+
+        std::string last()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return tokens.empty() ? std::string() : tokens.back();
+        }
+
+        std::mutex mutex;
+        std::vector<std::string> tokens;
+    };
+
+    // Answers requests from the test instead of a token server, recording
+    // when they were made.
+    struct ManualProvider
+    {
+        ManualProvider()
+            : provider(std::make_shared<CallbackTokenProvider>([this](uint64_t id, const TokenRequest&) {
+                std::lock_guard<std::mutex> lock(mutex);
+                requests.push_back(id);
+                times.push_back(Clock::now());
+                if (failing)
+                    failNow.push_back(id);
+            }))
+        {
+        }
+
+        // Fails the requests made while |failing|, outside of the callback
+        // the manager calls with its own lock released.
+        void FailPending()
+        {
+            std::vector<uint64_t> ids;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ids.swap(failNow);
+            }
+            for (auto id : ids)
+                provider->Complete(id, false, TokenGrant());
+        }
+
+        size_t count()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return requests.size();
+        }
+
+        uint64_t last()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return requests.empty() ? 0 : requests.back();
+        }
+
+        std::shared_ptr<CallbackTokenProvider> provider;
+        std::mutex mutex;
+        std::vector<uint64_t> requests;
+        std::vector<Clock::time_point> times;
+        std::vector<uint64_t> failNow;
+        bool failing = false;
+    };
+
+    void TestAcquireFetchesThenCaches()
+    {
+        Renewals renewals;
+        TokenManager manager(renewals.Function());
+        manager.Start(std::make_shared<StubTokenProvider>(5, 3600), TokenManagerOptions());
+
+        std::atomic<int> answers{0};
+        std::string first;
+        manager.Acquire("room", 7, [&](bool ok, const std::string& token) {
+            EXPECT(ok);
+            first = token;
+            answers++;
+        });
+        EXPECT(WaitUntil([&] { return answers == 1; }, 2000));
+        EXPECT(first.rfind("stub:room:7:", 0) == 0);
+
+        // Answered on this thread from the cache
+        std::string second;
+        manager.Acquire("room", 7, [&](bool ok, const std::string& token) {
+            EXPECT(ok);
+            second = token;
+        });
+        EXPECT(second == first);
+
+        auto stats = manager.GetStats();
+        EXPECT(stats.fetches == 1);
+        EXPECT(stats.cacheHits == 1);
+        auto log = manager.GetLog();
+        EXPECT(log.size() == 2 && !log[0].cached && log[1].cached);
+        EXPECT(renewals.size() == 0);
+    }
+
+    void TestConcurrentAcquisitionsShareAFetch()
+    {
+        ManualProvider manual;
+        TokenManager manager([](const std::string&) {});
+        manager.Start(manual.provider, TokenManagerOptions());
+        std::atomic<int> answers{0};
+        for (int i = 0; i < 3; ++i)
+        {
+            manager.Acquire("room", 1, [&](bool ok, const std::string& token) {
+                EXPECT(ok && token == "shared");
+                answers++;
+            });
+        }
+        EXPECT(WaitUntil([&] { return manual.count() == 1; }, 2000));
+        manual.provider->Complete(manual.last(), true, TokenGrant{"shared", 0});
+        EXPECT(answers == 3);
+        EXPECT(manual.count() == 1);
+        manager.Stop();
+    }
+
+    void TestFetchTimesOut()
+    {
+        ManualProvider manual;
+        TokenManager manager([](const std::string&) {});
+        TokenManagerOptions options;
+        options.fetchTimeoutMs = 50;
+        manager.Start(manual.provider, options);
+
+        std::atomic<int> failures{0};
+        auto start = Clock::now();
+        manager.Acquire("room", 1, [&](bool ok, const std::string& token) {
+            EXPECT(!ok && token.empty());
+            failures++;
+        });
+        EXPECT(WaitUntil([&] { return failures == 1; }, 2000));
+        EXPECT(Clock::now() - start >= std::chrono::milliseconds(50));
+        EXPECT(manager.GetStats().timeouts == 1);
+        EXPECT(manager.GetStats().failures == 1);
+
+        // The late answer is ignored
+        EXPECT(manual.provider->Complete(manual.last(), true, TokenGrant{"late", 0}));
+        EXPECT(failures == 1);
+        EXPECT(manager.GetStats().fetches == 1);
+        manager.Stop();
+    }
+
+    void TestFailedRenewalsBackOff()
+    {
+        ManualProvider manual;
+        manual.failing = true;
+        Renewals renewals;
+        TokenManager manager(renewals.Function());
+        TokenManagerOptions options;
+        options.retryMs = 20;
+        options.maxRetryMs = 80;
+        manager.Start(manual.provider, options);
+        manager.OnJoining("room", 1, "expired");
+
+        manager.OnRequestToken();
+        // Retried after 20, 40, 80 and 80 ms
+        for (size_t attempts = 1; attempts <= 5; ++attempts)
+        {
+            EXPECT(WaitUntil([&] {
+                manual.FailPending();
+                return manual.count() >= attempts;
+            }, 2000));
+        }
+        manual.FailPending();
+        std::vector<Clock::duration> gaps;
+        {
+            std::lock_guard<std::mutex> lock(manual.mutex);
+            for (size_t i = 1; i < manual.times.size(); ++i)
+                gaps.push_back(manual.times[i] - manual.times[i - 1]);
+        }
+        EXPECT(gaps.size() >= 4);
+        if (gaps.size() >= 4)
+        {
+            EXPECT(gaps[0] >= std::chrono::milliseconds(20));
+            EXPECT(gaps[1] >= std::chrono::milliseconds(40));
+            EXPECT(gaps[2] >= std::chrono::milliseconds(80));
+            EXPECT(gaps[3] >= std::chrono::milliseconds(80));
+            // Capped, doubling would have taken 160 ms
+            EXPECT(gaps[3] < std::chrono::milliseconds(150));
+        }
+
+        auto log = manager.GetLog();
+        EXPECT(!log.empty() && log[0].reason == TokenReason::Expired && !log[0].ok);
+        EXPECT(log.size() >= 2 && log[1].reason == TokenReason::Scheduled);
+
+        // A success renews and resets the delay
+        {
+            std::lock_guard<std::mutex> lock(manual.mutex);
+            manual.failing = false;
+        }
+        auto answered = manual.count();
+        EXPECT(WaitUntil([&] { return manual.count() > answered; }, 2000));
+        manual.provider->Complete(manual.last(), true, TokenGrant{"renewed", 0});
+        EXPECT(renewals.last() == "renewed");
+        EXPECT(manager.GetStats().renewals == 1);
+        manager.Stop();
+    }
+
+    void TestRenewalIsClampedToHalfTheLifetime()
+    {
+        // A 4 s token renewed 60 s ahead would be renewed at once, it is
+        // renewed 2 s before it expires instead
+        Renewals renewals;
+        TokenManager manager(renewals.Function());
+        TokenManagerOptions options;
+        options.renewAheadSeconds = 60;
+        manager.Start(std::make_shared<StubTokenProvider>(0, 4), options);
+
+        std::string token;
+        std::atomic<int> answers{0};
+        manager.Acquire("room", 1, [&](bool ok, const std::string& acquired) {
+            EXPECT(ok);
+            token = acquired;
+            answers++;
+        });
+        EXPECT(WaitUntil([&] { return answers == 1; }, 2000));
+        manager.OnJoining("room", 1, token);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        EXPECT(renewals.size() == 0);
+        EXPECT(WaitUntil([&] { return renewals.size() == 1; }, 4000));
+        EXPECT(renewals.last() != token);
+        auto log = manager.GetLog();
+        EXPECT(!log.empty() && log.back().reason == TokenReason::Scheduled && log.back().ok);
+        manager.Stop();
+    }
+
+    void TestWillExpireUsesThePrefetchedToken()
+    {
+        Renewals renewals;
+        TokenManager manager(renewals.Function());
+        manager.Start(std::make_shared<StubTokenProvider>(0, 3600), TokenManagerOptions());
+        manager.Prefetch("room", 1);
+        EXPECT(WaitUntil([&] { return manager.GetStats().fetches == 1; }, 2000));
+        manager.OnJoining("room", 1, "old");
+
+        // Renewed on this thread, from the cache
+        manager.OnTokenPrivilegeWillExpire();
+        EXPECT(renewals.size() == 1);
+        auto prefetched = renewals.last();
+        EXPECT(prefetched.rfind("stub:room:1:", 0) == 0);
+        auto log = manager.GetLog();
+        EXPECT(!log.empty() && log.back().reason == TokenReason::WillExpire && log.back().cached);
+
+        // The session's token is the cached one, so expiring fetches another
+        manager.OnRequestToken();
+        EXPECT(WaitUntil([&] { return renewals.size() == 2; }, 2000));
+        EXPECT(renewals.last() != prefetched);
+        log = manager.GetLog();
+        EXPECT(!log.empty() && log.back().reason == TokenReason::Expired && !log.back().cached);
+        EXPECT(manager.GetStats().renewals == 2);
+        manager.Stop();
+    }
+
+    void TestLeavingStopsRenewals()
+    {
+        Renewals renewals;
+        TokenManager manager(renewals.Function());
+        manager.Start(std::make_shared<StubTokenProvider>(0, 3600), TokenManagerOptions());
+        manager.OnJoining("room", 1, "old");
+        manager.OnLeft();
+        manager.OnRequestToken();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT(renewals.size() == 0);
+        EXPECT(manager.GetStats().fetches == 0);
+        manager.Stop();
+    }
+
+    void TestStopFailsWaiters()
+    {
+        ManualProvider manual;
+        TokenManager manager([](const std::string&) {});
+        manager.Start(manual.provider, TokenManagerOptions());
+        std::atomic<int> failures{0};
+        manager.Acquire("room", 1, [&](bool ok, const std::string&) {
+            EXPECT(!ok);
+            failures++;
+        });
+        EXPECT(WaitUntil([&] { return manual.count() == 1; }, 2000));
+        manager.Stop();
+        EXPECT(failures == 1);
+        EXPECT(!manager.running());
+
+        // Stopped managers fail at once
+        manager.Acquire("room", 1, [&](bool ok, const std::string&) {
+            EXPECT(!ok);
+            failures++;
+        });
+        EXPECT(failures == 2);
+        // The provider's answer finds nothing to complete
+        manual.provider->FailAll();
+        EXPECT(failures == 2);
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestAcquireFetchesThenCaches);
+    RUN_TEST(TestConcurrentAcquisitionsShareAFetch);
+    RUN_TEST(TestFetchTimesOut);
+    RUN_TEST(TestFailedRenewalsBackOff);
+    RUN_TEST(TestRenewalIsClampedToHalfTheLifetime);
+    RUN_TEST(TestWillExpireUsesThePrefetchedToken);
+    RUN_TEST(TestLeavingStopsRenewals);
+    RUN_TEST(TestStopFailsWaiters);
+    return TestResult();
+}
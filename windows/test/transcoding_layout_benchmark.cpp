@@ -0,0 +1,113 @@
+#include "transcoding_layout.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+using agora::rtc::LiveTranscoding;
+using agora::rtc::TranscodingUser;
+using agora_rtc_engine::LayoutTemplate;
+using agora_rtc_engine::TranscodingLayoutEngine;
+using agora_rtc_engine::TranscodingLayoutOptions;
+
+// Lays out a full channel of 17 hosts with every template, then churns hosts
+// in and out of a running TranscodingLayoutEngine and reports how many
+// setLiveTranscoding calls the debouncing leaves.
+
+namespace {
+
+    const size_t kHosts = TranscodingLayoutEngine::kMaxUsers;
+
+    const char* Name(LayoutTemplate layout)
+    {
+        switch (layout)
+        {
+        case LayoutTemplate::Grid:
+            return "grid";
+        case LayoutTemplate::SpeakerFocus:
+            return "speaker focus";
+        case LayoutTemplate::PictureInPicture:
+            return "picture in picture";
+        }
+        return "";
+    }
+
+    void BenchmarkComputeLayout(LayoutTemplate layout)
+    {
+        const int kIterations = 100000;
+        TranscodingLayoutOptions options;
+        options.layout = layout;
+        std::vector<unsigned int> uids;
+        for (unsigned int uid = 1; uid <= kHosts; uid++)
+            uids.push_back(uid);
+        std::vector<TranscodingUser> users;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kIterations; i++)
+            TranscodingLayoutEngine::ComputeLayout(options, uids, static_cast<unsigned int>(i % kHosts + 1), users);
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        EXPECT(users.size() == kHosts);
+        std::printf("%-20s %zu hosts: %.0f ns per layout\n", Name(layout), kHosts, elapsed / kIterations);
+    }
+
+    void BenchmarkChurn()
+    {
+        const int kChanges = 2000;
+        const auto kInterval = std::chrono::microseconds(500);
+        std::atomic<int> applied{0};
+        TranscodingLayoutEngine engine([&applied](const LiveTranscoding& transcoding) {
+            if (transcoding.userCount <= kHosts)
+                applied++;
+        });
+        for (unsigned int uid = 1; uid <= kHosts; uid++)
+            engine.AddUser(uid);
+        TranscodingLayoutOptions options;
+        options.layout = LayoutTemplate::SpeakerFocus;
+        options.debounceMs = 50;
+        engine.Start(options);
+
+        // One host at a time leaves and rejoins, and the speaker moves
+        std::mt19937 random(17);
+        std::uniform_int_distribution<unsigned int> host(1, kHosts);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kChanges; i++)
+        {
+            auto uid = host(random);
+            if (i % 3 == 2)
+                engine.SetSpeaker(uid);
+            else
+            {
+                engine.RemoveUser(uid);
+                engine.AddUser(uid);
+            }
+            std::this_thread::sleep_for(kInterval);
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        // Let the last burst settle
+        std::this_thread::sleep_for(std::chrono::milliseconds(4 * options.debounceMs));
+        engine.Stop();
+
+        auto stats = engine.GetStats();
+        EXPECT(stats.users == static_cast<int>(kHosts));
+        EXPECT(stats.applied == static_cast<uint64_t>(applied.load()));
+        EXPECT(stats.applied < stats.changes);
+        std::printf("churn: %llu changes in %.2f s, %llu layouts, %llu applied, %llu unchanged, %lld ns per layout\n",
+            static_cast<unsigned long long>(stats.changes), elapsed,
+            static_cast<unsigned long long>(stats.layouts), static_cast<unsigned long long>(stats.applied),
+            static_cast<unsigned long long>(stats.unchanged), static_cast<long long>(stats.averageLayoutNanos));
+    }
+
+}  // namespace
+
+int main()
+{
+    BenchmarkComputeLayout(LayoutTemplate::Grid);
+    BenchmarkComputeLayout(LayoutTemplate::SpeakerFocus);
+    BenchmarkComputeLayout(LayoutTemplate::PictureInPicture);
+    BenchmarkChurn();
+    return TestResult();
+}
@@ -0,0 +1,186 @@
+#include "video_render_policy.h"
+
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::RenderPolicy;
+using agora_rtc_engine::RenderPolicyCounters;
+using agora_rtc_engine::VideoRenderPolicy;
+
+namespace {
+
+    using Clock = VideoRenderPolicy::Clock;
+
+    const Clock::time_point kStart = Clock::time_point() + std::chrono::hours(1);
+    const unsigned int kUid = 42;
+
+    RenderPolicyCounters CountersOf(const VideoRenderPolicy& policy, unsigned int uid)
+    {
+        for (const auto& counters : policy.GetStats().users)
+        {
+            if (counters.uid == uid)
+                return counters;
+        }
+        return RenderPolicyCounters();
+    }
+
+    // Offers |frames| frames |intervalUs| apart from |start|, returning which
+    // were admitted.
+    std::vector<bool> Offer(VideoRenderPolicy& policy, int frames, int64_t intervalUs,
+        Clock::time_point start = kStart, int64_t firstRenderTimeMs = 1)
+    {
+        std::vector<bool> admitted;
+        for (int i = 0; i < frames; ++i)
+        {
+            auto offset = std::chrono::microseconds(intervalUs * i);
+            auto renderTimeMs = firstRenderTimeMs + intervalUs * i / 1000;
+            admitted.push_back(policy.Admit(kUid, 640, 360, renderTimeMs, start + offset));
+        }
+        return admitted;
+    }
+
+    int Count(const std::vector<bool>& admitted)
+    {
+        auto count = 0;
+        for (auto frame : admitted)
+            count += frame ? 1 : 0;
+        return count;
+    }
+
+    void TestChecksInOrder()
+    {
+        VideoRenderPolicy policy;
+        RenderPolicy hidden;
+        hidden.visible = false;
+        hidden.maxWidth = 320;
+        policy.SetPolicy(kUid, hidden);
+        // Hidden first, even when too large
+        EXPECT(!policy.Admit(kUid, 640, 360, 100, kStart));
+        EXPECT(CountersOf(policy, kUid).droppedHidden == 1);
+        EXPECT(CountersOf(policy, kUid).droppedSize == 0);
+
+        RenderPolicy small;
+        small.maxWidth = 320;
+        small.maxHeight = 180;
+        small.maxFps = 1;
+        policy.SetPolicy(kUid, small);
+        EXPECT(policy.Admit(kUid, 320, 180, 100, kStart));
+        // Size before staleness
+        EXPECT(!policy.Admit(kUid, 640, 180, 50, kStart + std::chrono::seconds(2)));
+        EXPECT(!policy.Admit(kUid, 320, 360, 50, kStart + std::chrono::seconds(2)));
+        EXPECT(CountersOf(policy, kUid).droppedSize == 2);
+        // Staleness before the rate
+        EXPECT(!policy.Admit(kUid, 320, 180, 100, kStart + std::chrono::milliseconds(10)));
+        EXPECT(CountersOf(policy, kUid).droppedStale == 1);
+        EXPECT(CountersOf(policy, kUid).droppedRate == 0);
+        EXPECT(!policy.Admit(kUid, 320, 180, 110, kStart + std::chrono::milliseconds(10)));
+        EXPECT(CountersOf(policy, kUid).droppedRate == 1);
+
+        auto counters = CountersOf(policy, kUid);
+        EXPECT(counters.delivered == 1);
+        // Every dropped frame's I420 size
+        EXPECT(counters.skippedBytes == 640 * 360 * 3 / 2 + 640 * 180 * 3 / 2 + 320 * 360 * 3 / 2 + 2 * 320 * 180 * 3 / 2);
+    }
+
+    void TestUnknownRenderTimesAreNotStale()
+    {
+        VideoRenderPolicy policy;
+        EXPECT(policy.Admit(kUid, 640, 360, 0, kStart));
+        EXPECT(policy.Admit(kUid, 640, 360, 0, kStart));
+        EXPECT(policy.Admit(kUid, 640, 360, 5, kStart));
+        EXPECT(!policy.Admit(kUid, 640, 360, 5, kStart));
+    }
+
+    void TestThrottlesToMaxFps()
+    {
+        VideoRenderPolicy policy;
+        RenderPolicy limited;
+        limited.maxFps = 15;
+        policy.SetPolicy(kUid, limited);
+        // 30 fps for 2 s: every other frame
+        auto admitted = Offer(policy, 60, 33333);
+        EXPECT(Count(admitted) == 30);
+        for (size_t i = 0; i + 1 < admitted.size(); i += 2)
+            EXPECT(admitted[i] && !admitted[i + 1]);
+        EXPECT(CountersOf(policy, kUid).droppedRate == 30);
+    }
+
+    void TestSlightlyEarlyFramesAreAdmitted()
+    {
+        // 60 fps for 2 s, jittered by up to 3 ms around the schedule: every
+        // other frame, where a strict schedule would drop a third of them
+        VideoRenderPolicy policy;
+        RenderPolicy limited;
+        limited.maxFps = 30;
+        policy.SetPolicy(kUid, limited);
+        auto admitted = 0;
+        for (int i = 0; i < 120; ++i)
+        {
+            auto jitterUs = i % 3 == 0 ? 3000 : i % 3 == 1 ? -3000 : 0;
+            auto offset = std::chrono::microseconds(i * 16667 + jitterUs);
+            admitted += policy.Admit(kUid, 640, 360, 1 + i * 16667 / 1000, kStart + offset) ? 1 : 0;
+        }
+        EXPECT(admitted == 60);
+    }
+
+    void TestPausesDoNotBurst()
+    {
+        VideoRenderPolicy policy;
+        RenderPolicy limited;
+        limited.maxFps = 10;
+        policy.SetPolicy(kUid, limited);
+        EXPECT(Count(Offer(policy, 10, 100000)) == 10);
+        // After a pause, 100 fps for 100 ms: only the first one and the one
+        // an interval later, less a quarter of it
+        auto resumed = kStart + std::chrono::seconds(5);
+        auto admitted = Offer(policy, 11, 10000, resumed, 5000);
+        EXPECT(Count(admitted) == 2);
+        EXPECT(admitted[0] && admitted[8]);
+    }
+
+    void TestSetPolicyAdmitsTheNextFrame()
+    {
+        VideoRenderPolicy policy;
+        RenderPolicy limited;
+        limited.maxFps = 1;
+        policy.SetPolicy(kUid, limited);
+        EXPECT(policy.Admit(kUid, 640, 360, 1, kStart));
+        EXPECT(!policy.Admit(kUid, 640, 360, 2, kStart + std::chrono::milliseconds(100)));
+        policy.SetPolicy(kUid, limited);
+        EXPECT(policy.Admit(kUid, 640, 360, 3, kStart + std::chrono::milliseconds(200)));
+    }
+
+    void TestRemovedUsersCountTowardsTheTotal()
+    {
+        VideoRenderPolicy policy;
+        RenderPolicy hidden;
+        hidden.visible = false;
+        policy.SetPolicy(kUid, hidden);
+        policy.Admit(kUid, 640, 360, 1, kStart);
+        policy.Admit(0, 640, 360, 1, kStart);
+        policy.RemoveRemoteUsers();
+        auto stats = policy.GetStats();
+        EXPECT(stats.users.size() == 1 && stats.users[0].uid == 0);
+        EXPECT(stats.total.droppedHidden == 1);
+        EXPECT(stats.total.delivered == 1);
+
+        // A user coming back starts without a policy
+        EXPECT(policy.Admit(kUid, 640, 360, 1, kStart));
+        policy.Reset();
+        EXPECT(policy.GetStats().total.delivered == 0);
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestChecksInOrder);
+    RUN_TEST(TestUnknownRenderTimesAreNotStale);
+    RUN_TEST(TestThrottlesToMaxFps);
+    RUN_TEST(TestSlightlyEarlyFramesAreAdmitted);
+    RUN_TEST(TestPausesDoNotBurst);
+    RUN_TEST(TestSetPolicyAdmitsTheNextFrame);
+    RUN_TEST(TestRemovedUsersCountTowardsTheTotal);
+    return TestResult();
+}
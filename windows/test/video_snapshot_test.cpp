@@ -0,0 +1,142 @@
+#include "video_snapshot.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "test.h"
+
+using agora_rtc_engine::ImageFormat;
+using agora_rtc_engine::SnapshotStatus;
+using agora_rtc_engine::VideoSnapshotService;
+
+namespace {
+
+    // The outcomes of the requests, which complete on worker threads.
+    class Outcomes
+    {
+    public:
+        VideoSnapshotService::Callback Add()
+        {
+            return [this](SnapshotStatus status, std::vector<uint8_t> encoded) {
+                std::lock_guard<std::mutex> lock(mutex);
+                statuses.push_back(status);
+                sizes.push_back(encoded.size());
+                condition.notify_all();
+            };
+        }
+
+        std::vector<SnapshotStatus> Wait(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait_for(lock, std::chrono::seconds(5), [this, count]() { return statuses.size() >= count; });
+            return statuses;
+        }
+
+        std::vector<size_t> sizes;
+
+    private:
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::vector<SnapshotStatus> statuses;
+    };
+
+    struct I420Frame
+    {
+        I420Frame(int width, int height)
+            : y(static_cast<size_t>(width) * height, 128),
+            u(static_cast<size_t>(width / 2) * (height / 2), 128),
+            v(static_cast<size_t>(width / 2) * (height / 2), 128)
+        {
+            frame.type = agora::media::IVideoFrameObserver::FRAME_TYPE_YUV420;
+            frame.width = width;
+            frame.height = height;
+            frame.yStride = width;
+            frame.uStride = width / 2;
+            frame.vStride = width / 2;
+            frame.yBuffer = y.data();
+            frame.uBuffer = u.data();
+            frame.vBuffer = v.data();
+            frame.rotation = 0;
+            frame.renderTimeMs = 0;
+            frame.avsync_type = 0;
+        }
+
+        std::vector<uint8_t> y;
+        std::vector<uint8_t> u;
+        std::vector<uint8_t> v;
+        VideoSnapshotService::VideoFrame frame;
+    };
+
+    void TestTimesOutWithoutFrames()
+    {
+        VideoSnapshotService snapshots;
+        Outcomes outcomes;
+        snapshots.Request(7, 0, ImageFormat::Png, outcomes.Add());
+
+        // Not yet due
+        snapshots.Expire(VideoSnapshotService::Clock::now() + agora_rtc_engine::kSnapshotTimeout / 2);
+        EXPECT(snapshots.GetStats().failed == 0);
+
+        // What the plugin's delayed task does once the timeout has passed
+        snapshots.Expire(VideoSnapshotService::Clock::now() + agora_rtc_engine::kSnapshotTimeout);
+        auto statuses = outcomes.Wait(1);
+        EXPECT(statuses.size() == 1);
+        EXPECT(!statuses.empty() && statuses[0] == SnapshotStatus::TimedOut);
+        EXPECT(snapshots.GetStats().failed == 1);
+    }
+
+    void TestOtherUidsFramesDoNotAnswer()
+    {
+        VideoSnapshotService snapshots;
+        Outcomes outcomes;
+        snapshots.Request(7, 0, ImageFormat::Png, outcomes.Add());
+        I420Frame frame(16, 16);
+        snapshots.OnVideoFrame(8, frame.frame);
+        snapshots.Expire(VideoSnapshotService::Clock::now() + agora_rtc_engine::kSnapshotTimeout);
+        auto statuses = outcomes.Wait(1);
+        EXPECT(statuses.size() == 1 && statuses[0] == SnapshotStatus::TimedOut);
+        EXPECT(snapshots.GetStats().captured == 0);
+    }
+
+    void TestCoalescedRequestsShareAFrame()
+    {
+        VideoSnapshotService snapshots;
+        Outcomes outcomes;
+        snapshots.Request(7, 0, ImageFormat::Png, outcomes.Add());
+        snapshots.Request(7, 8, ImageFormat::Jpeg, outcomes.Add());
+        I420Frame frame(16, 16);
+        snapshots.OnVideoFrame(7, frame.frame);
+        auto statuses = outcomes.Wait(2);
+        EXPECT(statuses.size() == 2);
+        for (auto status : statuses)
+            EXPECT(status == SnapshotStatus::Captured);
+        auto stats = snapshots.GetStats();
+        EXPECT(stats.coalesced == 1);
+        EXPECT(stats.captured == 1);
+        EXPECT(stats.encoded == 2);
+        // A frame after the requests completed times nothing out
+        snapshots.Expire(VideoSnapshotService::Clock::now() + agora_rtc_engine::kSnapshotTimeout);
+        EXPECT(snapshots.GetStats().failed == 0);
+    }
+
+    void TestCancelFailsAsCancelled()
+    {
+        VideoSnapshotService snapshots;
+        Outcomes outcomes;
+        snapshots.Request(7, 0, ImageFormat::Png, outcomes.Add());
+        snapshots.Cancel(7);
+        auto statuses = outcomes.Wait(1);
+        EXPECT(statuses.size() == 1 && statuses[0] == SnapshotStatus::Cancelled);
+    }
+
+}  // namespace
+
+int main()
+{
+    RUN_TEST(TestTimesOutWithoutFrames);
+    RUN_TEST(TestOtherUidsFramesDoNotAnswer);
+    RUN_TEST(TestCoalescedRequestsShareAFrame);
+    RUN_TEST(TestCancelFailsAsCancelled);
+    return TestResult();
+}
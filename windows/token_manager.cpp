@@ -0,0 +1,378 @@
+#include "token_manager.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // Bounds waits on the far-off time points standing for never.
+        const std::chrono::milliseconds kMaxWait(60 * 60 * 1000);
+
+        int64_t NowSeconds()
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }  // namespace
+
+    TokenManager::TokenManager(RenewFunction renew)
+        : renew(std::move(renew))
+    {
+    }
+
+    TokenManager::~TokenManager()
+    {
+        Stop();
+    }
+
+    void TokenManager::Start(std::shared_ptr<TokenProvider> newProvider, const TokenManagerOptions& newOptions)
+    {
+        Stop();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            provider = std::move(newProvider);
+            options = newOptions;
+            stopping = false;
+        }
+        worker = std::thread(&TokenManager::Run, this);
+    }
+
+    void TokenManager::Stop()
+    {
+        std::vector<AcquireFunction> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            for (auto& fetch : fetches)
+                waiters.insert(waiters.end(), fetch.second.waiters.begin(), fetch.second.waiters.end());
+            fetches.clear();
+            cache.clear();
+            sessionKey.clear();
+            sessionToken.clear();
+            renewAt = std::chrono::system_clock::time_point::max();
+        }
+        condition.notify_all();
+        if (worker.joinable())
+            worker.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            provider = nullptr;
+        }
+        for (auto& waiter : waiters)
+            waiter(false, std::string());
+    }
+
+    bool TokenManager::running() const
+    {
+        return worker.joinable();
+    }
+
+    void TokenManager::Acquire(const std::string& channelId, uint32_t uid, AcquireFunction done)
+    {
+        std::string token;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (provider == nullptr || stopping)
+            {
+                token.clear();
+            }
+            else if (auto cached = Cached(Key(channelId, uid)))
+            {
+                cacheHits++;
+                Log(TokenRequest{channelId, uid}, TokenReason::Acquire, true, true, 0);
+                token = cached->grant.token;
+            }
+            else
+            {
+                Request(channelId, uid, TokenReason::Acquire).waiters.push_back(std::move(done));
+                return;
+            }
+        }
+        done(!token.empty(), token);
+    }
+
+    void TokenManager::Prefetch(const std::string& channelId, uint32_t uid)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (provider != nullptr && !stopping && Cached(Key(channelId, uid)) == nullptr)
+            Request(channelId, uid, TokenReason::Prefetch);
+    }
+
+    void TokenManager::OnJoining(const std::string& channelId, uint32_t uid, const std::string& token)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        renewAt = std::chrono::system_clock::time_point::max();
+        retryDelay = std::chrono::milliseconds(0);
+        // Channels without tokens have nothing to renew
+        if (token.empty())
+        {
+            sessionKey.clear();
+            return;
+        }
+        sessionKey = Key(channelId, uid);
+        session = TokenRequest{channelId, uid};
+        sessionToken = token;
+        auto cached = cache.find(sessionKey);
+        if (cached != cache.end() && cached->second.grant.token == token)
+            ScheduleRenewal(cached->second);
+    }
+
+    void TokenManager::OnLeft()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sessionKey.clear();
+        sessionToken.clear();
+        renewAt = std::chrono::system_clock::time_point::max();
+    }
+
+    void TokenManager::OnTokenPrivilegeWillExpire()
+    {
+        std::string token;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            token = RenewSession(TokenReason::WillExpire);
+        }
+        if (!token.empty())
+            renew(token);
+    }
+
+    void TokenManager::OnRequestToken()
+    {
+        std::string token;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            token = RenewSession(TokenReason::Expired);
+        }
+        if (!token.empty())
+            renew(token);
+    }
+
+    std::vector<TokenEvent> TokenManager::GetLog() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::vector<TokenEvent>(log.begin(), log.end());
+    }
+
+    TokenManagerStats TokenManager::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        TokenManagerStats stats;
+        stats.fetches = fetched;
+        stats.failures = failures;
+        stats.timeouts = timeouts;
+        stats.cacheHits = cacheHits;
+        stats.renewals = renewals;
+        if (fetched > 0)
+            stats.meanFetchNanos = fetchNanos / static_cast<int64_t>(fetched);
+        stats.maxFetchNanos = maxFetchNanos;
+        return stats;
+    }
+
+    void TokenManager::Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping)
+        {
+            // Sends the new fetches, outside of the lock as providers may
+            // answer right away.
+            std::vector<std::tuple<std::string, uint64_t, TokenRequest>> requests;
+            for (auto& fetch : fetches)
+            {
+                if (!fetch.second.sent)
+                {
+                    fetch.second.sent = true;
+                    requests.emplace_back(fetch.first, fetch.second.id, fetch.second.request);
+                }
+            }
+            if (!requests.empty())
+            {
+                auto current = provider;
+                lock.unlock();
+                for (const auto& request : requests)
+                {
+                    auto key = std::get<0>(request);
+                    auto id = std::get<1>(request);
+                    current->Fetch(std::get<2>(request), [this, key, id](bool ok, const TokenGrant& grant) {
+                        OnFetched(key, id, ok, grant);
+                    });
+                }
+                lock.lock();
+                continue;
+            }
+
+            auto now = Clock::now();
+            auto timeout = std::chrono::milliseconds(options.fetchTimeoutMs);
+            auto wait = kMaxWait;
+            std::vector<std::pair<std::string, uint64_t>> expired;
+            for (const auto& fetch : fetches)
+            {
+                auto deadline = fetch.second.started + timeout;
+                if (deadline <= now)
+                    expired.emplace_back(fetch.first, fetch.second.id);
+                else
+                    wait = std::min(wait, std::chrono::ceil<std::chrono::milliseconds>(deadline - now));
+            }
+            if (!expired.empty())
+            {
+                timeouts += expired.size();
+                lock.unlock();
+                for (const auto& fetch : expired)
+                    OnFetched(fetch.first, fetch.second, false, TokenGrant());
+                lock.lock();
+                continue;
+            }
+
+            auto wallNow = std::chrono::system_clock::now();
+            if (renewAt <= wallNow)
+            {
+                renewAt = std::chrono::system_clock::time_point::max();
+                auto token = RenewSession(TokenReason::Scheduled);
+                if (!token.empty())
+                {
+                    lock.unlock();
+                    renew(token);
+                    lock.lock();
+                }
+                continue;
+            }
+            if (renewAt - wallNow < wait)
+                wait = std::chrono::ceil<std::chrono::milliseconds>(renewAt - wallNow);
+
+            condition.wait_for(lock, wait);
+        }
+    }
+
+    TokenManager::Fetch& TokenManager::Request(const std::string& channelId, uint32_t uid, TokenReason reason)
+    {
+        auto& fetch = fetches[Key(channelId, uid)];
+        if (fetch.id == 0)
+        {
+            fetch.id = ++lastFetchId;
+            fetch.request = TokenRequest{channelId, uid};
+            fetch.reason = reason;
+            fetch.started = Clock::now();
+            condition.notify_all();
+        }
+        return fetch;
+    }
+
+    std::string TokenManager::RenewSession(TokenReason reason)
+    {
+        if (sessionKey.empty() || provider == nullptr || stopping)
+            return std::string();
+        // Prefetched, or fetched for a renewal already under way
+        auto cached = Cached(sessionKey);
+        if (cached != nullptr && cached->grant.token != sessionToken)
+        {
+            cacheHits++;
+            renewals++;
+            Log(session, reason, true, true, 0);
+            sessionToken = cached->grant.token;
+            ScheduleRenewal(*cached);
+            return sessionToken;
+        }
+        Request(session.channelId, session.uid, reason).renew = true;
+        return std::string();
+    }
+
+    void TokenManager::OnFetched(const std::string& key, uint64_t id, bool ok, const TokenGrant& grant)
+    {
+        std::vector<AcquireFunction> waiters;
+        std::string renewWith;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = fetches.find(key);
+            // Timed out, or the manager was stopped
+            if (found == fetches.end() || found->second.id != id)
+                return;
+            auto fetch = std::move(found->second);
+            fetches.erase(found);
+
+            auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - fetch.started).count();
+            fetched++;
+            fetchNanos += latency;
+            maxFetchNanos = std::max(maxFetchNanos, latency);
+            ok = ok && !grant.token.empty();
+            if (ok)
+                cache[key] = CachedToken{grant, NowSeconds()};
+            else
+                failures++;
+            Log(fetch.request, fetch.reason, ok, false, latency);
+
+            if (fetch.renew && key == sessionKey)
+            {
+                if (ok)
+                {
+                    renewals++;
+                    sessionToken = grant.token;
+                    retryDelay = std::chrono::milliseconds(0);
+                    ScheduleRenewal(cache[key]);
+                    renewWith = grant.token;
+                }
+                else
+                {
+                    retryDelay = retryDelay.count() == 0 ? std::chrono::milliseconds(options.retryMs) : retryDelay * 2;
+                    retryDelay = std::min(retryDelay, std::chrono::milliseconds(options.maxRetryMs));
+                    renewAt = std::chrono::system_clock::now() + retryDelay;
+                    condition.notify_all();
+                }
+            }
+            waiters = std::move(fetch.waiters);
+        }
+        for (auto& waiter : waiters)
+            waiter(ok, ok ? grant.token : std::string());
+        if (!renewWith.empty())
+            renew(renewWith);
+    }
+
+    const TokenManager::CachedToken* TokenManager::Cached(const std::string& key) const
+    {
+        auto cached = cache.find(key);
+        if (cached == cache.end())
+            return nullptr;
+        // Trusted until the SDK says otherwise when the expiry is unknown
+        auto renewal = RenewalTime(cached->second);
+        if (renewal != 0 && renewal <= NowSeconds())
+            return nullptr;
+        return &cached->second;
+    }
+
+    int64_t TokenManager::RenewalTime(const CachedToken& token) const
+    {
+        auto expiresAt = token.grant.expiresAt;
+        if (expiresAt == 0)
+            return 0;
+        auto lifetime = std::max<int64_t>(expiresAt - token.receivedAt, 0);
+        return expiresAt - std::min<int64_t>(options.renewAheadSeconds, lifetime / 2);
+    }
+
+    void TokenManager::ScheduleRenewal(const CachedToken& token)
+    {
+        auto renewal = RenewalTime(token);
+        renewAt = renewal == 0 ? std::chrono::system_clock::time_point::max()
+                               : std::chrono::system_clock::time_point(std::chrono::seconds(renewal));
+        condition.notify_all();
+    }
+
+    void TokenManager::Log(const TokenRequest& request, TokenReason reason, bool ok, bool cached, int64_t latencyNanos)
+    {
+        TokenEvent event;
+        event.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        event.channelId = request.channelId;
+        event.uid = request.uid;
+        event.reason = reason;
+        event.ok = ok;
+        event.cached = cached;
+        event.latencyNanos = latencyNanos;
+        log.push_back(event);
+        if (log.size() > kMaxLogSize)
+            log.pop_front();
+    }
+
+    // static
+    std::string TokenManager::Key(const std::string& channelId, uint32_t uid)
+    {
+        return channelId + "/" + std::to_string(uid);
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,210 @@
+#ifndef AGORA_RTC_ENGINE_TOKEN_MANAGER_H_
+#define AGORA_RTC_ENGINE_TOKEN_MANAGER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "token_provider.h"
+
+namespace agora_rtc_engine {
+
+    struct TokenManagerOptions
+    {
+        // Renews this long before the token expires, ahead of the SDK's
+        // onTokenPrivilegeWillExpire 30 seconds before. Cached tokens closer
+        // to expiry are not handed out.
+        int renewAheadSeconds = 60;
+        // A provider not answering in time fails the fetch.
+        int fetchTimeoutMs = 10000;
+        // Failed renewals are retried after this long, doubling up to
+        // |maxRetryMs|.
+        int retryMs = 1000;
+        int maxRetryMs = 30000;
+    };
+
+    enum class TokenReason
+    {
+        // For joining or switching to a channel
+        Acquire = 0,
+        Prefetch = 1,
+        // Renewed ahead of the expiry
+        Scheduled = 2,
+        WillExpire = 3,
+        // The token expired, the SDK requested a new one
+        Expired = 4,
+    };
+
+    struct TokenEvent
+    {
+        // Milliseconds since the Unix epoch
+        int64_t timeMs = 0;
+        std::string channelId;
+        uint32_t uid = 0;
+        TokenReason reason = TokenReason::Acquire;
+        bool ok = false;
+        // Served from the tokens prefetched or fetched earlier.
+        bool cached = false;
+        // From the trigger to the token being available.
+        int64_t latencyNanos = 0;
+    };
+
+    struct TokenManagerStats
+    {
+        uint64_t fetches = 0;
+        uint64_t failures = 0;
+        uint64_t timeouts = 0;
+        uint64_t cacheHits = 0;
+        uint64_t renewals = 0;
+        int64_t meanFetchNanos = 0;
+        int64_t maxFetchNanos = 0;
+    };
+
+    // Keeps the engine's token valid and has tokens ready before they are
+    // needed, keeping token server round trips off joins and renewals.
+    //
+    // Tokens are fetched from a TokenProvider on a thread of the manager's
+    // own. The token of the channel the engine is in is renewed ahead of its
+    // expiry when that is known, and on onTokenPrivilegeWillExpire and
+    // onRequestToken otherwise. Tokens for other channels can be prefetched
+    // for a later join or switch. Concurrent requests for the same channel
+    // and uid share one fetch.
+    class TokenManager
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Called on any thread, e.g. to call renewToken.
+        using RenewFunction = std::function<void(const std::string& token)>;
+        // Called on any thread, or the calling one for cached tokens.
+        using AcquireFunction = std::function<void(bool ok, const std::string& token)>;
+
+        static const size_t kMaxLogSize = 64;
+
+        explicit TokenManager(RenewFunction renew);
+
+        ~TokenManager();
+
+        // Prevent copying
+        TokenManager(TokenManager const&) = delete;
+        TokenManager& operator=(TokenManager const&) = delete;
+
+        // Starts fetching from |provider|, replacing the current one.
+        void Start(std::shared_ptr<TokenProvider> provider, const TokenManagerOptions& options);
+
+        // Fails the pending acquisitions and forgets the cached tokens.
+        void Stop();
+
+        bool running() const;
+
+        // Gets a valid token for |channelId|, prefetched or fetched now.
+        void Acquire(const std::string& channelId, uint32_t uid, AcquireFunction done);
+
+        void Prefetch(const std::string& channelId, uint32_t uid);
+
+        // The engine joins or switches to |channelId| with |token|, which is
+        // renewed from now on.
+        void OnJoining(const std::string& channelId, uint32_t uid, const std::string& token);
+
+        void OnLeft();
+
+        void OnTokenPrivilegeWillExpire();
+
+        void OnRequestToken();
+
+        std::vector<TokenEvent> GetLog() const;
+
+        TokenManagerStats GetStats() const;
+
+    private:
+        struct CachedToken
+        {
+            TokenGrant grant;
+            // Seconds since the Unix epoch
+            int64_t receivedAt = 0;
+        };
+
+        struct Fetch
+        {
+            uint64_t id = 0;
+            TokenRequest request;
+            TokenReason reason = TokenReason::Acquire;
+            Clock::time_point started;
+            bool sent = false;
+            // Renews the session's token with the result
+            bool renew = false;
+            std::vector<AcquireFunction> waiters;
+        };
+
+        void Run();
+
+        // Starts or joins the fetch for |channelId| and |uid|, called with
+        // |mutex| held.
+        Fetch& Request(const std::string& channelId, uint32_t uid, TokenReason reason);
+
+        // Renews the session's token, from the cache or a fetch. Called with
+        // |mutex| held, returns the token to renew with now if cached.
+        std::string RenewSession(TokenReason reason);
+
+        // Called with the provider's answer, or on a timeout.
+        void OnFetched(const std::string& key, uint64_t id, bool ok, const TokenGrant& grant);
+
+        // Returns a cached token for |key| not due for renewal yet, called
+        // with |mutex| held.
+        const CachedToken* Cached(const std::string& key) const;
+
+        // When |token| is renewed: renewAheadSeconds before it expires, or
+        // halfway through its lifetime if shorter. Seconds since the Unix
+        // epoch, 0 if its expiry is unknown.
+        int64_t RenewalTime(const CachedToken& token) const;
+
+        // Renews the session's token at |token|'s renewal time, called with
+        // |mutex| held.
+        void ScheduleRenewal(const CachedToken& token);
+
+        // Called with |mutex| held.
+        void Log(const TokenRequest& request, TokenReason reason, bool ok, bool cached, int64_t latencyNanos);
+
+        static std::string Key(const std::string& channelId, uint32_t uid);
+
+        RenewFunction renew;
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        bool stopping = false;
+        std::thread worker;
+
+        std::shared_ptr<TokenProvider> provider;
+        TokenManagerOptions options;
+        std::map<std::string, CachedToken> cache;
+        std::map<std::string, Fetch> fetches;
+        uint64_t lastFetchId = 0;
+
+        // The channel the engine is in, empty when none.
+        std::string sessionKey;
+        TokenRequest session;
+        std::string sessionToken;
+        // When to renew the session's token.
+        std::chrono::system_clock::time_point renewAt = std::chrono::system_clock::time_point::max();
+        std::chrono::milliseconds retryDelay{0};
+
+        std::deque<TokenEvent> log;
+        uint64_t fetched = 0;
+        uint64_t failures = 0;
+        uint64_t timeouts = 0;
+        uint64_t cacheHits = 0;
+        uint64_t renewals = 0;
+        int64_t fetchNanos = 0;
+        int64_t maxFetchNanos = 0;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_TOKEN_MANAGER_H_
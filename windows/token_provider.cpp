@@ -0,0 +1,71 @@
+#include "token_provider.h"
+
+#include <chrono>
+#include <thread>
+
+namespace agora_rtc_engine {
+
+    StubTokenProvider::StubTokenProvider(int latencyMs, int ttlSeconds)
+        : latencyMs(latencyMs), ttlSeconds(ttlSeconds)
+    {
+    }
+
+    void StubTokenProvider::Fetch(const TokenRequest& request, Callback done)
+    {
+        // Stands in for the round trip to a token server
+        std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+        auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        TokenGrant grant;
+        grant.expiresAt = now + ttlSeconds;
+        grant.token = "stub:" + request.channelId + ":" + std::to_string(request.uid) + ":" + std::to_string(++issued) + ":" + std::to_string(grant.expiresAt);
+        done(true, grant);
+    }
+
+    CallbackTokenProvider::CallbackTokenProvider(RequestFunction request)
+        : request(std::move(request))
+    {
+    }
+
+    CallbackTokenProvider::~CallbackTokenProvider()
+    {
+        FailAll();
+    }
+
+    void CallbackTokenProvider::Fetch(const TokenRequest& tokenRequest, Callback done)
+    {
+        uint64_t requestId;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requestId = ++lastRequestId;
+            pending[requestId] = std::move(done);
+        }
+        request(requestId, tokenRequest);
+    }
+
+    bool CallbackTokenProvider::Complete(uint64_t requestId, bool ok, const TokenGrant& grant)
+    {
+        Callback done;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = pending.find(requestId);
+            if (found == pending.end())
+                return false;
+            done = std::move(found->second);
+            pending.erase(found);
+        }
+        done(ok, grant);
+        return true;
+    }
+
+    void CallbackTokenProvider::FailAll()
+    {
+        std::map<uint64_t, Callback> failed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed.swap(pending);
+        }
+        for (auto& request : failed)
+            request.second(false, TokenGrant());
+    }
+
+}  // namespace agora_rtc_engine
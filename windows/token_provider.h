@@ -0,0 +1,88 @@
+#ifndef AGORA_RTC_ENGINE_TOKEN_PROVIDER_H_
+#define AGORA_RTC_ENGINE_TOKEN_PROVIDER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace agora_rtc_engine {
+
+    struct TokenRequest
+    {
+        std::string channelId;
+        uint32_t uid = 0;
+    };
+
+    struct TokenGrant
+    {
+        std::string token;
+        // Seconds since the Unix epoch, 0 when unknown.
+        int64_t expiresAt = 0;
+    };
+
+    // Where tokens come from, usually the app's token server.
+    class TokenProvider
+    {
+    public:
+        // Called once, on any thread.
+        using Callback = std::function<void(bool ok, const TokenGrant& grant)>;
+
+        virtual ~TokenProvider() = default;
+
+        // Called on the token manager's thread.
+        virtual void Fetch(const TokenRequest& request, Callback done) = 0;
+    };
+
+    // Makes up tokens locally after a fixed latency, for exercising renewal
+    // without a token server. The SDK only accepts them in channels that do
+    // not require tokens.
+    class StubTokenProvider : public TokenProvider
+    {
+    public:
+        StubTokenProvider(int latencyMs, int ttlSeconds);
+
+        void Fetch(const TokenRequest& request, Callback done) override;
+
+    private:
+        int latencyMs;
+        int ttlSeconds;
+        std::atomic<uint64_t> issued{0};
+    };
+
+    // Hands requests to a function, e.g. to ask Dart, and completes them when
+    // the answer is passed to Complete.
+    class CallbackTokenProvider : public TokenProvider
+    {
+    public:
+        using RequestFunction = std::function<void(uint64_t requestId, const TokenRequest& request)>;
+
+        explicit CallbackTokenProvider(RequestFunction request);
+
+        // Fails the requests not answered yet.
+        ~CallbackTokenProvider() override;
+
+        // Prevent copying
+        CallbackTokenProvider(CallbackTokenProvider const&) = delete;
+        CallbackTokenProvider& operator=(CallbackTokenProvider const&) = delete;
+
+        void Fetch(const TokenRequest& request, Callback done) override;
+
+        // Returns false if |requestId| is unknown or was already completed.
+        bool Complete(uint64_t requestId, bool ok, const TokenGrant& grant);
+
+        void FailAll();
+
+    private:
+        RequestFunction request;
+
+        std::mutex mutex;
+        uint64_t lastRequestId = 0;
+        std::map<uint64_t, Callback> pending;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_TOKEN_PROVIDER_H_
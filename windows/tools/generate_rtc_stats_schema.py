@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Generates rtc_stats_schema.h from the stats structs in IAgoraRtcEngine.h.
+
+Run from the windows directory after updating the SDK:
+
+    python3 tools/generate_rtc_stats_schema.py
+
+Every scalar member of each struct in STRUCTS becomes a field of the
+schema, keyed by its name or by its entry in KEYS. Members that cannot be
+encoded as a scalar, such as arrays, are reported and left out.
+"""
+
+import os
+import re
+import sys
+
+HEADER = os.path.join('sdk', 'include', 'IAgoraRtcEngine.h')
+OUTPUT = 'rtc_stats_schema.h'
+
+STRUCTS = [
+    'RtcStats',
+    'LocalVideoStats',
+    'RemoteVideoStats',
+    'LocalAudioStats',
+    'RemoteAudioStats',
+]
+
+# Keys Dart reads under another name than the member's.
+KEYS = {
+    ('RtcStats', 'duration'): 'totalDuration',
+    ('RtcStats', 'txKBitRate'): 'txKBitrate',
+    ('RtcStats', 'rxKBitRate'): 'rxKBitrate',
+    ('RtcStats', 'txAudioKBitRate'): 'txAudioKBitrate',
+    ('RtcStats', 'rxAudioKBitRate'): 'rxAudioKBitrate',
+    ('RtcStats', 'txVideoKBitRate'): 'txVideoKBitrate',
+    ('RtcStats', 'rxVideoKBitRate'): 'rxVideoKBitrate',
+    ('RtcStats', 'userCount'): 'users',
+}
+
+MEMBER = re.compile(r'^\s*((?:const\s+)?[A-Za-z_][\w:]*(?:\s+[A-Za-z_][\w:]*)*)\s+([A-Za-z_]\w*)\s*(\[[^\]]*\])?\s*;\s*$')
+
+
+def strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', '', text, flags=re.S)
+    return re.sub(r'//[^\n]*', '', text)
+
+
+def struct_body(text, name):
+    match = re.search(r'\bstruct\s+' + name + r'\s*\{', text)
+    if not match:
+        sys.exit('struct %s not found in %s' % (name, HEADER))
+    depth = 1
+    i = match.end()
+    start = i
+    while depth > 0:
+        if text[i] == '{':
+            depth += 1
+        elif text[i] == '}':
+            depth -= 1
+        i += 1
+    return text[start:i - 1]
+
+
+def members(body, name):
+    fields = []
+    depth = 0
+    for line in body.split(';'):
+        # Only declarations at the struct's own level, not constructor bodies
+        statement = line.strip()
+        opened = line.count('{') - line.count('}')
+        if depth == 0 and '(' not in statement and '{' not in statement:
+            match = MEMBER.match(statement + ';')
+            if match:
+                if match.group(3):
+                    print('%s.%s: arrays are not supported, skipped' % (name, match.group(2)), file=sys.stderr)
+                else:
+                    fields.append(match.group(2))
+        depth += opened
+    return fields
+
+
+def macro_name(name):
+    return 'AGORA_RTC_STATS_FIELDS_' + re.sub(r'(?<!^)(?=[A-Z])', '_', name).upper()
+
+
+def main():
+    with open(HEADER, encoding='utf-8', errors='replace') as f:
+        text = strip_comments(f.read())
+
+    lines = [
+        '// Generated by tools/generate_rtc_stats_schema.py from IAgoraRtcEngine.h,',
+        '// do not edit.',
+        '#ifndef AGORA_RTC_ENGINE_RTC_STATS_SCHEMA_H_',
+        '#define AGORA_RTC_ENGINE_RTC_STATS_SCHEMA_H_',
+        '',
+        '// X(type, fields) for each stats struct, where fields(F) calls',
+        '// F(member, key) for each of its members.',
+        '#define AGORA_RTC_STATS_STRUCTS(X) \\',
+    ]
+    lines += ['    X(%s, %s) \\' % (name, macro_name(name)) for name in STRUCTS]
+    lines[-1] = lines[-1][:-2]
+    for name in STRUCTS:
+        fields = members(struct_body(text, name), name)
+        lines += ['', '#define %s(F) \\' % macro_name(name)]
+        lines += ['    F(%s, "%s") \\' % (field, KEYS.get((name, field), field)) for field in fields]
+        lines[-1] = lines[-1][:-2]
+    lines += ['', '#endif  // AGORA_RTC_ENGINE_RTC_STATS_SCHEMA_H_', '']
+
+    with open(OUTPUT, 'w', newline='\n') as f:
+        f.write('\n'.join(lines))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,309 @@
+#include "transcoding_layout.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        // Bursts are cut short after this many debounce periods.
+        const int kMaxDebouncePeriods = 4;
+
+        // Largest tiles of PictureInPicture, relative to the canvas.
+        const int kTileDivisor = 4;
+        const int kTileMargin = 8;
+
+        using agora::rtc::TranscodingUser;
+
+        TranscodingUser MakeUser(unsigned int uid, int x, int y, int width, int height, int zOrder)
+        {
+            TranscodingUser user;
+            user.uid = uid;
+            user.x = x;
+            user.y = y;
+            user.width = width;
+            user.height = height;
+            user.zOrder = zOrder;
+            return user;
+        }
+
+        bool SameUser(const TranscodingUser& a, const TranscodingUser& b)
+        {
+            return a.uid == b.uid && a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height &&
+                a.zOrder == b.zOrder && a.alpha == b.alpha && a.audioChannel == b.audioChannel;
+        }
+
+        bool SameCanvas(const TranscodingLayoutOptions& a, const TranscodingLayoutOptions& b)
+        {
+            return a.width == b.width && a.height == b.height && a.videoBitrate == b.videoBitrate &&
+                a.videoFramerate == b.videoFramerate && a.backgroundColor == b.backgroundColor;
+        }
+
+        // Splits |length| into |count| parts that add up exactly.
+        int Edge(int length, int count, int index)
+        {
+            return static_cast<int>(static_cast<int64_t>(length) * index / count);
+        }
+
+        void LayoutGrid(int width, int height, const std::vector<unsigned int>& uids, std::vector<TranscodingUser>& layout)
+        {
+            auto count = static_cast<int>(uids.size());
+            auto columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+            auto rows = (count + columns - 1) / columns;
+            for (int i = 0; i < count; ++i)
+            {
+                auto row = i / columns;
+                auto column = i % columns;
+                // Center the last, partial row
+                auto inRow = row == rows - 1 ? count - row * columns : columns;
+                auto offset = (columns - inRow) * width / (2 * columns);
+                auto x = offset + Edge(width, columns, column);
+                auto y = Edge(height, rows, row);
+                layout.push_back(MakeUser(uids[static_cast<size_t>(i)], x, y,
+                    Edge(width, columns, column + 1) - Edge(width, columns, column),
+                    Edge(height, rows, row + 1) - y, 0));
+            }
+        }
+
+        void LayoutSpeakerFocus(int width, int height, const std::vector<unsigned int>& uids, std::vector<TranscodingUser>& layout)
+        {
+            auto others = static_cast<int>(uids.size()) - 1;
+            if (others == 0)
+            {
+                layout.push_back(MakeUser(uids[0], 0, 0, width, height, 0));
+                return;
+            }
+            auto stripHeight = height / 4;
+            layout.push_back(MakeUser(uids[0], 0, 0, width, height - stripHeight, 0));
+            for (int i = 0; i < others; ++i)
+            {
+                auto x = Edge(width, others, i);
+                layout.push_back(MakeUser(uids[static_cast<size_t>(i + 1)], x, height - stripHeight,
+                    Edge(width, others, i + 1) - x, stripHeight, 0));
+            }
+        }
+
+        void LayoutPictureInPicture(int width, int height, const std::vector<unsigned int>& uids, std::vector<TranscodingUser>& layout)
+        {
+            layout.push_back(MakeUser(uids[0], 0, 0, width, height, 0));
+            // Smaller tiles once they would not fit in a quarter of the rows
+            auto others = static_cast<double>(uids.size() - 1);
+            auto divisor = std::max(kTileDivisor, static_cast<int>(std::ceil(std::sqrt(others))) + 1);
+            auto tileWidth = width / divisor;
+            auto tileHeight = height / divisor;
+            auto perRow = std::max(1, (width - kTileMargin) / (tileWidth + kTileMargin));
+            for (size_t i = 1; i < uids.size(); ++i)
+            {
+                // From the bottom right corner, leftwards then upwards
+                auto index = static_cast<int>(i - 1);
+                auto x = width - (index % perRow + 1) * (tileWidth + kTileMargin);
+                auto y = height - (index / perRow + 1) * (tileHeight + kTileMargin);
+                layout.push_back(MakeUser(uids[i], x, std::max(0, y), tileWidth, tileHeight, 1));
+            }
+        }
+    }  // namespace
+
+    TranscodingLayoutEngine::TranscodingLayoutEngine(ApplyFunction apply)
+        : apply(std::move(apply))
+    {
+    }
+
+    TranscodingLayoutEngine::~TranscodingLayoutEngine()
+    {
+        Stop();
+    }
+
+    void TranscodingLayoutEngine::Start(const TranscodingLayoutOptions& options)
+    {
+        bool start;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->options = options;
+            start = !running;
+            running = true;
+            // Apply the first layout without waiting
+            dirty = true;
+            firstChange = lastChange = Clock::now() - std::chrono::milliseconds(kMaxDebouncePeriods * options.debounceMs);
+        }
+        if (start)
+            worker = std::thread([this] { Run(); });
+        else
+            condition.notify_one();
+    }
+
+    void TranscodingLayoutEngine::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running)
+                return;
+            running = false;
+        }
+        condition.notify_one();
+        worker.join();
+        hasApplied = false;
+    }
+
+    void TranscodingLayoutEngine::AddUser(unsigned int uid)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (std::find(users.begin(), users.end(), uid) != users.end())
+            return;
+        users.push_back(uid);
+        Touch(Clock::now());
+    }
+
+    void TranscodingLayoutEngine::RemoveUser(unsigned int uid)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find(users.begin(), users.end(), uid);
+        if (it == users.end())
+            return;
+        users.erase(it);
+        Touch(Clock::now());
+    }
+
+    void TranscodingLayoutEngine::ClearUsers()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        users.clear();
+        speaker = 0;
+        Touch(Clock::now());
+    }
+
+    void TranscodingLayoutEngine::SetSpeaker(unsigned int uid)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (speaker == uid)
+            return;
+        speaker = uid;
+        if (options.layout != LayoutTemplate::Grid)
+            Touch(Clock::now());
+    }
+
+    TranscodingLayoutStats TranscodingLayoutEngine::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto result = stats;
+        result.users = static_cast<int>(users.size());
+        if (stats.layouts > 0)
+            result.averageLayoutNanos = totalLayoutNanos / static_cast<int64_t>(stats.layouts);
+        return result;
+    }
+
+    void TranscodingLayoutEngine::ComputeLayout(const TranscodingLayoutOptions& options, const std::vector<unsigned int>& uids,
+        unsigned int speaker, std::vector<TranscodingUser>& layout)
+    {
+        layout.clear();
+        if (uids.empty())
+            return;
+
+        // The speaker goes first and is never left out
+        std::vector<unsigned int> order;
+        order.reserve(std::min(uids.size(), kMaxUsers));
+        auto featured = std::find(uids.begin(), uids.end(), speaker) != uids.end() ? speaker : uids[0];
+        if (options.layout != LayoutTemplate::Grid)
+            order.push_back(featured);
+        for (auto uid : uids)
+        {
+            if (order.size() == kMaxUsers)
+                break;
+            if (options.layout == LayoutTemplate::Grid || uid != featured)
+                order.push_back(uid);
+        }
+
+        switch (options.layout)
+        {
+        case LayoutTemplate::Grid:
+            LayoutGrid(options.width, options.height, order, layout);
+            break;
+        case LayoutTemplate::SpeakerFocus:
+            LayoutSpeakerFocus(options.width, options.height, order, layout);
+            break;
+        case LayoutTemplate::PictureInPicture:
+            LayoutPictureInPicture(options.width, options.height, order, layout);
+            break;
+        }
+    }
+
+    void TranscodingLayoutEngine::Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running)
+        {
+            if (!dirty)
+            {
+                condition.wait(lock);
+                continue;
+            }
+            auto debounce = std::chrono::milliseconds(options.debounceMs);
+            auto deadline = std::min(lastChange + debounce, firstChange + kMaxDebouncePeriods * debounce);
+            if (Clock::now() < deadline)
+            {
+                condition.wait_until(lock, deadline);
+                continue;
+            }
+            dirty = false;
+            lock.unlock();
+            Update();
+            lock.lock();
+        }
+    }
+
+    void TranscodingLayoutEngine::Touch(Clock::time_point now)
+    {
+        stats.changes++;
+        if (!dirty)
+            firstChange = now;
+        lastChange = now;
+        dirty = true;
+        if (running)
+            condition.notify_one();
+    }
+
+    void TranscodingLayoutEngine::Update()
+    {
+        TranscodingLayoutOptions current;
+        std::vector<unsigned int> uids;
+        unsigned int featured;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = options;
+            uids = users;
+            featured = speaker;
+        }
+
+        auto start = Clock::now();
+        ComputeLayout(current, uids, featured, layout);
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+        auto unchanged = hasApplied && SameCanvas(current, appliedOptions) && layout.size() == appliedLayout.size() &&
+            std::equal(layout.begin(), layout.end(), appliedLayout.begin(), SameUser);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.layouts++;
+            totalLayoutNanos += nanos;
+            if (unchanged)
+                stats.unchanged++;
+            else
+                stats.applied++;
+        }
+        if (unchanged)
+            return;
+
+        agora::rtc::LiveTranscoding transcoding;
+        transcoding.width = current.width;
+        transcoding.height = current.height;
+        transcoding.videoBitrate = current.videoBitrate;
+        transcoding.videoFramerate = current.videoFramerate;
+        transcoding.backgroundColor = current.backgroundColor;
+        transcoding.userCount = static_cast<unsigned int>(layout.size());
+        transcoding.transcodingUsers = layout.empty() ? nullptr : layout.data();
+        apply(transcoding);
+
+        appliedLayout.swap(layout);
+        appliedOptions = current;
+        hasApplied = true;
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,129 @@
+#ifndef AGORA_RTC_ENGINE_TRANSCODING_LAYOUT_H_
+#define AGORA_RTC_ENGINE_TRANSCODING_LAYOUT_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IAgoraRtcEngine.h"
+
+namespace agora_rtc_engine {
+
+    enum class LayoutTemplate
+    {
+        // Equal cells, as close to square as the user count allows.
+        Grid = 0,
+        // The speaker above a strip of the other users.
+        SpeakerFocus = 1,
+        // The speaker full size, the other users in small tiles on top.
+        PictureInPicture = 2,
+    };
+
+    struct TranscodingLayoutOptions
+    {
+        LayoutTemplate layout = LayoutTemplate::Grid;
+        int width = 640;
+        int height = 360;
+        int videoBitrate = 400;
+        int videoFramerate = 15;
+        unsigned int backgroundColor = 0;
+        // Changes within this long of each other are applied together.
+        int debounceMs = 200;
+    };
+
+    struct TranscodingLayoutStats
+    {
+        int users = 0;
+        // Joins, leaves and speaker changes seen.
+        uint64_t changes = 0;
+        uint64_t layouts = 0;
+        uint64_t applied = 0;
+        // Layouts identical to the one already applied.
+        uint64_t unchanged = 0;
+        int64_t averageLayoutNanos = 0;
+    };
+
+    // Maintains the transcoding user set and applies a layout template to it.
+    //
+    // Users are added and removed as they join and leave. A background thread
+    // waits for bursts of changes to settle, recomputes the layout and only
+    // calls the apply function when the result differs from the last one
+    // applied. Continuous churn is still applied every four debounce periods.
+    class TranscodingLayoutEngine
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        // Called on the layout thread, e.g. to call setLiveTranscoding.
+        using ApplyFunction = std::function<void(const agora::rtc::LiveTranscoding& transcoding)>;
+
+        // The most users a transcoding can hold, later users are left out.
+        static constexpr size_t kMaxUsers = 17;
+
+        explicit TranscodingLayoutEngine(ApplyFunction apply);
+
+        ~TranscodingLayoutEngine();
+
+        // Prevent copying
+        TranscodingLayoutEngine(TranscodingLayoutEngine const&) = delete;
+        TranscodingLayoutEngine& operator=(TranscodingLayoutEngine const&) = delete;
+
+        // Starts or reconfigures layouts, applying one right away.
+        void Start(const TranscodingLayoutOptions& options);
+
+        // Stops applying layouts. Users are still tracked.
+        void Stop();
+
+        void AddUser(unsigned int uid);
+
+        void RemoveUser(unsigned int uid);
+
+        void ClearUsers();
+
+        // The user featured by SpeakerFocus and PictureInPicture, the first
+        // user when not set.
+        void SetSpeaker(unsigned int uid);
+
+        TranscodingLayoutStats GetStats() const;
+
+        // Lays out up to kMaxUsers of |uids| in join order.
+        static void ComputeLayout(const TranscodingLayoutOptions& options, const std::vector<unsigned int>& uids,
+            unsigned int speaker, std::vector<agora::rtc::TranscodingUser>& layout);
+
+    private:
+        void Run();
+
+        // Marks the layout as changed, called with |mutex| held.
+        void Touch(Clock::time_point now);
+
+        void Update();
+
+        ApplyFunction apply;
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        TranscodingLayoutOptions options;
+        std::vector<unsigned int> users;
+        unsigned int speaker = 0;
+        bool running = false;
+        bool dirty = false;
+        Clock::time_point firstChange;
+        Clock::time_point lastChange;
+        TranscodingLayoutStats stats;
+        int64_t totalLayoutNanos = 0;
+
+        // Owned by the layout thread
+        std::vector<agora::rtc::TranscodingUser> layout;
+        std::vector<agora::rtc::TranscodingUser> appliedLayout;
+        TranscodingLayoutOptions appliedOptions;
+        bool hasApplied = false;
+
+        std::thread worker;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_TRANSCODING_LAYOUT_H_
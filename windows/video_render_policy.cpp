@@ -0,0 +1,144 @@
+#include "video_render_policy.h"
+
+#include <algorithm>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        uint64_t I420Size(int width, int height)
+        {
+            return static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * 3 / 2;
+        }
+
+        void Accumulate(RenderPolicyCounters& total, const RenderPolicyCounters& counters)
+        {
+            total.delivered += counters.delivered;
+            total.droppedHidden += counters.droppedHidden;
+            total.droppedRate += counters.droppedRate;
+            total.droppedStale += counters.droppedStale;
+            total.droppedSize += counters.droppedSize;
+            total.skippedBytes += counters.skippedBytes;
+        }
+    }  // namespace
+
+    void VideoRenderPolicy::SetPolicy(unsigned int uid, const RenderPolicy& policy)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& entry = entries[uid];
+        entry.policy = policy;
+        entry.counters.uid = uid;
+        // Let the next frame through right away so a tile that becomes visible
+        // is refreshed without waiting for the old interval.
+        entry.nextDue = Clock::time_point{};
+    }
+
+    void VideoRenderPolicy::RemovePolicy(unsigned int uid)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(uid);
+        if (it != entries.end())
+            it->second.policy = RenderPolicy();
+    }
+
+    void VideoRenderPolicy::RemoveUser(unsigned int uid)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(uid);
+        if (it == entries.end())
+            return;
+        Accumulate(removed, it->second.counters);
+        entries.erase(it);
+    }
+
+    void VideoRenderPolicy::RemoveRemoteUsers()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (it->first == 0)
+            {
+                ++it;
+                continue;
+            }
+            Accumulate(removed, it->second.counters);
+            it = entries.erase(it);
+        }
+    }
+
+    void VideoRenderPolicy::Reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        removed = RenderPolicyCounters();
+    }
+
+    bool VideoRenderPolicy::Admit(unsigned int uid, int width, int height, int64_t renderTimeMs, Clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& entry = entries[uid];
+        entry.counters.uid = uid;
+        auto& counters = entry.counters;
+        const auto& policy = entry.policy;
+
+        if (!policy.visible)
+        {
+            counters.droppedHidden++;
+            counters.skippedBytes += I420Size(width, height);
+            return false;
+        }
+
+        // Larger than the tile, e.g. the high-quality stream while the switch
+        // to the low-quality one takes effect
+        if ((policy.maxWidth > 0 && width > policy.maxWidth) || (policy.maxHeight > 0 && height > policy.maxHeight))
+        {
+            counters.droppedSize++;
+            counters.skippedBytes += I420Size(width, height);
+            return false;
+        }
+
+        // A frame that is not newer than the last one delivered is out of date
+        // by the time it would be shown.
+        if (renderTimeMs != 0 && renderTimeMs <= entry.lastRenderTimeMs)
+        {
+            counters.droppedStale++;
+            counters.skippedBytes += I420Size(width, height);
+            return false;
+        }
+
+        if (policy.maxFps > 0)
+        {
+            auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / policy.maxFps;
+            // Accept frames slightly ahead of schedule so that a source running
+            // at a multiple of the target rate is not thinned unevenly.
+            if (now + interval / 4 < entry.nextDue)
+            {
+                counters.droppedRate++;
+                counters.skippedBytes += I420Size(width, height);
+                return false;
+            }
+            // Scheduled from now rather than the missed due time after a
+            // pause, otherwise it would be followed by a burst.
+            entry.nextDue = std::max(entry.nextDue, now) + interval;
+        }
+
+        if (renderTimeMs != 0)
+            entry.lastRenderTimeMs = renderTimeMs;
+        counters.delivered++;
+        return true;
+    }
+
+    RenderPolicyStats VideoRenderPolicy::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        RenderPolicyStats stats;
+        stats.users.reserve(entries.size());
+        Accumulate(stats.total, removed);
+        for (const auto& item : entries)
+        {
+            stats.users.push_back(item.second.counters);
+            Accumulate(stats.total, item.second.counters);
+        }
+        return stats;
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,88 @@
+#ifndef AGORA_RTC_ENGINE_VIDEO_RENDER_POLICY_H_
+#define AGORA_RTC_ENGINE_VIDEO_RENDER_POLICY_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace agora_rtc_engine {
+
+    // How the frames of one uid should reach the native render path.
+    // A value of 0 for the limits means "unlimited". Frames larger than
+    // |maxWidth| x |maxHeight| are dropped.
+    struct RenderPolicy
+    {
+        bool visible = true;
+        int maxFps = 0;
+        int maxWidth = 0;
+        int maxHeight = 0;
+    };
+
+    struct RenderPolicyCounters
+    {
+        unsigned int uid = 0;
+        uint64_t delivered = 0;
+        uint64_t droppedHidden = 0;
+        uint64_t droppedRate = 0;
+        uint64_t droppedStale = 0;
+        uint64_t droppedSize = 0;
+        // Bytes of I420 data that were not touched because of drops.
+        uint64_t skippedBytes = 0;
+    };
+
+    struct RenderPolicyStats
+    {
+        std::vector<RenderPolicyCounters> users;
+        RenderPolicyCounters total;
+    };
+
+    // Per-uid admission control for IVideoFrameObserver callbacks.
+    //
+    // |Admit| runs at the very top of onCaptureVideoFrame/onRenderVideoFrame,
+    // before any frame data is read, so it only looks at the frame geometry
+    // and timestamp.
+    class VideoRenderPolicy
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        void SetPolicy(unsigned int uid, const RenderPolicy& policy);
+
+        void RemovePolicy(unsigned int uid);
+
+        // Forgets the policy and timing state of |uid|, e.g. when the user
+        // goes offline. Its counters still count towards the total.
+        void RemoveUser(unsigned int uid);
+
+        // Forgets all remote uids, when leaving the channel.
+        void RemoveRemoteUsers();
+
+        // Forgets all policies, counters and per-uid timing state.
+        void Reset();
+
+        // Returns true if the frame should be processed, false if it should be
+        // dropped.
+        bool Admit(unsigned int uid, int width, int height, int64_t renderTimeMs, Clock::time_point now);
+
+        RenderPolicyStats GetStats() const;
+
+    private:
+        struct Entry
+        {
+            RenderPolicy policy;
+            RenderPolicyCounters counters;
+            Clock::time_point nextDue{};
+            int64_t lastRenderTimeMs = 0;
+        };
+
+        mutable std::mutex mutex;
+        std::unordered_map<unsigned int, Entry> entries;
+        // The counters of the uids removed since the last reset
+        RenderPolicyCounters removed;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_VIDEO_RENDER_POLICY_H_
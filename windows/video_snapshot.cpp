@@ -0,0 +1,248 @@
+#include "video_snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace agora_rtc_engine {
+
+    namespace {
+        const size_t kEncoderThreads = 2;
+
+        const float kJpegQuality = 0.85f;
+
+        uint8_t Clamp(int value)
+        {
+            return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+        }
+
+        void CopyPlane(const void* source, int sourceStride, int width, int height, std::vector<uint8_t>& plane)
+        {
+            plane.resize(static_cast<size_t>(width) * height);
+            auto from = static_cast<const uint8_t*>(source);
+            for (int row = 0; row < height; ++row)
+                std::memcpy(plane.data() + static_cast<size_t>(row) * width, from + static_cast<size_t>(row) * sourceStride, width);
+        }
+    }  // namespace
+
+    VideoSnapshotService::VideoSnapshotService()
+        : encoders(kEncoderThreads)
+    {
+    }
+
+    void VideoSnapshotService::Request(unsigned int uid, int maxSize, ImageFormat format, Callback callback)
+    {
+        requested++;
+        std::vector<Waiter> expired;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = Clock::now();
+            ExpireLocked(now, expired);
+            auto& entry = pending[uid];
+            if (entry.waiters.empty())
+                entry.deadline = now + kSnapshotTimeout;
+            else
+                coalesced++;
+            entry.waiters.push_back(Waiter{maxSize, format, std::move(callback)});
+            pendingCount.store(pending.size(), std::memory_order_release);
+        }
+        Fail(expired, SnapshotStatus::TimedOut);
+    }
+
+    void VideoSnapshotService::OnVideoFrame(unsigned int uid, const VideoFrame& frame)
+    {
+        if (pendingCount.load(std::memory_order_acquire) == 0)
+            return;
+        if (frame.type != agora::media::IVideoFrameObserver::FRAME_TYPE_YUV420)
+            return;
+
+        std::vector<Waiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = pending.find(uid);
+            if (it == pending.end())
+                return;
+            waiters = std::move(it->second.waiters);
+            pending.erase(it);
+            pendingCount.store(pending.size(), std::memory_order_release);
+        }
+
+        // The SDK buffers are only valid during the callback
+        I420Image image;
+        image.width = frame.width;
+        image.height = frame.height;
+        auto chromaWidth = (frame.width + 1) / 2;
+        auto chromaHeight = (frame.height + 1) / 2;
+        CopyPlane(frame.yBuffer, frame.yStride, frame.width, frame.height, image.y);
+        CopyPlane(frame.uBuffer, frame.uStride, chromaWidth, chromaHeight, image.u);
+        CopyPlane(frame.vBuffer, frame.vStride, chromaWidth, chromaHeight, image.v);
+        captured++;
+
+        encoders.Post([this, image = std::move(image), waiters = std::move(waiters)]() mutable {
+            Encode(image, waiters);
+        });
+    }
+
+    void VideoSnapshotService::Expire(Clock::time_point now)
+    {
+        std::vector<Waiter> expired;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ExpireLocked(now, expired);
+        }
+        Fail(expired, SnapshotStatus::TimedOut);
+    }
+
+    void VideoSnapshotService::Cancel(unsigned int uid)
+    {
+        std::vector<Waiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = pending.find(uid);
+            if (it == pending.end())
+                return;
+            waiters = std::move(it->second.waiters);
+            pending.erase(it);
+            pendingCount.store(pending.size(), std::memory_order_release);
+        }
+        Fail(waiters, SnapshotStatus::Cancelled);
+    }
+
+    void VideoSnapshotService::CancelAll()
+    {
+        std::vector<Waiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& item : pending)
+                for (auto& waiter : item.second.waiters)
+                    waiters.push_back(std::move(waiter));
+            pending.clear();
+            pendingCount.store(0, std::memory_order_release);
+        }
+        Fail(waiters, SnapshotStatus::Cancelled);
+    }
+
+    SnapshotStats VideoSnapshotService::GetStats()
+    {
+        Expire(Clock::now());
+
+        SnapshotStats stats;
+        stats.requested = requested;
+        stats.coalesced = coalesced;
+        stats.captured = captured;
+        stats.encoded = encoded;
+        stats.failed = failed;
+        if (stats.encoded > 0)
+            stats.averageEncodeMicros = encodeMicros / static_cast<int64_t>(stats.encoded);
+        return stats;
+    }
+
+    void VideoSnapshotService::ExpireLocked(Clock::time_point now, std::vector<Waiter>& expired)
+    {
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            if (it->second.deadline > now)
+            {
+                ++it;
+                continue;
+            }
+            for (auto& waiter : it->second.waiters)
+                expired.push_back(std::move(waiter));
+            it = pending.erase(it);
+        }
+        pendingCount.store(pending.size(), std::memory_order_release);
+    }
+
+    void VideoSnapshotService::Fail(std::vector<Waiter>& waiters, SnapshotStatus status)
+    {
+        failed += waiters.size();
+        for (auto& waiter : waiters)
+            waiter.callback(status, std::vector<uint8_t>());
+    }
+
+    void VideoSnapshotService::Encode(const I420Image& image, std::vector<Waiter>& waiters)
+    {
+        // Scale once per size and encode once per size and format
+        std::sort(waiters.begin(), waiters.end(), [](const Waiter& a, const Waiter& b) {
+            return a.maxSize != b.maxSize ? a.maxSize < b.maxSize : a.format < b.format;
+        });
+
+        std::vector<uint8_t> bgr;
+        std::vector<uint8_t> bytes;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+        for (size_t i = 0; i < waiters.size(); ++i)
+        {
+            auto& waiter = waiters[i];
+            auto newSize = i == 0 || waiter.maxSize != waiters[i - 1].maxSize;
+            if (newSize)
+                ScaleToBgr(image, waiter.maxSize, bgr, width, height, stride);
+            if (newSize || waiter.format != waiters[i - 1].format)
+            {
+                auto start = Clock::now();
+                if (!EncodeImage(bgr.data(), width, height, stride, waiter.format, kJpegQuality, bytes))
+                    bytes.clear();
+                encodeMicros += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+            }
+
+            if (bytes.empty())
+            {
+                failed++;
+                waiter.callback(SnapshotStatus::EncodeFailed, std::vector<uint8_t>());
+                continue;
+            }
+            encoded++;
+            waiter.callback(SnapshotStatus::Captured, bytes);
+        }
+    }
+
+    // static
+    void VideoSnapshotService::ScaleToBgr(const I420Image& image, int maxSize,
+        std::vector<uint8_t>& bgr, int& width, int& height, int& stride)
+    {
+        width = image.width;
+        height = image.height;
+        auto longer = std::max(width, height);
+        if (maxSize > 0 && longer > maxSize)
+        {
+            width = std::max(1, static_cast<int>(static_cast<int64_t>(image.width) * maxSize / longer));
+            height = std::max(1, static_cast<int>(static_cast<int64_t>(image.height) * maxSize / longer));
+        }
+        // WIC expects rows aligned to 4 bytes
+        stride = (width * 3 + 3) & ~3;
+        bgr.assign(static_cast<size_t>(stride) * height, 0);
+
+        auto chromaWidth = (image.width + 1) / 2;
+        for (int dy = 0; dy < height; ++dy)
+        {
+            auto y0 = static_cast<int>(static_cast<int64_t>(dy) * image.height / height);
+            auto y1 = std::max(y0 + 1, static_cast<int>(static_cast<int64_t>(dy + 1) * image.height / height));
+            auto row = bgr.data() + static_cast<size_t>(dy) * stride;
+            for (int dx = 0; dx < width; ++dx)
+            {
+                auto x0 = static_cast<int>(static_cast<int64_t>(dx) * image.width / width);
+                auto x1 = std::max(x0 + 1, static_cast<int>(static_cast<int64_t>(dx + 1) * image.width / width));
+
+                // Box filter the luma, sample the chroma at the center
+                int sum = 0;
+                for (int sy = y0; sy < y1; ++sy)
+                {
+                    auto source = image.y.data() + static_cast<size_t>(sy) * image.width;
+                    for (int sx = x0; sx < x1; ++sx)
+                        sum += source[sx];
+                }
+                auto luma = sum / ((y1 - y0) * (x1 - x0));
+                auto chroma = static_cast<size_t>((y0 + y1) / 4) * chromaWidth + (x0 + x1) / 4;
+                auto u = image.u[chroma] - 128;
+                auto v = image.v[chroma] - 128;
+
+                // BT.601 limited range
+                auto c = (luma - 16) * 298;
+                row[dx * 3 + 0] = Clamp((c + 516 * u + 128) >> 8);
+                row[dx * 3 + 1] = Clamp((c - 100 * u - 208 * v + 128) >> 8);
+                row[dx * 3 + 2] = Clamp((c + 409 * v + 128) >> 8);
+            }
+        }
+    }
+
+}  // namespace agora_rtc_engine
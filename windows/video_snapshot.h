@@ -0,0 +1,136 @@
+#ifndef AGORA_RTC_ENGINE_VIDEO_SNAPSHOT_H_
+#define AGORA_RTC_ENGINE_VIDEO_SNAPSHOT_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "IAgoraMediaEngine.h"
+
+#include "image_encoder.h"
+#include "worker_pool.h"
+
+namespace agora_rtc_engine {
+
+    // How long a request waits for a frame, e.g. from a user that does not
+    // publish video.
+    const std::chrono::seconds kSnapshotTimeout(5);
+
+    enum class SnapshotStatus
+    {
+        Captured = 0,
+        // No frame arrived within kSnapshotTimeout.
+        TimedOut = 1,
+        // The user went offline or the engine was destroyed.
+        Cancelled = 2,
+        EncodeFailed = 3,
+    };
+
+    struct SnapshotStats
+    {
+        uint64_t requested = 0;
+        // Requests that shared a frame with an earlier pending request.
+        uint64_t coalesced = 0;
+        uint64_t captured = 0;
+        uint64_t encoded = 0;
+        uint64_t failed = 0;
+        int64_t averageEncodeMicros = 0;
+    };
+
+    // Takes still images of the video of any uid (0 for the local capture).
+    //
+    // A request waits for the next frame of its uid; all requests pending for
+    // the same uid share that frame. Only copying the frame happens on the
+    // video thread, scaling and encoding run on a worker pool.
+    //
+    // The owner calls |Expire| once kSnapshotTimeout after each request, so
+    // that requests fail even if their uid never sends a frame.
+    class VideoSnapshotService
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using VideoFrame = agora::media::IVideoFrameObserver::VideoFrame;
+        // Called on a worker thread, or on the calling thread for requests that
+        // are cancelled or time out. |encoded| is empty unless |status| is
+        // Captured.
+        using Callback = std::function<void(SnapshotStatus status, std::vector<uint8_t> encoded)>;
+
+        VideoSnapshotService();
+
+        // |maxSize| bounds the longer side of the image, 0 keeps the frame size.
+        void Request(unsigned int uid, int maxSize, ImageFormat format, Callback callback);
+
+        // Copies |frame| if a snapshot of |uid| is pending. Cheap otherwise.
+        void OnVideoFrame(unsigned int uid, const VideoFrame& frame);
+
+        // Fails the requests that waited for a frame until |now|.
+        void Expire(Clock::time_point now);
+
+        // Fails the pending requests of |uid|, e.g. when the user goes offline.
+        void Cancel(unsigned int uid);
+
+        void CancelAll();
+
+        SnapshotStats GetStats();
+
+    private:
+        struct Waiter
+        {
+            int maxSize;
+            ImageFormat format;
+            Callback callback;
+        };
+
+        struct Pending
+        {
+            std::vector<Waiter> waiters;
+            Clock::time_point deadline;
+        };
+
+        // A frame copied out of the SDK buffers, with tightly packed planes.
+        struct I420Image
+        {
+            int width = 0;
+            int height = 0;
+            std::vector<uint8_t> y;
+            std::vector<uint8_t> u;
+            std::vector<uint8_t> v;
+        };
+
+        // Takes the requests that waited longer than kSnapshotTimeout for a
+        // frame.
+        void ExpireLocked(Clock::time_point now, std::vector<Waiter>& expired);
+
+        void Fail(std::vector<Waiter>& waiters, SnapshotStatus status);
+
+        void Encode(const I420Image& image, std::vector<Waiter>& waiters);
+
+        // Box-filters |image| so that its longer side is at most |maxSize| and
+        // converts it to 24-bit BGR.
+        static void ScaleToBgr(const I420Image& image, int maxSize,
+            std::vector<uint8_t>& bgr, int& width, int& height, int& stride);
+
+        std::mutex mutex;
+        std::unordered_map<unsigned int, Pending> pending;
+        // Lets the video thread skip the lock when nothing is pending.
+        std::atomic<size_t> pendingCount{0};
+
+        std::atomic<uint64_t> requested{0};
+        std::atomic<uint64_t> coalesced{0};
+        std::atomic<uint64_t> captured{0};
+        std::atomic<uint64_t> encoded{0};
+        std::atomic<uint64_t> failed{0};
+        std::atomic<int64_t> encodeMicros{0};
+
+        // Declared last so the workers are joined before the state they use is
+        // destroyed.
+        WorkerPool encoders;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_VIDEO_SNAPSHOT_H_
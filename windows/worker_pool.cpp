@@ -0,0 +1,55 @@
+#include "worker_pool.h"
+
+namespace agora_rtc_engine {
+
+    WorkerPool::WorkerPool(size_t threadCount)
+    {
+        threads.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i)
+            threads.emplace_back([this] { Run(); });
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    void WorkerPool::Post(Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        condition.notify_one();
+    }
+
+    size_t WorkerPool::QueueDepth() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tasks.size();
+    }
+
+    void WorkerPool::Run()
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+}  // namespace agora_rtc_engine
@@ -0,0 +1,46 @@
+#ifndef AGORA_RTC_ENGINE_WORKER_POOL_H_
+#define AGORA_RTC_ENGINE_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace agora_rtc_engine {
+
+    // A fixed set of threads running posted tasks in FIFO order, for work that
+    // must stay off both the platform thread and the SDK callback threads.
+    class WorkerPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        explicit WorkerPool(size_t threadCount);
+
+        // Runs the tasks already posted, then joins the threads.
+        ~WorkerPool();
+
+        // Prevent copying
+        WorkerPool(WorkerPool const&) = delete;
+        WorkerPool& operator=(WorkerPool const&) = delete;
+
+        void Post(Task task);
+
+        // Number of tasks posted but not yet started.
+        size_t QueueDepth() const;
+
+    private:
+        void Run();
+
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Task> tasks;
+        bool stopping = false;
+        std::vector<std::thread> threads;
+    };
+
+}  // namespace agora_rtc_engine
+
+#endif  // AGORA_RTC_ENGINE_WORKER_POOL_H_